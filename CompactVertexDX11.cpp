@@ -0,0 +1,262 @@
+//--------------------------------------------------------------------------------
+
+
+#include "PCH.h"
+#include "CompactVertexDX11.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+//--------------------------------------------------------------------------------
+using namespace Glyph3;
+//--------------------------------------------------------------------------------
+static_assert(sizeof(CompactVertexDX11::Vertex) == 28, "CompactVertexDX11::Vertex must stay packed");
+static_assert(sizeof(CompactBasicVertexDX11::Vertex) == 20, "CompactBasicVertexDX11::Vertex must stay packed");
+//--------------------------------------------------------------------------------
+namespace
+{
+	VertexElementsDX11<CompactVertexDX11::GetLayout().GetAttributeCount()> CompactElements = CompactVertexDX11::GetLayout().GetElements();
+	VertexElementsDX11<CompactBasicVertexDX11::GetLayout().GetAttributeCount()> CompactBasicElements = CompactBasicVertexDX11::GetLayout().GetElements();
+}
+//--------------------------------------------------------------------------------
+D3D11_INPUT_ELEMENT_DESC* CompactVertexDX11::Elements = CompactElements.items;
+D3D11_INPUT_ELEMENT_DESC* CompactBasicVertexDX11::Elements = CompactBasicElements.items;
+//--------------------------------------------------------------------------------
+namespace
+{
+	const float SNORM16 = 32767.0f;
+
+	int16_t ToSnorm16(float value)
+	{
+		return (int16_t)std::lround(std::min(std::max(value, -1.0f), 1.0f) * SNORM16);
+	}
+
+	float FromSnorm16(int16_t value)
+	{
+		return std::max((float)value / SNORM16, -1.0f);
+	}
+
+	uint16_t ToUnorm16(float value)
+	{
+		return (uint16_t)std::lround(std::min(std::max(value, 0.0f), 1.0f) * 65535.0f);
+	}
+
+	uint8_t ToUnorm8(float value)
+	{
+		return (uint8_t)std::lround(std::min(std::max(value, 0.0f), 1.0f) * 255.0f);
+	}
+
+	// Rounds to nearest even, like the hardware conversion
+	uint16_t ToHalf(float value)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+
+		uint32_t sign = (bits >> 16) & 0x8000u;
+		uint32_t magnitude = bits & 0x7FFFFFFFu;
+
+		if (magnitude > 0x7F800000u)
+			return (uint16_t)(sign | 0x7E00u);					// NaN
+		if (magnitude >= 0x47800000u)
+			return (uint16_t)(sign | 0x7C00u);					// Too large, infinity
+		if (magnitude < 0x38800000u)
+		{
+			// Below the smallest normal half, shift the mantissa into a subnormal
+			if (magnitude < 0x33000000u)
+				return (uint16_t)sign;
+			uint32_t exponent = magnitude >> 23;
+			uint32_t mantissa = (magnitude & 0x7FFFFFu) | 0x800000u;
+			uint32_t shift = 126 - exponent;
+			uint32_t half = mantissa >> shift;
+			uint32_t rest = mantissa & ((1u << shift) - 1);
+			uint32_t midway = 1u << (shift - 1);
+			if (rest > midway || (rest == midway && (half & 1)))
+				half++;
+			return (uint16_t)(sign | half);
+		}
+
+		uint32_t half = (magnitude - 0x38000000u) >> 13;
+		uint32_t rest = magnitude & 0x1FFFu;
+		if (rest > 0x1000u || (rest == 0x1000u && (half & 1)))
+			half++;
+		return (uint16_t)(sign | half);
+	}
+
+	float FromHalf(uint16_t value)
+	{
+		uint32_t sign = (uint32_t)(value & 0x8000u) << 16;
+		uint32_t exponent = (value >> 10) & 0x1Fu;
+		uint32_t mantissa = value & 0x3FFu;
+
+		if (exponent == 0)
+		{
+			float subnormal = std::ldexp((float)mantissa, -24);
+			return sign ? -subnormal : subnormal;
+		}
+
+		uint32_t bits = sign | (exponent == 31 ? 0x7F800000u : (exponent + 112) << 23) | (mantissa << 13);
+		float result;
+		std::memcpy(&result, &bits, sizeof(result));
+		return result;
+	}
+
+	Vector3f OctDecode(float ex, float ey)
+	{
+		Vector3f n(ex, ey, 1.0f - std::fabs(ex) - std::fabs(ey));
+		float fold = std::max(-n.z, 0.0f);
+		n.x += n.x >= 0.0f ? -fold : fold;
+		n.y += n.y >= 0.0f ? -fold : fold;
+		n.Normalize();
+		return n;
+	}
+
+	// Of the four codes around the exact one, keeps whichever decodes closest to n
+	void OctEncode(const Vector3f& n, int16_t* code)
+	{
+		float l1 = std::fabs(n.x) + std::fabs(n.y) + std::fabs(n.z);
+		float px = l1 > 0.0f ? n.x / l1 : 0.0f;
+		float py = l1 > 0.0f ? n.y / l1 : 0.0f;
+		if (n.z < 0.0f)
+		{
+			float fx = (1.0f - std::fabs(py)) * (px >= 0.0f ? 1.0f : -1.0f);
+			float fy = (1.0f - std::fabs(px)) * (py >= 0.0f ? 1.0f : -1.0f);
+			px = fx;
+			py = fy;
+		}
+
+		float baseX = std::floor(std::min(std::max(px, -1.0f), 1.0f) * SNORM16);
+		float baseY = std::floor(std::min(std::max(py, -1.0f), 1.0f) * SNORM16);
+		float bestDot = -2.0f;
+		for (int dx = 0; dx < 2; dx++)
+		{
+			for (int dy = 0; dy < 2; dy++)
+			{
+				float cx = std::min(baseX + dx, SNORM16);
+				float cy = std::min(baseY + dy, SNORM16);
+				Vector3f d = OctDecode(cx / SNORM16, cy / SNORM16);
+				float dot = d.x * n.x + d.y * n.y + d.z * n.z;
+				if (dot > bestDot)
+				{
+					bestDot = dot;
+					code[0] = (int16_t)cx;
+					code[1] = (int16_t)cy;
+				}
+			}
+		}
+	}
+
+	void EncodePosition(const Vector3f& p, const CompactVertexBounds& bounds, float w, int16_t* code)
+	{
+		// Flat axes keep a unit extent so they divide safely
+		const Vector3f& c = bounds.centre;
+		const Vector3f& e = bounds.extent;
+		code[0] = ToSnorm16((p.x - c.x) / (e.x > 0.0f ? e.x : 1.0f));
+		code[1] = ToSnorm16((p.y - c.y) / (e.y > 0.0f ? e.y : 1.0f));
+		code[2] = ToSnorm16((p.z - c.z) / (e.z > 0.0f ? e.z : 1.0f));
+		code[3] = ToSnorm16(w);
+	}
+
+	Vector3f DecodePosition(const int16_t* code, const CompactVertexBounds& bounds)
+	{
+		const Vector3f& c = bounds.centre;
+		const Vector3f& e = bounds.extent;
+		return Vector3f(c.x + FromSnorm16(code[0]) * (e.x > 0.0f ? e.x : 1.0f),
+			c.y + FromSnorm16(code[1]) * (e.y > 0.0f ? e.y : 1.0f),
+			c.z + FromSnorm16(code[2]) * (e.z > 0.0f ? e.z : 1.0f));
+	}
+
+	Vector3f Cross(const Vector3f& a, const Vector3f& b)
+	{
+		return Vector3f(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+	}
+}
+//--------------------------------------------------------------------------------
+CompactVertexDX11::CompactVertexDX11()
+{
+
+}
+//--------------------------------------------------------------------------------
+CompactVertexDX11::~CompactVertexDX11()
+{
+
+}
+//--------------------------------------------------------------------------------
+unsigned int CompactVertexDX11::GetElementCount()
+{
+	return(GetLayout().GetAttributeCount());
+}
+//--------------------------------------------------------------------------------
+CompactVertexDX11::Vertex CompactVertexDX11::Encode(const CustomVertexDX11::Vertex& vertex, const CompactVertexBounds& bounds)
+{
+	// The binormal keeps only which side of the normal and tangent it lies on
+	Vector3f side = Cross(vertex.normal, vertex.tangent);
+	float handedness = side.x * vertex.binormal.x + side.y * vertex.binormal.y + side.z * vertex.binormal.z;
+
+	Vertex packed;
+	EncodePosition(vertex.position, bounds, handedness < 0.0f ? -1.0f : 1.0f, packed.position);
+	OctEncode(vertex.normal, packed.normal);
+	OctEncode(vertex.tangent, packed.tangent);
+	packed.color[0] = ToUnorm8(vertex.color.x);
+	packed.color[1] = ToUnorm8(vertex.color.y);
+	packed.color[2] = ToUnorm8(vertex.color.z);
+	packed.color[3] = ToUnorm8(vertex.color.w);
+	packed.texcoords[0] = ToHalf(vertex.texcoords.x);
+	packed.texcoords[1] = ToHalf(vertex.texcoords.y);
+	packed.texweights[0] = ToUnorm16(vertex.texweights.x);
+	packed.texweights[1] = ToUnorm16(vertex.texweights.y);
+	return packed;
+}
+//--------------------------------------------------------------------------------
+CustomVertexDX11::Vertex CompactVertexDX11::Decode(const Vertex& vertex, const CompactVertexBounds& bounds)
+{
+	CustomVertexDX11::Vertex unpacked;
+	unpacked.position = DecodePosition(vertex.position, bounds);
+	unpacked.normal = OctDecode(FromSnorm16(vertex.normal[0]), FromSnorm16(vertex.normal[1]));
+	unpacked.tangent = OctDecode(FromSnorm16(vertex.tangent[0]), FromSnorm16(vertex.tangent[1]));
+	unpacked.binormal = Cross(unpacked.normal, unpacked.tangent) * (vertex.position[3] < 0 ? -1.0f : 1.0f);
+	unpacked.color = Vector4f(vertex.color[0] / 255.0f, vertex.color[1] / 255.0f,
+		vertex.color[2] / 255.0f, vertex.color[3] / 255.0f);
+	unpacked.texcoords = Vector2f(FromHalf(vertex.texcoords[0]), FromHalf(vertex.texcoords[1]));
+	unpacked.texweights = Vector2f(vertex.texweights[0] / 65535.0f, vertex.texweights[1] / 65535.0f);
+	return unpacked;
+}
+//--------------------------------------------------------------------------------
+CompactBasicVertexDX11::CompactBasicVertexDX11()
+{
+
+}
+//--------------------------------------------------------------------------------
+CompactBasicVertexDX11::~CompactBasicVertexDX11()
+{
+
+}
+//--------------------------------------------------------------------------------
+unsigned int CompactBasicVertexDX11::GetElementCount()
+{
+	return(GetLayout().GetAttributeCount());
+}
+//--------------------------------------------------------------------------------
+CompactBasicVertexDX11::Vertex CompactBasicVertexDX11::Encode(const BasicVertexDX11::Vertex& vertex, const CompactVertexBounds& bounds)
+{
+	Vertex packed;
+	EncodePosition(vertex.position, bounds, 1.0f, packed.position);
+	OctEncode(vertex.normal, packed.normal);
+	packed.color[0] = ToUnorm8(vertex.color.x);
+	packed.color[1] = ToUnorm8(vertex.color.y);
+	packed.color[2] = ToUnorm8(vertex.color.z);
+	packed.color[3] = ToUnorm8(vertex.color.w);
+	packed.texcoords[0] = ToHalf(vertex.texcoords.x);
+	packed.texcoords[1] = ToHalf(vertex.texcoords.y);
+	return packed;
+}
+//--------------------------------------------------------------------------------
+BasicVertexDX11::Vertex CompactBasicVertexDX11::Decode(const Vertex& vertex, const CompactVertexBounds& bounds)
+{
+	BasicVertexDX11::Vertex unpacked;
+	unpacked.position = DecodePosition(vertex.position, bounds);
+	unpacked.normal = OctDecode(FromSnorm16(vertex.normal[0]), FromSnorm16(vertex.normal[1]));
+	unpacked.color = Vector4f(vertex.color[0] / 255.0f, vertex.color[1] / 255.0f,
+		vertex.color[2] / 255.0f, vertex.color[3] / 255.0f);
+	unpacked.texcoords = Vector2f(FromHalf(vertex.texcoords[0]), FromHalf(vertex.texcoords[1]));
+	return unpacked;
+}
+//--------------------------------------------------------------------------------
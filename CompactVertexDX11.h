@@ -0,0 +1,139 @@
+#pragma once
+#include "PCH.h"
+#include "Vector2f.h"
+#include "Vector3f.h"
+#include "Vector4f.h"
+#include "BasicVertexDX11.h"
+#include "CustomVertexDX11.h"
+#include "VertexLayoutDX11.h"
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+//--------------------------------------------------------------------------------
+using namespace Glyph3;
+
+//--------------------------------------------------------------------------------
+// Box that compact positions are quantised in. A compact mesh draws at
+// centre + position * extent, so give its node that scale and offset, or build
+// it into the world matrix. Unit spheres measure as a centre of 0 and an extent
+// of 1, and draw unchanged.
+//--------------------------------------------------------------------------------
+struct CompactVertexBounds
+{
+	Vector3f centre;
+	Vector3f extent;	// Half the size on each axis
+
+	template<class TVertex>
+	static CompactVertexBounds Measure(const std::vector<TVertex>& vertices);
+};
+
+//--------------------------------------------------------------------------------
+// CustomVertexDX11::Vertex in 28 bytes instead of 80. The input assembler
+// decodes everything except the normal and tangent, which are octahedral:
+//   n = float3(e.x, e.y, 1 - abs(e.x) - abs(e.y));
+//   n.xy += (n.xy >= 0 ? -1 : 1) * saturate(-n.z);  normalize(n)
+// and the binormal, which is cross(normal, tangent) * position.w.
+//--------------------------------------------------------------------------------
+class CompactVertexDX11
+{
+public:
+	CompactVertexDX11();
+	~CompactVertexDX11();
+
+	struct Vertex {
+		int16_t position[4];	// Snorm in the bounds, w is the binormal's sign
+		int16_t normal[2];		// Octahedral snorm
+		int16_t tangent[2];		// Octahedral snorm
+		uint8_t color[4];		// Unorm
+		uint16_t texcoords[2];	// Half float, steps of 1/2048 below 1
+		uint16_t texweights[2];	// Unorm
+	};
+
+	static Vertex Encode(const CustomVertexDX11::Vertex& vertex, const CompactVertexBounds& bounds);
+	static CustomVertexDX11::Vertex Decode(const Vertex& vertex, const CompactVertexBounds& bounds);
+
+	static constexpr auto GetLayout()
+	{
+		return MakeVertexLayoutDX11<Vertex>(
+			VERTEX_ATTRIBUTE_DX11(Vertex, position, "POSITION", 0, DXGI_FORMAT_R16G16B16A16_SNORM),
+			VERTEX_ATTRIBUTE_DX11(Vertex, normal, "NORMAL", 0, DXGI_FORMAT_R16G16_SNORM),
+			VERTEX_ATTRIBUTE_DX11(Vertex, tangent, "TANGENT", 0, DXGI_FORMAT_R16G16_SNORM),
+			VERTEX_ATTRIBUTE_DX11(Vertex, color, "COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM),
+			VERTEX_ATTRIBUTE_DX11(Vertex, texcoords, "TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT),
+			VERTEX_ATTRIBUTE_DX11(Vertex, texweights, "TEXCOORD", 1, DXGI_FORMAT_R16G16_UNORM));
+	}
+
+	static unsigned int GetElementCount();
+	static D3D11_INPUT_ELEMENT_DESC* Elements;	// Generated from GetLayout
+};
+
+//--------------------------------------------------------------------------------
+// BasicVertexDX11::Vertex in 20 bytes instead of 48, for the terrain and the
+// other meshes without a tangent frame. The normal is octahedral as above, and
+// position.w is always 1.
+//--------------------------------------------------------------------------------
+class CompactBasicVertexDX11
+{
+public:
+	CompactBasicVertexDX11();
+	~CompactBasicVertexDX11();
+
+	struct Vertex {
+		int16_t position[4];	// Snorm in the bounds
+		int16_t normal[2];		// Octahedral snorm
+		uint8_t color[4];		// Unorm
+		uint16_t texcoords[2];	// Half float
+	};
+
+	static Vertex Encode(const BasicVertexDX11::Vertex& vertex, const CompactVertexBounds& bounds);
+	static BasicVertexDX11::Vertex Decode(const Vertex& vertex, const CompactVertexBounds& bounds);
+
+	static constexpr auto GetLayout()
+	{
+		return MakeVertexLayoutDX11<Vertex>(
+			VERTEX_ATTRIBUTE_DX11(Vertex, position, "POSITION", 0, DXGI_FORMAT_R16G16B16A16_SNORM),
+			VERTEX_ATTRIBUTE_DX11(Vertex, normal, "NORMAL", 0, DXGI_FORMAT_R16G16_SNORM),
+			VERTEX_ATTRIBUTE_DX11(Vertex, color, "COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM),
+			VERTEX_ATTRIBUTE_DX11(Vertex, texcoords, "TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT));
+	}
+
+	static unsigned int GetElementCount();
+	static D3D11_INPUT_ELEMENT_DESC* Elements;	// Generated from GetLayout
+};
+//--------------------------------------------------------------------------------
+static_assert(CompactVertexDX11::GetLayout().IsComplete(), "CompactVertexDX11::GetLayout must cover every member of Vertex");
+static_assert(CompactVertexDX11::GetLayout().FormatsMatch(), "CompactVertexDX11::GetLayout has a format the wrong size for its member");
+static_assert(CompactVertexDX11::GetLayout().OffsetsMatch(), "CompactVertexDX11::GetLayout must list the members in declaration order");
+static_assert(CompactBasicVertexDX11::GetLayout().IsComplete(), "CompactBasicVertexDX11::GetLayout must cover every member of Vertex");
+static_assert(CompactBasicVertexDX11::GetLayout().FormatsMatch(), "CompactBasicVertexDX11::GetLayout has a format the wrong size for its member");
+static_assert(CompactBasicVertexDX11::GetLayout().OffsetsMatch(), "CompactBasicVertexDX11::GetLayout must list the members in declaration order");
+//--------------------------------------------------------------------------------
+template<class TVertex>
+CompactVertexBounds CompactVertexBounds::Measure(const std::vector<TVertex>& vertices)
+{
+	Vector3f lo(FLT_MAX, FLT_MAX, FLT_MAX);
+	Vector3f hi(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+	for (const TVertex& v : vertices)
+	{
+		lo.x = v.position.x < lo.x ? v.position.x : lo.x;
+		lo.y = v.position.y < lo.y ? v.position.y : lo.y;
+		lo.z = v.position.z < lo.z ? v.position.z : lo.z;
+		hi.x = v.position.x > hi.x ? v.position.x : hi.x;
+		hi.y = v.position.y > hi.y ? v.position.y : hi.y;
+		hi.z = v.position.z > hi.z ? v.position.z : hi.z;
+	}
+
+	CompactVertexBounds bounds;
+	if (vertices.empty())
+	{
+		bounds.centre = Vector3f(0.0f, 0.0f, 0.0f);
+		bounds.extent = Vector3f(1.0f, 1.0f, 1.0f);
+		return bounds;
+	}
+
+	bounds.centre = Vector3f((lo.x + hi.x) * 0.5f, (lo.y + hi.y) * 0.5f, (lo.z + hi.z) * 0.5f);
+	bounds.extent = Vector3f((hi.x - lo.x) * 0.5f, (hi.y - lo.y) * 0.5f, (hi.z - lo.z) * 0.5f);
+	return bounds;
+}
+//--------------------------------------------------------------------------------
@@ -6,18 +6,13 @@
 //--------------------------------------------------------------------------------
 using namespace Glyph3;
 //--------------------------------------------------------------------------------
-D3D11_INPUT_ELEMENT_DESC CustomVertexDX11::Elements[5] = {
-	{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0,
-	  D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-	{ "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0,
-	  D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-	{ "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0,
-	  D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-	{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0,
-	  D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-	{ "TEXCOORD", 1, DXGI_FORMAT_R32G32_FLOAT, 0,
-	  D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 }
-};
+namespace
+{
+	// Constant initialised, so it is ready before any other static needs it
+	VertexElementsDX11<CustomVertexDX11::GetLayout().GetAttributeCount()> CustomElements = CustomVertexDX11::GetLayout().GetElements();
+}
+//--------------------------------------------------------------------------------
+D3D11_INPUT_ELEMENT_DESC* CustomVertexDX11::Elements = CustomElements.items;
 //--------------------------------------------------------------------------------
 CustomVertexDX11::CustomVertexDX11()
 {
@@ -31,7 +26,7 @@ CustomVertexDX11::~CustomVertexDX11()
 //--------------------------------------------------------------------------------
 unsigned int CustomVertexDX11::GetElementCount()
 {
-	return(sizeof(Elements) / sizeof(Elements[0]));
+	return(GetLayout().GetAttributeCount());
 }
 //--------------------------------------------------------------------------------
 
@@ -3,6 +3,7 @@
 #include "Vector2f.h"
 #include "Vector3f.h"
 #include "Vector4f.h"
+#include "VertexLayoutDX11.h"
 //--------------------------------------------------------------------------------
 using namespace Glyph3;
 
@@ -22,6 +23,31 @@ public:
 		Vector3f binormal;	// Additional element
 	};
 
+	// Every member, in order, as the input assembler reads it
+	static constexpr auto GetLayout()
+	{
+		return MakeVertexLayoutDX11<Vertex>(
+			VERTEX_ATTRIBUTE_DX11(Vertex, position, "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT),
+			VERTEX_ATTRIBUTE_DX11(Vertex, normal, "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT),
+			VERTEX_ATTRIBUTE_DX11(Vertex, color, "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT),
+			VERTEX_ATTRIBUTE_DX11(Vertex, texcoords, "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT),
+			VERTEX_ATTRIBUTE_DX11(Vertex, texweights, "TEXCOORD", 1, DXGI_FORMAT_R32G32_FLOAT),
+			VERTEX_ATTRIBUTE_DX11(Vertex, tangent, "TANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT),
+			VERTEX_ATTRIBUTE_DX11(Vertex, binormal, "BINORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT));
+	}
+
+	// Positions in stream 0 and the rest in stream 1, for depth and shadow passes
+	static constexpr auto GetSplitLayout()
+	{
+		return GetLayout().Isolate("POSITION");
+	}
+
 	static unsigned int GetElementCount();
-	static D3D11_INPUT_ELEMENT_DESC Elements[5]; // changed to 7 from 5
+	static D3D11_INPUT_ELEMENT_DESC* Elements;	// Generated from GetLayout
 };
+//--------------------------------------------------------------------------------
+static_assert(CustomVertexDX11::GetLayout().IsComplete(), "CustomVertexDX11::GetLayout must cover every member of Vertex");
+static_assert(CustomVertexDX11::GetLayout().FormatsMatch(), "CustomVertexDX11::GetLayout has a format the wrong size for its member");
+static_assert(CustomVertexDX11::GetLayout().GetStride() == sizeof(CustomVertexDX11::Vertex), "CustomVertexDX11::Vertex has padding");
+static_assert(CustomVertexDX11::GetLayout().OffsetsMatch(), "CustomVertexDX11::GetLayout must list the members in declaration order");
+static_assert(CustomVertexDX11::GetSplitLayout().GetStride(0) == sizeof(Vector3f), "CustomVertexDX11 position stream must hold only positions");
@@ -34,6 +34,13 @@
 #include <algorithm>
 #include <random>
 
+// SSE2 is used by GetNoiseSet(...) for the Value, Perlin, Simplex and Cubic noise types
+// It is always present on x64 and is the MSVC default for x86 (/arch:SSE2)
+#if !defined(FN_USE_DOUBLES) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define FN_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 const FN_DECIMAL GRAD_X[] =
 {
 	1, -1, 1, -1,
@@ -194,6 +201,24 @@ static FN_DECIMAL CubicLerp(FN_DECIMAL a, FN_DECIMAL b, FN_DECIMAL c, FN_DECIMAL
 	return t * t * t * p + t * t * ((a - b) - p) + t * (c - a) + b;
 }
 
+const FN_DECIMAL* FastNoise::GetValueLUT()
+{
+	return VAL_LUT;
+}
+
+const FN_DECIMAL* FastNoise::GetGradientLUT(int axis)
+{
+	switch (axis)
+	{
+	case 0:
+		return GRAD_X;
+	case 1:
+		return GRAD_Y;
+	default:
+		return GRAD_Z;
+	}
+}
+
 void FastNoise::SetSeed(int seed)
 {
 	m_seed = seed;
@@ -2248,3 +2273,1509 @@ void FastNoise::SingleGradientPerturb(unsigned char offset, FN_DECIMAL warpAmp,
 	x += Lerp(lx0x, lx1x, ys) * warpAmp;
 	y += Lerp(ly0x, ly1x, ys) * warpAmp;
 }
+
+// Noise Sets
+#ifdef FN_USE_SSE2
+// 4 wide versions of the Value, Perlin, Simplex and Cubic noise
+// Arithmetic is performed in the same order as the scalar versions so results match GetNoise(...)
+// The permutation table lookups have no SSE2 gather, so they are done per lane
+
+static inline __m128i SSE2_FastFloor(__m128 f)
+{
+	// Matches FastFloor(): truncate, then step back one for any negative input
+	__m128i i = _mm_cvttps_epi32(f);
+	return _mm_add_epi32(i, _mm_castps_si128(_mm_cmplt_ps(f, _mm_setzero_ps())));
+}
+static inline __m128 SSE2_Abs(__m128 f) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), f); }
+static inline __m128 SSE2_Lerp(__m128 a, __m128 b, __m128 t) { return _mm_add_ps(a, _mm_mul_ps(t, _mm_sub_ps(b, a))); }
+static inline __m128 SSE2_Select(__m128 mask, __m128 a, __m128 b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+static inline __m128 SSE2_CubicLerp(__m128 a, __m128 b, __m128 c, __m128 d, __m128 t)
+{
+	__m128 p = _mm_sub_ps(_mm_sub_ps(d, c), _mm_sub_ps(a, b));
+	__m128 t2 = _mm_mul_ps(t, t);
+	return _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(t2, t), p), _mm_mul_ps(t2, _mm_sub_ps(_mm_sub_ps(a, b), p))),
+		_mm_mul_ps(t, _mm_sub_ps(c, a))), b);
+}
+
+template <int interp>
+static inline __m128 SSE2_Interp(__m128 t)
+{
+	switch (interp)
+	{
+	case FastNoise::Hermite:
+		return _mm_mul_ps(_mm_mul_ps(t, t), _mm_sub_ps(_mm_set1_ps(3), _mm_mul_ps(_mm_set1_ps(2), t)));
+	case FastNoise::Quintic:
+		return _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(t, t), t),
+			_mm_add_ps(_mm_mul_ps(t, _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6)), _mm_set1_ps(15))), _mm_set1_ps(10)));
+	default:
+		return t;
+	}
+}
+
+// True when every lane lies in the same lattice cell as lane 0
+static inline bool SSE2_SameCell(__m128i x0, __m128i y0)
+{
+	__m128i sx = _mm_cmpeq_epi32(x0, _mm_shuffle_epi32(x0, 0));
+	__m128i sy = _mm_cmpeq_epi32(y0, _mm_shuffle_epi32(y0, 0));
+	return _mm_movemask_epi8(_mm_and_si128(sx, sy)) == 0xffff;
+}
+static inline bool SSE2_SameCell(__m128i x0, __m128i y0, __m128i z0)
+{
+	__m128i sz = _mm_cmpeq_epi32(z0, _mm_shuffle_epi32(z0, 0));
+	return SSE2_SameCell(x0, y0) && _mm_movemask_epi8(sz) == 0xffff;
+}
+// Loads a lane array filled by the hashing loop, broadcasting lane 0 when only it was filled
+static inline __m128 SSE2_LoadLanes(const float* lanes, int count)
+{
+	return count == 1 ? _mm_set1_ps(lanes[0]) : _mm_load_ps(lanes);
+}
+
+struct SSE2_LatticeTables
+{
+	const unsigned char* perm;
+	const unsigned char* perm12;
+};
+
+template <int interp>
+struct SSE2_Value
+{
+	static __m128 Single(const SSE2_LatticeTables& t, unsigned char offset, __m128 x, __m128 y)
+	{
+		__m128i x0 = SSE2_FastFloor(x);
+		__m128i y0 = SSE2_FastFloor(y);
+
+		__m128 xs = SSE2_Interp<interp>(_mm_sub_ps(x, _mm_cvtepi32_ps(x0)));
+		__m128 ys = SSE2_Interp<interp>(_mm_sub_ps(y, _mm_cvtepi32_ps(y0)));
+
+		alignas(16) int xi[4], yi[4];
+		alignas(16) float v00[4], v10[4], v01[4], v11[4];
+		_mm_store_si128((__m128i*)xi, x0);
+		_mm_store_si128((__m128i*)yi, y0);
+
+		int lanes = SSE2_SameCell(x0, y0) ? 1 : 4;
+
+		for (int l = 0; l < lanes; l++)
+		{
+			int xa = xi[l] & 0xff;
+			int xb = (xi[l] + 1) & 0xff;
+			unsigned char p0 = t.perm[(yi[l] & 0xff) + offset];
+			unsigned char p1 = t.perm[((yi[l] + 1) & 0xff) + offset];
+
+			v00[l] = VAL_LUT[t.perm[xa + p0]];
+			v10[l] = VAL_LUT[t.perm[xb + p0]];
+			v01[l] = VAL_LUT[t.perm[xa + p1]];
+			v11[l] = VAL_LUT[t.perm[xb + p1]];
+		}
+
+		__m128 xf0 = SSE2_Lerp(SSE2_LoadLanes(v00, lanes), SSE2_LoadLanes(v10, lanes), xs);
+		__m128 xf1 = SSE2_Lerp(SSE2_LoadLanes(v01, lanes), SSE2_LoadLanes(v11, lanes), xs);
+
+		return SSE2_Lerp(xf0, xf1, ys);
+	}
+
+	static __m128 Single(const SSE2_LatticeTables& t, unsigned char offset, __m128 x, __m128 y, __m128 z)
+	{
+		__m128i x0 = SSE2_FastFloor(x);
+		__m128i y0 = SSE2_FastFloor(y);
+		__m128i z0 = SSE2_FastFloor(z);
+
+		__m128 xs = SSE2_Interp<interp>(_mm_sub_ps(x, _mm_cvtepi32_ps(x0)));
+		__m128 ys = SSE2_Interp<interp>(_mm_sub_ps(y, _mm_cvtepi32_ps(y0)));
+		__m128 zs = SSE2_Interp<interp>(_mm_sub_ps(z, _mm_cvtepi32_ps(z0)));
+
+		alignas(16) int xi[4], yi[4], zi[4];
+		alignas(16) float v[8][4];
+		_mm_store_si128((__m128i*)xi, x0);
+		_mm_store_si128((__m128i*)yi, y0);
+		_mm_store_si128((__m128i*)zi, z0);
+
+		int lanes = SSE2_SameCell(x0, y0, z0) ? 1 : 4;
+
+		for (int l = 0; l < lanes; l++)
+		{
+			int xa = xi[l] & 0xff;
+			int xb = (xi[l] + 1) & 0xff;
+			int ya = yi[l] & 0xff;
+			int yb = (yi[l] + 1) & 0xff;
+			unsigned char pz0 = t.perm[(zi[l] & 0xff) + offset];
+			unsigned char pz1 = t.perm[((zi[l] + 1) & 0xff) + offset];
+			unsigned char p00 = t.perm[ya + pz0];
+			unsigned char p10 = t.perm[yb + pz0];
+			unsigned char p01 = t.perm[ya + pz1];
+			unsigned char p11 = t.perm[yb + pz1];
+
+			v[0][l] = VAL_LUT[t.perm[xa + p00]];
+			v[1][l] = VAL_LUT[t.perm[xb + p00]];
+			v[2][l] = VAL_LUT[t.perm[xa + p10]];
+			v[3][l] = VAL_LUT[t.perm[xb + p10]];
+			v[4][l] = VAL_LUT[t.perm[xa + p01]];
+			v[5][l] = VAL_LUT[t.perm[xb + p01]];
+			v[6][l] = VAL_LUT[t.perm[xa + p11]];
+			v[7][l] = VAL_LUT[t.perm[xb + p11]];
+		}
+
+		__m128 xf00 = SSE2_Lerp(SSE2_LoadLanes(v[0], lanes), SSE2_LoadLanes(v[1], lanes), xs);
+		__m128 xf10 = SSE2_Lerp(SSE2_LoadLanes(v[2], lanes), SSE2_LoadLanes(v[3], lanes), xs);
+		__m128 xf01 = SSE2_Lerp(SSE2_LoadLanes(v[4], lanes), SSE2_LoadLanes(v[5], lanes), xs);
+		__m128 xf11 = SSE2_Lerp(SSE2_LoadLanes(v[6], lanes), SSE2_LoadLanes(v[7], lanes), xs);
+
+		__m128 yf0 = SSE2_Lerp(xf00, xf10, ys);
+		__m128 yf1 = SSE2_Lerp(xf01, xf11, ys);
+
+		return SSE2_Lerp(yf0, yf1, zs);
+	}
+};
+
+template <int interp>
+struct SSE2_Perlin
+{
+	static __m128 Single(const SSE2_LatticeTables& t, unsigned char offset, __m128 x, __m128 y)
+	{
+		__m128i x0 = SSE2_FastFloor(x);
+		__m128i y0 = SSE2_FastFloor(y);
+
+		__m128 xd0 = _mm_sub_ps(x, _mm_cvtepi32_ps(x0));
+		__m128 yd0 = _mm_sub_ps(y, _mm_cvtepi32_ps(y0));
+		__m128 xd1 = _mm_sub_ps(xd0, _mm_set1_ps(1));
+		__m128 yd1 = _mm_sub_ps(yd0, _mm_set1_ps(1));
+
+		__m128 xs = SSE2_Interp<interp>(xd0);
+		__m128 ys = SSE2_Interp<interp>(yd0);
+
+		alignas(16) int xi[4], yi[4];
+		alignas(16) float gx[4][4], gy[4][4];
+		_mm_store_si128((__m128i*)xi, x0);
+		_mm_store_si128((__m128i*)yi, y0);
+
+		// Lanes of a set row usually fall in the same lattice cell, so only one lane needs hashing
+		int lanes = SSE2_SameCell(x0, y0) ? 1 : 4;
+
+		for (int l = 0; l < lanes; l++)
+		{
+			int xa = xi[l] & 0xff;
+			int xb = (xi[l] + 1) & 0xff;
+			unsigned char p0 = t.perm[(yi[l] & 0xff) + offset];
+			unsigned char p1 = t.perm[((yi[l] + 1) & 0xff) + offset];
+
+			unsigned char lut[4] = { t.perm12[xa + p0], t.perm12[xb + p0], t.perm12[xa + p1], t.perm12[xb + p1] };
+
+			for (int c = 0; c < 4; c++)
+			{
+				gx[c][l] = GRAD_X[lut[c]];
+				gy[c][l] = GRAD_Y[lut[c]];
+			}
+		}
+
+		__m128 g00 = _mm_add_ps(_mm_mul_ps(xd0, SSE2_LoadLanes(gx[0], lanes)), _mm_mul_ps(yd0, SSE2_LoadLanes(gy[0], lanes)));
+		__m128 g10 = _mm_add_ps(_mm_mul_ps(xd1, SSE2_LoadLanes(gx[1], lanes)), _mm_mul_ps(yd0, SSE2_LoadLanes(gy[1], lanes)));
+		__m128 g01 = _mm_add_ps(_mm_mul_ps(xd0, SSE2_LoadLanes(gx[2], lanes)), _mm_mul_ps(yd1, SSE2_LoadLanes(gy[2], lanes)));
+		__m128 g11 = _mm_add_ps(_mm_mul_ps(xd1, SSE2_LoadLanes(gx[3], lanes)), _mm_mul_ps(yd1, SSE2_LoadLanes(gy[3], lanes)));
+
+		__m128 xf0 = SSE2_Lerp(g00, g10, xs);
+		__m128 xf1 = SSE2_Lerp(g01, g11, xs);
+
+		return SSE2_Lerp(xf0, xf1, ys);
+	}
+
+	static __m128 Single(const SSE2_LatticeTables& t, unsigned char offset, __m128 x, __m128 y, __m128 z)
+	{
+		__m128i x0 = SSE2_FastFloor(x);
+		__m128i y0 = SSE2_FastFloor(y);
+		__m128i z0 = SSE2_FastFloor(z);
+
+		__m128 xd0 = _mm_sub_ps(x, _mm_cvtepi32_ps(x0));
+		__m128 yd0 = _mm_sub_ps(y, _mm_cvtepi32_ps(y0));
+		__m128 zd0 = _mm_sub_ps(z, _mm_cvtepi32_ps(z0));
+		__m128 xd1 = _mm_sub_ps(xd0, _mm_set1_ps(1));
+		__m128 yd1 = _mm_sub_ps(yd0, _mm_set1_ps(1));
+		__m128 zd1 = _mm_sub_ps(zd0, _mm_set1_ps(1));
+
+		__m128 xs = SSE2_Interp<interp>(xd0);
+		__m128 ys = SSE2_Interp<interp>(yd0);
+		__m128 zs = SSE2_Interp<interp>(zd0);
+
+		alignas(16) int xi[4], yi[4], zi[4];
+		alignas(16) float gx[8][4], gy[8][4], gz[8][4];
+		_mm_store_si128((__m128i*)xi, x0);
+		_mm_store_si128((__m128i*)yi, y0);
+		_mm_store_si128((__m128i*)zi, z0);
+
+		int lanes = SSE2_SameCell(x0, y0, z0) ? 1 : 4;
+
+		for (int l = 0; l < lanes; l++)
+		{
+			int xa = xi[l] & 0xff;
+			int xb = (xi[l] + 1) & 0xff;
+			int ya = yi[l] & 0xff;
+			int yb = (yi[l] + 1) & 0xff;
+			unsigned char pz0 = t.perm[(zi[l] & 0xff) + offset];
+			unsigned char pz1 = t.perm[((zi[l] + 1) & 0xff) + offset];
+			unsigned char p00 = t.perm[ya + pz0];
+			unsigned char p10 = t.perm[yb + pz0];
+			unsigned char p01 = t.perm[ya + pz1];
+			unsigned char p11 = t.perm[yb + pz1];
+
+			unsigned char lut[8] =
+			{
+				t.perm12[xa + p00], t.perm12[xb + p00], t.perm12[xa + p10], t.perm12[xb + p10],
+				t.perm12[xa + p01], t.perm12[xb + p01], t.perm12[xa + p11], t.perm12[xb + p11]
+			};
+
+			for (int c = 0; c < 8; c++)
+			{
+				gx[c][l] = GRAD_X[lut[c]];
+				gy[c][l] = GRAD_Y[lut[c]];
+				gz[c][l] = GRAD_Z[lut[c]];
+			}
+		}
+
+#define FN_SSE2_GRAD3D(c, xd, yd, zd) _mm_add_ps(_mm_add_ps(_mm_mul_ps(xd, SSE2_LoadLanes(gx[c], lanes)), _mm_mul_ps(yd, SSE2_LoadLanes(gy[c], lanes))), _mm_mul_ps(zd, SSE2_LoadLanes(gz[c], lanes)))
+		__m128 xf00 = SSE2_Lerp(FN_SSE2_GRAD3D(0, xd0, yd0, zd0), FN_SSE2_GRAD3D(1, xd1, yd0, zd0), xs);
+		__m128 xf10 = SSE2_Lerp(FN_SSE2_GRAD3D(2, xd0, yd1, zd0), FN_SSE2_GRAD3D(3, xd1, yd1, zd0), xs);
+		__m128 xf01 = SSE2_Lerp(FN_SSE2_GRAD3D(4, xd0, yd0, zd1), FN_SSE2_GRAD3D(5, xd1, yd0, zd1), xs);
+		__m128 xf11 = SSE2_Lerp(FN_SSE2_GRAD3D(6, xd0, yd1, zd1), FN_SSE2_GRAD3D(7, xd1, yd1, zd1), xs);
+#undef FN_SSE2_GRAD3D
+
+		__m128 yf0 = SSE2_Lerp(xf00, xf10, ys);
+		__m128 yf1 = SSE2_Lerp(xf01, xf11, ys);
+
+		return SSE2_Lerp(yf0, yf1, zs);
+	}
+};
+
+struct SSE2_Simplex
+{
+	// One simplex corner, 0 outside its radius
+	static __m128 Corner(__m128 r, __m128 x, __m128 y, const float* gx, const float* gy)
+	{
+		__m128 t = _mm_sub_ps(_mm_sub_ps(r, _mm_mul_ps(x, x)), _mm_mul_ps(y, y));
+		__m128 inside = _mm_cmpge_ps(t, _mm_setzero_ps());
+		t = _mm_mul_ps(t, t);
+		__m128 g = _mm_add_ps(_mm_mul_ps(x, _mm_load_ps(gx)), _mm_mul_ps(y, _mm_load_ps(gy)));
+		return _mm_and_ps(inside, _mm_mul_ps(_mm_mul_ps(t, t), g));
+	}
+
+	static __m128 Corner(__m128 r, __m128 x, __m128 y, __m128 z, const float* gx, const float* gy, const float* gz)
+	{
+		__m128 t = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(r, _mm_mul_ps(x, x)), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+		__m128 inside = _mm_cmpge_ps(t, _mm_setzero_ps());
+		t = _mm_mul_ps(t, t);
+		__m128 g = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_load_ps(gx)), _mm_mul_ps(y, _mm_load_ps(gy))), _mm_mul_ps(z, _mm_load_ps(gz)));
+		return _mm_and_ps(inside, _mm_mul_ps(_mm_mul_ps(t, t), g));
+	}
+
+	static __m128 Single(const SSE2_LatticeTables& t, unsigned char offset, __m128 x, __m128 y)
+	{
+		const __m128 one = _mm_set1_ps(1);
+		const __m128 g2 = _mm_set1_ps(G2);
+
+		__m128 s = _mm_mul_ps(_mm_add_ps(x, y), _mm_set1_ps(F2));
+		__m128i i0 = SSE2_FastFloor(_mm_add_ps(x, s));
+		__m128i j0 = SSE2_FastFloor(_mm_add_ps(y, s));
+
+		__m128 u = _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(i0, j0)), g2);
+		__m128 x0 = _mm_sub_ps(x, _mm_sub_ps(_mm_cvtepi32_ps(i0), u));
+		__m128 y0 = _mm_sub_ps(y, _mm_sub_ps(_mm_cvtepi32_ps(j0), u));
+
+		// Lower triangle steps along x first, upper along y
+		__m128 lower = _mm_cmpgt_ps(x0, y0);
+		__m128 x1 = _mm_add_ps(_mm_sub_ps(x0, _mm_and_ps(lower, one)), g2);
+		__m128 y1 = _mm_add_ps(_mm_sub_ps(y0, _mm_andnot_ps(lower, one)), g2);
+		__m128 x2 = _mm_add_ps(_mm_sub_ps(x0, one), _mm_set1_ps(2 * G2));
+		__m128 y2 = _mm_add_ps(_mm_sub_ps(y0, one), _mm_set1_ps(2 * G2));
+
+		alignas(16) int xi[4], yi[4];
+		alignas(16) float gx[3][4], gy[3][4];
+		_mm_store_si128((__m128i*)xi, i0);
+		_mm_store_si128((__m128i*)yi, j0);
+		int lowerBits = _mm_movemask_ps(lower);
+
+		// Lanes in one cell share its four corners, so those are hashed once
+		unsigned char cell[4];
+		bool same = SSE2_SameCell(i0, j0);
+		if (same)
+		{
+			for (int c = 0; c < 4; c++)
+				cell[c] = t.perm12[((xi[0] + (c & 1)) & 0xff) + t.perm[((yi[0] + (c >> 1)) & 0xff) + offset]];
+		}
+
+		for (int l = 0; l < 4; l++)
+		{
+			int c1 = (lowerBits >> l) & 1 ? 1 : 2;
+			unsigned char lut[3];
+			for (int c = 0; c < 3; c++)
+			{
+				int corner = c == 0 ? 0 : (c == 1 ? c1 : 3);
+				lut[c] = same ? cell[corner] :
+					t.perm12[((xi[l] + (corner & 1)) & 0xff) + t.perm[((yi[l] + (corner >> 1)) & 0xff) + offset]];
+				gx[c][l] = GRAD_X[lut[c]];
+				gy[c][l] = GRAD_Y[lut[c]];
+			}
+		}
+
+		const __m128 r = _mm_set1_ps(FN_DECIMAL(0.5));
+		__m128 n = _mm_add_ps(_mm_add_ps(Corner(r, x0, y0, gx[0], gy[0]), Corner(r, x1, y1, gx[1], gy[1])), Corner(r, x2, y2, gx[2], gy[2]));
+		return _mm_mul_ps(_mm_set1_ps(70), n);
+	}
+
+	static __m128 Single(const SSE2_LatticeTables& t, unsigned char offset, __m128 x, __m128 y, __m128 z)
+	{
+		const __m128 one = _mm_set1_ps(1);
+		const __m128 g3 = _mm_set1_ps(G3);
+
+		__m128 s = _mm_mul_ps(_mm_add_ps(_mm_add_ps(x, y), z), _mm_set1_ps(F3));
+		__m128i i0 = SSE2_FastFloor(_mm_add_ps(x, s));
+		__m128i j0 = SSE2_FastFloor(_mm_add_ps(y, s));
+		__m128i k0 = SSE2_FastFloor(_mm_add_ps(z, s));
+
+		__m128 u = _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(_mm_add_epi32(i0, j0), k0)), g3);
+		__m128 x0 = _mm_sub_ps(x, _mm_sub_ps(_mm_cvtepi32_ps(i0), u));
+		__m128 y0 = _mm_sub_ps(y, _mm_sub_ps(_mm_cvtepi32_ps(j0), u));
+		__m128 z0 = _mm_sub_ps(z, _mm_sub_ps(_mm_cvtepi32_ps(k0), u));
+
+		// The same six orderings as the scalar branches, ties broken the same way
+		__m128 xy = _mm_cmpge_ps(x0, y0);
+		__m128 yz = _mm_cmpge_ps(y0, z0);
+		__m128 xz = _mm_cmpge_ps(x0, z0);
+		__m128 i1 = _mm_and_ps(xy, _mm_or_ps(yz, xz));
+		__m128 j1 = _mm_andnot_ps(xy, yz);
+		__m128 k1 = _mm_andnot_ps(_mm_or_ps(yz, _mm_and_ps(xy, xz)), _mm_castsi128_ps(_mm_set1_epi32(-1)));
+		__m128 i2 = _mm_or_ps(xy, _mm_and_ps(yz, xz));
+		__m128 j2 = _mm_or_ps(_mm_andnot_ps(xy, _mm_castsi128_ps(_mm_set1_epi32(-1))), yz);
+		__m128 k2 = _mm_andnot_ps(_mm_and_ps(yz, _mm_or_ps(xy, xz)), _mm_castsi128_ps(_mm_set1_epi32(-1)));
+
+		__m128 x1 = _mm_add_ps(_mm_sub_ps(x0, _mm_and_ps(i1, one)), g3);
+		__m128 y1 = _mm_add_ps(_mm_sub_ps(y0, _mm_and_ps(j1, one)), g3);
+		__m128 z1 = _mm_add_ps(_mm_sub_ps(z0, _mm_and_ps(k1, one)), g3);
+		__m128 x2 = _mm_add_ps(_mm_sub_ps(x0, _mm_and_ps(i2, one)), _mm_set1_ps(2 * G3));
+		__m128 y2 = _mm_add_ps(_mm_sub_ps(y0, _mm_and_ps(j2, one)), _mm_set1_ps(2 * G3));
+		__m128 z2 = _mm_add_ps(_mm_sub_ps(z0, _mm_and_ps(k2, one)), _mm_set1_ps(2 * G3));
+		__m128 x3 = _mm_add_ps(_mm_sub_ps(x0, one), _mm_set1_ps(3 * G3));
+		__m128 y3 = _mm_add_ps(_mm_sub_ps(y0, one), _mm_set1_ps(3 * G3));
+		__m128 z3 = _mm_add_ps(_mm_sub_ps(z0, one), _mm_set1_ps(3 * G3));
+
+		alignas(16) int xi[4], yi[4], zi[4];
+		alignas(16) float gx[4][4], gy[4][4], gz[4][4];
+		_mm_store_si128((__m128i*)xi, i0);
+		_mm_store_si128((__m128i*)yi, j0);
+		_mm_store_si128((__m128i*)zi, k0);
+
+		// Corner c of the cube is offset (c & 1, (c >> 1) & 1, c >> 2) from the cell
+		int bits1 = _mm_movemask_ps(i1) | (_mm_movemask_ps(j1) << 4) | (_mm_movemask_ps(k1) << 8);
+		int bits2 = _mm_movemask_ps(i2) | (_mm_movemask_ps(j2) << 4) | (_mm_movemask_ps(k2) << 8);
+
+		unsigned char cell[8];
+		bool same = SSE2_SameCell(i0, j0, k0);
+		if (same)
+		{
+			for (int c = 0; c < 8; c++)
+			{
+				unsigned char pz = t.perm[((zi[0] + (c >> 2)) & 0xff) + offset];
+				cell[c] = t.perm12[((xi[0] + (c & 1)) & 0xff) + t.perm[((yi[0] + ((c >> 1) & 1)) & 0xff) + pz]];
+			}
+		}
+
+		for (int l = 0; l < 4; l++)
+		{
+			int corners[4] =
+			{
+				0,
+				((bits1 >> l) & 1) | (((bits1 >> (4 + l)) & 1) << 1) | (((bits1 >> (8 + l)) & 1) << 2),
+				((bits2 >> l) & 1) | (((bits2 >> (4 + l)) & 1) << 1) | (((bits2 >> (8 + l)) & 1) << 2),
+				7
+			};
+
+			for (int c = 0; c < 4; c++)
+			{
+				int corner = corners[c];
+				unsigned char lut;
+				if (same)
+				{
+					lut = cell[corner];
+				}
+				else
+				{
+					unsigned char pz = t.perm[((zi[l] + (corner >> 2)) & 0xff) + offset];
+					lut = t.perm12[((xi[l] + (corner & 1)) & 0xff) + t.perm[((yi[l] + ((corner >> 1) & 1)) & 0xff) + pz]];
+				}
+				gx[c][l] = GRAD_X[lut];
+				gy[c][l] = GRAD_Y[lut];
+				gz[c][l] = GRAD_Z[lut];
+			}
+		}
+
+		const __m128 r = _mm_set1_ps(FN_DECIMAL(0.6));
+		__m128 n = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+			Corner(r, x0, y0, z0, gx[0], gy[0], gz[0]),
+			Corner(r, x1, y1, z1, gx[1], gy[1], gz[1])),
+			Corner(r, x2, y2, z2, gx[2], gy[2], gz[2])),
+			Corner(r, x3, y3, z3, gx[3], gy[3], gz[3]));
+		return _mm_mul_ps(_mm_set1_ps(32), n);
+	}
+};
+
+struct SSE2_Cubic
+{
+	static __m128 Single(const SSE2_LatticeTables& t, unsigned char offset, __m128 x, __m128 y)
+	{
+		__m128i x1 = SSE2_FastFloor(x);
+		__m128i y1 = SSE2_FastFloor(y);
+
+		__m128 xs = _mm_sub_ps(x, _mm_cvtepi32_ps(x1));
+		__m128 ys = _mm_sub_ps(y, _mm_cvtepi32_ps(y1));
+
+		alignas(16) int xi[4], yi[4];
+		alignas(16) float v[4][4][4];
+		_mm_store_si128((__m128i*)xi, x1);
+		_mm_store_si128((__m128i*)yi, y1);
+
+		int lanes = SSE2_SameCell(x1, y1) ? 1 : 4;
+
+		// The 4 x 4 values around the cell, from x1 - 1 and y1 - 1
+		for (int l = 0; l < lanes; l++)
+		{
+			for (int dy = 0; dy < 4; dy++)
+			{
+				unsigned char py = t.perm[((yi[l] + dy - 1) & 0xff) + offset];
+				for (int dx = 0; dx < 4; dx++)
+					v[dy][dx][l] = VAL_LUT[t.perm[((xi[l] + dx - 1) & 0xff) + py]];
+			}
+		}
+
+		__m128 rows[4];
+		for (int dy = 0; dy < 4; dy++)
+		{
+			rows[dy] = SSE2_CubicLerp(SSE2_LoadLanes(v[dy][0], lanes), SSE2_LoadLanes(v[dy][1], lanes),
+				SSE2_LoadLanes(v[dy][2], lanes), SSE2_LoadLanes(v[dy][3], lanes), xs);
+		}
+
+		return _mm_mul_ps(SSE2_CubicLerp(rows[0], rows[1], rows[2], rows[3], ys), _mm_set1_ps(CUBIC_2D_BOUNDING));
+	}
+
+	static __m128 Single(const SSE2_LatticeTables& t, unsigned char offset, __m128 x, __m128 y, __m128 z)
+	{
+		__m128i x1 = SSE2_FastFloor(x);
+		__m128i y1 = SSE2_FastFloor(y);
+		__m128i z1 = SSE2_FastFloor(z);
+
+		__m128 xs = _mm_sub_ps(x, _mm_cvtepi32_ps(x1));
+		__m128 ys = _mm_sub_ps(y, _mm_cvtepi32_ps(y1));
+		__m128 zs = _mm_sub_ps(z, _mm_cvtepi32_ps(z1));
+
+		alignas(16) int xi[4], yi[4], zi[4];
+		alignas(16) float v[4][4][4][4];
+		_mm_store_si128((__m128i*)xi, x1);
+		_mm_store_si128((__m128i*)yi, y1);
+		_mm_store_si128((__m128i*)zi, z1);
+
+		int lanes = SSE2_SameCell(x1, y1, z1) ? 1 : 4;
+
+		for (int l = 0; l < lanes; l++)
+		{
+			for (int dz = 0; dz < 4; dz++)
+			{
+				unsigned char pz = t.perm[((zi[l] + dz - 1) & 0xff) + offset];
+				for (int dy = 0; dy < 4; dy++)
+				{
+					unsigned char py = t.perm[((yi[l] + dy - 1) & 0xff) + pz];
+					for (int dx = 0; dx < 4; dx++)
+						v[dz][dy][dx][l] = VAL_LUT[t.perm[((xi[l] + dx - 1) & 0xff) + py]];
+				}
+			}
+		}
+
+		__m128 planes[4];
+		for (int dz = 0; dz < 4; dz++)
+		{
+			__m128 rows[4];
+			for (int dy = 0; dy < 4; dy++)
+			{
+				rows[dy] = SSE2_CubicLerp(SSE2_LoadLanes(v[dz][dy][0], lanes), SSE2_LoadLanes(v[dz][dy][1], lanes),
+					SSE2_LoadLanes(v[dz][dy][2], lanes), SSE2_LoadLanes(v[dz][dy][3], lanes), xs);
+			}
+			planes[dz] = SSE2_CubicLerp(rows[0], rows[1], rows[2], rows[3], ys);
+		}
+
+		return _mm_mul_ps(SSE2_CubicLerp(planes[0], planes[1], planes[2], planes[3], zs), _mm_set1_ps(CUBIC_3D_BOUNDING));
+	}
+};
+
+// Fractal settings captured once per set
+struct SSE2_FractalParams
+{
+	SSE2_LatticeTables tables;
+	int octaves;
+	__m128 lacunarity;
+	float gain;
+	__m128 bounding;
+};
+
+// fractal < 0 evaluates the single noise, otherwise it is a FastNoise::FractalType
+template <class Kernel, int fractal>
+struct SSE2_Fractal
+{
+	static __m128 Eval(const SSE2_FractalParams& p, __m128 x, __m128 y)
+	{
+		if (fractal < 0)
+			return Kernel::Single(p.tables, 0, x, y);
+
+		__m128 sum = Octave(Kernel::Single(p.tables, p.tables.perm[0], x, y));
+		float amp = 1;
+
+		for (int i = 1; i < p.octaves; i++)
+		{
+			x = _mm_mul_ps(x, p.lacunarity);
+			y = _mm_mul_ps(y, p.lacunarity);
+
+			amp *= p.gain;
+			sum = Accumulate(sum, _mm_mul_ps(Octave(Kernel::Single(p.tables, p.tables.perm[i], x, y)), _mm_set1_ps(amp)));
+		}
+
+		return Finish(p, sum);
+	}
+
+	static __m128 Eval(const SSE2_FractalParams& p, __m128 x, __m128 y, __m128 z)
+	{
+		if (fractal < 0)
+			return Kernel::Single(p.tables, 0, x, y, z);
+
+		__m128 sum = Octave(Kernel::Single(p.tables, p.tables.perm[0], x, y, z));
+		float amp = 1;
+
+		for (int i = 1; i < p.octaves; i++)
+		{
+			x = _mm_mul_ps(x, p.lacunarity);
+			y = _mm_mul_ps(y, p.lacunarity);
+			z = _mm_mul_ps(z, p.lacunarity);
+
+			amp *= p.gain;
+			sum = Accumulate(sum, _mm_mul_ps(Octave(Kernel::Single(p.tables, p.tables.perm[i], x, y, z)), _mm_set1_ps(amp)));
+		}
+
+		return Finish(p, sum);
+	}
+
+private:
+	static __m128 Octave(__m128 n)
+	{
+		switch (fractal)
+		{
+		case FastNoise::Billow:
+			return _mm_sub_ps(_mm_mul_ps(SSE2_Abs(n), _mm_set1_ps(2)), _mm_set1_ps(1));
+		case FastNoise::RigidMulti:
+			return _mm_sub_ps(_mm_set1_ps(1), SSE2_Abs(n));
+		default:
+			return n;
+		}
+	}
+
+	static __m128 Accumulate(__m128 sum, __m128 octave)
+	{
+		return (fractal == FastNoise::RigidMulti) ? _mm_sub_ps(sum, octave) : _mm_add_ps(sum, octave);
+	}
+
+	static __m128 Finish(const SSE2_FractalParams& p, __m128 sum)
+	{
+		// RigidMulti is not scaled by the fractal bounding in the scalar version either
+		return (fractal == FastNoise::RigidMulti) ? sum : _mm_mul_ps(sum, p.bounding);
+	}
+};
+
+// Runs the 4 wide evaluator along the innermost axis of the set
+// Coordinates are formed as (start + index * step) * frequency, the same as GetNoise(start + index * step)
+template <class Evaluator>
+static void SSE2_FillSet(const SSE2_FractalParams& p, FN_DECIMAL* noiseSet,
+	FN_DECIMAL xStart, FN_DECIMAL yStart, int xSize, int ySize, FN_DECIMAL stepSize, FN_DECIMAL frequency)
+{
+	const __m128 freq = _mm_set1_ps(frequency);
+	const __m128 step = _mm_set1_ps(stepSize);
+	const __m128 laneOffset = _mm_set_ps(3, 2, 1, 0);
+
+	for (int x = 0; x < xSize; x++)
+	{
+		__m128 xf = _mm_mul_ps(_mm_set1_ps(xStart + (FN_DECIMAL)x * stepSize), freq);
+		FN_DECIMAL* row = noiseSet + (size_t)x * ySize;
+
+		for (int y = 0; y < ySize; y += 4)
+		{
+			__m128 yIndex = _mm_add_ps(_mm_set1_ps((FN_DECIMAL)y), laneOffset);
+			__m128 yf = _mm_mul_ps(_mm_add_ps(_mm_set1_ps(yStart), _mm_mul_ps(yIndex, step)), freq);
+
+			__m128 n = Evaluator::Eval(p, xf, yf);
+
+			if (y + 4 <= ySize)
+			{
+				_mm_storeu_ps(row + y, n);
+			}
+			else
+			{
+				alignas(16) float tail[4];
+				_mm_store_ps(tail, n);
+				for (int l = 0; y + l < ySize; l++)
+					row[y + l] = tail[l];
+			}
+		}
+	}
+}
+
+template <class Evaluator>
+static void SSE2_FillSet(const SSE2_FractalParams& p, FN_DECIMAL* noiseSet,
+	FN_DECIMAL xStart, FN_DECIMAL yStart, FN_DECIMAL zStart, int xSize, int ySize, int zSize, FN_DECIMAL stepSize, FN_DECIMAL frequency)
+{
+	const __m128 freq = _mm_set1_ps(frequency);
+	const __m128 step = _mm_set1_ps(stepSize);
+	const __m128 laneOffset = _mm_set_ps(3, 2, 1, 0);
+
+	for (int x = 0; x < xSize; x++)
+	{
+		__m128 xf = _mm_mul_ps(_mm_set1_ps(xStart + (FN_DECIMAL)x * stepSize), freq);
+
+		for (int y = 0; y < ySize; y++)
+		{
+			__m128 yf = _mm_mul_ps(_mm_set1_ps(yStart + (FN_DECIMAL)y * stepSize), freq);
+			FN_DECIMAL* row = noiseSet + ((size_t)x * ySize + y) * zSize;
+
+			for (int z = 0; z < zSize; z += 4)
+			{
+				__m128 zIndex = _mm_add_ps(_mm_set1_ps((FN_DECIMAL)z), laneOffset);
+				__m128 zf = _mm_mul_ps(_mm_add_ps(_mm_set1_ps(zStart), _mm_mul_ps(zIndex, step)), freq);
+
+				__m128 n = Evaluator::Eval(p, xf, yf, zf);
+
+				if (z + 4 <= zSize)
+				{
+					_mm_storeu_ps(row + z, n);
+				}
+				else
+				{
+					alignas(16) float tail[4];
+					_mm_store_ps(tail, n);
+					for (int l = 0; z + l < zSize; l++)
+						row[z + l] = tail[l];
+				}
+			}
+		}
+	}
+}
+
+// Resolves the fractal type once, so the inner loop is branch free
+template <class Kernel, class... Args>
+static bool SSE2_DispatchFractal(int fractal, Args... args)
+{
+	switch (fractal)
+	{
+	case -1:
+		SSE2_FillSet<SSE2_Fractal<Kernel, -1>>(args...);
+		return true;
+	case FastNoise::FBM:
+		SSE2_FillSet<SSE2_Fractal<Kernel, FastNoise::FBM>>(args...);
+		return true;
+	case FastNoise::Billow:
+		SSE2_FillSet<SSE2_Fractal<Kernel, FastNoise::Billow>>(args...);
+		return true;
+	case FastNoise::RigidMulti:
+		SSE2_FillSet<SSE2_Fractal<Kernel, FastNoise::RigidMulti>>(args...);
+		return true;
+	default:
+		return false;
+	}
+}
+
+// Resolves the interpolation too, for the kernels that use it
+template <template <int> class Kernel, class... Args>
+static bool SSE2_DispatchSet(FastNoise::Interp interp, int fractal, Args... args)
+{
+	switch (interp)
+	{
+	case FastNoise::Linear:
+		return SSE2_DispatchFractal<Kernel<FastNoise::Linear>>(fractal, args...);
+	case FastNoise::Hermite:
+		return SSE2_DispatchFractal<Kernel<FastNoise::Hermite>>(fractal, args...);
+	case FastNoise::Quintic:
+		return SSE2_DispatchFractal<Kernel<FastNoise::Quintic>>(fractal, args...);
+	default:
+		return false;
+	}
+}
+#endif
+
+// Shared by the 2D and 3D scalar set fallbacks, the overloads are picked by the pointer types
+template <class SingleFunc, class FractalFunc>
+void FastNoise::GetSetFunc(SingleFunc& single, FractalFunc& fractal) const
+{
+	single = nullptr;
+	fractal = nullptr;
+
+	switch (m_noiseType)
+	{
+	case Value:
+		single = &FastNoise::SingleValue;
+		break;
+	case ValueFractal:
+		switch (m_fractalType)
+		{
+		case FBM:
+			fractal = &FastNoise::SingleValueFractalFBM;
+			break;
+		case Billow:
+			fractal = &FastNoise::SingleValueFractalBillow;
+			break;
+		case RigidMulti:
+			fractal = &FastNoise::SingleValueFractalRigidMulti;
+			break;
+		}
+		break;
+	case Perlin:
+		single = &FastNoise::SinglePerlin;
+		break;
+	case PerlinFractal:
+		switch (m_fractalType)
+		{
+		case FBM:
+			fractal = &FastNoise::SinglePerlinFractalFBM;
+			break;
+		case Billow:
+			fractal = &FastNoise::SinglePerlinFractalBillow;
+			break;
+		case RigidMulti:
+			fractal = &FastNoise::SinglePerlinFractalRigidMulti;
+			break;
+		}
+		break;
+	case Simplex:
+		single = &FastNoise::SingleSimplex;
+		break;
+	case SimplexFractal:
+		switch (m_fractalType)
+		{
+		case FBM:
+			fractal = &FastNoise::SingleSimplexFractalFBM;
+			break;
+		case Billow:
+			fractal = &FastNoise::SingleSimplexFractalBillow;
+			break;
+		case RigidMulti:
+			fractal = &FastNoise::SingleSimplexFractalRigidMulti;
+			break;
+		}
+		break;
+	case Cellular:
+		switch (m_cellularReturnType)
+		{
+		case CellValue:
+		case NoiseLookup:
+		case Distance:
+			fractal = &FastNoise::SingleCellular;
+			break;
+		default:
+			fractal = &FastNoise::SingleCellular2Edge;
+			break;
+		}
+		break;
+	case WhiteNoise:
+		fractal = &FastNoise::GetWhiteNoise;
+		break;
+	case Cubic:
+		single = &FastNoise::SingleCubic;
+		break;
+	case CubicFractal:
+		switch (m_fractalType)
+		{
+		case FBM:
+			fractal = &FastNoise::SingleCubicFractalFBM;
+			break;
+		case Billow:
+			fractal = &FastNoise::SingleCubicFractalBillow;
+			break;
+		case RigidMulti:
+			fractal = &FastNoise::SingleCubicFractalRigidMulti;
+			break;
+		}
+		break;
+	}
+}
+
+bool FastNoise::GetNoiseSetSSE2(const SetParams& params, FN_DECIMAL* noiseSet, FN_DECIMAL xStart, FN_DECIMAL yStart, int xSize, int ySize, FN_DECIMAL stepSize)
+{
+	if (!noiseSet || xSize <= 0 || ySize <= 0)
+		return false;
+
+#ifdef FN_USE_SSE2
+	SSE2_FractalParams sse = { { params.perm, params.perm12 }, params.octaves, _mm_set1_ps(params.lacunarity), params.gain, _mm_set1_ps(params.fractalBounding) };
+
+	switch (params.noiseType)
+	{
+	case Value:
+	case ValueFractal:
+		if (SSE2_DispatchSet<SSE2_Value>(params.interp, params.noiseType == Value ? -1 : (int)params.fractalType,
+			sse, noiseSet, xStart, yStart, xSize, ySize, stepSize, params.frequency))
+			return true;
+		break;
+	case Perlin:
+	case PerlinFractal:
+		if (SSE2_DispatchSet<SSE2_Perlin>(params.interp, params.noiseType == Perlin ? -1 : (int)params.fractalType,
+			sse, noiseSet, xStart, yStart, xSize, ySize, stepSize, params.frequency))
+			return true;
+		break;
+	case Simplex:
+	case SimplexFractal:
+		if (SSE2_DispatchFractal<SSE2_Simplex>(params.noiseType == Simplex ? -1 : (int)params.fractalType,
+			sse, noiseSet, xStart, yStart, xSize, ySize, stepSize, params.frequency))
+			return true;
+		break;
+	case Cubic:
+	case CubicFractal:
+		if (SSE2_DispatchFractal<SSE2_Cubic>(params.noiseType == Cubic ? -1 : (int)params.fractalType,
+			sse, noiseSet, xStart, yStart, xSize, ySize, stepSize, params.frequency))
+			return true;
+		break;
+	default:
+		break;
+	}
+#endif
+
+	return false;
+}
+
+void FastNoise::GetNoiseSet(FN_DECIMAL* noiseSet, FN_DECIMAL xStart, FN_DECIMAL yStart, int xSize, int ySize, FN_DECIMAL stepSize) const
+{
+	if (!noiseSet || xSize <= 0 || ySize <= 0)
+		return;
+
+	SetParams params = { m_perm, m_perm12, m_noiseType, m_fractalType, m_interp, m_frequency, m_octaves, m_lacunarity, m_gain, m_fractalBounding };
+	if (GetNoiseSetSSE2(params, noiseSet, xStart, yStart, xSize, ySize, stepSize))
+		return;
+
+	// Scalar path, the noise function is resolved once for the whole set
+	typedef FN_DECIMAL(FastNoise::*SingleFunc)(unsigned char, FN_DECIMAL, FN_DECIMAL) const;
+	typedef FN_DECIMAL(FastNoise::*FractalFunc)(FN_DECIMAL, FN_DECIMAL) const;
+
+	SingleFunc single;
+	FractalFunc fractal;
+	GetSetFunc(single, fractal);
+
+	for (int x = 0; x < xSize; x++)
+	{
+		FN_DECIMAL xf = (xStart + (FN_DECIMAL)x * stepSize) * m_frequency;
+		FN_DECIMAL* row = noiseSet + (size_t)x * ySize;
+
+		for (int y = 0; y < ySize; y++)
+		{
+			FN_DECIMAL yf = (yStart + (FN_DECIMAL)y * stepSize) * m_frequency;
+
+			if (single)
+				row[y] = (this->*single)(0, xf, yf);
+			else if (fractal)
+				row[y] = (this->*fractal)(xf, yf);
+			else
+				row[y] = 0;
+		}
+	}
+}
+
+bool FastNoise::GetNoiseSetSSE2(const SetParams& params, FN_DECIMAL* noiseSet, FN_DECIMAL xStart, FN_DECIMAL yStart, FN_DECIMAL zStart, int xSize, int ySize, int zSize, FN_DECIMAL stepSize)
+{
+	if (!noiseSet || xSize <= 0 || ySize <= 0 || zSize <= 0)
+		return false;
+
+#ifdef FN_USE_SSE2
+	SSE2_FractalParams sse = { { params.perm, params.perm12 }, params.octaves, _mm_set1_ps(params.lacunarity), params.gain, _mm_set1_ps(params.fractalBounding) };
+
+	switch (params.noiseType)
+	{
+	case Value:
+	case ValueFractal:
+		if (SSE2_DispatchSet<SSE2_Value>(params.interp, params.noiseType == Value ? -1 : (int)params.fractalType,
+			sse, noiseSet, xStart, yStart, zStart, xSize, ySize, zSize, stepSize, params.frequency))
+			return true;
+		break;
+	case Perlin:
+	case PerlinFractal:
+		if (SSE2_DispatchSet<SSE2_Perlin>(params.interp, params.noiseType == Perlin ? -1 : (int)params.fractalType,
+			sse, noiseSet, xStart, yStart, zStart, xSize, ySize, zSize, stepSize, params.frequency))
+			return true;
+		break;
+	case Simplex:
+	case SimplexFractal:
+		if (SSE2_DispatchFractal<SSE2_Simplex>(params.noiseType == Simplex ? -1 : (int)params.fractalType,
+			sse, noiseSet, xStart, yStart, zStart, xSize, ySize, zSize, stepSize, params.frequency))
+			return true;
+		break;
+	case Cubic:
+	case CubicFractal:
+		if (SSE2_DispatchFractal<SSE2_Cubic>(params.noiseType == Cubic ? -1 : (int)params.fractalType,
+			sse, noiseSet, xStart, yStart, zStart, xSize, ySize, zSize, stepSize, params.frequency))
+			return true;
+		break;
+	default:
+		break;
+	}
+#endif
+
+	return false;
+}
+
+void FastNoise::GetNoiseSet(FN_DECIMAL* noiseSet, FN_DECIMAL xStart, FN_DECIMAL yStart, FN_DECIMAL zStart, int xSize, int ySize, int zSize, FN_DECIMAL stepSize) const
+{
+	if (!noiseSet || xSize <= 0 || ySize <= 0 || zSize <= 0)
+		return;
+
+	SetParams params = { m_perm, m_perm12, m_noiseType, m_fractalType, m_interp, m_frequency, m_octaves, m_lacunarity, m_gain, m_fractalBounding };
+	if (GetNoiseSetSSE2(params, noiseSet, xStart, yStart, zStart, xSize, ySize, zSize, stepSize))
+		return;
+
+	typedef FN_DECIMAL(FastNoise::*SingleFunc)(unsigned char, FN_DECIMAL, FN_DECIMAL, FN_DECIMAL) const;
+	typedef FN_DECIMAL(FastNoise::*FractalFunc)(FN_DECIMAL, FN_DECIMAL, FN_DECIMAL) const;
+
+	SingleFunc single;
+	FractalFunc fractal;
+	GetSetFunc(single, fractal);
+
+	for (int x = 0; x < xSize; x++)
+	{
+		FN_DECIMAL xf = (xStart + (FN_DECIMAL)x * stepSize) * m_frequency;
+
+		for (int y = 0; y < ySize; y++)
+		{
+			FN_DECIMAL yf = (yStart + (FN_DECIMAL)y * stepSize) * m_frequency;
+			FN_DECIMAL* row = noiseSet + ((size_t)x * ySize + y) * zSize;
+
+			for (int z = 0; z < zSize; z++)
+			{
+				FN_DECIMAL zf = (zStart + (FN_DECIMAL)z * stepSize) * m_frequency;
+
+				if (single)
+					row[z] = (this->*single)(0, xf, yf, zf);
+				else if (fractal)
+					row[z] = (this->*fractal)(xf, yf, zf);
+				else
+					row[z] = 0;
+			}
+		}
+	}
+}
+
+// Derivatives
+static void InterpDeriv(FastNoise::Interp interp, FN_DECIMAL t, FN_DECIMAL& s, FN_DECIMAL& ds)
+{
+	switch (interp)
+	{
+	case FastNoise::Linear:
+		s = t;
+		ds = 1;
+		break;
+	case FastNoise::Hermite:
+		s = InterpHermiteFunc(t);
+		ds = 6 * t * (1 - t);
+		break;
+	default:
+		s = InterpQuinticFunc(t);
+		ds = t * t * (t * (t * 30 - 60) + 30);
+		break;
+	}
+}
+
+// Lerp(a, b, t) with a and b carrying gradients da and db, t varies along axis at rate dt
+template <int D>
+static FN_DECIMAL LerpDeriv(FN_DECIMAL a, const FN_DECIMAL* da, FN_DECIMAL b, const FN_DECIMAL* db,
+	FN_DECIMAL t, FN_DECIMAL dt, int axis, FN_DECIMAL* d)
+{
+	for (int i = 0; i < D; i++)
+		d[i] = da[i] + t * (db[i] - da[i]);
+	d[axis] += dt * (b - a);
+
+	return Lerp(a, b, t);
+}
+
+// Value and slope of an octave after the fractal shaping
+static FN_DECIMAL FractalShapeDeriv(FastNoise::FractalType fractalType, FN_DECIMAL n, FN_DECIMAL& slope)
+{
+	switch (fractalType)
+	{
+	case FastNoise::Billow:
+		slope = n < 0 ? FN_DECIMAL(-2) : FN_DECIMAL(2);
+		return FastAbs(n) * 2 - 1;
+	case FastNoise::RigidMulti:
+		slope = n < 0 ? FN_DECIMAL(1) : FN_DECIMAL(-1);
+		return 1 - FastAbs(n);
+	default:
+		slope = 1;
+		return n;
+	}
+}
+
+static FN_DECIMAL SimplexCornerDeriv2D(FN_DECIMAL t, unsigned char lutPos, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL* d)
+{
+	if (t < 0)
+		return 0;
+
+	FN_DECIMAL t2 = t * t;
+	FN_DECIMAL t4 = t2 * t2;
+	FN_DECIMAL g = x * GRAD_X[lutPos] + y * GRAD_Y[lutPos];
+	FN_DECIMAL dt = 8 * t2 * t * g;
+
+	d[0] += t4 * GRAD_X[lutPos] - dt * x;
+	d[1] += t4 * GRAD_Y[lutPos] - dt * y;
+	return t4 * g;
+}
+
+static FN_DECIMAL SimplexCornerDeriv3D(FN_DECIMAL t, unsigned char lutPos, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL* d)
+{
+	if (t < 0)
+		return 0;
+
+	FN_DECIMAL t2 = t * t;
+	FN_DECIMAL t4 = t2 * t2;
+	FN_DECIMAL g = x * GRAD_X[lutPos] + y * GRAD_Y[lutPos] + z * GRAD_Z[lutPos];
+	FN_DECIMAL dt = 8 * t2 * t * g;
+
+	d[0] += t4 * GRAD_X[lutPos] - dt * x;
+	d[1] += t4 * GRAD_Y[lutPos] - dt * y;
+	d[2] += t4 * GRAD_Z[lutPos] - dt * z;
+	return t4 * g;
+}
+
+bool FastNoise::GetSingleDerivFunc(SingleDeriv2DFunc& single, bool& fractal) const
+{
+	switch (m_noiseType)
+	{
+	case Perlin:
+	case PerlinFractal:
+		single = &FastNoise::SinglePerlinDeriv;
+		fractal = m_noiseType == PerlinFractal;
+		return true;
+	case Simplex:
+	case SimplexFractal:
+		single = &FastNoise::SingleSimplexDeriv;
+		fractal = m_noiseType == SimplexFractal;
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool FastNoise::GetSingleDerivFunc(SingleDeriv3DFunc& single, bool& fractal) const
+{
+	switch (m_noiseType)
+	{
+	case Perlin:
+	case PerlinFractal:
+		single = &FastNoise::SinglePerlinDeriv;
+		fractal = m_noiseType == PerlinFractal;
+		return true;
+	case Simplex:
+	case SimplexFractal:
+		single = &FastNoise::SingleSimplexDeriv;
+		fractal = m_noiseType == SimplexFractal;
+		return true;
+	default:
+		return false;
+	}
+}
+
+FN_DECIMAL FastNoise::GetNoiseDeriv(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL& dx, FN_DECIMAL& dy) const
+{
+	SingleDeriv2DFunc single;
+	bool fractal;
+
+	if (!GetSingleDerivFunc(single, fractal))
+	{
+		FN_DECIMAL h = FN_DECIMAL(0.01) / m_frequency;
+		dx = (GetNoise(x + h, y) - GetNoise(x - h, y)) / (2 * h);
+		dy = (GetNoise(x, y + h) - GetNoise(x, y - h)) / (2 * h);
+		return GetNoise(x, y);
+	}
+
+	FN_DECIMAL d[2];
+	FN_DECIMAL n = fractal ?
+		SingleFractalDeriv(single, x * m_frequency, y * m_frequency, d) :
+		(this->*single)(0, x * m_frequency, y * m_frequency, d);
+
+	dx = d[0] * m_frequency;
+	dy = d[1] * m_frequency;
+	return n;
+}
+
+FN_DECIMAL FastNoise::GetNoiseDeriv(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL& dx, FN_DECIMAL& dy, FN_DECIMAL& dz) const
+{
+	SingleDeriv3DFunc single;
+	bool fractal;
+
+	if (!GetSingleDerivFunc(single, fractal))
+	{
+		FN_DECIMAL h = FN_DECIMAL(0.01) / m_frequency;
+		dx = (GetNoise(x + h, y, z) - GetNoise(x - h, y, z)) / (2 * h);
+		dy = (GetNoise(x, y + h, z) - GetNoise(x, y - h, z)) / (2 * h);
+		dz = (GetNoise(x, y, z + h) - GetNoise(x, y, z - h)) / (2 * h);
+		return GetNoise(x, y, z);
+	}
+
+	FN_DECIMAL d[3];
+	FN_DECIMAL n = fractal ?
+		SingleFractalDeriv(single, x * m_frequency, y * m_frequency, z * m_frequency, d) :
+		(this->*single)(0, x * m_frequency, y * m_frequency, z * m_frequency, d);
+
+	dx = d[0] * m_frequency;
+	dy = d[1] * m_frequency;
+	dz = d[2] * m_frequency;
+	return n;
+}
+
+void FastNoise::GetNoiseSetDeriv(FN_DECIMAL* noiseSet, FN_DECIMAL* dxSet, FN_DECIMAL* dySet,
+	FN_DECIMAL xStart, FN_DECIMAL yStart, int xSize, int ySize, FN_DECIMAL stepSize) const
+{
+	if (!noiseSet || xSize <= 0 || ySize <= 0)
+		return;
+
+	SingleDeriv2DFunc single;
+	bool fractal;
+	bool analytic = GetSingleDerivFunc(single, fractal);
+
+	for (int x = 0; x < xSize; x++)
+	{
+		FN_DECIMAL xs = xStart + (FN_DECIMAL)x * stepSize;
+		size_t row = (size_t)x * ySize;
+
+		for (int y = 0; y < ySize; y++)
+		{
+			FN_DECIMAL ys = yStart + (FN_DECIMAL)y * stepSize;
+			FN_DECIMAL d[2];
+
+			if (!analytic)
+				noiseSet[row + y] = GetNoiseDeriv(xs, ys, d[0], d[1]);
+			else
+			{
+				noiseSet[row + y] = fractal ?
+					SingleFractalDeriv(single, xs * m_frequency, ys * m_frequency, d) :
+					(this->*single)(0, xs * m_frequency, ys * m_frequency, d);
+				d[0] *= m_frequency;
+				d[1] *= m_frequency;
+			}
+
+			if (dxSet) dxSet[row + y] = d[0];
+			if (dySet) dySet[row + y] = d[1];
+		}
+	}
+}
+
+void FastNoise::GetNoiseSetDeriv(FN_DECIMAL* noiseSet, FN_DECIMAL* dxSet, FN_DECIMAL* dySet, FN_DECIMAL* dzSet,
+	FN_DECIMAL xStart, FN_DECIMAL yStart, FN_DECIMAL zStart, int xSize, int ySize, int zSize, FN_DECIMAL stepSize) const
+{
+	if (!noiseSet || xSize <= 0 || ySize <= 0 || zSize <= 0)
+		return;
+
+	SingleDeriv3DFunc single;
+	bool fractal;
+	bool analytic = GetSingleDerivFunc(single, fractal);
+
+	for (int x = 0; x < xSize; x++)
+	{
+		FN_DECIMAL xs = xStart + (FN_DECIMAL)x * stepSize;
+
+		for (int y = 0; y < ySize; y++)
+		{
+			FN_DECIMAL ys = yStart + (FN_DECIMAL)y * stepSize;
+			size_t row = ((size_t)x * ySize + y) * zSize;
+
+			for (int z = 0; z < zSize; z++)
+			{
+				FN_DECIMAL zs = zStart + (FN_DECIMAL)z * stepSize;
+				FN_DECIMAL d[3];
+
+				if (!analytic)
+					noiseSet[row + z] = GetNoiseDeriv(xs, ys, zs, d[0], d[1], d[2]);
+				else
+				{
+					noiseSet[row + z] = fractal ?
+						SingleFractalDeriv(single, xs * m_frequency, ys * m_frequency, zs * m_frequency, d) :
+						(this->*single)(0, xs * m_frequency, ys * m_frequency, zs * m_frequency, d);
+					d[0] *= m_frequency;
+					d[1] *= m_frequency;
+					d[2] *= m_frequency;
+				}
+
+				if (dxSet) dxSet[row + z] = d[0];
+				if (dySet) dySet[row + z] = d[1];
+				if (dzSet) dzSet[row + z] = d[2];
+			}
+		}
+	}
+}
+
+FN_DECIMAL FastNoise::SingleFractalDeriv(SingleDeriv2DFunc single, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL* d) const
+{
+	FN_DECIMAL nd[2];
+	FN_DECIMAL slope;
+	FN_DECIMAL sum = FractalShapeDeriv(m_fractalType, (this->*single)(m_perm[0], x, y, nd), slope);
+	FN_DECIMAL amp = 1;
+	FN_DECIMAL scale = 1;
+	int i = 0;
+
+	d[0] = nd[0] * slope;
+	d[1] = nd[1] * slope;
+
+	while (++i < m_octaves)
+	{
+		x *= m_lacunarity;
+		y *= m_lacunarity;
+		scale *= m_lacunarity;
+
+		amp *= m_gain;
+		FN_DECIMAL shaped = FractalShapeDeriv(m_fractalType, (this->*single)(m_perm[i], x, y, nd), slope);
+		FN_DECIMAL weight = (m_fractalType == RigidMulti ? -slope : slope) * amp * scale;
+
+		if (m_fractalType == RigidMulti)
+			sum -= shaped * amp;
+		else
+			sum += shaped * amp;
+
+		d[0] += nd[0] * weight;
+		d[1] += nd[1] * weight;
+	}
+
+	if (m_fractalType == RigidMulti)
+		return sum;
+
+	d[0] *= m_fractalBounding;
+	d[1] *= m_fractalBounding;
+	return sum * m_fractalBounding;
+}
+
+FN_DECIMAL FastNoise::SingleFractalDeriv(SingleDeriv3DFunc single, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL* d) const
+{
+	FN_DECIMAL nd[3];
+	FN_DECIMAL slope;
+	FN_DECIMAL sum = FractalShapeDeriv(m_fractalType, (this->*single)(m_perm[0], x, y, z, nd), slope);
+	FN_DECIMAL amp = 1;
+	FN_DECIMAL scale = 1;
+	int i = 0;
+
+	d[0] = nd[0] * slope;
+	d[1] = nd[1] * slope;
+	d[2] = nd[2] * slope;
+
+	while (++i < m_octaves)
+	{
+		x *= m_lacunarity;
+		y *= m_lacunarity;
+		z *= m_lacunarity;
+		scale *= m_lacunarity;
+
+		amp *= m_gain;
+		FN_DECIMAL shaped = FractalShapeDeriv(m_fractalType, (this->*single)(m_perm[i], x, y, z, nd), slope);
+		FN_DECIMAL weight = (m_fractalType == RigidMulti ? -slope : slope) * amp * scale;
+
+		if (m_fractalType == RigidMulti)
+			sum -= shaped * amp;
+		else
+			sum += shaped * amp;
+
+		d[0] += nd[0] * weight;
+		d[1] += nd[1] * weight;
+		d[2] += nd[2] * weight;
+	}
+
+	if (m_fractalType == RigidMulti)
+		return sum;
+
+	d[0] *= m_fractalBounding;
+	d[1] *= m_fractalBounding;
+	d[2] *= m_fractalBounding;
+	return sum * m_fractalBounding;
+}
+
+FN_DECIMAL FastNoise::SinglePerlinDeriv(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL* d) const
+{
+	int x0 = FastFloor(x);
+	int y0 = FastFloor(y);
+	int x1 = x0 + 1;
+	int y1 = y0 + 1;
+
+	FN_DECIMAL xd0 = x - (FN_DECIMAL)x0;
+	FN_DECIMAL yd0 = y - (FN_DECIMAL)y0;
+	FN_DECIMAL xd1 = xd0 - 1;
+	FN_DECIMAL yd1 = yd0 - 1;
+
+	FN_DECIMAL xs, ys, dxs, dys;
+	InterpDeriv(m_interp, xd0, xs, dxs);
+	InterpDeriv(m_interp, yd0, ys, dys);
+
+	// Corner gradients are the derivatives of the corner dot products
+	unsigned char lut00 = Index2D_12(offset, x0, y0);
+	unsigned char lut10 = Index2D_12(offset, x1, y0);
+	unsigned char lut01 = Index2D_12(offset, x0, y1);
+	unsigned char lut11 = Index2D_12(offset, x1, y1);
+
+	FN_DECIMAL g00[2] = { GRAD_X[lut00], GRAD_Y[lut00] };
+	FN_DECIMAL g10[2] = { GRAD_X[lut10], GRAD_Y[lut10] };
+	FN_DECIMAL g01[2] = { GRAD_X[lut01], GRAD_Y[lut01] };
+	FN_DECIMAL g11[2] = { GRAD_X[lut11], GRAD_Y[lut11] };
+
+	FN_DECIMAL d0[2], d1[2];
+	FN_DECIMAL xf0 = LerpDeriv<2>(xd0 * g00[0] + yd0 * g00[1], g00, xd1 * g10[0] + yd0 * g10[1], g10, xs, dxs, 0, d0);
+	FN_DECIMAL xf1 = LerpDeriv<2>(xd0 * g01[0] + yd1 * g01[1], g01, xd1 * g11[0] + yd1 * g11[1], g11, xs, dxs, 0, d1);
+
+	return LerpDeriv<2>(xf0, d0, xf1, d1, ys, dys, 1, d);
+}
+
+FN_DECIMAL FastNoise::SinglePerlinDeriv(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL* d) const
+{
+	int x0 = FastFloor(x);
+	int y0 = FastFloor(y);
+	int z0 = FastFloor(z);
+
+	FN_DECIMAL xd0 = x - (FN_DECIMAL)x0;
+	FN_DECIMAL yd0 = y - (FN_DECIMAL)y0;
+	FN_DECIMAL zd0 = z - (FN_DECIMAL)z0;
+
+	FN_DECIMAL xs, ys, zs, dxs, dys, dzs;
+	InterpDeriv(m_interp, xd0, xs, dxs);
+	InterpDeriv(m_interp, yd0, ys, dys);
+	InterpDeriv(m_interp, zd0, zs, dzs);
+
+	// Corner c is offset by (c & 1, (c >> 1) & 1, c >> 2)
+	FN_DECIMAL n[8];
+	FN_DECIMAL g[8][3];
+	for (int c = 0; c < 8; c++)
+	{
+		int cx = c & 1;
+		int cy = (c >> 1) & 1;
+		int cz = c >> 2;
+		FN_DECIMAL xd = xd0 - cx;
+		FN_DECIMAL yd = yd0 - cy;
+		FN_DECIMAL zd = zd0 - cz;
+
+		unsigned char lutPos = Index3D_12(offset, x0 + cx, y0 + cy, z0 + cz);
+		g[c][0] = GRAD_X[lutPos];
+		g[c][1] = GRAD_Y[lutPos];
+		g[c][2] = GRAD_Z[lutPos];
+		n[c] = xd * g[c][0] + yd * g[c][1] + zd * g[c][2];
+	}
+
+	FN_DECIMAL d00[3], d10[3], d01[3], d11[3], d0[3], d1[3];
+	FN_DECIMAL xf00 = LerpDeriv<3>(n[0], g[0], n[1], g[1], xs, dxs, 0, d00);
+	FN_DECIMAL xf10 = LerpDeriv<3>(n[2], g[2], n[3], g[3], xs, dxs, 0, d10);
+	FN_DECIMAL xf01 = LerpDeriv<3>(n[4], g[4], n[5], g[5], xs, dxs, 0, d01);
+	FN_DECIMAL xf11 = LerpDeriv<3>(n[6], g[6], n[7], g[7], xs, dxs, 0, d11);
+
+	FN_DECIMAL yf0 = LerpDeriv<3>(xf00, d00, xf10, d10, ys, dys, 1, d0);
+	FN_DECIMAL yf1 = LerpDeriv<3>(xf01, d01, xf11, d11, ys, dys, 1, d1);
+
+	return LerpDeriv<3>(yf0, d0, yf1, d1, zs, dzs, 2, d);
+}
+
+FN_DECIMAL FastNoise::SingleSimplexDeriv(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL* d) const
+{
+	FN_DECIMAL t = (x + y) * F2;
+	int i = FastFloor(x + t);
+	int j = FastFloor(y + t);
+
+	t = (i + j) * G2;
+	FN_DECIMAL X0 = i - t;
+	FN_DECIMAL Y0 = j - t;
+
+	FN_DECIMAL x0 = x - X0;
+	FN_DECIMAL y0 = y - Y0;
+
+	int i1, j1;
+	if (x0 > y0)
+	{
+		i1 = 1; j1 = 0;
+	}
+	else
+	{
+		i1 = 0; j1 = 1;
+	}
+
+	FN_DECIMAL x1 = x0 - (FN_DECIMAL)i1 + G2;
+	FN_DECIMAL y1 = y0 - (FN_DECIMAL)j1 + G2;
+	FN_DECIMAL x2 = x0 - 1 + 2 * G2;
+	FN_DECIMAL y2 = y0 - 1 + 2 * G2;
+
+	// The corner offsets move with the point inside a cell, so each one differentiates to 1
+	d[0] = 0;
+	d[1] = 0;
+
+	FN_DECIMAL n0 = SimplexCornerDeriv2D(FN_DECIMAL(0.5) - x0 * x0 - y0 * y0, Index2D_12(offset, i, j), x0, y0, d);
+	FN_DECIMAL n1 = SimplexCornerDeriv2D(FN_DECIMAL(0.5) - x1 * x1 - y1 * y1, Index2D_12(offset, i + i1, j + j1), x1, y1, d);
+	FN_DECIMAL n2 = SimplexCornerDeriv2D(FN_DECIMAL(0.5) - x2 * x2 - y2 * y2, Index2D_12(offset, i + 1, j + 1), x2, y2, d);
+
+	d[0] *= 70;
+	d[1] *= 70;
+	return 70 * (n0 + n1 + n2);
+}
+
+FN_DECIMAL FastNoise::SingleSimplexDeriv(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL* d) const
+{
+	FN_DECIMAL t = (x + y + z) * F3;
+	int i = FastFloor(x + t);
+	int j = FastFloor(y + t);
+	int k = FastFloor(z + t);
+
+	t = (i + j + k) * G3;
+	FN_DECIMAL X0 = i - t;
+	FN_DECIMAL Y0 = j - t;
+	FN_DECIMAL Z0 = k - t;
+
+	FN_DECIMAL x0 = x - X0;
+	FN_DECIMAL y0 = y - Y0;
+	FN_DECIMAL z0 = z - Z0;
+
+	int i1, j1, k1;
+	int i2, j2, k2;
+
+	if (x0 >= y0)
+	{
+		if (y0 >= z0)
+		{
+			i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 1; k2 = 0;
+		}
+		else if (x0 >= z0)
+		{
+			i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 0; k2 = 1;
+		}
+		else // x0 < z0
+		{
+			i1 = 0; j1 = 0; k1 = 1; i2 = 1; j2 = 0; k2 = 1;
+		}
+	}
+	else // x0 < y0
+	{
+		if (y0 < z0)
+		{
+			i1 = 0; j1 = 0; k1 = 1; i2 = 0; j2 = 1; k2 = 1;
+		}
+		else if (x0 < z0)
+		{
+			i1 = 0; j1 = 1; k1 = 0; i2 = 0; j2 = 1; k2 = 1;
+		}
+		else // x0 >= z0
+		{
+			i1 = 0; j1 = 1; k1 = 0; i2 = 1; j2 = 1; k2 = 0;
+		}
+	}
+
+	FN_DECIMAL x1 = x0 - i1 + G3;
+	FN_DECIMAL y1 = y0 - j1 + G3;
+	FN_DECIMAL z1 = z0 - k1 + G3;
+	FN_DECIMAL x2 = x0 - i2 + 2 * G3;
+	FN_DECIMAL y2 = y0 - j2 + 2 * G3;
+	FN_DECIMAL z2 = z0 - k2 + 2 * G3;
+	FN_DECIMAL x3 = x0 - 1 + 3 * G3;
+	FN_DECIMAL y3 = y0 - 1 + 3 * G3;
+	FN_DECIMAL z3 = z0 - 1 + 3 * G3;
+
+	d[0] = 0;
+	d[1] = 0;
+	d[2] = 0;
+
+	FN_DECIMAL n0 = SimplexCornerDeriv3D(FN_DECIMAL(0.6) - x0 * x0 - y0 * y0 - z0 * z0, Index3D_12(offset, i, j, k), x0, y0, z0, d);
+	FN_DECIMAL n1 = SimplexCornerDeriv3D(FN_DECIMAL(0.6) - x1 * x1 - y1 * y1 - z1 * z1, Index3D_12(offset, i + i1, j + j1, k + k1), x1, y1, z1, d);
+	FN_DECIMAL n2 = SimplexCornerDeriv3D(FN_DECIMAL(0.6) - x2 * x2 - y2 * y2 - z2 * z2, Index3D_12(offset, i + i2, j + j2, k + k2), x2, y2, z2, d);
+	FN_DECIMAL n3 = SimplexCornerDeriv3D(FN_DECIMAL(0.6) - x3 * x3 - y3 * y3 - z3 * z3, Index3D_12(offset, i + 1, j + 1, k + 1), x3, y3, z3, d);
+
+	d[0] *= 32;
+	d[1] *= 32;
+	d[2] *= 32;
+	return 32 * (n0 + n1 + n2 + n3);
+}
@@ -207,12 +207,70 @@ public:
 	void GradientPerturb(FN_DECIMAL& x, FN_DECIMAL& y, FN_DECIMAL& z) const;
 	void GradientPerturbFractal(FN_DECIMAL& x, FN_DECIMAL& y, FN_DECIMAL& z) const;
 
+	//Noise Sets
+	// Fills noiseSet with GetNoise(...) sampled over a regular lattice, starting at
+	// (xStart, yStart) and advancing stepSize per sample along each axis
+	// noiseSet must hold xSize * ySize values and is indexed [x * ySize + y]
+	// Value, Perlin, Simplex and Cubic (and their fractal types) use SSE2 when available,
+	// Cellular and WhiteNoise resolve their dispatch once per set rather than per sample
+	void GetNoiseSet(FN_DECIMAL* noiseSet, FN_DECIMAL xStart, FN_DECIMAL yStart, int xSize, int ySize, FN_DECIMAL stepSize = 1) const;
+
+	// noiseSet must hold xSize * ySize * zSize values and is indexed [(x * ySize + y) * zSize + z]
+	void GetNoiseSet(FN_DECIMAL* noiseSet, FN_DECIMAL xStart, FN_DECIMAL yStart, FN_DECIMAL zStart, int xSize, int ySize, int zSize, FN_DECIMAL stepSize = 1) const;
+
+	// Everything the SSE2 set fills read, for evaluators that keep their own copy of the
+	// tables (LJMUNoiseKernel). perm and perm12 hold 512 entries each, as GetPermutation{12}()
+	struct SetParams
+	{
+		const unsigned char* perm;
+		const unsigned char* perm12;
+		NoiseType noiseType;
+		FractalType fractalType;
+		Interp interp;
+		FN_DECIMAL frequency;
+		int octaves;
+		FN_DECIMAL lacunarity;
+		FN_DECIMAL gain;
+		FN_DECIMAL fractalBounding;
+	};
+
+	// Fills noiseSet as GetNoiseSet(...) does through the SSE2 kernels
+	// Returns false and leaves noiseSet untouched if SSE2 is unavailable or the noise type has no SSE2 kernel
+	static bool GetNoiseSetSSE2(const SetParams& params, FN_DECIMAL* noiseSet, FN_DECIMAL xStart, FN_DECIMAL yStart, int xSize, int ySize, FN_DECIMAL stepSize = 1);
+	static bool GetNoiseSetSSE2(const SetParams& params, FN_DECIMAL* noiseSet, FN_DECIMAL xStart, FN_DECIMAL yStart, FN_DECIMAL zStart, int xSize, int ySize, int zSize, FN_DECIMAL stepSize = 1);
+
+	//Derivatives
+	// Returns GetNoise(...) and writes its partial derivatives along each input axis
+	// Perlin, Simplex and their fractal types are differentiated analytically in the same pass,
+	// other noise types fall back to central differences over four or six extra GetNoise calls
+	FN_DECIMAL GetNoiseDeriv(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL& dx, FN_DECIMAL& dy) const;
+	FN_DECIMAL GetNoiseDeriv(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL& dx, FN_DECIMAL& dy, FN_DECIMAL& dz) const;
+
+	// Same lattice and layout as GetNoiseSet(...), each derivative set may be null
+	void GetNoiseSetDeriv(FN_DECIMAL* noiseSet, FN_DECIMAL* dxSet, FN_DECIMAL* dySet,
+		FN_DECIMAL xStart, FN_DECIMAL yStart, int xSize, int ySize, FN_DECIMAL stepSize = 1) const;
+	void GetNoiseSetDeriv(FN_DECIMAL* noiseSet, FN_DECIMAL* dxSet, FN_DECIMAL* dySet, FN_DECIMAL* dzSet,
+		FN_DECIMAL xStart, FN_DECIMAL yStart, FN_DECIMAL zStart, int xSize, int ySize, int zSize, FN_DECIMAL stepSize = 1) const;
+
 	//4D
 	FN_DECIMAL GetSimplex(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL w) const;
 
 	FN_DECIMAL GetWhiteNoise(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL w) const;
 	FN_DECIMAL GetWhiteNoiseInt(int x, int y, int z, int w) const;
 
+	//Tables
+	// Permutation tables for the current seed, 512 entries each
+	// Exposed for compile-time specialised evaluators (LJMUNoiseKernel)
+	const unsigned char* GetPermutation() const { return m_perm; }
+	const unsigned char* GetPermutation12() const { return m_perm12; }
+
+	// Returns the fractal bounding derived from gain and octaves
+	FN_DECIMAL GetFractalBounding() const { return m_fractalBounding; }
+
+	// Value lookup table (256 entries) and gradient lookup tables (12 entries)
+	static const FN_DECIMAL* GetValueLUT();
+	static const FN_DECIMAL* GetGradientLUT(int axis);
+
 private:
 	unsigned char m_perm[512];
 	unsigned char m_perm12[512];
@@ -292,6 +350,27 @@ private:
 
 	void SingleGradientPerturb(unsigned char offset, FN_DECIMAL warpAmp, FN_DECIMAL frequency, FN_DECIMAL& x, FN_DECIMAL& y, FN_DECIMAL& z) const;
 
+	//Noise Sets
+	// Resolves the scalar noise function for the set fallback, single takes an offset and fractal
+	// does not, one of them is set. Instantiated for the 2D and 3D function types in FastNoise.cpp.
+	template <class SingleFunc, class FractalFunc>
+	void GetSetFunc(SingleFunc& single, FractalFunc& fractal) const;
+
+	//Derivatives
+	typedef FN_DECIMAL(FastNoise::*SingleDeriv2DFunc)(unsigned char, FN_DECIMAL, FN_DECIMAL, FN_DECIMAL*) const;
+	typedef FN_DECIMAL(FastNoise::*SingleDeriv3DFunc)(unsigned char, FN_DECIMAL, FN_DECIMAL, FN_DECIMAL, FN_DECIMAL*) const;
+
+	bool GetSingleDerivFunc(SingleDeriv2DFunc& single, bool& fractal) const;
+	bool GetSingleDerivFunc(SingleDeriv3DFunc& single, bool& fractal) const;
+
+	FN_DECIMAL SingleFractalDeriv(SingleDeriv2DFunc single, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL* d) const;
+	FN_DECIMAL SinglePerlinDeriv(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL* d) const;
+	FN_DECIMAL SingleSimplexDeriv(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL* d) const;
+
+	FN_DECIMAL SingleFractalDeriv(SingleDeriv3DFunc single, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL* d) const;
+	FN_DECIMAL SinglePerlinDeriv(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL* d) const;
+	FN_DECIMAL SingleSimplexDeriv(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL* d) const;
+
 	//4D
 	FN_DECIMAL SingleSimplex(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL w) const;
 
@@ -0,0 +1,477 @@
+#include "LJMUHeightErosion.h"
+#include "LJMUHeightmap.h"
+#include "LJMUThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+
+using namespace LJMUDX;
+
+namespace
+{
+	/////////////////////////
+	// SplitMix64, a small random
+	// sequence that any 64-bit key
+	// seeds well, so every tile of
+	// every round gets its own
+	/////////////////////////
+	struct LJMUErosionRandom
+	{
+		uint64_t state;
+
+		LJMUErosionRandom(int pseed, int pround, int ptile) :
+			state(((uint64_t)(uint32_t)pseed << 32) ^ ((uint64_t)(uint32_t)pround << 16) ^ (uint64_t)(uint32_t)ptile * 0x9E3779B97F4A7C15ull)
+		{
+			this->next();
+		}
+
+		uint64_t next()
+		{
+			uint64_t z = (this->state += 0x9E3779B97F4A7C15ull);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			return z ^ (z >> 31);
+		}
+
+		// Uniform in [0, 1)
+		float nextFloat()
+		{
+			return (float)(this->next() >> 40) * (1.0f / 16777216.0f);
+		}
+	};
+
+	// Droplets spawned per round for every this many grid cells. Each round moves the tiles.
+	const int EROSION_CELLS_PER_DROPLET = 32;
+
+	/////////////////////////
+	// Bilinear height and slope
+	// inside the cell holding
+	// (pi, pj)
+	/////////////////////////
+	inline float sampleSlope(const float* pheights, int plength, float pi, float pj, float& pgradi, float& pgradj)
+	{
+		int ti = (int)pi;
+		int tj = (int)pj;
+		float tu = pi - ti;
+		float tv = pj - tj;
+
+		const float* trow = pheights + (size_t)ti * plength + tj;
+		float th00 = trow[0];
+		float th01 = trow[1];
+		float th10 = trow[plength];
+		float th11 = trow[plength + 1];
+
+		pgradi = (th10 - th00) * (1.0f - tv) + (th11 - th01) * tv;
+		pgradj = (th01 - th00) * (1.0f - tu) + (th11 - th10) * tu;
+		return (th00 * (1.0f - tu) + th10 * tu) * (1.0f - tv) + (th01 * (1.0f - tu) + th11 * tu) * tv;
+	}
+}
+
+///////////////////////////
+// Constructor
+///////////////////////////
+LJMUHeightErosion::LJMUHeightErosion() :
+	_obj_pool(nullptr),
+	_max_threads(0),
+	_seed(1337),
+	_tile_size(64),
+	_lifetime(30),
+	_inertia(0.05f),
+	_capacity(4.0f),
+	_min_capacity(0.01f),
+	_erode_rate(0.3f),
+	_deposit_rate(0.3f),
+	_evaporate_rate(0.01f),
+	_gravity(4.0f),
+	_radius(3),
+	_talus(0.01f),
+	_thermal_rate(0.5f)
+{
+
+}
+
+///////////////////////////
+// Roll Droplets over the Map
+///////////////////////////
+bool LJMUHeightErosion::erodeHydraulic(LJMUHeightmap& pmap, int pdroplets)
+{
+	std::vector<float> theights;
+	if (!this->readMap(pmap, theights))
+		return false;
+
+	this->buildBrush();
+	this->hydraulic(theights.data(), pmap.getWidth(), pmap.getLength(), pdroplets);
+	this->writeMap(pmap, theights);
+	return true;
+}
+
+///////////////////////////
+// Slump Slopes steeper than
+// the Talus
+///////////////////////////
+bool LJMUHeightErosion::erodeThermal(LJMUHeightmap& pmap, int piterations)
+{
+	std::vector<float> theights;
+	if (!this->readMap(pmap, theights))
+		return false;
+
+	this->thermal(theights, pmap.getWidth(), pmap.getLength(), piterations);
+	this->writeMap(pmap, theights);
+	return true;
+}
+
+///////////////////////////
+// Time the Droplets on a
+// Rising Thread Count
+///////////////////////////
+std::vector<LJMUErosionTiming> LJMUHeightErosion::benchmarkHydraulic(const LJMUHeightmap& pmap, int pdroplets, int pmaxthreads)
+{
+	std::vector<LJMUErosionTiming> tlist;
+	std::vector<float> tsource;
+	if (!this->readMap(pmap, tsource))
+		return tlist;
+
+	this->buildBrush();
+
+	int tsaved = this->_max_threads;
+	this->_max_threads = 0;
+	int tmaxthreads = this->getThreadCount();
+	if (pmaxthreads > 0)
+		tmaxthreads = std::min(tmaxthreads, pmaxthreads);
+
+	std::vector<float> tfirst;
+	std::vector<float> twork;
+	for (int tthreads = 1;; tthreads = std::min(tthreads * 2, tmaxthreads))
+	{
+		twork = tsource;
+		this->_max_threads = tthreads;
+
+		auto tstart = std::chrono::steady_clock::now();
+		this->hydraulic(twork.data(), pmap.getWidth(), pmap.getLength(), pdroplets);
+		auto tend = std::chrono::steady_clock::now();
+
+		LJMUErosionTiming ttiming;
+		ttiming.threads = tthreads;
+		ttiming.seconds = std::chrono::duration<double>(tend - tstart).count();
+		ttiming.droplets_per_second = ttiming.seconds > 0.0 ? pdroplets / ttiming.seconds : 0.0;
+
+		if (tfirst.empty())
+			tfirst = twork;
+		ttiming.matches = twork == tfirst;
+		tlist.push_back(ttiming);
+
+		if (tthreads == tmaxthreads)
+			break;
+	}
+
+	this->_max_threads = tsaved;
+	return tlist;
+}
+
+///////////////////////////
+// Threads Work is Spread
+// over, the Caller included
+///////////////////////////
+int LJMUHeightErosion::getThreadCount() const
+{
+	LJMUThreadPool& tpool = this->_obj_pool ? *this->_obj_pool : LJMUThreadPool::getShared();
+	int tthreads = (int)tpool.getWorkerCount() + 1;
+	if (this->_max_threads > 0)
+		tthreads = std::min(tthreads, this->_max_threads);
+	return tthreads;
+}
+
+///////////////////////////
+// Run pbody over pcount Items
+// on at most getThreadCount()
+// Threads
+///////////////////////////
+void LJMUHeightErosion::runParallel(int pcount, const std::function<void(int)>& pbody) const
+{
+	int tthreads = std::min(this->getThreadCount(), pcount);
+	if (tthreads <= 1)
+	{
+		for (int i = 0; i < pcount; i++)
+			pbody(i);
+		return;
+	}
+
+	//Each thread keeps taking the next item, so uneven tiles still balance
+	std::atomic<int> tnext(0);
+	LJMUThreadPool& tpool = this->_obj_pool ? *this->_obj_pool : LJMUThreadPool::getShared();
+	tpool.parallelFor(tthreads, [&](int)
+	{
+		for (int i = tnext++; i < pcount; i = tnext++)
+			pbody(i);
+	});
+}
+
+///////////////////////////
+// Decode the Map to Floats
+///////////////////////////
+bool LJMUHeightErosion::readMap(const LJMUHeightmap& pmap, std::vector<float>& pheights) const
+{
+	if (pmap.getWidth() < 3 || pmap.getLength() < 3)
+		return false;
+
+	int tlength = pmap.getLength();
+	pheights.resize(pmap.getSampleCount());
+	this->runParallel(pmap.getWidth(), [&](int i)
+	{
+		pmap.readRow(i, 0, tlength, pheights.data() + (size_t)i * tlength);
+	});
+	return true;
+}
+
+///////////////////////////
+// Store the Eroded Heights,
+// Widening a Unorm Map's Range
+// to Hold them
+///////////////////////////
+void LJMUHeightErosion::writeMap(LJMUHeightmap& pmap, const std::vector<float>& pheights) const
+{
+	if (pmap.getFormat() != LJMUHeightmap::FORMAT_FLOAT32)
+	{
+		auto trange = std::minmax_element(pheights.begin(), pheights.end());
+		float tspan = *trange.second - *trange.first;
+		pmap.setScaleOffset(tspan > 0.0f ? tspan : 1.0f, *trange.first);
+	}
+
+	int tlength = pmap.getLength();
+	this->runParallel(pmap.getWidth(), [&](int i)
+	{
+		pmap.writeRow(i, 0, tlength, pheights.data() + (size_t)i * tlength);
+	});
+}
+
+///////////////////////////
+// Droplets in Rounds of Four
+// Passes, one per Tile Colour
+///////////////////////////
+void LJMUHeightErosion::hydraulic(float* pheights, int pwidth, int plength, int pdroplets) const
+{
+	//A droplet may leave its tile by a margin that keeps it and its brush off the next tile of
+	//the same colour, and tiles are widened so the margin covers a whole lifetime
+	int tradius = std::max(this->_radius, 0);
+	int ttile = std::max(this->_tile_size, 2 * (std::max(this->_lifetime, 1) + tradius + 1));
+	int tmargin = ttile / 2 - tradius - 1;
+
+	//Droplets only spawn where all four corners of their cell exist
+	int tcellsi = pwidth - 1;
+	int tcellsj = plength - 1;
+	int64_t tarea = (int64_t)tcellsi * tcellsj;
+	int64_t tperround = std::max<int64_t>(tarea / EROSION_CELLS_PER_DROPLET, 1);
+
+	std::vector<int> tlist_tiles;
+	int64_t tremaining = std::max(pdroplets, 0);
+	for (int tround = 0; tremaining > 0; tround++)
+	{
+		int64_t tbudget = std::min(tremaining, tperround);
+		tremaining -= tbudget;
+
+		//Shift the tile grid every round so tile edges do not leave a pattern
+		LJMUErosionRandom trandom(this->_seed, tround, -1);
+		int toffi = (int)(trandom.next() % (uint64_t)ttile);
+		int toffj = (int)(trandom.next() % (uint64_t)ttile);
+		int ttilesi = (tcellsi + toffi + ttile - 1) / ttile;
+		int ttilesj = (tcellsj + toffj + ttile - 1) / ttile;
+
+		for (int tcolour = 0; tcolour < 4; tcolour++)
+		{
+			tlist_tiles.clear();
+			for (int ti = tcolour & 1; ti < ttilesi; ti += 2)
+			{
+				for (int tj = tcolour >> 1; tj < ttilesj; tj += 2)
+					tlist_tiles.push_back(ti * ttilesj + tj);
+			}
+
+			this->runParallel((int)tlist_tiles.size(), [&](int pindex)
+			{
+				int ttileindex = tlist_tiles[pindex];
+				int ti = ttileindex / ttilesj;
+				int tj = ttileindex % ttilesj;
+				int ti0 = std::max(ti * ttile - toffi, 0);
+				int tj0 = std::max(tj * ttile - toffj, 0);
+				int ti1 = std::min((ti + 1) * ttile - toffi, tcellsi);
+				int tj1 = std::min((tj + 1) * ttile - toffj, tcellsj);
+
+				//Share of this round's droplets by area, counting the cells of the tiles before this one
+				//so the shares add up to the budget exactly
+				int64_t tcellsbefore = (int64_t)ti0 * tcellsj + (int64_t)(ti1 - ti0) * tj0;
+				int64_t tcellsafter = tcellsbefore + (int64_t)(ti1 - ti0) * (tj1 - tj0);
+				int64_t tcount = tbudget * tcellsafter / tarea - tbudget * tcellsbefore / tarea;
+
+				Reach treach;
+				treach.i0 = std::max(ti0 - tmargin, 0);
+				treach.j0 = std::max(tj0 - tmargin, 0);
+				treach.i1 = std::min(ti1 + tmargin, tcellsi);
+				treach.j1 = std::min(tj1 + tmargin, tcellsj);
+
+				LJMUErosionRandom tspawn(this->_seed, tround, ttileindex);
+				for (int64_t d = 0; d < tcount; d++)
+				{
+					float tpi = ti0 + tspawn.nextFloat() * (ti1 - ti0);
+					float tpj = tj0 + tspawn.nextFloat() * (tj1 - tj0);
+					this->runDroplet(pheights, pwidth, plength, treach, tpi, tpj);
+				}
+			});
+		}
+	}
+}
+
+///////////////////////////
+// Jacobi Iterations of Slope
+// Relaxation
+///////////////////////////
+void LJMUHeightErosion::thermal(std::vector<float>& pheights, int pwidth, int plength, int piterations) const
+{
+	static const int NEIGHBOUR_I[8] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+	static const int NEIGHBOUR_J[8] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+	static const float NEIGHBOUR_DISTANCE[8] = { 1.41421356f, 1.0f, 1.41421356f, 1.0f, 1.0f, 1.41421356f, 1.0f, 1.41421356f };
+
+	//Each pair of samples works out the same exchange from both sides, so height is conserved
+	float trate = this->_thermal_rate / 8.0f;
+	std::vector<float> tnext(pheights.size());
+
+	for (int it = 0; it < piterations; it++)
+	{
+		const float* tsrc = pheights.data();
+		float* tdst = tnext.data();
+
+		this->runParallel(pwidth, [&](int i)
+		{
+			for (int j = 0; j < plength; j++)
+			{
+				float th = tsrc[(size_t)i * plength + j];
+				float tchange = 0.0f;
+
+				for (int n = 0; n < 8; n++)
+				{
+					int ni = i + NEIGHBOUR_I[n];
+					int nj = j + NEIGHBOUR_J[n];
+					if (ni < 0 || nj < 0 || ni >= pwidth || nj >= plength)
+						continue;
+
+					float tdiff = th - tsrc[(size_t)ni * plength + nj];
+					float ttalus = this->_talus * NEIGHBOUR_DISTANCE[n];
+					if (tdiff > ttalus)
+						tchange -= (tdiff - ttalus) * trate;
+					else if (tdiff < -ttalus)
+						tchange -= (tdiff + ttalus) * trate;
+				}
+				tdst[(size_t)i * plength + j] = th + tchange;
+			}
+		});
+
+		pheights.swap(tnext);
+	}
+}
+
+///////////////////////////
+// Roll one Droplet until it
+// Stops, Evaporates or Leaves
+// its Reach
+///////////////////////////
+void LJMUHeightErosion::runDroplet(float* pheights, int pwidth, int plength, const Reach& preach, float pi, float pj) const
+{
+	float tdiri = 0.0f;
+	float tdirj = 0.0f;
+	float tspeed = 1.0f;
+	float twater = 1.0f;
+	float tsediment = 0.0f;
+
+	for (int tstep = 0; tstep < this->_lifetime; tstep++)
+	{
+		int tnodei = (int)pi;
+		int tnodej = (int)pj;
+		float tu = pi - tnodei;
+		float tv = pj - tnodej;
+
+		float tgradi;
+		float tgradj;
+		float theight = sampleSlope(pheights, plength, pi, pj, tgradi, tgradj);
+
+		//Turn downhill, keeping some of the old direction
+		tdiri = tdiri * this->_inertia - tgradi * (1.0f - this->_inertia);
+		tdirj = tdirj * this->_inertia - tgradj * (1.0f - this->_inertia);
+		float tlen = std::sqrt(tdiri * tdiri + tdirj * tdirj);
+		if (tlen < 1e-12f)
+			break;
+
+		tdiri /= tlen;
+		tdirj /= tlen;
+		pi += tdiri;
+		pj += tdirj;
+		if (pi < preach.i0 || pj < preach.j0 || pi >= preach.i1 || pj >= preach.j1)
+			break;
+
+		float tunused;
+		float tdelta = sampleSlope(pheights, plength, pi, pj, tunused, tunused) - theight;
+		float tcapacity = std::max(-tdelta * tspeed * twater * this->_capacity, this->_min_capacity);
+
+		if (tsediment > tcapacity || tdelta > 0.0f)
+		{
+			//Fill the pit climbed out of, or drop what the slowing droplet can no longer carry
+			float tamount = tdelta > 0.0f ? std::min(tdelta, tsediment) : (tsediment - tcapacity) * this->_deposit_rate;
+			tsediment -= tamount;
+
+			float* trow = pheights + (size_t)tnodei * plength + tnodej;
+			trow[0] += tamount * (1.0f - tu) * (1.0f - tv);
+			trow[1] += tamount * (1.0f - tu) * tv;
+			trow[plength] += tamount * tu * (1.0f - tv);
+			trow[plength + 1] += tamount * tu * tv;
+		}
+		else
+		{
+			//Wear the ground down around the cell, never deeper than the drop just made
+			float tamount = std::min((tcapacity - tsediment) * this->_erode_rate, -tdelta);
+			for (const BrushSample& tbrush : this->_list_brush)
+			{
+				int ti = tnodei + tbrush.di;
+				int tj = tnodej + tbrush.dj;
+				if (ti < 0 || tj < 0 || ti >= pwidth || tj >= plength)
+					continue;
+
+				float ttake = tamount * tbrush.weight;
+				pheights[(size_t)ti * plength + tj] -= ttake;
+				tsediment += ttake;
+			}
+		}
+
+		tspeed = std::sqrt(std::max(tspeed * tspeed - tdelta * this->_gravity, 0.0f));
+		twater *= 1.0f - this->_evaporate_rate;
+	}
+}
+
+///////////////////////////
+// Weights of the Samples a
+// Droplet Erodes, falling off
+// with Distance
+///////////////////////////
+void LJMUHeightErosion::buildBrush()
+{
+	this->_list_brush.clear();
+	int tradius = std::max(this->_radius, 0);
+	float tsum = 0.0f;
+
+	for (int di = -tradius; di <= tradius; di++)
+	{
+		for (int dj = -tradius; dj <= tradius; dj++)
+		{
+			float tweight = (float)tradius - std::sqrt((float)(di * di + dj * dj));
+			if (tradius == 0)
+				tweight = 1.0f;
+			if (tweight <= 0.0f)
+				continue;
+
+			BrushSample tsample = { di, dj, tweight };
+			this->_list_brush.push_back(tsample);
+			tsum += tweight;
+		}
+	}
+
+	for (BrushSample& tsample : this->_list_brush)
+		tsample.weight /= tsum;
+}
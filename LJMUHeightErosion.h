@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace LJMUDX
+{
+	class LJMUHeightmap;
+	class LJMUThreadPool;
+
+	/////////////////////////
+	// Hydraulic droplets run over
+	// the map with a given number
+	// of threads
+	/////////////////////////
+	struct LJMUErosionTiming
+	{
+		int		threads;
+		double	seconds;
+		double	droplets_per_second;
+		bool	matches;				//Same heights as the first run
+	};
+
+	/////////////////////////
+	// Erodes a heightmap, meant to
+	// run between generating a map
+	// and normalising it.
+	//
+	// Hydraulic erosion rolls
+	// droplets downhill that pick
+	// up sediment and drop it as
+	// they slow. The map is cut
+	// into square tiles coloured
+	// like a 2 x 2 checkerboard.
+	// Droplets start in a tile and
+	// die if they wander more than
+	// half a tile out of it, so
+	// tiles of one colour never
+	// touch the same samples and
+	// run in parallel. Each tile
+	// takes its droplets from its
+	// own random sequence, which
+	// makes the result depend on
+	// the seed only, never on the
+	// thread count.
+	//
+	// Thermal erosion moves height
+	// from any slope steeper than
+	// the talus to the neighbour
+	// below. Every sample gathers
+	// its own change from the last
+	// iteration, so rows run in
+	// parallel without sharing.
+	/////////////////////////
+	class LJMUHeightErosion
+	{
+	public:
+		//--------CONSTRUCTORS/DESTRUCTORS----------------------------------------------------
+		LJMUHeightErosion();
+
+		//--------PUBLIC METHODS-------------------------------------------------------------
+		void			setThreadPool(LJMUThreadPool* ppool) { this->_obj_pool = ppool; }
+		void			setMaxThreads(int pthreads) { this->_max_threads = pthreads; }	//0 uses every pool thread
+		void			setSeed(int pseed) { this->_seed = pseed; }
+
+		// Tiles are widened to fit a droplet's whole lifetime when set smaller
+		void			setTileSize(int psize) { this->_tile_size = psize; }
+		void			setDropletLifetime(int psteps) { this->_lifetime = psteps; }
+		void			setInertia(float pinertia) { this->_inertia = pinertia; }
+		void			setCapacity(float pcapacity, float pmincapacity) { this->_capacity = pcapacity; this->_min_capacity = pmincapacity; }
+		void			setErodeRate(float prate) { this->_erode_rate = prate; }
+		void			setDepositRate(float prate) { this->_deposit_rate = prate; }
+		void			setEvaporateRate(float prate) { this->_evaporate_rate = prate; }
+		void			setGravity(float pgravity) { this->_gravity = pgravity; }
+		void			setErodeRadius(int pradius) { this->_radius = pradius; }
+
+		// ptalus is the steepest stable height difference between neighbouring samples
+		void			setTalus(float ptalus) { this->_talus = ptalus; }
+		void			setThermalRate(float prate) { this->_thermal_rate = prate; }
+
+		// Unorm maps have their scale and offset widened to the eroded range, so nothing is
+		// clamped. Both fail on maps with fewer than 3 x 3 samples.
+		bool			erodeHydraulic(LJMUHeightmap& pmap, int pdroplets);
+		bool			erodeThermal(LJMUHeightmap& pmap, int piterations);
+
+		// Times pdroplets droplets on a copy of pmap with 1, 2, 4 .. pmaxthreads threads,
+		// 0 going up to every thread of the pool. pmap is left unchanged.
+		std::vector<LJMUErosionTiming>	benchmarkHydraulic(const LJMUHeightmap& pmap, int pdroplets, int pmaxthreads = 0);
+
+	private:
+		//-------------HELPER TYPES----------------------------------------------------
+		struct BrushSample
+		{
+			int		di;
+			int		dj;
+			float	weight;
+		};
+
+		struct Reach
+		{
+			int		i0;			//Droplets stay inside [i0, i1) x [j0, j1)
+			int		j0;
+			int		i1;
+			int		j1;
+		};
+
+		//-------------HELPER METHODS--------------------------------------------------
+		int				getThreadCount() const;
+		void			runParallel(int pcount, const std::function<void(int)>& pbody) const;
+
+		bool			readMap(const LJMUHeightmap& pmap, std::vector<float>& pheights) const;
+		void			writeMap(LJMUHeightmap& pmap, const std::vector<float>& pheights) const;
+
+		void			hydraulic(float* pheights, int pwidth, int plength, int pdroplets) const;
+		void			thermal(std::vector<float>& pheights, int pwidth, int plength, int piterations) const;
+		void			runDroplet(float* pheights, int pwidth, int plength, const Reach& preach, float pi, float pj) const;
+		void			buildBrush();
+
+		//--------CLASS MEMBERS--------------------------------------------------------------
+		LJMUThreadPool*				_obj_pool;
+		int							_max_threads;
+		int							_seed;
+		int							_tile_size;
+		int							_lifetime;
+		float						_inertia;
+		float						_capacity;
+		float						_min_capacity;
+		float						_erode_rate;
+		float						_deposit_rate;
+		float						_evaporate_rate;
+		float						_gravity;
+		int							_radius;
+		float						_talus;
+		float						_thermal_rate;
+		std::vector<BrushSample>	_list_brush;
+	};
+}
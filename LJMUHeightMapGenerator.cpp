@@ -0,0 +1,370 @@
+#include "LJMUHeightMapGenerator.h"
+#include "LJMUNoiseGraph.h"
+#include "LJMUNoiseKernel.h"
+#include "LJMUThreadPool.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace LJMUDX;
+
+///////////////////////////
+// Constructor, a 64x64 tile
+// of floats is 16KB so a tile
+// stays resident in L1/L2
+// while it is filled and scanned
+///////////////////////////
+LJMUHeightMapGenerator::LJMUHeightMapGenerator(int ptilesize) :
+	_tile_size(std::max(ptilesize, 8)),
+	_obj_pool(nullptr)
+{
+
+}
+
+///////////////////////////
+// Generate a Map Tile by Tile
+///////////////////////////
+LJMUHeightRange LJMUHeightMapGenerator::generate(LJMUHeightmap& pmap, const TileFillFunc& pfill, bool pnormalise)
+{
+	LJMUHeightRange trange = { 0.0, 0.0 };
+	if (pmap.isEmpty())
+		return trange;
+
+	if (pmap.getFormat() == LJMUHeightmap::FORMAT_FLOAT32)
+	{
+		//Float samples hold the values as they are
+		pmap.setScaleOffset(1.0f, 0.0f);
+		trange = this->fillTiles(pmap, pfill, nullptr);
+	}
+	else
+	{
+		//The codes are spread over the range so nothing is clipped and no precision is wasted,
+		//so the values wait in floats until the range is known, then are quantised in one pass
+		std::vector<float> theights(pmap.getSampleCount());
+		trange = this->fillTiles(pmap, pfill, theights.data());
+		double tspan = trange.max_height - trange.min_height;
+		pmap.setScaleOffset(tspan > 0.0 ? (float)tspan : 1.0f, (float)trange.min_height);
+		this->writeTiles(pmap, theights.data());
+	}
+
+	if (pnormalise)
+		this->applyRange(pmap, trange);
+
+	return trange;
+}
+
+///////////////////////////
+// Generate a Map from Noise
+///////////////////////////
+LJMUHeightRange LJMUHeightMapGenerator::generateNoise(LJMUHeightmap& pmap, const FastNoise& pnoise, bool pnormalise)
+{
+	return this->generate(pmap, [&pnoise](const LJMUHeightTile& ptile, float* pout)
+	{
+		pnoise.GetNoiseSet(pout, (FN_DECIMAL)ptile.i0, (FN_DECIMAL)ptile.j0, ptile.width, ptile.length);
+	}, pnormalise);
+}
+
+///////////////////////////
+// Generate a Map and its
+// Gradient from Noise
+///////////////////////////
+LJMUHeightRange LJMUHeightMapGenerator::generateNoiseGradient(LJMUHeightmap& pmap, float* pgradi, float* pgradj,
+	const FastNoise& pnoise, bool pnormalise)
+{
+	int tlength = pmap.getLength();
+
+	LJMUHeightRange trange = this->generate(pmap,
+		[&pnoise, pgradi, pgradj, tlength](const LJMUHeightTile& ptile, float* pout)
+	{
+		//The gradient tiles go straight to their place in the full maps
+		thread_local std::vector<float> tgradi;
+		thread_local std::vector<float> tgradj;
+		tgradi.resize((size_t)ptile.width * ptile.length);
+		tgradj.resize((size_t)ptile.width * ptile.length);
+
+		pnoise.GetNoiseSetDeriv(pout, pgradi ? tgradi.data() : nullptr, pgradj ? tgradj.data() : nullptr,
+			(FN_DECIMAL)ptile.i0, (FN_DECIMAL)ptile.j0, ptile.width, ptile.length);
+
+		for (int i = 0; i < ptile.width; i++)
+		{
+			size_t tsrc = (size_t)i * ptile.length;
+			size_t tdst = (size_t)(ptile.i0 + i) * tlength + ptile.j0;
+
+			if (pgradi)
+				std::copy(tgradi.begin() + tsrc, tgradi.begin() + tsrc + ptile.length, pgradi + tdst);
+			if (pgradj)
+				std::copy(tgradj.begin() + tsrc, tgradj.begin() + tsrc + ptile.length, pgradj + tdst);
+		}
+	}, pnormalise);
+
+	if (!pnormalise || (!pgradi && !pgradj))
+		return trange;
+
+	//Normalising scales every height by 1 / range, the slopes follow
+	double tspan = trange.max_height - trange.min_height;
+	float tscale = tspan > 0.0 ? (float)(1.0 / tspan) : 1.0f;
+	int twidth = pmap.getWidth();
+
+	LJMUThreadPool& tpool = this->_obj_pool ? *this->_obj_pool : LJMUThreadPool::getShared();
+	tpool.parallelFor(this->getTileCount(twidth, tlength), [&](int pindex)
+	{
+		LJMUHeightTile ttile = this->getTile(pindex, twidth, tlength);
+		for (int i = 0; i < ttile.width; i++)
+		{
+			size_t trow = (size_t)(ttile.i0 + i) * tlength + ttile.j0;
+			for (int j = 0; j < ttile.length; j++)
+			{
+				if (pgradi) pgradi[trow + j] *= tscale;
+				if (pgradj) pgradj[trow + j] *= tscale;
+			}
+		}
+	});
+
+	return trange;
+}
+
+///////////////////////////
+// Generate a Map from a
+// Noise Kernel
+///////////////////////////
+LJMUHeightRange LJMUHeightMapGenerator::generateNoise(LJMUHeightmap& pmap, const LJMUNoiseEvaluator& pnoise, bool pnormalise)
+{
+	return this->generate(pmap, [&pnoise](const LJMUHeightTile& ptile, float* pout)
+	{
+		pnoise.getNoiseSet(pout, (FN_DECIMAL)ptile.i0, (FN_DECIMAL)ptile.j0, ptile.width, ptile.length);
+	}, pnormalise);
+}
+
+///////////////////////////
+// Generate a Map from a
+// Noise Graph Node
+///////////////////////////
+LJMUHeightRange LJMUHeightMapGenerator::generateGraph(LJMUHeightmap& pmap, const LJMUNoiseGraph& pgraph, int pnode, bool pnormalise)
+{
+	return this->generate(pmap, [&pgraph, pnode](const LJMUHeightTile& ptile, float* pout)
+	{
+		pgraph.evaluateSet(pnode, pout, (FN_DECIMAL)ptile.i0, (FN_DECIMAL)ptile.j0, ptile.width, ptile.length);
+	}, pnormalise);
+}
+
+///////////////////////////
+// Normalise an Existing Map
+///////////////////////////
+LJMUHeightRange LJMUHeightMapGenerator::normalise(LJMUHeightmap& pmap)
+{
+	LJMUHeightRange trange = { 0.0, 0.0 };
+	if (pmap.isEmpty())
+		return trange;
+
+	trange = this->findRange(pmap);
+	this->applyRange(pmap, trange);
+	return trange;
+}
+
+///////////////////////////
+// Re-encode a Map in another
+// Format in one Pass
+///////////////////////////
+LJMUHeightRange LJMUHeightMapGenerator::quantise(LJMUHeightmap& pmap, LJMUHeightmap::Format pformat, bool pnormalise)
+{
+	LJMUHeightRange trange = { 0.0, 0.0 };
+	if (pmap.isEmpty())
+		return trange;
+
+	//Unorm codes are spread over the range, float samples keep the decoded values
+	trange = this->findRange(pmap);
+	double tspan = trange.max_height - trange.min_height;
+	LJMUHeightmap tmap;
+	bool tcreated = pformat == LJMUHeightmap::FORMAT_FLOAT32 ?
+		tmap.create(pmap.getWidth(), pmap.getLength(), pformat) :
+		tmap.create(pmap.getWidth(), pmap.getLength(), pformat, tspan > 0.0 ? (float)tspan : 1.0f, (float)trange.min_height);
+	if (!tcreated)
+		return trange;
+
+	LJMUThreadPool& tpool = this->_obj_pool ? *this->_obj_pool : LJMUThreadPool::getShared();
+
+	int twidth = pmap.getWidth();
+	int tlength = pmap.getLength();
+	tpool.parallelFor(this->getTileCount(twidth, tlength), [&](int pindex)
+	{
+		LJMUHeightTile ttile = this->getTile(pindex, twidth, tlength);
+
+		thread_local std::vector<float> trow;
+		trow.resize(ttile.length);
+
+		for (int i = 0; i < ttile.width; i++)
+		{
+			pmap.readRow(ttile.i0 + i, ttile.j0, ttile.length, trow.data());
+			tmap.writeRow(ttile.i0 + i, ttile.j0, ttile.length, trow.data());
+		}
+	});
+
+	if (pnormalise)
+		this->applyRange(tmap, trange);
+
+	pmap = std::move(tmap);
+	return trange;
+}
+
+///////////////////////////
+// Smallest and Largest Height
+// of an Existing Map
+///////////////////////////
+LJMUHeightRange LJMUHeightMapGenerator::findRange(const LJMUHeightmap& pmap)
+{
+	LJMUThreadPool& tpool = this->_obj_pool ? *this->_obj_pool : LJMUThreadPool::getShared();
+
+	int twidth = pmap.getWidth();
+	int tlength = pmap.getLength();
+	int ttiles = this->getTileCount(twidth, tlength);
+	std::vector<LJMUHeightRange> ttileranges(ttiles);
+
+	tpool.parallelFor(ttiles, [&](int pindex)
+	{
+		LJMUHeightTile ttile = this->getTile(pindex, twidth, tlength);
+
+		thread_local std::vector<float> trow;
+		trow.resize(ttile.length);
+
+		float tmin = pmap.getHeight(ttile.i0, ttile.j0);
+		float tmax = tmin;
+
+		for (int i = 0; i < ttile.width; i++)
+		{
+			pmap.readRow(ttile.i0 + i, ttile.j0, ttile.length, trow.data());
+			for (int j = 0; j < ttile.length; j++)
+			{
+				tmin = std::min(tmin, trow[j]);
+				tmax = std::max(tmax, trow[j]);
+			}
+		}
+
+		ttileranges[pindex].min_height = tmin;
+		ttileranges[pindex].max_height = tmax;
+	});
+
+	LJMUHeightRange trange = ttileranges[0];
+	for (const auto& ttilerange : ttileranges)
+	{
+		trange.min_height = std::min(trange.min_height, ttilerange.min_height);
+		trange.max_height = std::max(trange.max_height, ttilerange.max_height);
+	}
+	return trange;
+}
+
+///////////////////////////
+// Fill every Tile, reducing
+// the Range and writing the
+// Samples to the Map, or to
+// pheights laid out like it
+///////////////////////////
+LJMUHeightRange LJMUHeightMapGenerator::fillTiles(LJMUHeightmap& pmap, const TileFillFunc& pfill, float* pheights)
+{
+	LJMUThreadPool& tpool = this->_obj_pool ? *this->_obj_pool : LJMUThreadPool::getShared();
+
+	int twidth = pmap.getWidth();
+	int tlength = pmap.getLength();
+	int ttiles = this->getTileCount(twidth, tlength);
+	std::vector<LJMUHeightRange> ttileranges(ttiles);
+
+	tpool.parallelFor(ttiles, [&](int pindex)
+	{
+		LJMUHeightTile ttile = this->getTile(pindex, twidth, tlength);
+
+		//Per-thread scratch tile, reused across tiles
+		thread_local std::vector<float> tscratch;
+		tscratch.resize((size_t)ttile.width * ttile.length);
+
+		pfill(ttile, tscratch.data());
+
+		float tmin = tscratch[0];
+		float tmax = tscratch[0];
+
+		for (int i = 0; i < ttile.width; i++)
+		{
+			const float* tsrc = tscratch.data() + (size_t)i * ttile.length;
+
+			for (int j = 0; j < ttile.length; j++)
+			{
+				tmin = std::min(tmin, tsrc[j]);
+				tmax = std::max(tmax, tsrc[j]);
+			}
+
+			//Tiles cover disjoint spans of the map, so the writes need no locking
+			if (pheights)
+				std::copy(tsrc, tsrc + ttile.length, pheights + (size_t)(ttile.i0 + i) * tlength + ttile.j0);
+			else
+				pmap.writeRow(ttile.i0 + i, ttile.j0, ttile.length, tsrc);
+		}
+
+		ttileranges[pindex].min_height = tmin;
+		ttileranges[pindex].max_height = tmax;
+	});
+
+	//Reduce in tile order
+	LJMUHeightRange trange = ttileranges[0];
+	for (const auto& ttilerange : ttileranges)
+	{
+		trange.min_height = std::min(trange.min_height, ttilerange.min_height);
+		trange.max_height = std::max(trange.max_height, ttilerange.max_height);
+	}
+	return trange;
+}
+
+///////////////////////////
+// Write Heights laid out like
+// the Map into its Samples
+///////////////////////////
+void LJMUHeightMapGenerator::writeTiles(LJMUHeightmap& pmap, const float* pheights)
+{
+	LJMUThreadPool& tpool = this->_obj_pool ? *this->_obj_pool : LJMUThreadPool::getShared();
+
+	int twidth = pmap.getWidth();
+	int tlength = pmap.getLength();
+	tpool.parallelFor(this->getTileCount(twidth, tlength), [&](int pindex)
+	{
+		LJMUHeightTile ttile = this->getTile(pindex, twidth, tlength);
+		for (int i = 0; i < ttile.width; i++)
+			pmap.writeRow(ttile.i0 + i, ttile.j0, ttile.length, pheights + (size_t)(ttile.i0 + i) * tlength + ttile.j0);
+	});
+}
+
+///////////////////////////
+// Number of Tiles Covering
+// the Map
+///////////////////////////
+int LJMUHeightMapGenerator::getTileCount(int pwidth, int plength) const
+{
+	int ttilesi = (pwidth + this->_tile_size - 1) / this->_tile_size;
+	int ttilesj = (plength + this->_tile_size - 1) / this->_tile_size;
+	return ttilesi * ttilesj;
+}
+
+///////////////////////////
+// Rectangle of a Tile, edge
+// tiles are clipped to the map
+///////////////////////////
+LJMUHeightTile LJMUHeightMapGenerator::getTile(int pindex, int pwidth, int plength) const
+{
+	int ttilesj = (plength + this->_tile_size - 1) / this->_tile_size;
+
+	LJMUHeightTile ttile;
+	ttile.i0 = (pindex / ttilesj) * this->_tile_size;
+	ttile.j0 = (pindex % ttilesj) * this->_tile_size;
+	ttile.width = std::min(this->_tile_size, pwidth - ttile.i0);
+	ttile.length = std::min(this->_tile_size, plength - ttile.j0);
+	return ttile;
+}
+
+///////////////////////////
+// Remap a Map whose decoded
+// values span prange to [0,1]
+///////////////////////////
+void LJMUHeightMapGenerator::applyRange(LJMUHeightmap& pmap, const LJMUHeightRange& prange)
+{
+	double tspan = prange.max_height - prange.min_height;
+	if (tspan <= 0.0)
+		tspan = 1.0;
+
+	pmap.setScaleOffset((float)(pmap.getScale() / tspan), (float)((pmap.getOffset() - prange.min_height) / tspan));
+}
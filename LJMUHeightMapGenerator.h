@@ -0,0 +1,105 @@
+#pragma once
+
+#include <functional>
+
+#include "FastNoise.h"
+#include "LJMUHeightmap.h"
+
+namespace LJMUDX
+{
+	class LJMUNoiseEvaluator;
+	class LJMUNoiseGraph;
+	class LJMUThreadPool;
+
+	/////////////////////////
+	// Rectangle of heightmap
+	// samples handed to a tile
+	// fill function. Samples are
+	// laid out [i * length + j]
+	// with i in [i0, i0 + width)
+	// and j in [j0, j0 + length).
+	/////////////////////////
+	struct LJMUHeightTile
+	{
+		int i0;
+		int j0;
+		int width;
+		int length;
+	};
+
+	/////////////////////////
+	// Smallest and largest
+	// value in a heightmap
+	/////////////////////////
+	struct LJMUHeightRange
+	{
+		double min_height;
+		double max_height;
+	};
+
+	/////////////////////////
+	// Fills heightmaps tile by
+	// tile on the thread pool.
+	// Each tile is written and
+	// its min/max found while it
+	// is still in cache, then the
+	// map's scale and offset are
+	// set to decode it to [0,1].
+	// The result does not depend
+	// on the number of threads.
+	/////////////////////////
+	class LJMUHeightMapGenerator
+	{
+	public:
+		// Fills ptile into pout, a ptile.width * ptile.length block
+		typedef std::function<void(const LJMUHeightTile& ptile, float* pout)> TileFillFunc;
+
+		//--------CONSTRUCTORS/DESTRUCTORS----------------------------------------------------
+		LJMUHeightMapGenerator(int ptilesize = 64);
+
+		//--------PUBLIC METHODS-------------------------------------------------------------
+		void			setThreadPool(LJMUThreadPool* ppool) { this->_obj_pool = ppool; }
+		int				getTileSize() const { return this->_tile_size; }
+
+		// Fills pmap with pfill, normalised to [0,1] when pnormalise is set. pfill runs once
+		// per tile. A unorm map's tiles are held as floats until the range its codes are
+		// spread over is known, then quantised in one pass. The returned range is that of
+		// the unscaled values.
+		LJMUHeightRange	generate(LJMUHeightmap& pmap, const TileFillFunc& pfill, bool pnormalise = true);
+
+		// Generates the map from pnoise.GetNoise(i, j) using the batch noise path
+		LJMUHeightRange	generateNoise(LJMUHeightmap& pmap, const FastNoise& pnoise, bool pnormalise = true);
+
+		// Generates the map and its slope from pnoise.GetNoiseDeriv(i, j). pgradi and pgradj
+		// receive dh/di and dh/dj laid out like the map, either may be null, and are scaled
+		// along with the heights when pnormalise is set
+		LJMUHeightRange	generateNoiseGradient(LJMUHeightmap& pmap, float* pgradi, float* pgradj,
+							const FastNoise& pnoise, bool pnormalise = true);
+
+		// Generates the map from pnoise.getNoise(i, j), one set fill per tile
+		LJMUHeightRange	generateNoise(LJMUHeightmap& pmap, const LJMUNoiseEvaluator& pnoise, bool pnormalise = true);
+
+		// Generates the map from node pnode of a noise graph
+		LJMUHeightRange	generateGraph(LJMUHeightmap& pmap, const LJMUNoiseGraph& pgraph, int pnode, bool pnormalise = true);
+
+		// Finds the range of an existing map and remaps it to [0,1] through its scale and offset
+		LJMUHeightRange	normalise(LJMUHeightmap& pmap);
+
+		// Re-encodes pmap in pformat, a unorm map's codes spread over its range, normalised
+		// to [0,1] when pnormalise is set. Generate and edit in float, then quantise once.
+		LJMUHeightRange	quantise(LJMUHeightmap& pmap, LJMUHeightmap::Format pformat, bool pnormalise = true);
+
+	protected:
+		//-------------HELPER METHODS--------------------------------------------------
+		int				getTileCount(int pwidth, int plength) const;
+		LJMUHeightTile	getTile(int pindex, int pwidth, int plength) const;
+		LJMUHeightRange	fillTiles(LJMUHeightmap& pmap, const TileFillFunc& pfill, float* pheights);
+		void			writeTiles(LJMUHeightmap& pmap, const float* pheights);
+		LJMUHeightRange	findRange(const LJMUHeightmap& pmap);
+		void			applyRange(LJMUHeightmap& pmap, const LJMUHeightRange& prange);
+
+		//--------CLASS MEMBERS--------------------------------------------------------------
+		int				_tile_size;
+		LJMUThreadPool*	_obj_pool;
+	};
+}
@@ -0,0 +1,288 @@
+#include "LJMUHeightPyramid.h"
+#include "LJMUHeightmap.h"
+#include "LJMUThreadPool.h"
+
+#include <algorithm>
+#include <cfloat>
+
+//SSE2 is always there on x64, and on x86 when the compiler has been told it can use it
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LJMU_PYRAMID_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace LJMUDX;
+
+///////////////////////////
+// Constructor
+///////////////////////////
+LJMUHeightPyramid::LJMUHeightPyramid(int pbaselevel) :
+	_base_level(std::max(pbaselevel, 0)),
+	_map_width(0),
+	_map_length(0),
+	_obj_pool(nullptr)
+{
+
+}
+
+///////////////////////////
+// Build every Level
+///////////////////////////
+bool LJMUHeightPyramid::build(const LJMUHeightmap& pmap)
+{
+	this->clear();
+	if (pmap.getWidth() < 2 || pmap.getLength() < 2)
+		return false;
+
+	this->_map_width = pmap.getWidth();
+	this->_map_length = pmap.getLength();
+
+	for (int tlevel = this->_base_level;; tlevel++)
+	{
+		Level tnew;
+		tnew.cells_i = this->getCellsI(tlevel);
+		tnew.cells_j = this->getCellsJ(tlevel);
+		tnew.bounds.resize((size_t)tnew.cells_i * tnew.cells_j);
+		this->_list_levels.push_back(std::move(tnew));
+
+		if (this->_list_levels.back().cells_i == 1 && this->_list_levels.back().cells_j == 1)
+			break;
+	}
+
+	const Level& tbase = this->_list_levels.front();
+	this->computeBase(pmap, 0, 0, tbase.cells_i - 1, tbase.cells_j - 1);
+
+	for (int l = 1; l < (int)this->_list_levels.size(); l++)
+		this->computeLevel(l, 0, 0, this->_list_levels[l].cells_i - 1, this->_list_levels[l].cells_j - 1);
+
+	return true;
+}
+
+///////////////////////////
+// Refresh a Changed Region.
+// A sample is a corner of the
+// cells either side of it, so
+// the cells before it are
+// refreshed as well.
+///////////////////////////
+void LJMUHeightPyramid::update(const LJMUHeightmap& pmap, int pi0, int pj0, int pwidth, int plength)
+{
+	if (this->isEmpty() || pwidth <= 0 || plength <= 0)
+		return;
+
+	const Level& tbase = this->_list_levels.front();
+	int tci0 = std::max((pi0 - 1) >> this->_base_level, 0);
+	int tcj0 = std::max((pj0 - 1) >> this->_base_level, 0);
+	int tci1 = std::min((pi0 + pwidth - 1) >> this->_base_level, tbase.cells_i - 1);
+	int tcj1 = std::min((pj0 + plength - 1) >> this->_base_level, tbase.cells_j - 1);
+	if (tci0 > tci1 || tcj0 > tcj1)
+		return;
+
+	this->computeBase(pmap, tci0, tcj0, tci1, tcj1);
+
+	for (int l = 1; l < (int)this->_list_levels.size(); l++)
+	{
+		tci0 >>= 1;
+		tcj0 >>= 1;
+		tci1 >>= 1;
+		tcj1 >>= 1;
+		this->computeLevel(l, tci0, tcj0, tci1, tcj1);
+	}
+}
+
+///////////////////////////
+// Remove every Level
+///////////////////////////
+void LJMUHeightPyramid::clear()
+{
+	this->_list_levels.clear();
+	this->_map_width = 0;
+	this->_map_length = 0;
+}
+
+///////////////////////////
+// Bounds of a Cell at any
+// Level
+///////////////////////////
+LJMUHeightBounds LJMUHeightPyramid::getCellBounds(const LJMUHeightmap& pmap, int plevel, int pci, int pcj) const
+{
+	if (plevel >= this->_base_level)
+		return this->getBounds(plevel, pci, pcj);
+
+	int tia = pci << plevel;
+	int tja = pcj << plevel;
+	int tib = std::min((pci + 1) << plevel, this->_map_width - 1);
+	int tjb = std::min((pcj + 1) << plevel, this->_map_length - 1);
+
+	LJMUHeightBounds tbounds = { FLT_MAX, -FLT_MAX };
+	for (int i = tia; i <= tib; i++)
+	{
+		for (int j = tja; j <= tjb; j++)
+		{
+			float th = pmap.getHeight(i, j);
+			tbounds.min = std::min(tbounds.min, th);
+			tbounds.max = std::max(tbounds.max, th);
+		}
+	}
+	return tbounds;
+}
+
+///////////////////////////
+// Bounds over a Region of
+// Samples
+///////////////////////////
+LJMUHeightBounds LJMUHeightPyramid::getRegionBounds(int pi0, int pj0, int pi1, int pj1) const
+{
+	LJMUHeightBounds tbounds = { FLT_MAX, -FLT_MAX };
+	if (this->isEmpty())
+		return tbounds;
+
+	//Base cells holding the samples, a region ending on a cell edge stops at the cell before it
+	const Level& tbase = this->_list_levels.front();
+	pi0 = std::min(std::max(pi0, 0), this->_map_width - 1);
+	pj0 = std::min(std::max(pj0, 0), this->_map_length - 1);
+	pi1 = std::min(std::max(pi1, pi0), this->_map_width - 1);
+	pj1 = std::min(std::max(pj1, pj0), this->_map_length - 1);
+
+	int tci0 = std::min(pi0 >> this->_base_level, tbase.cells_i - 1);
+	int tcj0 = std::min(pj0 >> this->_base_level, tbase.cells_j - 1);
+	int tci1 = std::max(std::min((pi1 - 1) >> this->_base_level, tbase.cells_i - 1), tci0);
+	int tcj1 = std::max(std::min((pj1 - 1) >> this->_base_level, tbase.cells_j - 1), tcj0);
+
+	this->mergeRegion(this->getTopLevel(), 0, 0, tci0, tcj0, tci1, tcj1, tbounds);
+	return tbounds;
+}
+
+///////////////////////////
+// Base Cells from the Map,
+// a Row of Cells per Task
+///////////////////////////
+void LJMUHeightPyramid::computeBase(const LJMUHeightmap& pmap, int pci0, int pcj0, int pci1, int pcj1)
+{
+	Level& tbase = this->_list_levels.front();
+	int tshift = this->_base_level;
+	int tja = pcj0 << tshift;
+	int tjb = std::min((pcj1 + 1) << tshift, this->_map_length - 1);
+	int tspan = tjb - tja + 1;
+
+	LJMUThreadPool& tpool = this->_obj_pool ? *this->_obj_pool : LJMUThreadPool::getShared();
+	tpool.parallelFor(pci1 - pci0 + 1, [&](int prow)
+	{
+		int tci = pci0 + prow;
+		int tia = tci << tshift;
+		int tib = std::min((tci + 1) << tshift, this->_map_width - 1);
+
+		//Fold the cell rows into one lowest and one highest row, then reduce each cell's columns
+		thread_local std::vector<float> trows;
+		trows.resize((size_t)tspan * 3);
+		float* tlow = trows.data();
+		float* thigh = tlow + tspan;
+		float* trow = thigh + tspan;
+
+		pmap.readRow(tia, tja, tspan, tlow);
+		std::copy(tlow, tlow + tspan, thigh);
+
+		for (int i = tia + 1; i <= tib; i++)
+		{
+			pmap.readRow(i, tja, tspan, trow);
+			int j = 0;
+
+#ifdef LJMU_PYRAMID_SSE2
+			for (; j + 4 <= tspan; j += 4)
+			{
+				__m128 tvalues = _mm_loadu_ps(trow + j);
+				_mm_storeu_ps(tlow + j, _mm_min_ps(_mm_loadu_ps(tlow + j), tvalues));
+				_mm_storeu_ps(thigh + j, _mm_max_ps(_mm_loadu_ps(thigh + j), tvalues));
+			}
+#endif
+			for (; j < tspan; j++)
+			{
+				tlow[j] = std::min(tlow[j], trow[j]);
+				thigh[j] = std::max(thigh[j], trow[j]);
+			}
+		}
+
+		LJMUHeightBounds* tout = tbase.bounds.data() + (size_t)tci * tbase.cells_j;
+		for (int cj = pcj0; cj <= pcj1; cj++)
+		{
+			int tjfirst = (cj << tshift) - tja;
+			int tjlast = std::min((cj + 1) << tshift, this->_map_length - 1) - tja;
+
+			float tlo = tlow[tjfirst];
+			float thi = thigh[tjfirst];
+			for (int j = tjfirst + 1; j <= tjlast; j++)
+			{
+				tlo = std::min(tlo, tlow[j]);
+				thi = std::max(thi, thigh[j]);
+			}
+			tout[cj].min = tlo;
+			tout[cj].max = thi;
+		}
+	});
+}
+
+///////////////////////////
+// Merge 2 x 2 Cells of the
+// Level Below
+///////////////////////////
+void LJMUHeightPyramid::computeLevel(int pindex, int pci0, int pcj0, int pci1, int pcj1)
+{
+	const Level& tbelow = this->_list_levels[pindex - 1];
+	Level& tlevel = this->_list_levels[pindex];
+
+	LJMUThreadPool& tpool = this->_obj_pool ? *this->_obj_pool : LJMUThreadPool::getShared();
+	tpool.parallelFor(pci1 - pci0 + 1, [&](int prow)
+	{
+		//The last row or column may only have one cell below it
+		int tci = pci0 + prow;
+		int ti0 = tci * 2;
+		int ti1 = std::min(ti0 + 1, tbelow.cells_i - 1);
+		const LJMUHeightBounds* tsrc0 = tbelow.bounds.data() + (size_t)ti0 * tbelow.cells_j;
+		const LJMUHeightBounds* tsrc1 = tbelow.bounds.data() + (size_t)ti1 * tbelow.cells_j;
+		LJMUHeightBounds* tout = tlevel.bounds.data() + (size_t)tci * tlevel.cells_j;
+
+		for (int cj = pcj0; cj <= pcj1; cj++)
+		{
+			int tj0 = cj * 2;
+			int tj1 = std::min(tj0 + 1, tbelow.cells_j - 1);
+			tout[cj].min = std::min(std::min(tsrc0[tj0].min, tsrc0[tj1].min), std::min(tsrc1[tj0].min, tsrc1[tj1].min));
+			tout[cj].max = std::max(std::max(tsrc0[tj0].max, tsrc0[tj1].max), std::max(tsrc1[tj0].max, tsrc1[tj1].max));
+		}
+	});
+}
+
+///////////////////////////
+// Merge the Cells inside a
+// Range of Base Cells, taking
+// whole cells where they fit
+///////////////////////////
+void LJMUHeightPyramid::mergeRegion(int plevel, int pci, int pcj, int pci0, int pcj0, int pci1, int pcj1,
+	LJMUHeightBounds& pbounds) const
+{
+	int tshift = plevel - this->_base_level;
+	int tfirsti = pci << tshift;
+	int tfirstj = pcj << tshift;
+	int tlasti = ((pci + 1) << tshift) - 1;
+	int tlastj = ((pcj + 1) << tshift) - 1;
+
+	if (tfirsti > pci1 || tfirstj > pcj1 || tlasti < pci0 || tlastj < pcj0)
+		return;
+
+	if (tshift == 0 || (tfirsti >= pci0 && tfirstj >= pcj0 && tlasti <= pci1 && tlastj <= pcj1))
+	{
+		const LJMUHeightBounds& tcell = this->getBounds(plevel, pci, pcj);
+		pbounds.min = std::min(pbounds.min, tcell.min);
+		pbounds.max = std::max(pbounds.max, tcell.max);
+		return;
+	}
+
+	int tcellsi = this->_list_levels[tshift - 1].cells_i;
+	int tcellsj = this->_list_levels[tshift - 1].cells_j;
+	for (int c = 0; c < 4; c++)
+	{
+		int tci = pci * 2 + (c & 1);
+		int tcj = pcj * 2 + (c >> 1);
+		if (tci < tcellsi && tcj < tcellsj)
+			this->mergeRegion(plevel - 1, tci, tcj, pci0, pcj0, pci1, pcj1, pbounds);
+	}
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace LJMUDX
+{
+	class LJMUHeightmap;
+	class LJMUThreadPool;
+
+	/////////////////////////
+	// Lowest and highest height
+	// over part of a heightmap
+	/////////////////////////
+	struct LJMUHeightBounds
+	{
+		float min;
+		float max;
+	};
+
+	/////////////////////////
+	// Min/max mip chain over a
+	// heightmap's grid cells.
+	// Cell (ci, cj) of level L
+	// covers samples ci << L to
+	// (ci + 1) << L along i,
+	// clamped to the map, and
+	// each level merges 2 x 2
+	// cells of the one below until
+	// a single cell is left.
+	//
+	// Only levels from the base
+	// level up are stored. Below
+	// it a cell spans so few
+	// samples that reading them is
+	// as quick as a lookup, and a
+	// base of 2 needs a sixteenth
+	// of the memory of one range
+	// per grid cell.
+	/////////////////////////
+	class LJMUHeightPyramid
+	{
+	public:
+		//--------CONSTRUCTORS/DESTRUCTORS----------------------------------------------------
+		LJMUHeightPyramid(int pbaselevel = 2);
+
+		//--------PUBLIC METHODS-------------------------------------------------------------
+		void			setThreadPool(LJMUThreadPool* ppool) { this->_obj_pool = ppool; }
+
+		// Fails on maps with fewer than 2 x 2 samples
+		bool			build(const LJMUHeightmap& pmap);
+
+		// Refreshes the cells touching samples [pi0, pi0 + pwidth) x [pj0, pj0 + plength)
+		// after they changed in pmap, which must be the map the pyramid was built from
+		void			update(const LJMUHeightmap& pmap, int pi0, int pj0, int pwidth, int plength);
+		void			clear();
+
+		bool			isEmpty() const { return this->_list_levels.empty(); }
+		int				getBaseLevel() const { return this->_base_level; }
+		int				getTopLevel() const { return this->_base_level + (int)this->_list_levels.size() - 1; }
+
+		// Cell counts for any level, stored or not
+		int				getCellsI(int plevel) const { return ((this->_map_width - 1) + (1 << plevel) - 1) >> plevel; }
+		int				getCellsJ(int plevel) const { return ((this->_map_length - 1) + (1 << plevel) - 1) >> plevel; }
+
+		// Stored levels only, plevel >= getBaseLevel()
+		const LJMUHeightBounds&	getBounds(int plevel, int pci, int pcj) const
+		{
+			const Level& tlevel = this->_list_levels[plevel - this->_base_level];
+			return tlevel.bounds[(size_t)pci * tlevel.cells_j + pcj];
+		}
+
+		// Bounds of cell (pci, pcj) at any level, read from pmap below the base level
+		LJMUHeightBounds	getCellBounds(const LJMUHeightmap& pmap, int plevel, int pci, int pcj) const;
+
+		// Bounds over samples [pi0, pi1] x [pj0, pj1], from the largest stored cells that fit.
+		// Along edges that do not fall on base cells it can take in up to one base cell more.
+		LJMUHeightBounds	getRegionBounds(int pi0, int pj0, int pi1, int pj1) const;
+
+	private:
+		//-------------HELPER TYPES----------------------------------------------------
+		struct Level
+		{
+			int								cells_i;
+			int								cells_j;
+			std::vector<LJMUHeightBounds>	bounds;		//[ci * cells_j + cj]
+		};
+
+		//-------------HELPER METHODS--------------------------------------------------
+		void			computeBase(const LJMUHeightmap& pmap, int pci0, int pcj0, int pci1, int pcj1);
+		void			computeLevel(int pindex, int pci0, int pcj0, int pci1, int pcj1);
+		void			mergeRegion(int plevel, int pci, int pcj, int pci0, int pcj0, int pci1, int pcj1,
+							LJMUHeightBounds& pbounds) const;
+
+		//--------CLASS MEMBERS--------------------------------------------------------------
+		std::vector<Level>		_list_levels;		//Base level first
+		int						_base_level;
+		int						_map_width;
+		int						_map_length;
+		LJMUThreadPool*			_obj_pool;
+	};
+}
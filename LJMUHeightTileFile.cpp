@@ -0,0 +1,645 @@
+#include "LJMUHeightTileFile.h"
+#include "LJMUHeightmap.h"
+#include "LJMUThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstring>
+
+using namespace LJMUDX;
+
+namespace
+{
+	const char		HEIGHTTILE_MAGIC[4] = { 'L', 'J', 'H', 'T' };
+	const uint32_t	HEIGHTTILE_VERSION = 1;
+
+	// How a tile's bytes are stored
+	const uint32_t	HEIGHTTILE_RAW = 0;
+	const uint32_t	HEIGHTTILE_RICE = 1;
+
+	// Largest tile edge a file may declare, so a tile's sample count fits an int
+	const uint32_t	HEIGHTTILE_MAX_TILE = 16384;
+
+	// Quotients this long stop the unary run and are followed by the raw zigzagged residual,
+	// which needs 17 bits since the prediction is clamped to the code range
+	const int		RICE_ESCAPE = 24;
+	const int		RICE_RAW_BITS = 17;
+	const int		RICE_PARAM_BITS = 5;
+
+	struct FileHeader
+	{
+		char		magic[4];
+		uint32_t	version;
+		uint32_t	width;
+		uint32_t	length;
+		uint32_t	tile_size;
+		uint32_t	mip_count;
+		float		scale;
+		float		offset;
+	};
+
+	/////////////////////////
+	// Bits written low first
+	/////////////////////////
+	struct BitWriter
+	{
+		std::vector<uint8_t>&	out;
+		uint64_t				bits;
+		int						count;
+
+		BitWriter(std::vector<uint8_t>& pout) : out(pout), bits(0), count(0) {}
+
+		void write(uint32_t pvalue, int pcount)
+		{
+			this->bits |= (uint64_t)pvalue << this->count;
+			this->count += pcount;
+			while (this->count >= 8)
+			{
+				this->out.push_back((uint8_t)this->bits);
+				this->bits >>= 8;
+				this->count -= 8;
+			}
+		}
+
+		void flush()
+		{
+			if (this->count > 0)
+				this->out.push_back((uint8_t)this->bits);
+			this->bits = 0;
+			this->count = 0;
+		}
+	};
+
+	/////////////////////////
+	// Reads what BitWriter wrote.
+	// Reading past the end gives
+	// zeros and sets overrun.
+	/////////////////////////
+	struct BitReader
+	{
+		const uint8_t*	next;
+		const uint8_t*	end;
+		uint64_t		bits;
+		int				count;
+		bool			overrun;
+
+		BitReader(const uint8_t* pdata, size_t pbytes) : next(pdata), end(pdata + pbytes), bits(0), count(0), overrun(false) {}
+
+		void refill()
+		{
+			while (this->count <= 56 && this->next < this->end)
+			{
+				this->bits |= (uint64_t)*this->next++ << this->count;
+				this->count += 8;
+			}
+		}
+
+		uint32_t read(int pcount)
+		{
+			if (this->count < pcount)
+			{
+				this->refill();
+				if (this->count < pcount)
+				{
+					this->overrun = true;
+					this->count = pcount;
+				}
+			}
+			uint32_t tvalue = (uint32_t)(this->bits & ((1ull << pcount) - 1));
+			this->bits >>= pcount;
+			this->count -= pcount;
+			return tvalue;
+		}
+
+		// Ones before the next zero, at most plimit
+		int readUnary(int plimit)
+		{
+			int tones = 0;
+			while (tones < plimit && this->read(1))
+				tones++;
+			return tones;
+		}
+	};
+
+	inline uint32_t zigzag(int pvalue) { return ((uint32_t)pvalue << 1) ^ (uint32_t)(pvalue >> 31); }
+	inline int unzigzag(uint32_t pvalue) { return (int)(pvalue >> 1) ^ -(int)(pvalue & 1); }
+
+	/////////////////////////
+	// Planar prediction from the
+	// samples already decoded,
+	// left along the first row and
+	// up along the first column
+	/////////////////////////
+	inline int predict(const uint16_t* pcodes, int pstride, int pi, int pj)
+	{
+		if (pi == 0)
+			return pj == 0 ? 0 : pcodes[pj - 1];
+
+		const uint16_t* trow = pcodes + (size_t)pi * pstride;
+		if (pj == 0)
+			return trow[-pstride];
+
+		int tpredict = trow[pj - 1] + trow[pj - pstride] - trow[pj - pstride - 1];
+		return std::min(std::max(tpredict, 0), 65535);
+	}
+
+	/////////////////////////
+	// Rice code a Tile, falling
+	// back to raw codes if that
+	// comes out no smaller
+	/////////////////////////
+	uint32_t encodeTile(const uint16_t* pcodes, int pstride, int pwidth, int plength, std::vector<uint8_t>& pout)
+	{
+		pout.clear();
+		std::vector<uint32_t> tresiduals((size_t)plength);
+		BitWriter twriter(pout);
+
+		for (int i = 0; i < pwidth; i++)
+		{
+			const uint16_t* trow = pcodes + (size_t)i * pstride;
+			for (int j = 0; j < plength; j++)
+				tresiduals[j] = zigzag((int)trow[j] - predict(pcodes, pstride, i, j));
+
+			//Pick the parameter that codes this row in the fewest bits
+			int tbest = 0;
+			uint64_t tbestbits = UINT64_MAX;
+			for (int k = 0; k < (1 << RICE_PARAM_BITS) && k <= RICE_RAW_BITS; k++)
+			{
+				uint64_t tbits = 0;
+				for (int j = 0; j < plength; j++)
+				{
+					uint32_t tquotient = tresiduals[j] >> k;
+					tbits += tquotient < (uint32_t)RICE_ESCAPE ? tquotient + 1 + k : RICE_ESCAPE + RICE_RAW_BITS;
+				}
+				if (tbits < tbestbits)
+				{
+					tbest = k;
+					tbestbits = tbits;
+				}
+			}
+
+			twriter.write((uint32_t)tbest, RICE_PARAM_BITS);
+			for (int j = 0; j < plength; j++)
+			{
+				uint32_t tquotient = tresiduals[j] >> tbest;
+				if (tquotient < (uint32_t)RICE_ESCAPE)
+				{
+					twriter.write((1u << tquotient) - 1, (int)tquotient + 1);
+					if (tbest > 0)
+						twriter.write(tresiduals[j] & ((1u << tbest) - 1), tbest);
+				}
+				else
+				{
+					twriter.write((1u << RICE_ESCAPE) - 1, RICE_ESCAPE);
+					twriter.write(tresiduals[j], RICE_RAW_BITS);
+				}
+			}
+		}
+		twriter.flush();
+
+		size_t trawbytes = (size_t)pwidth * plength * sizeof(uint16_t);
+		if (pout.size() < trawbytes)
+			return HEIGHTTILE_RICE;
+
+		pout.resize(trawbytes);
+		for (int i = 0; i < pwidth; i++)
+			std::memcpy(pout.data() + (size_t)i * plength * sizeof(uint16_t), pcodes + (size_t)i * pstride, plength * sizeof(uint16_t));
+		return HEIGHTTILE_RAW;
+	}
+
+	/////////////////////////
+	// Undo encodeTile into codes
+	// laid out with pstride
+	/////////////////////////
+	bool decodeTile(const uint8_t* pdata, size_t pbytes, uint32_t pmethod, int pwidth, int plength, uint16_t* pcodes, int pstride)
+	{
+		if (pmethod == HEIGHTTILE_RAW)
+		{
+			if (pbytes != (size_t)pwidth * plength * sizeof(uint16_t))
+				return false;
+			for (int i = 0; i < pwidth; i++)
+				std::memcpy(pcodes + (size_t)i * pstride, pdata + (size_t)i * plength * sizeof(uint16_t), plength * sizeof(uint16_t));
+			return true;
+		}
+
+		if (pmethod != HEIGHTTILE_RICE)
+			return false;
+
+		BitReader treader(pdata, pbytes);
+		for (int i = 0; i < pwidth; i++)
+		{
+			int tparam = (int)treader.read(RICE_PARAM_BITS);
+			uint16_t* trow = pcodes + (size_t)i * pstride;
+
+			for (int j = 0; j < plength; j++)
+			{
+				int tquotient = treader.readUnary(RICE_ESCAPE);
+				uint32_t tvalue;
+				if (tquotient < RICE_ESCAPE)
+					tvalue = ((uint32_t)tquotient << tparam) | (tparam > 0 ? treader.read(tparam) : 0);
+				else
+					tvalue = treader.read(RICE_RAW_BITS);
+
+				int tcode = predict(pcodes, pstride, i, j) + unzigzag(tvalue);
+				trow[j] = (uint16_t)std::min(std::max(tcode, 0), 65535);
+			}
+		}
+		return !treader.overrun;
+	}
+}
+
+///////////////////////////
+// Constructor
+///////////////////////////
+LJMUHeightTileFile::LJMUHeightTileFile() :
+	_tile_size(0),
+	_scale(1.0f),
+	_offset(0.0f),
+	_obj_pool(nullptr)
+{
+
+}
+
+LJMUHeightTileFile::~LJMUHeightTileFile()
+{
+	this->close();
+}
+
+///////////////////////////
+// Write a Map as Tiles
+///////////////////////////
+bool LJMUHeightTileFile::write(const std::string& pfilename, const LJMUHeightmap& pmap, int ptilesize,
+	int pmipcount, LJMUThreadPool* ppool)
+{
+	if (pmap.isEmpty() || ptilesize < 2)
+		return false;
+
+	//Codes of the full map, requantised to 16 bits over the range unless they already are
+	int twidth = pmap.getWidth();
+	int tlength = pmap.getLength();
+	float tscale = pmap.getScale();
+	float toffset = pmap.getOffset();
+	std::vector<uint16_t> tcodes(pmap.getSampleCount());
+
+	if (pmap.getFormat() == LJMUHeightmap::FORMAT_UNORM16)
+	{
+		std::memcpy(tcodes.data(), pmap.getData(), tcodes.size() * sizeof(uint16_t));
+	}
+	else
+	{
+		std::vector<float> theights(pmap.getSampleCount());
+		for (int i = 0; i < twidth; i++)
+			pmap.readRow(i, 0, tlength, theights.data() + (size_t)i * tlength);
+
+		auto trange = std::minmax_element(theights.begin(), theights.end());
+		toffset = *trange.first;
+		tscale = *trange.second > *trange.first ? *trange.second - *trange.first : 1.0f;
+
+		LJMUHeightmap tquantised;
+		if (!tquantised.create(twidth, tlength, LJMUHeightmap::FORMAT_UNORM16, tscale, toffset))
+			return false;
+		for (int i = 0; i < twidth; i++)
+			tquantised.writeRow(i, 0, tlength, theights.data() + (size_t)i * tlength);
+		std::memcpy(tcodes.data(), tquantised.getData(), tcodes.size() * sizeof(uint16_t));
+	}
+
+	//Levels until one tile holds a whole level, or as many as were asked for
+	std::vector<std::vector<uint16_t>> tlist_codes;
+	std::vector<Level> tlist_levels;
+	tlist_codes.push_back(std::move(tcodes));
+
+	for (;;)
+	{
+		Level tlevel;
+		tlevel.width = tlist_levels.empty() ? twidth : ((tlist_levels.back().width - 1) >> 1) + 1;
+		tlevel.length = tlist_levels.empty() ? tlength : ((tlist_levels.back().length - 1) >> 1) + 1;
+		tlevel.tiles_i = (tlevel.width + ptilesize - 1) / ptilesize;
+		tlevel.tiles_j = (tlevel.length + ptilesize - 1) / ptilesize;
+		tlevel.first_entry = tlist_levels.empty() ? 0 : tlist_levels.back().first_entry + (size_t)tlist_levels.back().tiles_i * tlist_levels.back().tiles_j;
+
+		if (!tlist_levels.empty())
+		{
+			const std::vector<uint16_t>& tabove = tlist_codes.back();
+			int tabovelength = tlist_levels.back().length;
+			std::vector<uint16_t> tlevelcodes((size_t)tlevel.width * tlevel.length);
+			for (int i = 0; i < tlevel.width; i++)
+			{
+				for (int j = 0; j < tlevel.length; j++)
+					tlevelcodes[(size_t)i * tlevel.length + j] = tabove[(size_t)(i * 2) * tabovelength + j * 2];
+			}
+			tlist_codes.push_back(std::move(tlevelcodes));
+		}
+		tlist_levels.push_back(tlevel);
+
+		bool tlast = tlevel.tiles_i == 1 && tlevel.tiles_j == 1;
+		if (pmipcount > 0 ? (int)tlist_levels.size() >= pmipcount : tlast)
+			break;
+		if (tlevel.width == 1 && tlevel.length == 1)
+			break;
+	}
+
+	//Compress every tile of every level across the pool
+	size_t ttilecount = tlist_levels.back().first_entry + (size_t)tlist_levels.back().tiles_i * tlist_levels.back().tiles_j;
+	std::vector<std::vector<uint8_t>> tlist_tiles(ttilecount);
+	std::vector<TileEntry> tlist_entries(ttilecount);
+
+	LJMUThreadPool& tpool = ppool ? *ppool : LJMUThreadPool::getShared();
+	tpool.parallelFor((int)ttilecount, [&](int ptile)
+	{
+		int tmip = 0;
+		while (tmip + 1 < (int)tlist_levels.size() && tlist_levels[tmip + 1].first_entry <= (size_t)ptile)
+			tmip++;
+
+		const Level& tlevel = tlist_levels[tmip];
+		int tindex = ptile - (int)tlevel.first_entry;
+		int ti0 = (tindex / tlevel.tiles_j) * ptilesize;
+		int tj0 = (tindex % tlevel.tiles_j) * ptilesize;
+		int tw = std::min(ptilesize, tlevel.width - ti0);
+		int tl = std::min(ptilesize, tlevel.length - tj0);
+
+		const uint16_t* tfirst = tlist_codes[tmip].data() + (size_t)ti0 * tlevel.length + tj0;
+		tlist_entries[ptile].method = encodeTile(tfirst, tlevel.length, tw, tl, tlist_tiles[ptile]);
+		tlist_entries[ptile].bytes = (uint32_t)tlist_tiles[ptile].size();
+	});
+
+	FileHeader theader;
+	std::memcpy(theader.magic, HEIGHTTILE_MAGIC, sizeof(theader.magic));
+	theader.version = HEIGHTTILE_VERSION;
+	theader.width = (uint32_t)twidth;
+	theader.length = (uint32_t)tlength;
+	theader.tile_size = (uint32_t)ptilesize;
+	theader.mip_count = (uint32_t)tlist_levels.size();
+	theader.scale = tscale;
+	theader.offset = toffset;
+
+	uint64_t tposition = sizeof(FileHeader) + ttilecount * sizeof(TileEntry);
+	for (TileEntry& tentry : tlist_entries)
+	{
+		tentry.offset = tposition;
+		tposition += tentry.bytes;
+	}
+
+	std::ofstream tfile(pfilename, std::ios::binary | std::ios::trunc);
+	if (!tfile)
+		return false;
+
+	tfile.write(reinterpret_cast<const char*>(&theader), sizeof(theader));
+	tfile.write(reinterpret_cast<const char*>(tlist_entries.data()), tlist_entries.size() * sizeof(TileEntry));
+	for (const auto& ttile : tlist_tiles)
+		tfile.write(reinterpret_cast<const char*>(ttile.data()), ttile.size());
+
+	return (bool)tfile;
+}
+
+///////////////////////////
+// Read the Header and Tables
+///////////////////////////
+bool LJMUHeightTileFile::open(const std::string& pfilename)
+{
+	this->close();
+
+	std::lock_guard<std::mutex> tlock(this->_mutex);
+	this->_file.open(pfilename, std::ios::binary);
+	if (!this->_file)
+		return false;
+
+	//Nothing read from the file is trusted until it is checked against the file's length
+	this->_file.seekg(0, std::ios::end);
+	std::streamoff tend = this->_file.tellg();
+	uint64_t tfilebytes = tend > 0 ? (uint64_t)tend : 0;
+	this->_file.seekg(0, std::ios::beg);
+
+	FileHeader theader;
+	if (tfilebytes < sizeof(theader) || !this->_file.read(reinterpret_cast<char*>(&theader), sizeof(theader)) ||
+		std::memcmp(theader.magic, HEIGHTTILE_MAGIC, sizeof(theader.magic)) != 0 ||
+		theader.version != HEIGHTTILE_VERSION || theader.width == 0 || theader.length == 0 ||
+		theader.width > (uint32_t)INT_MAX || theader.length > (uint32_t)INT_MAX ||
+		theader.tile_size < 2 || theader.tile_size > HEIGHTTILE_MAX_TILE || theader.mip_count == 0 || theader.mip_count > 32)
+	{
+		this->_file.close();
+		return false;
+	}
+
+	size_t tentries = 0;
+	for (uint32_t m = 0; m < theader.mip_count; m++)
+	{
+		Level tlevel;
+		tlevel.width = m == 0 ? (int)theader.width : ((this->_list_levels.back().width - 1) >> 1) + 1;
+		tlevel.length = m == 0 ? (int)theader.length : ((this->_list_levels.back().length - 1) >> 1) + 1;
+		tlevel.tiles_i = (tlevel.width + (int)theader.tile_size - 1) / (int)theader.tile_size;
+		tlevel.tiles_j = (tlevel.length + (int)theader.tile_size - 1) / (int)theader.tile_size;
+		tlevel.first_entry = tentries;
+		tentries += (size_t)tlevel.tiles_i * tlevel.tiles_j;
+		this->_list_levels.push_back(tlevel);
+	}
+
+	//The table has to fit the file before it is allocated
+	uint64_t ttablebytes = (uint64_t)tentries * sizeof(TileEntry);
+	bool tvalid = ttablebytes <= tfilebytes - sizeof(theader);
+	if (tvalid)
+	{
+		this->_list_entries.resize(tentries);
+		tvalid = (bool)this->_file.read(reinterpret_cast<char*>(this->_list_entries.data()), ttablebytes);
+	}
+
+	//Every tile lies after the table and inside the file, and is no bigger than its raw codes
+	uint64_t tmaxtilebytes = (uint64_t)theader.tile_size * theader.tile_size * sizeof(uint16_t);
+	for (size_t e = 0; tvalid && e < this->_list_entries.size(); e++)
+	{
+		const TileEntry& tentry = this->_list_entries[e];
+		tvalid = (tentry.method == HEIGHTTILE_RAW || tentry.method == HEIGHTTILE_RICE) &&
+			tentry.bytes <= tmaxtilebytes && tentry.offset >= sizeof(theader) + ttablebytes &&
+			tentry.offset <= tfilebytes && tentry.bytes <= tfilebytes - tentry.offset;
+	}
+
+	if (!tvalid)
+	{
+		this->_list_levels.clear();
+		this->_list_entries.clear();
+		this->_file.close();
+		return false;
+	}
+
+	this->_filename = pfilename;
+	this->_tile_size = (int)theader.tile_size;
+	this->_scale = theader.scale;
+	this->_offset = theader.offset;
+	return true;
+}
+
+///////////////////////////
+// Close the File
+///////////////////////////
+void LJMUHeightTileFile::close()
+{
+	std::lock_guard<std::mutex> tlock(this->_mutex);
+	if (this->_file.is_open())
+		this->_file.close();
+	this->_file.clear();
+
+	this->_filename.clear();
+	this->_list_levels.clear();
+	this->_list_entries.clear();
+	this->_tile_size = 0;
+}
+
+///////////////////////////
+// Stored Size of a Tile
+///////////////////////////
+uint32_t LJMUHeightTileFile::getTileBytes(int pmip, int pti, int ptj) const
+{
+	const TileEntry* tentry = this->getEntry(pmip, pti, ptj);
+	return tentry ? tentry->bytes : 0;
+}
+
+///////////////////////////
+// Fetch and Decode one Tile
+///////////////////////////
+bool LJMUHeightTileFile::readTile(int pmip, int pti, int ptj, uint16_t* pout) const
+{
+	const TileEntry* tentry = this->getEntry(pmip, pti, ptj);
+	if (!tentry || !pout)
+		return false;
+
+	thread_local std::vector<uint8_t> tbytes;
+	if (!this->readBytes(*tentry, tbytes))
+		return false;
+
+	const Level& tlevel = this->_list_levels[pmip];
+	int tw = std::min(this->_tile_size, tlevel.width - pti * this->_tile_size);
+	int tl = std::min(this->_tile_size, tlevel.length - ptj * this->_tile_size);
+	return decodeTile(tbytes.data(), tbytes.size(), tentry->method, tw, tl, pout, this->_tile_size);
+}
+
+///////////////////////////
+// Heights over a Region,
+// Decoding each Tile it
+// Touches once
+///////////////////////////
+bool LJMUHeightTileFile::readRegion(int pmip, int pi0, int pj0, int pwidth, int plength, float* pout) const
+{
+	if (pmip < 0 || pmip >= this->getMipCount() || pwidth <= 0 || plength <= 0 || !pout)
+		return false;
+
+	const Level& tlevel = this->_list_levels[pmip];
+	int tsize = this->_tile_size;
+	int tia = std::min(std::max(pi0, 0), tlevel.width - 1);
+	int tja = std::min(std::max(pj0, 0), tlevel.length - 1);
+	int tib = std::min(std::max(pi0 + pwidth - 1, 0), tlevel.width - 1);
+	int tjb = std::min(std::max(pj0 + plength - 1, 0), tlevel.length - 1);
+
+	thread_local std::vector<uint16_t> ttile;
+	ttile.resize((size_t)tsize * tsize);
+	float tdecode = this->_scale / 65535.0f;
+
+	for (int ti = tia / tsize; ti <= tib / tsize; ti++)
+	{
+		for (int tj = tja / tsize; tj <= tjb / tsize; tj++)
+		{
+			if (!this->readTile(pmip, ti, tj, ttile.data()))
+				return false;
+
+			//Every output sample whose clamped position falls inside this tile
+			int ttilei0 = ti * tsize;
+			int ttilej0 = tj * tsize;
+			int ttilei1 = std::min(ttilei0 + tsize, tlevel.width) - 1;
+			int ttilej1 = std::min(ttilej0 + tsize, tlevel.length) - 1;
+
+			for (int i = 0; i < pwidth; i++)
+			{
+				int tsi = std::min(std::max(pi0 + i, 0), tlevel.width - 1);
+				if (tsi < ttilei0 || tsi > ttilei1)
+					continue;
+
+				const uint16_t* trow = ttile.data() + (size_t)(tsi - ttilei0) * tsize;
+				float* tdst = pout + (size_t)i * plength;
+				for (int j = 0; j < plength; j++)
+				{
+					int tsj = std::min(std::max(pj0 + j, 0), tlevel.length - 1);
+					if (tsj >= ttilej0 && tsj <= ttilej1)
+						tdst[j] = trow[tsj - ttilej0] * tdecode + this->_offset;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+///////////////////////////
+// Decode a Whole Level, a
+// Tile per Task
+///////////////////////////
+bool LJMUHeightTileFile::readLevel(int pmip, LJMUHeightmap& pmap) const
+{
+	if (pmip < 0 || pmip >= this->getMipCount())
+		return false;
+
+	const Level& tlevel = this->_list_levels[pmip];
+	if (!pmap.create(tlevel.width, tlevel.length, LJMUHeightmap::FORMAT_UNORM16, this->_scale, this->_offset))
+		return false;
+
+	int tsize = this->_tile_size;
+	uint16_t* tsamples = static_cast<uint16_t*>(pmap.getData());
+	std::atomic<bool> tfailed(false);
+
+	LJMUThreadPool& tpool = this->_obj_pool ? *this->_obj_pool : LJMUThreadPool::getShared();
+	tpool.parallelFor(tlevel.tiles_i * tlevel.tiles_j, [&](int ptile)
+	{
+		int ti = ptile / tlevel.tiles_j;
+		int tj = ptile % tlevel.tiles_j;
+		uint16_t* tfirst = tsamples + (size_t)ti * tsize * tlevel.length + (size_t)tj * tsize;
+
+		const TileEntry* tentry = this->getEntry(pmip, ti, tj);
+		thread_local std::vector<uint8_t> tbytes;
+		if (!this->readBytes(*tentry, tbytes))
+		{
+			tfailed = true;
+			return;
+		}
+
+		//Decode straight into the map, its rows being the tile's stride
+		int tw = std::min(tsize, tlevel.width - ti * tsize);
+		int tl = std::min(tsize, tlevel.length - tj * tsize);
+		if (!decodeTile(tbytes.data(), tbytes.size(), tentry->method, tw, tl, tfirst, tlevel.length))
+			tfailed = true;
+	});
+
+	if (tfailed)
+	{
+		pmap.release();
+		return false;
+	}
+	return true;
+}
+
+///////////////////////////
+// Table Entry of a Tile
+///////////////////////////
+const LJMUHeightTileFile::TileEntry* LJMUHeightTileFile::getEntry(int pmip, int pti, int ptj) const
+{
+	if (pmip < 0 || pmip >= this->getMipCount())
+		return nullptr;
+
+	const Level& tlevel = this->_list_levels[pmip];
+	if (pti < 0 || ptj < 0 || pti >= tlevel.tiles_i || ptj >= tlevel.tiles_j)
+		return nullptr;
+
+	return &this->_list_entries[tlevel.first_entry + (size_t)pti * tlevel.tiles_j + ptj];
+}
+
+///////////////////////////
+// Stored Bytes of a Tile.
+// Only the file access is
+// serialised, callers decode
+// on their own thread.
+///////////////////////////
+bool LJMUHeightTileFile::readBytes(const TileEntry& pentry, std::vector<uint8_t>& pbytes) const
+{
+	pbytes.resize(pentry.bytes);
+
+	std::lock_guard<std::mutex> tlock(this->_mutex);
+	this->_file.clear();
+	this->_file.seekg((std::streamoff)pentry.offset);
+	return (bool)this->_file.read(reinterpret_cast<char*>(pbytes.data()), pentry.bytes);
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace LJMUDX
+{
+	class LJMUHeightmap;
+	class LJMUThreadPool;
+
+	/////////////////////////
+	// Tiled, compressed heightmap
+	// file (.lht). A header is
+	// followed by one tile table
+	// per mip level, then the
+	// tiles. Heights are stored as
+	// 16-bit codes decoding as
+	// code / 65535 * scale + offset.
+	//
+	// Every tile compresses on its
+	// own, so any one of them can
+	// be read and decoded alone.
+	// Each sample is predicted
+	// from its left, upper and
+	// upper left neighbours in the
+	// tile, and the residuals are
+	// Rice coded with a parameter
+	// picked per row. Mip level m
+	// keeps every 2^m th sample of
+	// the full map, so each level
+	// lines up with a mesh built
+	// at that step.
+	//
+	// Values are written little
+	// endian, as on every target
+	// the demo builds for.
+	/////////////////////////
+	class LJMUHeightTileFile
+	{
+	public:
+		//--------CONSTRUCTORS/DESTRUCTORS----------------------------------------------------
+		LJMUHeightTileFile();
+		~LJMUHeightTileFile();
+
+		LJMUHeightTileFile(const LJMUHeightTileFile&) = delete;
+		LJMUHeightTileFile& operator=(const LJMUHeightTileFile&) = delete;
+
+		//--------PUBLIC METHODS-------------------------------------------------------------
+		// Writes pmap in tiles of ptilesize samples a side. pmipcount of 0 adds levels until
+		// one tile holds the whole level. 16-bit unorm maps keep their codes exactly, other
+		// formats are quantised to 16 bits over their range.
+		static bool		write(const std::string& pfilename, const LJMUHeightmap& pmap, int ptilesize = 64,
+							int pmipcount = 0, LJMUThreadPool* ppool = nullptr);
+
+		// Reads the header and tile tables, the tiles stay on disk until asked for. Fails if
+		// the sizes or any tile's place in the file do not fit the file's length.
+		bool			open(const std::string& pfilename);
+		void			close();
+
+		void			setThreadPool(LJMUThreadPool* ppool) { this->_obj_pool = ppool; }
+
+		bool			isOpen() const { return !this->_list_levels.empty(); }
+		const std::string&	getFileName() const { return this->_filename; }
+		int				getMipCount() const { return (int)this->_list_levels.size(); }
+		int				getTileSize() const { return this->_tile_size; }
+		int				getWidth(int pmip = 0) const { return this->_list_levels[pmip].width; }
+		int				getLength(int pmip = 0) const { return this->_list_levels[pmip].length; }
+		int				getTilesI(int pmip) const { return this->_list_levels[pmip].tiles_i; }
+		int				getTilesJ(int pmip) const { return this->_list_levels[pmip].tiles_j; }
+		float			getScale() const { return this->_scale; }
+		float			getOffset() const { return this->_offset; }
+
+		// Bytes on disk of one tile, for comparing against its raw size
+		uint32_t		getTileBytes(int pmip, int pti, int ptj) const;
+
+		// Decodes one tile's codes into pout, laid out [i * tile size + j]. Tiles on the far
+		// edges can be narrower, and leave the rest of pout untouched. Thread safe.
+		bool			readTile(int pmip, int pti, int ptj, uint16_t* pout) const;
+
+		// Heights of samples [pi0, pi0 + pwidth) x [pj0, pj0 + plength) of level pmip into
+		// pout[i * plength + j], clamped to the level's edges. Thread safe.
+		bool			readRegion(int pmip, int pi0, int pj0, int pwidth, int plength, float* pout) const;
+
+		// Level pmip as a 16-bit unorm map with the file's scale and offset
+		bool			readLevel(int pmip, LJMUHeightmap& pmap) const;
+
+	private:
+		//-------------HELPER TYPES----------------------------------------------------
+		struct TileEntry
+		{
+			uint64_t	offset;
+			uint32_t	bytes;
+			uint32_t	method;
+		};
+
+		struct Level
+		{
+			int			width;
+			int			length;
+			int			tiles_i;
+			int			tiles_j;
+			size_t		first_entry;	//Into _list_entries, tiles laid out [ti * tiles_j + tj]
+		};
+
+		//-------------HELPER METHODS--------------------------------------------------
+		const TileEntry*	getEntry(int pmip, int pti, int ptj) const;
+		bool			readBytes(const TileEntry& pentry, std::vector<uint8_t>& pbytes) const;
+
+		//--------CLASS MEMBERS--------------------------------------------------------------
+		std::string				_filename;
+		int						_tile_size;
+		float					_scale;
+		float					_offset;
+		std::vector<Level>		_list_levels;
+		std::vector<TileEntry>	_list_entries;
+		LJMUThreadPool*			_obj_pool;
+		mutable std::ifstream	_file;
+		mutable std::mutex		_mutex;			//Guards _file, the seek and read of a tile
+	};
+}
@@ -0,0 +1,323 @@
+#include "LJMUHeightmap.h"
+
+#include <algorithm>
+#include <new>
+#include <utility>
+
+// SSE2 is always present on x64 and is the MSVC default for x86 (/arch:SSE2)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LJMU_HEIGHTMAP_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace LJMUDX;
+
+namespace
+{
+	inline float decodeSample(uint32_t pcode, float pscale, float poffset)
+	{
+		return (float)pcode * pscale + poffset;
+	}
+
+	// Rounds to the nearest code in [0, pmax]
+	inline uint32_t encodeSample(float pheight, float pinvscale, float poffset, float pmax)
+	{
+		float tcode = (pheight - poffset) * pinvscale;
+		tcode = std::min(std::max(tcode, 0.0f), pmax);
+		return (uint32_t)(tcode + 0.5f);
+	}
+
+#ifdef LJMU_HEIGHTMAP_SSE2
+	inline __m128i encodeSSE2(__m128 pheight, __m128 pinvscale, __m128 poffset, __m128 pmax)
+	{
+		__m128 tcode = _mm_mul_ps(_mm_sub_ps(pheight, poffset), pinvscale);
+		tcode = _mm_min_ps(_mm_max_ps(tcode, _mm_setzero_ps()), pmax);
+		return _mm_cvttps_epi32(_mm_add_ps(tcode, _mm_set1_ps(0.5f)));
+	}
+#endif
+}
+
+///////////////////////////
+// Constructors
+///////////////////////////
+LJMUHeightmap::LJMUHeightmap() :
+	_width(0),
+	_length(0),
+	_format(FORMAT_FLOAT32),
+	_scale(1.0f),
+	_offset(0.0f)
+{
+
+}
+
+LJMUHeightmap::LJMUHeightmap(int pwidth, int plength, Format pformat, float pscale, float poffset) :
+	LJMUHeightmap()
+{
+	this->create(pwidth, plength, pformat, pscale, poffset);
+}
+
+LJMUHeightmap::LJMUHeightmap(LJMUHeightmap&& pother) :
+	LJMUHeightmap()
+{
+	*this = std::move(pother);
+}
+
+LJMUHeightmap& LJMUHeightmap::operator=(LJMUHeightmap&& pother)
+{
+	if (this != &pother)
+	{
+		this->_width = pother._width;
+		this->_length = pother._length;
+		this->_format = pother._format;
+		this->_scale = pother._scale;
+		this->_offset = pother._offset;
+		this->_list_samples = std::move(pother._list_samples);
+		pother.release();
+	}
+	return *this;
+}
+
+///////////////////////////
+// Allocate the Samples
+///////////////////////////
+bool LJMUHeightmap::create(int pwidth, int plength, Format pformat, float pscale, float poffset)
+{
+	this->release();
+	if (pwidth <= 0 || plength <= 0)
+		return false;
+
+	try
+	{
+		this->_list_samples.assign((size_t)pwidth * plength * getSampleBytes(pformat), 0);
+	}
+	catch (const std::bad_alloc&)
+	{
+		return false;
+	}
+
+	this->_width = pwidth;
+	this->_length = plength;
+	this->_format = pformat;
+	this->_scale = pscale;
+	this->_offset = poffset;
+	return true;
+}
+
+///////////////////////////
+// Free the Samples
+///////////////////////////
+void LJMUHeightmap::release()
+{
+	std::vector<uint8_t>().swap(this->_list_samples);
+	this->_width = 0;
+	this->_length = 0;
+	this->_scale = 1.0f;
+	this->_offset = 0.0f;
+}
+
+///////////////////////////
+// Bytes per Sample
+///////////////////////////
+int LJMUHeightmap::getSampleBytes(Format pformat)
+{
+	switch (pformat)
+	{
+	case FORMAT_UNORM16:
+		return 2;
+	case FORMAT_UNORM8:
+		return 1;
+	default:
+		return 4;
+	}
+}
+
+///////////////////////////
+// Largest Stored Code,
+// 1 for float samples
+///////////////////////////
+float LJMUHeightmap::getCodeMax() const
+{
+	switch (this->_format)
+	{
+	case FORMAT_UNORM16:
+		return 65535.0f;
+	case FORMAT_UNORM8:
+		return 255.0f;
+	default:
+		return 1.0f;
+	}
+}
+
+///////////////////////////
+// Set the Decode Mapping
+///////////////////////////
+void LJMUHeightmap::setScaleOffset(float pscale, float poffset)
+{
+	this->_scale = pscale;
+	this->_offset = poffset;
+}
+
+///////////////////////////
+// Single Sample Access
+///////////////////////////
+float LJMUHeightmap::getHeight(int pi, int pj) const
+{
+	size_t tindex = this->getIndex(pi, pj);
+
+	switch (this->_format)
+	{
+	case FORMAT_UNORM16:
+		return decodeSample(reinterpret_cast<const uint16_t*>(this->_list_samples.data())[tindex],
+			this->_scale / 65535.0f, this->_offset);
+	case FORMAT_UNORM8:
+		return decodeSample(this->_list_samples[tindex], this->_scale / 255.0f, this->_offset);
+	default:
+		return reinterpret_cast<const float*>(this->_list_samples.data())[tindex] * this->_scale + this->_offset;
+	}
+}
+
+void LJMUHeightmap::setHeight(int pi, int pj, float pheight)
+{
+	this->writeRow(pi, pj, 1, &pheight);
+}
+
+///////////////////////////
+// Decode a Run of Samples
+///////////////////////////
+void LJMUHeightmap::readRow(int pi, int pj, int pcount, float* pout) const
+{
+	size_t tindex = this->getIndex(pi, pj);
+	float tscale = this->_scale / this->getCodeMax();
+	float toffset = this->_offset;
+	int j = 0;
+
+#ifdef LJMU_HEIGHTMAP_SSE2
+	__m128 vscale = _mm_set1_ps(tscale);
+	__m128 voffset = _mm_set1_ps(toffset);
+	__m128i vzero = _mm_setzero_si128();
+#endif
+
+	switch (this->_format)
+	{
+	case FORMAT_UNORM16:
+	{
+		const uint16_t* tsrc = reinterpret_cast<const uint16_t*>(this->_list_samples.data()) + tindex;
+#ifdef LJMU_HEIGHTMAP_SSE2
+		for (; j + 8 <= pcount; j += 8)
+		{
+			__m128i tcodes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tsrc + j));
+			__m128 tlo = _mm_cvtepi32_ps(_mm_unpacklo_epi16(tcodes, vzero));
+			__m128 thi = _mm_cvtepi32_ps(_mm_unpackhi_epi16(tcodes, vzero));
+			_mm_storeu_ps(pout + j, _mm_add_ps(_mm_mul_ps(tlo, vscale), voffset));
+			_mm_storeu_ps(pout + j + 4, _mm_add_ps(_mm_mul_ps(thi, vscale), voffset));
+		}
+#endif
+		for (; j < pcount; j++)
+			pout[j] = decodeSample(tsrc[j], tscale, toffset);
+		break;
+	}
+	case FORMAT_UNORM8:
+	{
+		const uint8_t* tsrc = this->_list_samples.data() + tindex;
+#ifdef LJMU_HEIGHTMAP_SSE2
+		for (; j + 16 <= pcount; j += 16)
+		{
+			__m128i tcodes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tsrc + j));
+			__m128i tlo = _mm_unpacklo_epi8(tcodes, vzero);
+			__m128i thi = _mm_unpackhi_epi8(tcodes, vzero);
+			__m128i twords[4] = { _mm_unpacklo_epi16(tlo, vzero), _mm_unpackhi_epi16(tlo, vzero),
+				_mm_unpacklo_epi16(thi, vzero), _mm_unpackhi_epi16(thi, vzero) };
+
+			for (int k = 0; k < 4; k++)
+				_mm_storeu_ps(pout + j + k * 4, _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(twords[k]), vscale), voffset));
+		}
+#endif
+		for (; j < pcount; j++)
+			pout[j] = decodeSample(tsrc[j], tscale, toffset);
+		break;
+	}
+	default:
+	{
+		const float* tsrc = reinterpret_cast<const float*>(this->_list_samples.data()) + tindex;
+#ifdef LJMU_HEIGHTMAP_SSE2
+		for (; j + 4 <= pcount; j += 4)
+			_mm_storeu_ps(pout + j, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(tsrc + j), vscale), voffset));
+#endif
+		for (; j < pcount; j++)
+			pout[j] = tsrc[j] * tscale + toffset;
+		break;
+	}
+	}
+}
+
+///////////////////////////
+// Encode a Run of Samples
+///////////////////////////
+void LJMUHeightmap::writeRow(int pi, int pj, int pcount, const float* pin)
+{
+	size_t tindex = this->getIndex(pi, pj);
+	float tmax = this->getCodeMax();
+	float tinvscale = this->_scale != 0.0f ? tmax / this->_scale : 0.0f;
+	float toffset = this->_offset;
+	int j = 0;
+
+#ifdef LJMU_HEIGHTMAP_SSE2
+	__m128 vinvscale = _mm_set1_ps(tinvscale);
+	__m128 voffset = _mm_set1_ps(toffset);
+	__m128 vmax = _mm_set1_ps(tmax);
+#endif
+
+	switch (this->_format)
+	{
+	case FORMAT_UNORM16:
+	{
+		uint16_t* tdst = reinterpret_cast<uint16_t*>(this->_list_samples.data()) + tindex;
+#ifdef LJMU_HEIGHTMAP_SSE2
+		//SSE2 only has a signed 32 to 16 bit pack, so bias the codes into its range and back
+		__m128i vbias32 = _mm_set1_epi32(32768);
+		__m128i vbias16 = _mm_set1_epi16((short)0x8000);
+		for (; j + 8 <= pcount; j += 8)
+		{
+			__m128i tlo = _mm_sub_epi32(encodeSSE2(_mm_loadu_ps(pin + j), vinvscale, voffset, vmax), vbias32);
+			__m128i thi = _mm_sub_epi32(encodeSSE2(_mm_loadu_ps(pin + j + 4), vinvscale, voffset, vmax), vbias32);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(tdst + j), _mm_xor_si128(_mm_packs_epi32(tlo, thi), vbias16));
+		}
+#endif
+		for (; j < pcount; j++)
+			tdst[j] = (uint16_t)encodeSample(pin[j], tinvscale, toffset, tmax);
+		break;
+	}
+	case FORMAT_UNORM8:
+	{
+		uint8_t* tdst = this->_list_samples.data() + tindex;
+#ifdef LJMU_HEIGHTMAP_SSE2
+		for (; j + 16 <= pcount; j += 16)
+		{
+			__m128i t0 = encodeSSE2(_mm_loadu_ps(pin + j), vinvscale, voffset, vmax);
+			__m128i t1 = encodeSSE2(_mm_loadu_ps(pin + j + 4), vinvscale, voffset, vmax);
+			__m128i t2 = encodeSSE2(_mm_loadu_ps(pin + j + 8), vinvscale, voffset, vmax);
+			__m128i t3 = encodeSSE2(_mm_loadu_ps(pin + j + 12), vinvscale, voffset, vmax);
+			__m128i tbytes = _mm_packus_epi16(_mm_packs_epi32(t0, t1), _mm_packs_epi32(t2, t3));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(tdst + j), tbytes);
+		}
+#endif
+		for (; j < pcount; j++)
+			tdst[j] = (uint8_t)encodeSample(pin[j], tinvscale, toffset, tmax);
+		break;
+	}
+	default:
+	{
+		//Float samples keep whatever range they are given
+		float* tdst = reinterpret_cast<float*>(this->_list_samples.data()) + tindex;
+		float tinv = this->_scale != 0.0f ? 1.0f / this->_scale : 0.0f;
+#ifdef LJMU_HEIGHTMAP_SSE2
+		__m128 vinv = _mm_set1_ps(tinv);
+		for (; j + 4 <= pcount; j += 4)
+			_mm_storeu_ps(tdst + j, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(pin + j), voffset), vinv));
+#endif
+		for (; j < pcount; j++)
+			tdst[j] = (pin[j] - toffset) * tinv;
+		break;
+	}
+	}
+}
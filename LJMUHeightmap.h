@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace LJMUDX
+{
+	/////////////////////////
+	// Heightmap that owns its
+	// samples, laid out
+	// [i * length + j]. Samples
+	// are stored as float32,
+	// 16-bit unorm or 8-bit unorm
+	// and decode as
+	// stored * scale + offset,
+	// where a unorm sample is
+	// read as code / max code.
+	//
+	// Changing the scale and
+	// offset remaps every height
+	// without touching the
+	// samples, so normalising a
+	// map costs one scan.
+	/////////////////////////
+	class LJMUHeightmap
+	{
+	public:
+		enum Format { FORMAT_FLOAT32, FORMAT_UNORM16, FORMAT_UNORM8 };
+
+		//--------CONSTRUCTORS/DESTRUCTORS----------------------------------------------------
+		LJMUHeightmap();
+		LJMUHeightmap(int pwidth, int plength, Format pformat = FORMAT_FLOAT32, float pscale = 1.0f, float poffset = 0.0f);
+
+		LJMUHeightmap(LJMUHeightmap&& pother);
+		LJMUHeightmap& operator=(LJMUHeightmap&& pother);
+
+		LJMUHeightmap(const LJMUHeightmap&) = delete;
+		LJMUHeightmap& operator=(const LJMUHeightmap&) = delete;
+
+		//--------PUBLIC METHODS-------------------------------------------------------------
+		// Allocates a zeroed map, returns false if the size is invalid or allocation fails
+		bool			create(int pwidth, int plength, Format pformat = FORMAT_FLOAT32, float pscale = 1.0f, float poffset = 0.0f);
+		void			release();
+
+		bool			isEmpty() const { return this->_list_samples.empty(); }
+		int				getWidth() const { return this->_width; }
+		int				getLength() const { return this->_length; }
+		Format			getFormat() const { return this->_format; }
+		float			getScale() const { return this->_scale; }
+		float			getOffset() const { return this->_offset; }
+		size_t			getSampleCount() const { return (size_t)this->_width * this->_length; }
+		size_t			getBytes() const { return this->_list_samples.size(); }
+		static int		getSampleBytes(Format pformat);
+
+		// Changes how stored samples decode, the samples themselves are unchanged
+		void			setScaleOffset(float pscale, float poffset);
+
+		float			getHeight(int pi, int pj) const;
+		// Values outside the range of a unorm map are clamped
+		void			setHeight(int pi, int pj, float pheight);
+
+		// Bulk conversion of pcount samples of row pi starting at column pj
+		void			readRow(int pi, int pj, int pcount, float* pout) const;
+		void			writeRow(int pi, int pj, int pcount, const float* pin);
+
+		// Stored samples in the map's format, for loaders and GPU uploads
+		void*			getData() { return this->_list_samples.data(); }
+		const void*		getData() const { return this->_list_samples.data(); }
+
+	private:
+		//-------------HELPER METHODS--------------------------------------------------
+		size_t			getIndex(int pi, int pj) const { return (size_t)pi * this->_length + pj; }
+		float			getCodeMax() const;
+
+		//--------CLASS MEMBERS--------------------------------------------------------------
+		int						_width;
+		int						_length;
+		Format					_format;
+		float					_scale;
+		float					_offset;
+		std::vector<uint8_t>	_list_samples;
+	};
+}
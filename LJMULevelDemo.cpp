@@ -2,6 +2,7 @@
 #include "LJMULevelDemo.h"
 
 //------------DX TK AND STD/STL Includes-------------------------------------
+#include <algorithm>
 #include <sstream>
 
 //------------Include Hieroglyph Engine Files--------------------------------
@@ -39,6 +40,11 @@ using namespace LJMUDX;
 
 #include "LJMUMeshOBJ.h"
 #include "FastNoise.h"
+#include "LJMUHeightMapGenerator.h"
+#include "LJMUHeightErosion.h"
+#include "LJMUHeightTileFile.h"
+#include "LJMUMappedHeightmap.h"
+#include "LJMUTerrainMeshBuilder.h"
 
 LJMULevelDemo AppInstance;
 
@@ -55,7 +61,10 @@ LJMULevelDemo::LJMULevelDemo() :
 	m_pWindow(nullptr),
 	m_iSwapChain(0),
 	m_DepthTarget(nullptr),
-	m_RenderTarget(nullptr)
+	m_RenderTarget(nullptr),
+	m_BrushKey(0),
+	m_BrushPressed(false),
+	m_BrushFlattenHeight(0.0f)
 {
 
 }
@@ -205,135 +214,74 @@ CustomMeshPtr	LJMULevelDemo::CreatePlaneCustomMesh(const Vector3f& center,
 	const Vector2f& gridPos,
 	const Vector2f& texScale)
 {
-	std::vector<Vector3f> vertices;
-	std::vector<Vector4f> vertexColors;
-	std::vector<Vector2f> texCoord;
-
-	std::vector<Vector2f> texWeights;
-
-	Vector3f x_unit = xdir;
-	Vector3f z_unit = zdir;
-
-	x_unit.Normalize();
-	z_unit.Normalize();
-
 	int xVertices = (int)numVertices.x;
 	int zVertices = (int)numVertices.y;
 
-	float xSpacing = spacing.x;
-	float zSpacing = spacing.y;
-
-	Vector3f x = x_unit * ((float)xVertices - 1) / 2 * xSpacing;
-	Vector3f z = z_unit * ((float)xVertices - 1) / 2 * zSpacing;
-
-	// Get the location of the top-left vertex
-	Vector3f startPos = center - x - z;
-
-	// Calculate the unit up vector (y_unit).
-	// Direct3D uses left-hand rule to determine the direction (since z axis direction is reversed)
-	// Hence z cross x gives the y up vector
-	Vector3f y_unit = z_unit.Cross(x_unit);
-	y_unit.Normalize();
-
-	float heightScale = 10.0f;
-
-	float majorheightfrequency = 0.02f;
-	float majorheight = 1.0f;
-
-	float minorheightfrequency = 0.2;
-	float minorheight = 0.25f;
-
-	for (int i = 0; i < xVertices; i++)
+	// Heights before scaling, for the texture weight pass
+	LJMUHeightmap heights(xVertices, zVertices);
+
+	LJMUWavePlaneSurface surface(center, xdir, zdir, xVertices, zVertices, spacing, gridPos, texScale);
+	surface.setHeights(&heights);
+
+	// The tangent frame follows the grid, u along x and v along z
+	CustomVertexDX11::Vertex prototype;
+	prototype.normal = surface.getUp();
+	prototype.texweights = Vector2f(0.0f, 0.0f);
+	prototype.tangent = xdir;
+	prototype.tangent.Normalize();
+	prototype.binormal = zdir;
+	prototype.binormal.Normalize();
+
+	// Rows along x, so vertex (i, j) is at i * zVertices + j
+	std::vector<CustomVertexDX11::Vertex> vertices;
+	std::vector<uint32_t> indices;
+	LJMUParametricSurface::generate(surface, zVertices, xVertices, prototype, vertices, indices);
+
+	// Texture weights come from a separate pass over the heights, blending the high layer
+	// in across the middle height as the old sigmoid of abruptness 5 did
+	const float heightScale = LJMUWavePlaneSurface::HEIGHT_SCALE;
+	const float blendWidth = 0.4f * heightScale * heightScale;
+
+	LJMUTerrainSplat splat;
+	splat.setSpacing(spacing);
+	splat.setHeightScale(heightScale * heightScale);
+
+	LJMUSplatLayer highLayer;
+	highLayer.height.lo = 0.0f;
+	highLayer.height.fade = blendWidth;
+	splat.addLayer(highLayer);
+
+	LJMUSplatLayer lowLayer;
+	lowLayer.height.hi = 0.0f;
+	lowLayer.height.fade = blendWidth;
+	splat.addLayer(lowLayer);
+
+	std::vector<float> weights;
+	splat.generateWeights(heights, weights);
+	for (size_t k = 0; k < vertices.size() && k * 2 + 1 < weights.size(); k++)
 	{
-		for (int j = 0; j < zVertices; j++)
-		{
-			//float height = cos((float)i * 0.1f)* sin((float)j * 0.1f)* heightScale;
-
-			//Vector3f pos = startPos + x_unit * xSpacing * i + z_unit * zSpacing * j;
-
-			float shifted_i = (float)i + gridPos.x * (xVertices - 1);
-			float shifted_j = (float)j + gridPos.y * (zVertices - 1);
-
-			//Vector3f pos = startPos + x_unit * xSpacing * shifted_i + z_unit * zSpacing * shifted_j;
-
-			float majorperiodicheight_x = sin(shifted_i * majorheightfrequency * GLYPH_PI) * majorheight;
-			float majorperiodicheight_z = cos(shifted_j * majorheightfrequency * GLYPH_PI) * majorheight;
-			float majorperiodicheight = majorperiodicheight_x * majorperiodicheight_z;
-
-			float minorperiodicheight_x = sin(shifted_i * minorheightfrequency * GLYPH_PI) * minorheight;
-			float minorperiodicheight_z = cos(shifted_j * minorheightfrequency * GLYPH_PI) * minorheight;
-			float minorperiodicheight = minorperiodicheight_x * minorperiodicheight_z;
-
-			float height = (majorperiodicheight + minorperiodicheight) * heightScale;
-
-			Vector3f pos = startPos +
-				x_unit * xSpacing * shifted_i +
-				z_unit * zSpacing * shifted_j +
-				y_unit * height * heightScale;
-
-
-
-			vertices.push_back(pos);
-
-			//vertexColors.push_back(colour);
-
-			float shade = (height / heightScale + 1) / 2.0f;
-
-			if (shade < 0)
-				shade = 0;
-			else if (shade > 1)
-				shade = 1;
-
-			vertexColors.push_back(Vector4f(shade, 1 - shade, shade / 2, 1));
-
-			Vector2f normalisedTexScale = Vector2f(texScale.x / numVertices.x,
-				texScale.y / numVertices.y);
-
-			float u = shifted_i;
-			float v = shifted_j;
-			texCoord.push_back(Vector2f(u, v) * normalisedTexScale);
-
-			float nheight = majorperiodicheight + minorperiodicheight;
-			float abruptness = 5.0f;
-			float sigmoid = 1 / (1 + exp(-nheight * abruptness));
-
-			texWeights.push_back(Vector2f(nheight, 0.0f));
-		}
+		vertices[k].texweights = Vector2f(weights[k * 2], weights[k * 2 + 1]);
 	}
 
-	int numberofVertices = vertices.size();
-
-	std::vector<int> indices;
-
-	GeneratePlaneIndexArray(xVertices, zVertices, true, indices);
-
-	int numberofIndices = indices.size();
-	int numberofTriangles = numberofIndices / 3;
-
-	//auto terrainMesh = std::make_shared<DrawExecutorDX11<CustomVertexDX11::Vertex>>();
-	//terrainMesh->SetLayoutElements(CustomVertexDX11::GetElementCount(),
-	//	CustomVertexDX11::Elements);
-
-	auto terrainMesh = std::make_shared<DrawExecutorDX11<CustomVertexDX11::Vertex>>();
+	// Vertices are shared between the quads that use them, rather than repeated for every triangle
+	auto terrainMesh = std::make_shared<DrawIndexedExecutorDX11<CustomVertexDX11::Vertex>>();
 	terrainMesh->SetLayoutElements(CustomVertexDX11::GetElementCount(),
 		CustomVertexDX11::Elements);
 
 	terrainMesh->SetPrimitiveType(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-	terrainMesh->SetMaxVertexCount(numberofIndices);
+	terrainMesh->SetMaxVertexCount((unsigned int)vertices.size());
+	terrainMesh->SetMaxIndexCount((unsigned int)indices.size());
 
-	CustomVertexDX11::Vertex tv;
-
-	for (int i = 0; i < numberofIndices; i++)
+	for (const CustomVertexDX11::Vertex& tv : vertices)
 	{
-		tv.position = vertices[indices[i]];
-		tv.color = vertexColors[indices[i]];
-		tv.texcoords = texCoord[indices[i]];
-
-		tv.texweights = texWeights[indices[i]];
-
 		terrainMesh->AddVertex(tv);
 	}
 
+	for (size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		terrainMesh->AddIndices(indices[i], indices[i + 1], indices[i + 2]);
+	}
+
 	return terrainMesh;
 }
 
@@ -341,71 +289,18 @@ MeshPtr LJMULevelDemo::CreateCylinderMesh(int h_res,
 	int v_res,
 	Vector4f colour)
 {
-	std::vector<Vector3f> vertices;
-	std::vector<Vector4f> vertexColors;
-	std::vector<Vector2f> texCoord;
-
-	// Cartesian coordinates (x,y,z) variables
-	float x;
-	float y;
-	float z;
-
-	// Nested loops that calculate the vertex position and projector function
-
-	// v_res is the number of vertical segments
-	for (int j = 0; j <= v_res; ++j)
-	{
-		// height goes from -0.5 to +0.5
-		float height = float(j) / float(v_res) - 0.5f;
-
-		// h_res is the number of angle increments
-		for (int i = 0; i <= h_res; ++i)
-		{
-			// azimuthAngle goes from 0 to 2 Pi
-			float azimuthAngle = 2.0 * GLYPH_PI * float(i) / float(h_res);
-			float sa = std::sin(azimuthAngle);
-			float ca = std::cos(azimuthAngle);
-
-			x = ca;
-			y = height;
-			z = sa;
-
-			// u is the horizontal texture coordinate (range from 0 to 1)
-			float u = float(i) / float(h_res);
-			// v is the vertical texture coordinate (range from 0 to 1)
-			float v = float(j) / float(v_res);
-
-			vertices.push_back(Vector3f(x, y, z));
-			vertexColors.push_back(colour);
-			texCoord.push_back(Vector2f(u, v));
-		}
-	}
-
-	// Setup index array
-	std::vector<int> indices;
-
-	GeneratePlaneIndexArray(h_res + 1, v_res + 1, true, indices);
-
-	int numberofIndices = indices.size();
-	int numberofTriangles = numberofIndices / 3;
+	// Cylinders of the same resolution and colour share one indexed mesh
+	std::vector<float> params = { float(h_res), float(v_res), colour.x, colour.y, colour.z, colour.w };
 
-	auto mesh = std::make_shared<DrawExecutorDX11<BasicVertexDX11::Vertex>>();
-	mesh->SetLayoutElements(BasicVertexDX11::GetElementCount(), BasicVertexDX11::Elements);
-	mesh->SetPrimitiveType(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-	mesh->SetMaxVertexCount(numberofIndices);
-
-	BasicVertexDX11::Vertex tv;
-
-	for (int i = 0; i < numberofIndices; i++)
+	return m_MeshCache.get<BasicVertexDX11>("cylinder", params,
+		[&](std::vector<BasicVertexDX11::Vertex>& vertices, std::vector<uint32_t>& indices)
 	{
-		tv.position = vertices[indices[i]];
-		tv.color = vertexColors[indices[i]];
-		tv.texcoords = texCoord[indices[i]];
-
-		mesh->AddVertex(tv);
-	}
+		BasicVertexDX11::Vertex prototype;
+		prototype.color = colour;
 
-	return mesh;
+		// h_res angle increments round, v_res segments up, u and v from 0 to 1
+		LJMUParametricSurface::generate(LJMUCylinderSurface(), h_res + 1, v_res + 1, prototype, vertices, indices);
+	});
 }
 
 
@@ -423,13 +318,13 @@ std::wstring LJMULevelDemo::GetName()
 /////////////////////////////////////
 void LJMULevelDemo::inputAssemblyStage()
 {
+	SetupHeightMap();				// The terrain is built from the heightmap, so it comes first
 	setupPlane();
 	SetupSkySphere();
 	SetupSphere();
 	SetupMars();
 	SetupSun();
 	SetupMoon();
-	SetupHeightMap();
 
 	//SetupCylinder();
 }
@@ -466,10 +361,8 @@ void LJMULevelDemo::SetupSphere()
 	mRotation.RotationX(-GLYPH_PI);
 	Vector3f vTranslation = Vector3f(0.0f, 1500.0f, 5000.0f);
 
-	unsigned int h_res = 50;
-	unsigned int v_res = 50;
-
-	auto sphereMesh = CreateCustomStandardSphere(h_res, v_res, Vector4f(1, 0, 0, 1));
+	// Start at the coarsest level, updateSphereLOD refines it from the body's size on screen
+	auto sphereMesh = GetCustomLODSphere(m_SphereLOD.getLevelCount() - 1);
 
 	m_sphereMaterial = CreateGSAnimMaterial();
 	m_sphereMaterial = createLitTexturedMaterial();
@@ -493,8 +386,9 @@ void LJMULevelDemo::SetupSphere()
 	m_pSphereActor->GetNode()->Position() = vTranslation;
 
 	m_pScene->AddActor(m_pSphereActor);
+	addSphereLODBody(m_pSphereActor, true);
 
-	auto cloudMesh = CreateStandardSphere(h_res, v_res, Vector4f(1, 0, 0, 1));
+	auto cloudMesh = GetLODSphere(m_SphereLOD.getLevelCount() - 1);
 	m_cloudMaterial = createTransparentLitTexturedMaterial();
 	SetTextureToBasicMaterial(m_cloudMaterial, m_cloudTexture);
 
@@ -514,86 +408,7 @@ void LJMULevelDemo::SetupSphere()
 	m_pCloudActor->GetNode()->Position() = vTranslation;
 
 	m_pScene->AddActor(m_pCloudActor);
-}
-
-CustomMeshPtr LJMULevelDemo::CreateCustomStandardSphere(int h_res,
-	int v_res,
-	Vector4f colour)
-{
-	std::vector<Vector3f> vertices;
-	std::vector<Vector4f> vertexColors;
-	std::vector<Vector2f> texCoord;
-
-	std::vector<Vector3f> normals;
-
-	std::vector<Vector3f> tangent;
-	std::vector<Vector3f> binormal;
-
-	// Cartesian coordinates (x,y,z) variables
-	float x;
-	float y;
-	float z;
-
-	for (int j = 0; j <= v_res; ++j)
-	{
-		float elevationAngle = GLYPH_PI * float(j) / float(v_res);
-		float sp = (float)std::sin(elevationAngle);
-		float cp = (float)std::cos(elevationAngle);
-		for (int i = 0; i <= h_res; ++i)
-		{
-			float azimuthAngle = 2.0 * GLYPH_PI * float(i) / float(h_res);
-			float sa = std::sin(azimuthAngle);
-			float ca = std::cos(azimuthAngle);
-
-			x = sp * ca;
-			y = cp;
-			z = sp * sa;
-
-			float u = float(i) / float(h_res);
-			float v = float(j) / float(v_res);
-
-			vertices.push_back(Vector3f(x, y, z));
-			vertexColors.push_back(colour);
-			texCoord.push_back(Vector2f(u, v));
-
-			normals.push_back(Vector3f(x, y, z));
-
-			tangent.push_back(Vector3f(0, 1, 0));
-			binormal.push_back(Vector3f(0, 0, 1));
-
-		}
-	}
-
-	// Setup index array
-	std::vector<int> indices;
-
-	GeneratePlaneIndexArray(h_res + 1, v_res + 1, true, indices);
-
-	int numberofIndices = indices.size();
-	int numberofTriangles = numberofIndices / 3;
-
-	auto mesh = std::make_shared<DrawExecutorDX11<CustomVertexDX11::Vertex>>();
-	mesh->SetLayoutElements(CustomVertexDX11::GetElementCount(), CustomVertexDX11::Elements);
-	mesh->SetPrimitiveType(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-	mesh->SetMaxVertexCount(numberofIndices);
-
-	CustomVertexDX11::Vertex tv;
-
-	for (int i = 0; i < numberofIndices; i++)
-	{
-		tv.position = vertices[indices[i]];
-		tv.color = vertexColors[indices[i]];
-		tv.texcoords = texCoord[indices[i]];
-
-		tv.normal = normals[indices[i]];
-
-		tv.tangent = tangent[indices[i]];
-		tv.binormal = binormal[indices[i]];
-
-		mesh->AddVertex(tv);
-	}
-
-	return mesh;
+	addSphereLODBody(m_pCloudActor, false);
 }
 
 void LJMUDX::LJMULevelDemo::SetupMars()
@@ -603,10 +418,8 @@ void LJMUDX::LJMULevelDemo::SetupMars()
 	mRotation.MakeIdentity();
 	Vector3f vTranslation = Vector3f(0.0f, 1500.0f, -5000.0f);
 
-	unsigned int h_res = 50;
-	unsigned int v_res = 50;
-
-	auto sphereMesh = CreateCustomStandardSphere(h_res, v_res, Vector4f(1, 0, 0, 1));
+	// Start at the coarsest level, updateSphereLOD refines it from the body's size on screen
+	auto sphereMesh = GetCustomLODSphere(m_SphereLOD.getLevelCount() - 1);
 
 	m_marsMaterial = createLitTexturedMaterial();
 	SetTextureToBasicMaterial(m_marsMaterial, m_marsTexture);
@@ -629,6 +442,7 @@ void LJMUDX::LJMULevelDemo::SetupMars()
 	m_pMarsActor->GetNode()->Position() = vTranslation;
 
 	m_pScene->AddActor(m_pMarsActor);
+	addSphereLODBody(m_pMarsActor, true);
 }
 
 void LJMUDX::LJMULevelDemo::updateMars()
@@ -688,10 +502,8 @@ void LJMUDX::LJMULevelDemo::SetupMoon()
 	mRotation.MakeIdentity();
 	Vector3f vTranslation = Vector3f(-5000.0f, 1500.0f, 5000.0f);
 
-	unsigned int h_res = 50;
-	unsigned int v_res = 50;
-
-	auto sphereMesh = CreateCustomStandardSphere(h_res, v_res, Vector4f(1, 0, 0, 1));
+	// Start at the coarsest level, updateSphereLOD refines it from the body's size on screen
+	auto sphereMesh = GetCustomLODSphere(m_SphereLOD.getLevelCount() - 1);
 
 	m_moonMaterial = createLitTexturedMaterial();
 	SetTextureToBasicMaterial(m_moonMaterial, m_moonTexture);
@@ -714,6 +526,7 @@ void LJMUDX::LJMULevelDemo::SetupMoon()
 	m_pMoonActor->GetNode()->Position() = vTranslation;
 
 	m_pScene->AddActor(m_pMoonActor);
+	addSphereLODBody(m_pMoonActor, true);
 }
 
 void LJMUDX::LJMULevelDemo::updateMoon()
@@ -791,11 +604,16 @@ void LJMULevelDemo::Update()
 
 	//---------- Object Updates -------------------------------------------------------
 
+	updateTerrainEditing();
+	clampCameraToTerrain();
+	updateTerrainLOD();
+	updateTerrainStreaming();
 	updateSphere();
 	UpdateSkySphere(m_totalTime);
 	updateMars();
 	updateSun();
 	updateMoon();
+	updateSphereLOD();
 	setLights2Material(m_terrainMaterial);
 	updatePlanetLight(m_totalTime);
 	setLights2Material(m_sphereMaterial);
@@ -810,7 +628,16 @@ void LJMULevelDemo::Update()
 	static Vector4f twhiteclr(1.0f, 1.0f, 1.0f, 1.0f);
 	static Vector4f tyellowclr(1.0f, 1.0f, 0.0f, 1.0f);
 
-	m_pRender_text->writeText(outputFPSInfo(), ttextpos, twhiteclr);
+	std::wstring fpsInfo = outputFPSInfo();
+	m_pRender_text->writeText(fpsInfo, ttextpos, twhiteclr);
+
+	if (m_TerrainHorizon.isBuilt())
+	{
+		// Start under the last line of the frame rate text
+		float lines = 1.0f + (float)std::count(fpsInfo.begin(), fpsInfo.end(), L'\n');
+		ttextpos.SetTranslation(Vector3f(tx, ty + 30.0f * lines, 0.0f));
+		m_pRender_text->writeText(outputTerrainLightInfo(), ttextpos, tyellowclr);
+	}
 
 	this->m_pScene->Update(m_pTimer->Elapsed());
 	this->m_pScene->Render(this->m_pRenderer11);
@@ -902,11 +729,23 @@ bool LJMULevelDemo::HandleEvent(EventPtr pevent)
 	{
 		EvtKeyDownPtr tkey_down = std::static_pointer_cast<EvtKeyDown>(pevent);
 		unsigned int  tkeycode = tkey_down->GetCharacterCode();
+
+		// Terrain brushes: R raises, F lowers, G smooths, T flattens to the height first aimed at
+		if ((tkeycode == 'R' || tkeycode == 'F' || tkeycode == 'G' || tkeycode == 'T') && tkeycode != m_BrushKey)
+		{
+			m_BrushKey = tkeycode;
+			m_BrushPressed = true;
+		}
 	}
 	else if (e == SYSTEM_KEYBOARD_KEYUP)
 	{
 		EvtKeyUpPtr tkey_up = std::static_pointer_cast<EvtKeyUp>(pevent);
 		unsigned int tkeycode = tkey_up->GetCharacterCode();
+
+		if (tkeycode == m_BrushKey)
+		{
+			m_BrushKey = 0;
+		}
 	}
 
 	return(Application::HandleEvent(pevent));
@@ -936,8 +775,11 @@ void LJMULevelDemo::ShutdownEngineComponents()
 //////////////////////////////////
 void LJMULevelDemo::Shutdown()
 {
-	//NOTHING TO DO HERE
-
+	// Let any chunk rebuilds finish before the heightmap they read goes away
+	if (m_pTerrainExecutor)
+	{
+		m_pTerrainExecutor->clear();
+	}
 }
 
 //////////////////////////////////
@@ -953,56 +795,53 @@ void LJMULevelDemo::TakeScreenShot()
 }
 
 //////////////////////////////////////
-// Output our Frame Rate
+// Output the Sun and Sky Reaching the
+// Ground under the Camera
 //////////////////////////////////////
-std::wstring LJMULevelDemo::outputFPSInfo()
+std::wstring LJMULevelDemo::outputTerrainLightInfo()
 {
+	Vector3f cameraPos = m_pCamera->Spatial().GetTranslation();
+
 	std::wstringstream out;
-	out << L"FPS: " << m_pTimer->Framerate();
+	out.precision(2);
+	out << std::fixed << L"Ground sunlight: " << m_TerrainHorizon.getSunlight(cameraPos.x, cameraPos.z, m_vDirectionalLightDirection)
+		<< L"  Sky: " << m_TerrainHorizon.getOcclusion(cameraPos.x, cameraPos.z);
 	return out.str();
 }
 
-
-void LJMULevelDemo::GeneratePlaneIndexArray(int terrainWidth, int terrainLength,
-	bool bWinding,
-	std::vector<int>& indices)
+//////////////////////////////////////
+// Output our Frame Rate
+//////////////////////////////////////
+std::wstring LJMULevelDemo::outputFPSInfo()
 {
-	indices.clear();
+	std::wstringstream out;
+	out << L"FPS: " << m_pTimer->Framerate();
 
-	if (terrainWidth >= 2 && terrainLength >= 2)
+	if (m_pTerrainStreamer)
 	{
-		for (int XIdx = 0; XIdx < terrainWidth - 1; XIdx++)
-		{
-			for (int YIdx = 0; YIdx < terrainLength - 1; YIdx++)
-			{
-				const int I0 = (XIdx + 0) * terrainLength + (YIdx + 0);
-				const int I1 = (XIdx + 1) * terrainLength + (YIdx + 0);
-				const int I2 = (XIdx + 1) * terrainLength + (YIdx + 1);
-				const int I3 = (XIdx + 0) * terrainLength + (YIdx + 1);
-
-				if (bWinding)
-					ConvertQuadToTriangles(indices, I0, I1, I2, I3);
-				else
-					ConvertQuadToTriangles(indices, I0, I3, I2, I1);
-
-			}
-		}
+		LJMUTerrainStreamStats stats = m_pTerrainStreamer->getStats();
+		out << L"\nChunks: " << stats.resident << L" resident, " << stats.in_flight << L" in flight"
+			<< L", latency " << stats.total.getMean() << L" ms";
 	}
-}
 
-void LJMULevelDemo::ConvertQuadToTriangles(std::vector<int>& indices,
-	int Vert0, int Vert1,
-	int Vert2, int Vert3)
-{
-	indices.push_back(Vert3);
-	indices.push_back(Vert1);
-	indices.push_back(Vert0);
+	if (m_pNoiseTileCache)
+	{
+		LJMUNoiseTileCacheStats tileStats = m_pNoiseTileCache->getStats();
+		out << L"\nNoise tiles: " << tileStats.tile_count << L", " << tileStats.bytes_used / (1024 * 1024)
+			<< L" of " << tileStats.bytes_budget / (1024 * 1024) << L" MB, " << tileStats.hits << L" hits, "
+			<< tileStats.misses << L" misses, " << tileStats.evictions << L" evicted, "
+			<< tileStats.shared_edges << L" shared edges";
+	}
 
-	indices.push_back(Vert3);
-	indices.push_back(Vert2);
-	indices.push_back(Vert1);
+	LJMUMeshCacheStats meshStats = m_MeshCache.getStats();
+	out << L"\nMeshes: " << meshStats.meshes << L" with " << meshStats.references << L" references, "
+		<< (meshStats.vertex_bytes + meshStats.index_bytes) / 1024 << L" KB of "
+		<< meshStats.unshared_bytes / 1024 << L" KB unshared, ACMR "
+		<< meshStats.cache.before.acmr << L" -> " << meshStats.cache.after.acmr;
+	return out.str();
 }
 
+
 void LJMULevelDemo::LoadTextures()
 {
 	m_grassTerrainTexture = RendererDX11::Get()->LoadTexture(L"TerrainGrass.tif");
@@ -1030,64 +869,137 @@ MeshPtr LJMULevelDemo::CreateStandardSphere(int h_res,
 	int v_res,
 	Vector4f colour)
 {
-	std::vector<Vector3f> vertices;
-	std::vector<Vector4f> vertexColors;
-	std::vector<Vector2f> texCoord;
+	// Every sphere with the same resolution and colour shares one indexed mesh
+	std::vector<float> params = { float(h_res), float(v_res), colour.x, colour.y, colour.z, colour.w };
+
+	return m_MeshCache.get<BasicVertexDX11>("sphere", params,
+		[&](std::vector<BasicVertexDX11::Vertex>& vertices, std::vector<uint32_t>& indices)
+	{
+		BasicVertexDX11::Vertex prototype;
+		prototype.color = colour;
+
+		LJMUParametricSurface::generate(LJMUSphereSurface(), h_res + 1, v_res + 1, prototype, vertices, indices);
+	});
+}
 
-	// Cartesian coordinates (x,y,z) variables
-	float x;
-	float y;
-	float z;
+//////////////////////////////////////
+// Cube-Sphere Levels of Detail, Kept
+// Once Built so Bodies Moving Back and
+// Forth don't Rebuild them
+//////////////////////////////////////
+CustomMeshPtr LJMULevelDemo::GetCustomLODSphere(int level)
+{
+	if (m_CustomSphereLODs.size() < (size_t)m_SphereLOD.getLevelCount())
+	{
+		m_CustomSphereLODs.resize(m_SphereLOD.getLevelCount());
+	}
 
-	for (int j = 0; j <= v_res; ++j)
+	CustomMeshPtr& mesh = m_CustomSphereLODs[level];
+	if (!mesh)
 	{
-		float elevationAngle = GLYPH_PI * float(j) / float(v_res);
-		float sp = (float)std::sin(elevationAngle);
-		float cp = (float)std::cos(elevationAngle);
-		for (int i = 0; i <= h_res; ++i)
+		int cells = m_SphereLOD.getCells(level);
+		std::vector<float> params = { float(cells) };
+
+		mesh = m_MeshCache.get<CustomVertexDX11>("cubesphere", params,
+			[&](std::vector<CustomVertexDX11::Vertex>& vertices, std::vector<uint32_t>& indices)
 		{
-			float azimuthAngle = 2.0 * GLYPH_PI * float(i) / float(h_res);
-			float sa = std::sin(azimuthAngle);
-			float ca = std::cos(azimuthAngle);
+			std::vector<LJMUSphereVertex> sphere;
+			LJMUSphereLOD::build(cells, sphere, indices);
 
-			x = sp * ca;
-			y = cp;
-			z = sp * sa;
+			CustomVertexDX11::Vertex tv;
+			tv.color = Vector4f(1, 0, 0, 1);
+			tv.texweights = Vector2f(0, 0);
 
-			float u = float(i) / float(h_res);
-			float v = float(j) / float(v_res);
+			vertices.reserve(sphere.size());
+			for (const LJMUSphereVertex& sv : sphere)
+			{
+				tv.position = sv.position;
+				tv.normal = sv.normal;
+				tv.texcoords = sv.texcoords;
+				tv.tangent = sv.tangent;
+				tv.binormal = sv.binormal;
+				vertices.push_back(tv);
+			}
+		});
+	}
+	return mesh;
+}
 
-			vertices.push_back(Vector3f(x, y, z));
-			vertexColors.push_back(colour);
-			texCoord.push_back(Vector2f(u, v));
-		}
+MeshPtr LJMULevelDemo::GetLODSphere(int level)
+{
+	if (m_SphereLODs.size() < (size_t)m_SphereLOD.getLevelCount())
+	{
+		m_SphereLODs.resize(m_SphereLOD.getLevelCount());
 	}
 
-	// Setup index array
-	std::vector<int> indices;
+	MeshPtr& mesh = m_SphereLODs[level];
+	if (!mesh)
+	{
+		int cells = m_SphereLOD.getCells(level);
+		std::vector<float> params = { float(cells) };
+
+		mesh = m_MeshCache.get<BasicVertexDX11>("cubesphere", params,
+			[&](std::vector<BasicVertexDX11::Vertex>& vertices, std::vector<uint32_t>& indices)
+		{
+			std::vector<LJMUSphereVertex> sphere;
+			LJMUSphereLOD::build(cells, sphere, indices);
 
-	GeneratePlaneIndexArray(h_res + 1, v_res + 1, true, indices);
+			BasicVertexDX11::Vertex tv;
+			tv.color = Vector4f(1, 0, 0, 1);
 
-	int numberofIndices = indices.size();
-	int numberofTriangles = numberofIndices / 3;
+			vertices.reserve(sphere.size());
+			for (const LJMUSphereVertex& sv : sphere)
+			{
+				tv.position = sv.position;
+				tv.normal = sv.normal;
+				tv.texcoords = sv.texcoords;
+				vertices.push_back(tv);
+			}
+		});
+	}
+	return mesh;
+}
 
-	auto mesh = std::make_shared<DrawExecutorDX11<BasicVertexDX11::Vertex>>();
-	mesh->SetLayoutElements(BasicVertexDX11::GetElementCount(), BasicVertexDX11::Elements);
-	mesh->SetPrimitiveType(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-	mesh->SetMaxVertexCount(numberofIndices);
+void LJMULevelDemo::addSphereLODBody(Actor* actor, bool custom)
+{
+	SphereLODBody body = { actor, custom, m_SphereLOD.getLevelCount() - 1 };
+	m_SphereLODBodies.push_back(body);
+}
 
-	BasicVertexDX11::Vertex tv;
+//////////////////////////////////////
+// Swap each Planet's Sphere for the
+// Level its Size on Screen Needs
+//////////////////////////////////////
+void LJMULevelDemo::updateSphereLOD()
+{
+	const float fovY = static_cast<float>(GLYPH_PI) / 2.0f;
+	Vector3f cameraPos = m_pCamera->Spatial().GetTranslation();
 
-	for (int i = 0; i < numberofIndices; i++)
+	for (SphereLODBody& body : m_SphereLODBodies)
 	{
-		tv.position = vertices[indices[i]];
-		tv.color = vertexColors[indices[i]];
-		tv.texcoords = texCoord[indices[i]];
+		// The unit spheres are scaled evenly, so any axis of the scale is the radius
+		float screenRadius = LJMUSphereLOD::getScreenRadius(body.actor->GetNode()->Position(),
+			body.actor->GetNode()->Scale().x,
+			cameraPos,
+			m_iscreenHeight,
+			fovY);
+
+		int level = m_SphereLOD.selectLevel(body.level, screenRadius);
+		if (level == body.level)
+		{
+			continue;
+		}
 
-		mesh->AddVertex(tv);
+		body.level = level;
+		if (body.custom)
+		{
+			body.actor->GetBody()->SetGeometry(GetCustomLODSphere(level));
+		}
+		else
+		{
+			body.actor->GetBody()->SetGeometry(GetLODSphere(level));
+		}
 	}
-
-	return mesh;
 }
 
 void LJMULevelDemo::updateSphere()
@@ -1138,18 +1050,89 @@ void LJMULevelDemo::setupPlane()
 	float CenterZ = m_MapNumVerticesZ * m_SpaceBetweenVertices.y / 2;
 	m_WorldOriginCoord = Vector3f(-CenterX, 0.0f, -CenterZ);
 
-	auto planeMesh = CreatePlaneMesh(Vector3f(0.0f, 0.0f, 0.0f),
-		Vector3f(1.0f, 0.0f, 0.0f),
-		Vector3f(0.0f, 0.0f, 1.0f),
-		Vector2f(256.0f, 256.0f),
-		Vector2f(10.0f, 10.0f),
-		Vector4f(1.0f, 1.0f, 1.0f, 1.0f),
-		Vector2f(0, 0),
-		Vector2f(64.0f, 64.0f));
-
 	Actor* planeSegmentActor = new Actor();
 
-	planeSegmentActor->GetBody()->SetGeometry(planeMesh);
+	if (m_bStreamTerrain)
+	{
+		// The same noise as the generated map, built a chunk at a time on the thread pool around the camera
+		FastNoise noiseGenerator;
+		noiseGenerator.SetNoiseType(FastNoise::Perlin);
+		noiseGenerator.SetSeed(1024);
+		noiseGenerator.SetFrequency(0.0025f * 4);
+
+		// Tiles the size of a chunk, so revisited chunks and shared aprons are read back, not resampled
+		m_pNoiseTileCache = std::make_shared<LJMUNoiseTileCache>(32, 32 * 1024 * 1024);
+
+		// Raw noise runs from -1 to 1, lift it to the 0 to m_HeightScale of a normalised map
+		m_pTerrainStreamer = std::make_shared<LJMUTerrainStreamer>(LJMUNoiseTileSource::fromNoise(noiseGenerator));
+		m_pTerrainStreamer->setChunkCells(32);
+		m_pTerrainStreamer->setTileCache(m_pNoiseTileCache);
+		m_pTerrainStreamer->setOrigin(Vector3f(0.0f, m_HeightScale * 0.5f, 0.0f));
+		m_pTerrainStreamer->setSpacing(m_SpaceBetweenVertices);
+		m_pTerrainStreamer->setHeightScale(m_HeightScale * 0.5f);
+		m_pTerrainStreamer->setTexRepeats(8.0f);
+		m_pTerrainStreamer->setMaxError(8.0f);
+		m_pTerrainStreamer->setViewDistance(6000.0f);
+		m_pTerrainStreamer->setMaxStaged(16);
+		m_pTerrainStreamer->setUploadsPerFrame(2);
+
+		planeSegmentActor->GetBody()->SetGeometry(m_pTerrainStreamer);
+		vTranslation = Vector3f(0.0f, 0.0f, 0.0f);
+	}
+	else if (!m_WorldHeightmap.isEmpty())
+	{
+		// The brushes below can raise or lower anywhere only on a float map, a 16 bit map would clamp
+		// them at its range. Decoding every sample once here is lossless and keeps edits off that path.
+		LJMUHeightMapGenerator generator;
+		generator.quantise(m_WorldHeightmap, LJMUHeightmap::FORMAT_FLOAT32, false);
+
+		// One shared vertex per height sample, with normals for the terrain lights
+		LJMUTerrainMeshBuilder terrainBuilder;
+		terrainBuilder.setOrigin(m_WorldOriginCoord);
+		terrainBuilder.setSpacing(m_SpaceBetweenVertices);
+		terrainBuilder.setHeightScale(m_HeightScale);
+		terrainBuilder.setTexScale(Vector2f(128.0f, 128.0f));
+
+		// Fewer, larger triangles wherever the ground is flat enough to stay within 8 units of the heightmap
+		terrainBuilder.setMaxError(8.0f);
+
+		// Split the terrain into 32x32 cell chunks, with a level of detail picked per chunk each frame
+		m_TerrainQuadtree.build(m_WorldHeightmap, 32, m_WorldOriginCoord, m_SpaceBetweenVertices, m_HeightScale);
+
+		m_pTerrainExecutor = std::make_shared<LJMUTerrainExecutor>();
+		m_pTerrainExecutor->build(m_TerrainQuadtree, m_WorldHeightmap, terrainBuilder);
+
+		planeSegmentActor->GetBody()->SetGeometry(m_pTerrainExecutor);
+		vTranslation = Vector3f(0.0f, 0.0f, 0.0f);
+
+		// Heights and ground hits for the camera and anything placed on the terrain
+		m_TerrainQuery.bind(m_WorldHeightmap, m_WorldOriginCoord, m_SpaceBetweenVertices, m_HeightScale);
+
+		// Horizon angles in 16 directions out to 4000 units, for sun shadows and ambient occlusion
+		m_TerrainHorizon.setDirectionCount(16);
+		m_TerrainHorizon.setMaxDistance(4000.0f);
+		m_TerrainHorizon.build(m_WorldHeightmap, m_WorldOriginCoord, m_SpaceBetweenVertices, m_HeightScale);
+
+		// Brush edits at runtime, remeshing only the chunks over the changed heights
+		m_TerrainEditor.bind(m_WorldHeightmap, m_WorldOriginCoord, m_SpaceBetweenVertices, m_HeightScale);
+		m_TerrainEditor.setTerrain(&m_TerrainQuadtree, m_pTerrainExecutor.get());
+		m_TerrainEditor.setQuery(&m_TerrainQuery);
+		m_TerrainEditor.setHorizon(&m_TerrainHorizon);
+	}
+	else
+	{
+		auto planeMesh = CreatePlaneMesh(Vector3f(0.0f, 0.0f, 0.0f),
+			Vector3f(1.0f, 0.0f, 0.0f),
+			Vector3f(0.0f, 0.0f, 1.0f),
+			Vector2f(256.0f, 256.0f),
+			Vector2f(10.0f, 10.0f),
+			Vector4f(1.0f, 1.0f, 1.0f, 1.0f),
+			Vector2f(0, 0),
+			Vector2f(64.0f, 64.0f));
+
+		planeSegmentActor->GetBody()->SetGeometry(planeMesh);
+	}
+
 	planeSegmentActor->GetBody()->SetMaterial(m_terrainMaterial);
 	planeSegmentActor->GetNode()->Scale() = vScale;
 	planeSegmentActor->GetNode()->Rotation() = mRotation;
@@ -1168,120 +1151,37 @@ MeshPtr	LJMULevelDemo::CreatePlaneMesh(const Vector3f& center,
 	const Vector2f& gridPos,
 	const Vector2f& texScale)
 {
-	std::vector<Vector3f> vertices;
-	std::vector<Vector4f> vertexColors;
-	std::vector<Vector2f> texCoord;
-
-	Vector3f x_unit = xdir;
-	Vector3f z_unit = zdir;
-
-	x_unit.Normalize();
-	z_unit.Normalize();
-
 	int xVertices = (int)numVertices.x;
 	int zVertices = (int)numVertices.y;
 
-	float xSpacing = spacing.x;
-	float zSpacing = spacing.y;
-
-	Vector3f x = x_unit * ((float)xVertices - 1) / 2 * xSpacing;
-	Vector3f z = z_unit * ((float)xVertices - 1) / 2 * zSpacing;
-
-	// Get the location of the top-left vertex
-	Vector3f startPos = center - x - z;
-
-	// Calculate the unit up vector (y_unit).
-	// Direct3D uses left-hand rule to determine the direction (since z axis direction is reversed)
-	// Hence z cross x gives the y up vector
-	Vector3f y_unit = z_unit.Cross(x_unit);
-	y_unit.Normalize();
-
-	float heightScale = 10.0f;
-
-	float majorheightfrequency = 0.02f;
-	float majorheight = 1.0f;
-
-	float minorheightfrequency = 0.2;
-	float minorheight = 0.25f;
-
-	for (int i = 0; i < xVertices; i++)
-	{
-		for (int j = 0; j < zVertices; j++)
-		{
-			//float height = cos((float)i * 0.1f)* sin((float)j * 0.1f)* heightScale;
-
-			//Vector3f pos = startPos + x_unit * xSpacing * i + z_unit * zSpacing * j;
+	LJMUWavePlaneSurface surface(center, xdir, zdir, xVertices, zVertices, spacing, gridPos, texScale);
 
-			float shifted_i = (float)i + gridPos.x * (xVertices - 1);
-			float shifted_j = (float)j + gridPos.y * (zVertices - 1);
+	BasicVertexDX11::Vertex prototype;
+	prototype.normal = surface.getUp();
 
-			//Vector3f pos = startPos + x_unit * xSpacing * shifted_i + z_unit * zSpacing * shifted_j;
+	// Rows along x, so vertex (i, j) is at i * zVertices + j
+	std::vector<BasicVertexDX11::Vertex> vertices;
+	std::vector<uint32_t> indices;
+	LJMUParametricSurface::generate(surface, zVertices, xVertices, prototype, vertices, indices);
 
-			float majorperiodicheight_x = sin(shifted_i * majorheightfrequency * GLYPH_PI) * majorheight;
-			float majorperiodicheight_z = cos(shifted_j * majorheightfrequency * GLYPH_PI) * majorheight;
-			float majorperiodicheight = majorperiodicheight_x * majorperiodicheight_z;
-
-			float minorperiodicheight_x = sin(shifted_i * minorheightfrequency * GLYPH_PI) * minorheight;
-			float minorperiodicheight_z = cos(shifted_j * minorheightfrequency * GLYPH_PI) * minorheight;
-			float minorperiodicheight = minorperiodicheight_x * minorperiodicheight_z;
-
-			float height = (majorperiodicheight + minorperiodicheight) * heightScale;
-
-			Vector3f pos = startPos +
-				x_unit * xSpacing * shifted_i +
-				z_unit * zSpacing * shifted_j +
-				y_unit * height * heightScale;
-
-
-
-			vertices.push_back(pos);
-
-			//vertexColors.push_back(colour);
-
-			float shade = (height / heightScale + 1) / 2.0f;
-
-			if (shade < 0)
-				shade = 0;
-			else if (shade > 1)
-				shade = 1;
-
-			vertexColors.push_back(Vector4f(shade, 1 - shade, shade / 2, 1));
-
-			Vector2f normalisedTexScale = Vector2f(texScale.x / numVertices.x, texScale.y / numVertices.y);
-
-			float u = shifted_i;
-			float v = shifted_j;
-
-			texCoord.push_back(Vector2f(u, v) * normalisedTexScale);
-		}
-	}
-
-	int numberofVertices = vertices.size();
-
-	std::vector<int> indices;
-
-	GeneratePlaneIndexArray(xVertices, zVertices, true, indices);
-
-	int numberofIndices = indices.size();
-	int numberofTriangles = numberofIndices / 3;
-
-	auto terrainMesh = std::make_shared<DrawExecutorDX11<BasicVertexDX11::Vertex>>();
+	// Vertices are shared between the quads that use them, rather than repeated for every triangle
+	auto terrainMesh = std::make_shared<DrawIndexedExecutorDX11<BasicVertexDX11::Vertex>>();
 	terrainMesh->SetLayoutElements(BasicVertexDX11::GetElementCount(),
 		BasicVertexDX11::Elements);
 	terrainMesh->SetPrimitiveType(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-	terrainMesh->SetMaxVertexCount(numberofIndices);
+	terrainMesh->SetMaxVertexCount((unsigned int)vertices.size());
+	terrainMesh->SetMaxIndexCount((unsigned int)indices.size());
 
-	BasicVertexDX11::Vertex tv;
-
-	for (int i = 0; i < numberofIndices; i++)
+	for (const BasicVertexDX11::Vertex& tv : vertices)
 	{
-		tv.position = vertices[indices[i]];
-		tv.color = vertexColors[indices[i]];
-		tv.texcoords = texCoord[indices[i]];
-
 		terrainMesh->AddVertex(tv);
 	}
 
+	for (size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		terrainMesh->AddIndices(indices[i], indices[i + 1], indices[i + 2]);
+	}
+
 	return terrainMesh;
 }
 
@@ -1725,157 +1625,268 @@ void LJMULevelDemo::updateTerrainLight(float time)
 	m_vPointLightRange = Vector4f(520.0f, 0.0f, 0.0f, 0.0f);
 }
 
-void LJMULevelDemo::SetupHeightMap()
+void LJMULevelDemo::updateTerrainLOD()
 {
+	if (!m_pTerrainExecutor)
+	{
+		return;
+	}
 
-	m_MapNumVerticesX = 512;
-	m_MapNumVerticesZ = 512;
+	// Refine the terrain until no chunk's height error covers more than two pixels
+	const float maxPixelError = 2.0f;
+	const float fovY = static_cast<float>(GLYPH_PI) / 2.0f;
+
+	Vector3f cameraPos = m_pCamera->Spatial().GetTranslation();
+	Matrix3f cameraRotation = m_pCamera->GetNode()->Rotation();
+	Vector3f right = cameraRotation.GetRow(0);
+	Vector3f up = cameraRotation.GetRow(1);
+	Vector3f forward = cameraRotation.GetRow(2);
+
+	// Side and near planes of the view, facing inwards. The far plane is left to the depth buffer.
+	float halfY = fovY * 0.5f;
+	float halfX = atan(tan(halfY) * m_iscreenWidth / m_iscreenHeight);
+
+	Vector3f planeNormals[5] = {
+		right * cos(halfX) + forward * sin(halfX),
+		right * -cos(halfX) + forward * sin(halfX),
+		up * cos(halfY) + forward * sin(halfY),
+		up * -cos(halfY) + forward * sin(halfY),
+		forward
+	};
+
+	Vector4f planes[5];
+	for (int p = 0; p < 5; p++)
+	{
+		const Vector3f& n = planeNormals[p];
+		planes[p] = Vector4f(n.x, n.y, n.z, -(n.x * cameraPos.x + n.y * cameraPos.y + n.z * cameraPos.z));
+	}
+	planes[4].w -= 0.1f;
 
-	// Uncomment the next two lines to generate height map using sin and cosine functions
-	//m_HeightScale = 700.0f;
-	//m_WorldHeightmap = GenerateHeightMap(m_MapNumVerticesX, m_MapNumVerticesZ);
+	// Chunks hidden behind hills are dropped as well, tested against the height query's pyramid
+	LJMUTerrainCulling culling = { planes, 5, m_TerrainQuery.isBound() ? &m_TerrainQuery : nullptr };
 
-	// Uncomment the next three lines to generate height map by loading raw heightmap file
-	 //m_HeightScale = 1200.0f;
-	 //std::string HeightMapFilename = "heightmap512x512.r16";
-	 //m_WorldHeightmap = GenerateHeightMap(HeightMapFilename, m_MapNumVerticesX, m_MapNumVerticesZ);
+	m_TerrainQuadtree.select(cameraPos,
+		maxPixelError,
+		m_iscreenHeight,
+		fovY,
+		culling,
+		m_TerrainSelection);
 
-	// Uncomment the next four lines to generate height map by using a noise generator function
-	m_HeightScale = 1550.0f;
-	float frequency = 0.0025f * 4;
-	int seed = 1024;
-	m_WorldHeightmap = GenerateHeightMap(frequency, seed, m_MapNumVerticesX, m_MapNumVerticesZ);
+	m_pTerrainExecutor->setSelection(m_TerrainSelection);
+}
 
-	if (!m_WorldHeightmap)
+void LJMULevelDemo::clampCameraToTerrain()
+{
+	if (!m_TerrainQuery.isBound())
 	{
 		return;
 	}
 
-	// the remainder of the code will normalise the height to range 0 to 1
-
-	double maxHeight = 0;
-	double minHeight = 1000000;
+	// Keep the camera at least eye height above the ground under it
+	const float eyeHeight = 40.0f;
 
-	int hmsize = m_MapNumVerticesX * m_MapNumVerticesZ;
-
-	for (int index = 0; index < hmsize; index++)
+	Vector3f cameraPos = m_pCamera->Spatial().GetTranslation();
+	if (!m_TerrainQuery.isInside(cameraPos.x, cameraPos.z))
 	{
-		if (maxHeight < m_WorldHeightmap[index])
-			maxHeight = m_WorldHeightmap[index];
-		if (minHeight > m_WorldHeightmap[index])
-			minHeight = m_WorldHeightmap[index];
+		return;
 	}
 
-	double range = maxHeight - minHeight;
-
-	for (int index = 0; index < hmsize; index++)
+	float groundHeight = m_TerrainQuery.getHeight(cameraPos.x, cameraPos.z) + eyeHeight;
+	if (cameraPos.y < groundHeight)
 	{
-		m_WorldHeightmap[index] = (m_WorldHeightmap[index] - minHeight) / range;
+		cameraPos.y = groundHeight;
+		m_pCamera->Spatial().SetTranslation(cameraPos);
 	}
 }
 
-double* LJMULevelDemo::GenerateHeightMap(int HeightMapWidth, int HeightMapLength)
+void LJMULevelDemo::updateTerrainEditing()
 {
-	// Calculate the size of the raw image data.
-	long actualSize = HeightMapWidth * HeightMapLength;
-
-	double* heightmap = new double[actualSize];
-	if (!heightmap)
+	if (!m_TerrainEditor.isBound())
 	{
-		return nullptr;
+		return;
 	}
 
-	float majorheightfrequency = 0.02f;
-	float majorheight = 255.0f;
+	// Stroke the ground the camera is looking at while a brush key is held
+	const float maxReach = 10000.0f;
 
-	float minorheightfrequency = 0.2;
-	float minorheight = 50;
+	Vector3f cameraPos = m_pCamera->Spatial().GetTranslation();
+	Vector3f forward = m_pCamera->GetNode()->Rotation().GetRow(2);
+	float distance = 0.0f;
 
-	for (int i = 0; i < HeightMapWidth; i++)
+	if (m_BrushKey != 0 && m_TerrainQuery.intersectRay(cameraPos, forward, maxReach, distance))
 	{
-		for (int j = 0; j < HeightMapLength; j++)
-		{
-			float majorperiodicheight_x = sin(i * majorheightfrequency * GLYPH_PI) * majorheight;
-			float majorperiodicheight_z = cos(j * majorheightfrequency * GLYPH_PI) * majorheight;
-			float majorperiodicheight = majorperiodicheight_x * majorperiodicheight_z;
+		Vector3f target = cameraPos + forward * distance;
 
-			float minorperiodicheight_x = sin(i * minorheightfrequency * GLYPH_PI) * minorheight;
-			float minorperiodicheight_z = cos(j * minorheightfrequency * GLYPH_PI) * minorheight;
-			float minorperiodicheight = minorperiodicheight_x * minorperiodicheight_z;
+		if (m_BrushPressed)
+		{
+			m_BrushFlattenHeight = target.y;
+			m_BrushPressed = false;
+		}
 
-			float height = (majorperiodicheight + minorperiodicheight);
+		// 32 samples either side, a 64x64 stroke each frame. Heights stay within 0 to m_HeightScale.
+		LJMUTerrainBrush brush;
+		brush.radius = 32.0f * m_SpaceBetweenVertices.x;
+		brush.strength = 400.0f * m_tpf;
+		brush.height = m_BrushFlattenHeight;
 
-			heightmap[i * HeightMapLength + j] = height;
+		switch (m_BrushKey)
+		{
+		case 'R':
+			brush.mode = LJMUTerrainBrush::BRUSH_RAISE;
+			break;
+		case 'F':
+			brush.mode = LJMUTerrainBrush::BRUSH_LOWER;
+			break;
+		case 'G':
+			brush.mode = LJMUTerrainBrush::BRUSH_SMOOTH;
+			brush.strength = 0.5f;
+			break;
+		default:
+			brush.mode = LJMUTerrainBrush::BRUSH_FLATTEN;
+			brush.strength = 0.25f;
+			break;
 		}
+
+		m_TerrainEditor.stroke(brush, target.x, target.z);
 	}
 
-	return heightmap;
+	// Applies this frame's strokes and swaps in the chunks remeshed since the last one
+	m_TerrainEditor.update();
 }
 
-double* LJMULevelDemo::GenerateHeightMap(std::string filename,
-	int HeightMapWidth, int HeightMapLength)
+void LJMULevelDemo::updateTerrainStreaming()
 {
-
-	// Calculate the size of the raw image data.
-	int actualSize = HeightMapWidth * HeightMapLength;
-
-	// Allocate memory for the raw image data.
-	unsigned short* rawImage = new unsigned short[actualSize];
-	if (!rawImage)
+	if (!m_pTerrainStreamer)
 	{
-		return nullptr;
+		return;
 	}
 
-	FILE* filePtr;
+	// Request, cancel and commit chunks for the camera's new position, at most two uploads a frame
+	m_pTerrainStreamer->update(m_pCamera->Spatial().GetTranslation(),
+		m_pCamera->GetNode()->Rotation().GetRow(2));
+}
+
+void LJMULevelDemo::SetupHeightMap()
+{
+	// Set to true to stream endless noise terrain around the camera instead of building one map
+	m_bStreamTerrain = false;
+
+	m_MapNumVerticesX = 512;
+	m_MapNumVerticesZ = 512;
+
+	// Uncomment the next two lines to generate height map using sin and cosine functions
+	//m_HeightScale = 700.0f;
+	//GenerateHeightMap(m_WorldHeightmap, m_MapNumVerticesX, m_MapNumVerticesZ);
+
+	// Uncomment the next three lines to generate height map by loading raw heightmap file
+	 //m_HeightScale = 1200.0f;
+	 //std::string HeightMapFilename = "heightmap512x512.r16";	// or a .lht written by Tools/HeightTileTool
+	 //GenerateHeightMap(m_WorldHeightmap, HeightMapFilename, m_MapNumVerticesX, m_MapNumVerticesZ);
+
+	// Uncomment the next four lines to generate height map by using a noise generator function
+	m_HeightScale = 1550.0f;
+	float frequency = 0.0025f * 4;
+	int seed = 1024;
+
+	// Set both to 0 to use the raw noise, the erosion stage runs before the heights are normalised
+	m_ErosionDroplets = 200000;
+	m_ErosionThermalIterations = 10;
 
-	// Open the 16 bit raw height map file for reading in binary.
-	int error = fopen_s(&filePtr, filename.c_str(), "rb");
-	if (error != 0)
+	// Streamed terrain samples the same noise a chunk at a time instead
+	if (m_bStreamTerrain)
 	{
-		return false;
+		return;
 	}
 
-	// Read in the raw image data.
-	int count = fread(rawImage, sizeof(unsigned short), actualSize, filePtr);
-	if (count != actualSize)
+	// Every GenerateHeightMap overload leaves the heights normalised to range 0 to 1
+	if (!GenerateHeightMap(m_WorldHeightmap, frequency, seed, m_MapNumVerticesX, m_MapNumVerticesZ))
 	{
-		return false;
+		return;
 	}
+}
 
-	// Close the file.
-	error = fclose(filePtr);
-	if (error != 0)
+bool LJMULevelDemo::GenerateHeightMap(LJMUHeightmap& heightmap, int HeightMapWidth, int HeightMapLength)
+{
+	// 16 bit samples are plenty for heights normalised to 0 to 1, at a quarter of the memory of doubles
+	if (!heightmap.create(HeightMapWidth, HeightMapLength, LJMUHeightmap::FORMAT_UNORM16))
 	{
 		return false;
 	}
 
-	double* heightmap = new double[actualSize];
-	if (!heightmap)
+	float majorheightfrequency = 0.02f;
+	float majorheight = 255.0f;
+
+	float minorheightfrequency = 0.2;
+	float minorheight = 50;
+
+	LJMUHeightMapGenerator generator;
+	generator.generate(heightmap, [=](const LJMUHeightTile& tile, float* out)
+	{
+		for (int ti = 0; ti < tile.width; ti++)
+		{
+			int i = tile.i0 + ti;
+
+			for (int tj = 0; tj < tile.length; tj++)
+			{
+				int j = tile.j0 + tj;
+
+				float majorperiodicheight_x = sin(i * majorheightfrequency * GLYPH_PI) * majorheight;
+				float majorperiodicheight_z = cos(j * majorheightfrequency * GLYPH_PI) * majorheight;
+				float majorperiodicheight = majorperiodicheight_x * majorperiodicheight_z;
+
+				float minorperiodicheight_x = sin(i * minorheightfrequency * GLYPH_PI) * minorheight;
+				float minorperiodicheight_z = cos(j * minorheightfrequency * GLYPH_PI) * minorheight;
+				float minorperiodicheight = minorperiodicheight_x * minorperiodicheight_z;
+
+				out[ti * tile.length + tj] = (majorperiodicheight + minorperiodicheight);
+			}
+		}
+	});
+
+	return true;
+}
+
+bool LJMULevelDemo::GenerateHeightMap(LJMUHeightmap& heightmap, std::string filename,
+	int HeightMapWidth, int HeightMapLength)
+{
+	// Tiled files written by HeightTileTool are decoded a tile at a time across the thread pool
+	if (filename.size() > 4 && filename.compare(filename.size() - 4, 4, ".lht") == 0)
 	{
-		return nullptr;
+		LJMUHeightTileFile tiles;
+		if (!tiles.open(filename) || tiles.getWidth() != HeightMapWidth || tiles.getLength() != HeightMapLength ||
+			!tiles.readLevel(0, heightmap))
+		{
+			return false;
+		}
+
+		LJMUHeightMapGenerator generator;
+		generator.normalise(heightmap);
+		return true;
 	}
 
-	for (int k = 0; k < actualSize; k++)
+	// The raw file holds 16 bit unsigned heights, which are copied straight from the mapped file into the map's samples
+	LJMUMappedHeightmap file;
+	if (!file.open(filename, HeightMapWidth, HeightMapLength) ||
+		!heightmap.create(HeightMapWidth, HeightMapLength, LJMUHeightmap::FORMAT_UNORM16) ||
+		!file.readRows(0, HeightMapWidth, static_cast<uint16_t*>(heightmap.getData())))
 	{
-		heightmap[k] = (double)(rawImage[k]);
+		heightmap.release();
+		return false;
 	}
 
-	// Release the bitmap image data.
-	delete[] rawImage;
-	rawImage = 0;
+	// Only the scale and offset change, the samples stay exactly as they were in the file
+	LJMUHeightMapGenerator generator;
+	generator.normalise(heightmap);
 
-	return heightmap;
+	return true;
 }
 
-double* LJMULevelDemo::GenerateHeightMap(float frequency, int seed, int HeightMapWidth, int HeightMapLength)
+bool LJMULevelDemo::GenerateHeightMap(LJMUHeightmap& heightmap, float frequency, int seed, int HeightMapWidth, int HeightMapLength)
 {
-	// Calculate the size of the raw image data.
-	long actualSize = HeightMapWidth * HeightMapLength;
-
-	double* heightmap = new double[actualSize];
-	if (!heightmap)
+	// Generated and eroded in float, then quantised to 16 bits once at the end
+	if (!heightmap.create(HeightMapWidth, HeightMapLength, LJMUHeightmap::FORMAT_FLOAT32))
 	{
-		return nullptr;
+		return false;
 	}
 
 	FastNoise noiseGenerator;
@@ -1883,15 +1894,25 @@ double* LJMULevelDemo::GenerateHeightMap(float frequency, int seed, int HeightMa
 	noiseGenerator.SetSeed(seed);
 	noiseGenerator.SetFrequency(frequency);
 
-	for (int i = 0; i < HeightMapWidth; i++)				// we use less-or-equal-than sign to join adjacent grids
+	// Sample the map in batched tiles across the thread pool, laid out as heightmap[i * HeightMapLength + j]
+	LJMUHeightMapGenerator generator;
+	generator.generateNoise(heightmap, noiseGenerator, false);
+
+	// Carve gullies with droplets and slump the steepest slopes, the same seed always gives the same map
+	LJMUHeightErosion erosion;
+	erosion.setSeed(seed);
+	if (m_ErosionDroplets > 0)
 	{
-		for (int j = 0; j < HeightMapLength; j++)			// we use less-or-equal-than sign to join adjacent grids
-		{
-			heightmap[i * HeightMapLength + j] = noiseGenerator.GetNoise(i, j);
-		}
+		erosion.erodeHydraulic(heightmap, m_ErosionDroplets);
 	}
+	if (m_ErosionThermalIterations > 0)
+	{
+		erosion.erodeThermal(heightmap, m_ErosionThermalIterations);
+	}
+
+	generator.quantise(heightmap, LJMUHeightmap::FORMAT_UNORM16);
 
-	return heightmap;
+	return true;
 }
 
 MaterialPtr LJMULevelDemo::createTransparentLitTexturedMaterial()
@@ -16,6 +16,17 @@
 
 //LJMU Framework Includes
 #include "LJMUTextOverlay.h"
+#include "LJMUHeightmap.h"
+#include "LJMUTerrainQuadtree.h"
+#include "LJMUTerrainExecutor.h"
+#include "LJMUTerrainStreamer.h"
+#include "LJMUTerrainQuery.h"
+#include "LJMUTerrainEditor.h"
+#include "LJMUTerrainSplat.h"
+#include "LJMUTerrainHorizon.h"
+#include "LJMUMeshCache.h"
+#include "LJMUSphereLOD.h"
+#include "LJMUParametricSurface.h"
 
 using namespace Glyph3;
 
@@ -88,15 +99,6 @@ namespace LJMUDX
 		void					SetupCylinder();
 
 
-		void	GeneratePlaneIndexArray(int terrainWidth,
-			int terrainLength,
-			bool bWinding,
-			std::vector<int>& indices);
-
-		void	ConvertQuadToTriangles(std::vector<int>& indices,
-			int Vert0, int Vert1,
-			int Vert2, int Vert3);
-
 		float		m_totalTime = 0;
 		float		m_tpf = 0;
 
@@ -231,10 +233,6 @@ namespace LJMUDX
 			ResourcePtr bumptexture,
 			ResourcePtr lighttexture);
 
-		CustomMeshPtr CreateCustomStandardSphere(int h_res,
-			int v_res,
-			Vector4f colour);
-
 		ResourcePtr	m_sphereLightTexture;
 
 		ResourcePtr	m_cloudTexture;
@@ -246,16 +244,57 @@ namespace LJMUDX
 		void		setTerrainLightsParameters();
 		void		updateTerrainLight(float time);
 
-		double* GenerateHeightMap(int HeightMapWidth, int HeightMapLength);
-		double* GenerateHeightMap(std::string filename,
+		bool GenerateHeightMap(LJMUHeightmap& heightmap, int HeightMapWidth, int HeightMapLength);
+		bool GenerateHeightMap(LJMUHeightmap& heightmap, std::string filename,
 			int HeightMapWidth,
 			int HeightMapLength);
-		double* GenerateHeightMap(float frequency, int seed,
+		bool GenerateHeightMap(LJMUHeightmap& heightmap, float frequency, int seed,
 			int HeightMapWidth, int HeightMapLength);
 
 		void		SetupHeightMap();
 
-		double* m_WorldHeightmap;
+		LJMUHeightmap m_WorldHeightmap;
+
+		LJMUTerrainQuadtree		m_TerrainQuadtree;
+		LJMUTerrainExecutorPtr	m_pTerrainExecutor;
+		std::vector<int>		m_TerrainSelection;
+		void		updateTerrainLOD();
+
+		bool					m_bStreamTerrain;
+		LJMUTerrainStreamerPtr	m_pTerrainStreamer;
+		std::shared_ptr<LJMUNoiseTileCache>	m_pNoiseTileCache;	// Streamed chunk heights, kept for revisits
+		void		updateTerrainStreaming();
+
+		LJMUTerrainQuery		m_TerrainQuery;
+		void		clampCameraToTerrain();
+
+		LJMUMeshCache			m_MeshCache;		// Geometry shared between actors, see CreateStandardSphere
+
+		// Planets swap between cube-sphere levels of detail by their size on screen
+		struct SphereLODBody
+		{
+			Actor*	actor;
+			bool	custom;		// Drawn with CustomVertexDX11, otherwise BasicVertexDX11
+			int		level;
+		};
+
+		LJMUSphereLOD				m_SphereLOD;
+		std::vector<SphereLODBody>	m_SphereLODBodies;
+		std::vector<CustomMeshPtr>	m_CustomSphereLODs;
+		std::vector<MeshPtr>		m_SphereLODs;
+		CustomMeshPtr	GetCustomLODSphere(int level);
+		MeshPtr			GetLODSphere(int level);
+		void		addSphereLODBody(Actor* actor, bool custom);
+		void		updateSphereLOD();
+
+		LJMUTerrainHorizon		m_TerrainHorizon;
+		std::wstring	outputTerrainLightInfo();
+
+		LJMUTerrainEditor		m_TerrainEditor;
+		unsigned int			m_BrushKey;			// Key of the brush held down, 0 for none
+		bool					m_BrushPressed;		// Held down since the last frame's stroke
+		float					m_BrushFlattenHeight;
+		void		updateTerrainEditing();
 
 		Vector3f	m_WorldOriginCoord;
 
@@ -265,5 +304,8 @@ namespace LJMUDX
 		float		m_HeightScale;
 		Vector2f	m_SpaceBetweenVertices;
 
+		int			m_ErosionDroplets;
+		int			m_ErosionThermalIterations;
+
 	};
 }
@@ -0,0 +1,220 @@
+#include "LJMUMappedHeightmap.h"
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace LJMUDX;
+
+///////////////////////////
+// Window Constructor, takes
+// ownership of the view
+///////////////////////////
+LJMUHeightWindow::LJMUHeightWindow(void* pview, const uint16_t* psamples, int pfirstrow, int prowcount, int plength) :
+	_view(pview),
+	_samples(psamples),
+	_first_row(pfirstrow),
+	_row_count(prowcount),
+	_length(plength)
+{
+
+}
+
+LJMUHeightWindow::~LJMUHeightWindow()
+{
+	if (this->_view)
+		UnmapViewOfFile(this->_view);
+}
+
+///////////////////////////
+// Constructor
+///////////////////////////
+LJMUMappedHeightmap::LJMUMappedHeightmap(size_t pwindowbytes, int pmaxwindows) :
+	_file(nullptr),
+	_mapping(nullptr),
+	_width(0),
+	_length(0),
+	_window_bytes(std::max<size_t>(pwindowbytes, 64 * 1024)),
+	_max_windows(std::max(pmaxwindows, 1)),
+	_rows_per_window(0),
+	_granularity(64 * 1024)
+{
+	SYSTEM_INFO tinfo;
+	GetSystemInfo(&tinfo);
+	this->_granularity = tinfo.dwAllocationGranularity;
+}
+
+LJMUMappedHeightmap::~LJMUMappedHeightmap()
+{
+	this->close();
+}
+
+///////////////////////////
+// Map a Heightmap File
+///////////////////////////
+bool LJMUMappedHeightmap::open(const std::string& pfilename, int pwidth, int plength)
+{
+	this->close();
+	if (pwidth <= 0 || plength <= 0)
+		return false;
+
+	//Random access stops the cache manager reading ahead of the rows actually touched
+	HANDLE tfile = CreateFileA(pfilename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+	if (tfile == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER tsize;
+	uint64_t tneeded = (uint64_t)pwidth * plength * sizeof(uint16_t);
+	if (!GetFileSizeEx(tfile, &tsize) || (uint64_t)tsize.QuadPart < tneeded)
+	{
+		CloseHandle(tfile);
+		return false;
+	}
+
+	HANDLE tmapping = CreateFileMapping(tfile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!tmapping)
+	{
+		CloseHandle(tfile);
+		return false;
+	}
+
+	std::lock_guard<std::mutex> tlock(this->_mutex);
+
+	size_t trowbytes = (size_t)plength * sizeof(uint16_t);
+	this->_file = tfile;
+	this->_mapping = tmapping;
+	this->_width = pwidth;
+	this->_length = plength;
+	this->_rows_per_window = (int)std::min<size_t>(std::max<size_t>(this->_window_bytes / trowbytes, 1), (size_t)pwidth);
+	this->_list_windows.assign((pwidth + this->_rows_per_window - 1) / this->_rows_per_window, nullptr);
+	return true;
+}
+
+///////////////////////////
+// Unmap the File, windows
+// still held elsewhere stay
+// valid until released
+///////////////////////////
+void LJMUMappedHeightmap::close()
+{
+	std::lock_guard<std::mutex> tlock(this->_mutex);
+
+	this->_list_windows.clear();
+	this->_list_resident.clear();
+
+	if (this->_mapping)
+		CloseHandle(this->_mapping);
+	if (this->_file)
+		CloseHandle(this->_file);
+
+	this->_mapping = nullptr;
+	this->_file = nullptr;
+	this->_width = 0;
+	this->_length = 0;
+	this->_rows_per_window = 0;
+}
+
+///////////////////////////
+// Find or Map the Window
+// Holding a Row
+///////////////////////////
+LJMUHeightWindowPtr LJMUMappedHeightmap::getWindow(int pi)
+{
+	std::lock_guard<std::mutex> tlock(this->_mutex);
+	if (!this->_mapping || pi < 0 || pi >= this->_width)
+		return nullptr;
+
+	int twindow = pi / this->_rows_per_window;
+	LJMUHeightWindowPtr& tentry = this->_list_windows[twindow];
+
+	if (tentry)
+	{
+		//Move to the most recently used end
+		auto tit = std::find(this->_list_resident.begin(), this->_list_resident.end(), twindow);
+		if (tit != this->_list_resident.end())
+			this->_list_resident.erase(tit);
+		this->_list_resident.push_back(twindow);
+		return tentry;
+	}
+
+	tentry = this->mapWindow(twindow);
+	if (!tentry)
+		return nullptr;
+
+	this->_list_resident.push_back(twindow);
+	while ((int)this->_list_resident.size() > this->_max_windows)
+	{
+		this->_list_windows[this->_list_resident.front()] = nullptr;
+		this->_list_resident.pop_front();
+	}
+
+	return this->_list_windows[twindow];
+}
+
+///////////////////////////
+// Single Raw Sample
+///////////////////////////
+uint16_t LJMUMappedHeightmap::getSample(int pi, int pj)
+{
+	if (pj < 0 || pj >= this->_length)
+		return 0;
+
+	LJMUHeightWindowPtr twindow = this->getWindow(pi);
+	return twindow ? twindow->getRow(pi)[pj] : 0;
+}
+
+///////////////////////////
+// Copy Rows Out
+///////////////////////////
+bool LJMUMappedHeightmap::readRows(int pi, int pcount, uint16_t* pout)
+{
+	if (pi < 0 || pcount < 0 || pi + pcount > this->_width)
+		return false;
+
+	int trow = pi;
+	while (trow < pi + pcount)
+	{
+		LJMUHeightWindowPtr twindow = this->getWindow(trow);
+		if (!twindow)
+			return false;
+
+		//Rows in a window are contiguous, so copy as many as it holds in one go
+		int tend = std::min(pi + pcount, twindow->getFirstRow() + twindow->getRowCount());
+		std::memcpy(pout + (size_t)(trow - pi) * this->_length, twindow->getRow(trow),
+			(size_t)(tend - trow) * this->_length * sizeof(uint16_t));
+		trow = tend;
+	}
+	return true;
+}
+
+///////////////////////////
+// Map one Window, the view
+// starts on an allocation
+// granularity boundary
+///////////////////////////
+LJMUHeightWindowPtr LJMUMappedHeightmap::mapWindow(int pwindow)
+{
+	int tfirst = pwindow * this->_rows_per_window;
+	int tcount = std::min(this->_rows_per_window, this->_width - tfirst);
+
+	uint64_t toffset = (uint64_t)tfirst * this->_length * sizeof(uint16_t);
+	uint64_t taligned = toffset - toffset % this->_granularity;
+	size_t tskip = (size_t)(toffset - taligned);
+	size_t tbytes = tskip + (size_t)tcount * this->_length * sizeof(uint16_t);
+
+	void* tview = MapViewOfFile(this->_mapping, FILE_MAP_READ,
+		(DWORD)(taligned >> 32), (DWORD)(taligned & 0xffffffffu), tbytes);
+	if (!tview)
+		return nullptr;
+
+	const uint16_t* tsamples = reinterpret_cast<const uint16_t*>(static_cast<const uint8_t*>(tview) + tskip);
+	return LJMUHeightWindowPtr(new LJMUHeightWindow(tview, tsamples, tfirst, tcount, this->_length));
+}
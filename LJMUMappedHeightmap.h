@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace LJMUDX
+{
+	/////////////////////////
+	// Block of rows of a mapped
+	// heightmap file. The view
+	// stays mapped for as long as
+	// anyone holds the window,
+	// even after the heightmap
+	// has dropped it.
+	/////////////////////////
+	class LJMUHeightWindow
+	{
+	public:
+		//--------CONSTRUCTORS/DESTRUCTORS----------------------------------------------------
+		~LJMUHeightWindow();
+
+		LJMUHeightWindow(const LJMUHeightWindow&) = delete;
+		LJMUHeightWindow& operator=(const LJMUHeightWindow&) = delete;
+
+		//--------PUBLIC METHODS-------------------------------------------------------------
+		int				getFirstRow() const { return this->_first_row; }
+		int				getRowCount() const { return this->_row_count; }
+		bool			hasRow(int pi) const { return pi >= this->_first_row && pi < this->_first_row + this->_row_count; }
+
+		// Raw samples of row pi, which must be inside the window
+		const uint16_t*	getRow(int pi) const { return this->_samples + (size_t)(pi - this->_first_row) * this->_length; }
+
+	private:
+		friend class LJMUMappedHeightmap;
+
+		LJMUHeightWindow(void* pview, const uint16_t* psamples, int pfirstrow, int prowcount, int plength);
+
+		//--------CLASS MEMBERS--------------------------------------------------------------
+		void*			_view;
+		const uint16_t*	_samples;
+		int				_first_row;
+		int				_row_count;
+		int				_length;
+	};
+
+	typedef std::shared_ptr<const LJMUHeightWindow> LJMUHeightWindowPtr;
+
+	/////////////////////////
+	// Read-only view of a raw
+	// 16-bit heightmap file
+	// (.r16), laid out
+	// [i * length + j] like
+	// LJMUHeightmap. Opening only
+	// maps the file, rows are
+	// mapped a window at a time
+	// when first touched and the
+	// OS pages them in on demand,
+	// so maps larger than memory
+	// or the address space work.
+	// Only the most recently used
+	// windows stay mapped.
+	/////////////////////////
+	class LJMUMappedHeightmap
+	{
+	public:
+		//--------CONSTRUCTORS/DESTRUCTORS----------------------------------------------------
+		LJMUMappedHeightmap(size_t pwindowbytes = 16 * 1024 * 1024, int pmaxwindows = 16);
+		~LJMUMappedHeightmap();
+
+		LJMUMappedHeightmap(const LJMUMappedHeightmap&) = delete;
+		LJMUMappedHeightmap& operator=(const LJMUMappedHeightmap&) = delete;
+
+		//--------PUBLIC METHODS-------------------------------------------------------------
+		// Fails if the file cannot be opened or holds fewer than pwidth * plength samples
+		bool			open(const std::string& pfilename, int pwidth, int plength);
+		void			close();
+
+		bool			isOpen() const { return this->_mapping != nullptr; }
+		int				getWidth() const { return this->_width; }
+		int				getLength() const { return this->_length; }
+		int				getRowsPerWindow() const { return this->_rows_per_window; }
+
+		// Window holding row pi, mapping it if needed. Null if pi is out of range or mapping fails.
+		LJMUHeightWindowPtr	getWindow(int pi);
+
+		// Single raw sample, 0 if it cannot be read. Use windows for anything in bulk.
+		uint16_t		getSample(int pi, int pj);
+
+		// Copies rows [pi, pi + pcount) into pout, pcount * length samples
+		bool			readRows(int pi, int pcount, uint16_t* pout);
+
+	private:
+		//-------------HELPER METHODS--------------------------------------------------
+		LJMUHeightWindowPtr	mapWindow(int pwindow);
+
+		//--------CLASS MEMBERS--------------------------------------------------------------
+		void*							_file;
+		void*							_mapping;
+		int								_width;
+		int								_length;
+		size_t							_window_bytes;
+		int								_max_windows;
+		int								_rows_per_window;
+		uint32_t						_granularity;
+		std::vector<LJMUHeightWindowPtr>	_list_windows;		//Indexed by window, null when not mapped
+		std::deque<int>					_list_resident;		//Mapped windows, least recently used first
+		std::mutex						_mutex;
+	};
+}
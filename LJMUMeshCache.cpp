@@ -0,0 +1,100 @@
+#include "LJMUMeshCache.h"
+
+#include <cstring>
+
+using namespace LJMUDX;
+
+///////////////////////////
+// Constructor
+///////////////////////////
+LJMUMeshCache::LJMUMeshCache() :
+	_hits(0),
+	_misses(0)
+{
+}
+
+///////////////////////////
+// Count the Live Meshes and
+// their Handles
+///////////////////////////
+LJMUMeshCacheStats LJMUMeshCache::getStats() const
+{
+	LJMUMeshCacheStats tstats = {};
+	uint64_t ttriangles = 0;
+	uint64_t tvertices = 0;
+
+	std::lock_guard<std::mutex> tlock(this->_mutex);
+	tstats.hits = this->_hits;
+	tstats.misses = this->_misses;
+
+	for (const auto& tpair : this->_list_entries)
+	{
+		const Entry& tentry = tpair.second;
+		long treferences = tentry.mesh.use_count();
+		if (treferences == 0)
+			continue;
+
+		size_t tbytes = tentry.vertex_bytes + tentry.index_bytes;
+		tstats.meshes++;
+		tstats.references += (int)treferences;
+		tstats.vertex_bytes += tentry.vertex_bytes;
+		tstats.index_bytes += tentry.index_bytes;
+		tstats.unshared_bytes += tbytes * (size_t)treferences;
+
+		tstats.cache.before.transforms += tentry.report.before.transforms;
+		tstats.cache.after.transforms += tentry.report.after.transforms;
+		ttriangles += tentry.triangles;
+		tvertices += tentry.vertices;
+	}
+
+	//Totals over every mesh, not the mean of each mesh's ratios
+	if (ttriangles > 0)
+	{
+		tstats.cache.before.acmr = (float)tstats.cache.before.transforms / (float)ttriangles;
+		tstats.cache.after.acmr = (float)tstats.cache.after.transforms / (float)ttriangles;
+		tstats.cache.before.atvr = (float)tstats.cache.before.transforms / (float)tvertices;
+		tstats.cache.after.atvr = (float)tstats.cache.after.transforms / (float)tvertices;
+	}
+	return tstats;
+}
+
+///////////////////////////
+// Drop Entries whose Mesh
+// has been Released
+///////////////////////////
+void LJMUMeshCache::purge()
+{
+	std::lock_guard<std::mutex> tlock(this->_mutex);
+	for (auto it = this->_list_entries.begin(); it != this->_list_entries.end();)
+	{
+		if (it->second.mesh.expired())
+			it = this->_list_entries.erase(it);
+		else
+			++it;
+	}
+}
+
+///////////////////////////
+// Key from the Generator,
+// Format and the exact Bits of
+// each Parameter
+///////////////////////////
+std::string LJMUMeshCache::makeKey(const std::string& pgenerator, const std::vector<float>& pparams, const char* pformat)
+{
+	static const char HEX[] = "0123456789abcdef";
+
+	std::string tkey = pgenerator;
+	tkey += '|';
+	tkey += pformat;
+
+	for (float tparam : pparams)
+	{
+		uint32_t tbits;
+		std::memcpy(&tbits, &tparam, sizeof(tbits));
+
+		tkey += '|';
+		for (int s = 28; s >= 0; s -= 4)
+			tkey += HEX[(tbits >> s) & 0xF];
+	}
+	return tkey;
+}
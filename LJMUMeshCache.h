@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#include "DrawIndexedExecutorDX11.h"
+#include "LJMUMeshOptimizer.h"
+
+namespace LJMUDX
+{
+	/////////////////////////
+	// What a mesh cache holds and
+	// how often it was asked
+	/////////////////////////
+	struct LJMUMeshCacheStats
+	{
+		int						meshes;				//Live meshes, each built once
+		int						references;			//Handles held to them
+		uint64_t				hits;
+		uint64_t				misses;
+		size_t					vertex_bytes;
+		size_t					index_bytes;
+		size_t					unshared_bytes;		//What the handles would take with a copy each
+		LJMUMeshOptimizeReport	cache;				//Vertex cache use of the live meshes, as generated and as drawn
+	};
+
+	/////////////////////////
+	// Shares indexed meshes built
+	// by the same generator with
+	// the same parameters and
+	// vertex format. Every mesh
+	// goes through LJMUMeshOptimizer
+	// once, when it is built.
+	//
+	// The cache only keeps weak
+	// references, so a mesh lives
+	// while anything holds its
+	// handle and is built again on
+	// the next request after the
+	// last one lets go. A handle's
+	// use count is the mesh's
+	// reference count.
+	/////////////////////////
+	class LJMUMeshCache
+	{
+	public:
+		//--------HELPER TYPES---------------------------------------------------------------
+		template<class TFormat>
+		using MeshPtr = std::shared_ptr<Glyph3::DrawIndexedExecutorDX11<typename TFormat::Vertex>>;
+
+		template<class TFormat>
+		using BuildFunc = std::function<void(std::vector<typename TFormat::Vertex>&, std::vector<uint32_t>&)>;
+
+		//--------CONSTRUCTORS/DESTRUCTORS----------------------------------------------------
+		LJMUMeshCache();
+
+		LJMUMeshCache(const LJMUMeshCache&) = delete;
+		LJMUMeshCache& operator=(const LJMUMeshCache&) = delete;
+
+		//--------PUBLIC METHODS-------------------------------------------------------------
+		// TFormat is a vertex layout class such as BasicVertexDX11, giving Vertex, Elements and
+		// GetElementCount. pgenerator and pparams name the geometry, and on a miss pbuild fills
+		// in its vertices and triangle list. pbuild runs under the cache's lock, so it must not
+		// call back into the cache.
+		template<class TFormat>
+		MeshPtr<TFormat>	get(const std::string& pgenerator, const std::vector<float>& pparams,
+								const BuildFunc<TFormat>& pbuild);
+
+		LJMUMeshCacheStats	getStats() const;
+		void				purge();						//Forgets meshes nothing holds any more
+
+	private:
+		//-------------HELPER TYPES----------------------------------------------------
+		struct Entry
+		{
+			std::weak_ptr<void>		mesh;
+			size_t					vertex_bytes;
+			size_t					index_bytes;
+			uint32_t				vertices;
+			uint32_t				triangles;
+			LJMUMeshOptimizeReport	report;
+		};
+
+		//-------------HELPER METHODS--------------------------------------------------
+		static std::string	makeKey(const std::string& pgenerator, const std::vector<float>& pparams, const char* pformat);
+
+		//--------CLASS MEMBERS--------------------------------------------------------------
+		std::map<std::string, Entry>	_list_entries;
+		uint64_t						_hits;
+		uint64_t						_misses;
+		mutable std::mutex				_mutex;
+	};
+
+	///////////////////////////
+	// Shared Mesh for the Key,
+	// Building it on a Miss
+	///////////////////////////
+	template<class TFormat>
+	LJMUMeshCache::MeshPtr<TFormat> LJMUMeshCache::get(const std::string& pgenerator, const std::vector<float>& pparams,
+		const BuildFunc<TFormat>& pbuild)
+	{
+		typedef typename TFormat::Vertex TVertex;
+		typedef Glyph3::DrawIndexedExecutorDX11<TVertex> TMesh;
+
+		std::string tkey = makeKey(pgenerator, pparams, typeid(TFormat).name());
+
+		std::lock_guard<std::mutex> tlock(this->_mutex);
+		Entry& tentry = this->_list_entries[tkey];
+		std::shared_ptr<void> tshared = tentry.mesh.lock();
+		if (tshared)
+		{
+			this->_hits++;
+			return std::static_pointer_cast<TMesh>(tshared);
+		}
+		this->_misses++;
+
+		std::vector<TVertex> tvertices;
+		std::vector<uint32_t> tindices;
+		pbuild(tvertices, tindices);
+		LJMUMeshOptimizeReport treport = LJMUMeshOptimizer::optimize(tvertices, tindices);
+
+		auto tmesh = std::make_shared<TMesh>();
+		tmesh->SetLayoutElements(TFormat::GetElementCount(), TFormat::Elements);
+		tmesh->SetPrimitiveType(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+		tmesh->SetMaxVertexCount((unsigned int)tvertices.size());
+		tmesh->SetMaxIndexCount((unsigned int)tindices.size());
+
+		for (const auto& tvertex : tvertices)
+			tmesh->AddVertex(tvertex);
+
+		for (size_t i = 0; i + 2 < tindices.size(); i += 3)
+			tmesh->AddIndices(tindices[i], tindices[i + 1], tindices[i + 2]);
+
+		tentry.mesh = tmesh;
+		tentry.vertex_bytes = tvertices.size() * sizeof(TVertex);
+		tentry.index_bytes = tindices.size() * sizeof(uint32_t);
+		tentry.vertices = (uint32_t)tvertices.size();
+		tentry.triangles = (uint32_t)(tindices.size() / 3);
+		tentry.report = treport;
+		return tmesh;
+	}
+}
@@ -0,0 +1,324 @@
+#include "LJMUMeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace LJMUDX;
+using namespace Glyph3;
+
+namespace
+{
+	const uint32_t UNMAPPED = 0xFFFFFFFFu;
+
+	/////////////////////////
+	// FIFO cache over time stamps.
+	// A miss stamps the vertex with
+	// the miss count, so it stays
+	// in while fewer than size
+	// misses have come after it.
+	/////////////////////////
+	class FifoCache
+	{
+	public:
+		FifoCache(size_t pvertexcount, int psize) :
+			_stamps(pvertexcount, 0),
+			_size((uint32_t)std::max(psize, 1)),
+			_misses(_size)
+		{
+		}
+
+		// True on a miss
+		bool		touch(uint32_t pvertex)
+		{
+			if (this->_misses - this->_stamps[pvertex] < this->_size)
+				return false;
+			this->_stamps[pvertex] = ++this->_misses;
+			return true;
+		}
+
+		void		flush() { this->_misses += this->_size; }
+
+	private:
+		std::vector<uint32_t>	_stamps;
+		uint32_t				_size;
+		uint32_t				_misses;
+	};
+
+	/////////////////////////
+	// Area weighted centre and
+	// normal of a run of triangles
+	/////////////////////////
+	struct ClusterShape
+	{
+		Vector3f	centre;
+		Vector3f	normal;
+		float		area;
+	};
+
+	///////////////////////////
+	// Sum the Triangles of
+	// [pfirst, plast)
+	///////////////////////////
+	ClusterShape measureCluster(const std::vector<uint32_t>& pindices, const std::vector<Vector3f>& ppositions,
+		size_t pfirst, size_t plast)
+	{
+		ClusterShape tshape = { Vector3f(0, 0, 0), Vector3f(0, 0, 0), 0.0f };
+		for (size_t t = pfirst; t < plast; t++)
+		{
+			const Vector3f& ta = ppositions[pindices[t * 3 + 0]];
+			const Vector3f& tb = ppositions[pindices[t * 3 + 1]];
+			const Vector3f& tc = ppositions[pindices[t * 3 + 2]];
+
+			Vector3f tcross = (tb - ta).Cross(tc - ta);
+			float tarea = std::sqrt(tcross.Dot(tcross)) * 0.5f;
+
+			tshape.normal = tshape.normal + tcross;
+			tshape.centre = tshape.centre + (ta + tb + tc) * (tarea / 3.0f);
+			tshape.area += tarea;
+		}
+		return tshape;
+	}
+}
+
+///////////////////////////
+// Simulate the Cache over the
+// Index List
+///////////////////////////
+LJMUVertexCacheStats LJMUMeshOptimizer::analyzeVertexCache(const std::vector<uint32_t>& pindices, size_t pvertexcount,
+	int pcachesize)
+{
+	LJMUVertexCacheStats tstats = { 0, 0.0f, 0.0f };
+	if (pindices.size() < 3)
+		return tstats;
+
+	FifoCache tcache(pvertexcount, pcachesize);
+	std::vector<uint8_t> tused(pvertexcount, 0);
+	uint32_t tunique = 0;
+
+	for (uint32_t tindex : pindices)
+	{
+		if (tcache.touch(tindex))
+			tstats.transforms++;
+		if (!tused[tindex])
+		{
+			tused[tindex] = 1;
+			tunique++;
+		}
+	}
+
+	tstats.acmr = (float)tstats.transforms / (float)(pindices.size() / 3);
+	tstats.atvr = (float)tstats.transforms / (float)tunique;
+	return tstats;
+}
+
+///////////////////////////
+// Tipsify
+///////////////////////////
+void LJMUMeshOptimizer::optimizeVertexCache(std::vector<uint32_t>& pindices, size_t pvertexcount, int pcachesize,
+	std::vector<uint32_t>* pclusters)
+{
+	if (pclusters)
+		pclusters->clear();
+
+	size_t ttricount = pindices.size() / 3;
+	if (ttricount == 0)
+		return;
+
+	//Triangles around each vertex, and how many of them are still to be emitted
+	std::vector<uint32_t> tlive(pvertexcount, 0);
+	for (size_t i = 0; i < ttricount * 3; i++)
+		tlive[pindices[i]]++;
+
+	std::vector<uint32_t> tfirst(pvertexcount + 1, 0);
+	for (size_t v = 0; v < pvertexcount; v++)
+		tfirst[v + 1] = tfirst[v] + tlive[v];
+
+	std::vector<uint32_t> tadjacent(ttricount * 3);
+	std::vector<uint32_t> tfill(tfirst.begin(), tfirst.end() - 1);
+	for (size_t i = 0; i < ttricount * 3; i++)
+		tadjacent[tfill[pindices[i]]++] = (uint32_t)(i / 3);
+
+	//Time stamps start a whole cache behind, so every vertex misses on first use
+	uint32_t tcachesize = (uint32_t)std::max(pcachesize, 1);
+	uint32_t ttime = tcachesize + 1;
+	std::vector<uint32_t> tstamps(pvertexcount, 0);
+
+	std::vector<uint8_t> temitted(ttricount, 0);
+	std::vector<uint32_t> tdeadend;
+	std::vector<uint32_t> tcandidates;
+	std::vector<uint32_t> tout;
+	tout.reserve(ttricount * 3);
+	tdeadend.reserve(ttricount * 3);
+
+	size_t tcursor = 0;
+	uint32_t tfan = pindices[0];
+	if (pclusters)
+		pclusters->push_back(0);
+
+	for (;;)
+	{
+		tcandidates.clear();
+		for (uint32_t a = tfirst[tfan]; a < tfirst[tfan + 1]; a++)
+		{
+			uint32_t ttri = tadjacent[a];
+			if (temitted[ttri])
+				continue;
+
+			for (int c = 0; c < 3; c++)
+			{
+				uint32_t tv = pindices[ttri * 3 + c];
+				tout.push_back(tv);
+				tdeadend.push_back(tv);
+				tcandidates.push_back(tv);
+				tlive[tv]--;
+				if (ttime - tstamps[tv] > tcachesize)
+					tstamps[tv] = ttime++;
+			}
+			temitted[ttri] = 1;
+		}
+
+		//Fan next round the oldest candidate still in the cache once its triangles are added
+		int64_t tbest = -1;
+		int64_t tbestpriority = -1;
+		for (uint32_t tv : tcandidates)
+		{
+			if (tlive[tv] == 0)
+				continue;
+
+			int64_t tage = (int64_t)ttime - tstamps[tv];
+			int64_t tpriority = (tage + 2 * (int64_t)tlive[tv] <= (int64_t)tcachesize) ? tage : 0;
+			if (tpriority > tbestpriority)
+			{
+				tbest = tv;
+				tbestpriority = tpriority;
+			}
+		}
+
+		if (tbest < 0)
+		{
+			//Dead end, back up through the recent vertices, then scan for any left at all
+			while (!tdeadend.empty() && tbest < 0)
+			{
+				uint32_t tv = tdeadend.back();
+				tdeadend.pop_back();
+				if (tlive[tv] > 0)
+					tbest = tv;
+			}
+			while (tbest < 0 && tcursor < pvertexcount)
+			{
+				if (tlive[tcursor] > 0)
+					tbest = (int64_t)tcursor;
+				else
+					tcursor++;
+			}
+			if (tbest < 0)
+				break;
+
+			//Only a fan round a vertex gone from the cache starts cold enough to be a cluster
+			if (pclusters && ttime - tstamps[tbest] > tcachesize)
+				pclusters->push_back((uint32_t)(tout.size() / 3));
+		}
+		tfan = (uint32_t)tbest;
+	}
+
+	pindices.swap(tout);
+}
+
+///////////////////////////
+// Split the Tipsify Clusters
+// and Sort them Outside In
+///////////////////////////
+void LJMUMeshOptimizer::optimizeOverdraw(std::vector<uint32_t>& pindices, const std::vector<Vector3f>& ppositions,
+	float pthreshold, int pcachesize)
+{
+	std::vector<uint32_t> thard;
+	optimizeVertexCache(pindices, ppositions.size(), pcachesize, &thard);
+
+	size_t ttricount = pindices.size() / 3;
+	if (ttricount == 0)
+		return;
+
+	float ttarget = analyzeVertexCache(pindices, ppositions.size(), pcachesize).acmr * pthreshold;
+	thard.push_back((uint32_t)ttricount);
+
+	//A cluster ends once its own ACMR, from an empty cache, comes down to the target
+	std::vector<uint32_t> tclusters;
+	FifoCache tcache(ppositions.size(), pcachesize);
+	for (size_t h = 0; h + 1 < thard.size(); h++)
+	{
+		size_t tstart = thard[h];
+		size_t tend = thard[h + 1];
+		uint32_t tmisses = 0;
+
+		tclusters.push_back((uint32_t)tstart);
+		tcache.flush();
+		for (size_t t = tstart; t < tend; t++)
+		{
+			for (int c = 0; c < 3; c++)
+				tmisses += tcache.touch(pindices[t * 3 + c]) ? 1 : 0;
+
+			if (t + 1 < tend && (float)tmisses <= ttarget * (float)(t + 1 - tclusters.back()))
+			{
+				tclusters.push_back((uint32_t)(t + 1));
+				tcache.flush();
+				tmisses = 0;
+			}
+		}
+
+		//A tail that never came down runs on warm from the cluster before it instead
+		if (tclusters.back() != tstart && (float)tmisses > ttarget * (float)(tend - tclusters.back()))
+			tclusters.pop_back();
+	}
+	tclusters.push_back((uint32_t)ttricount);
+
+	//Clusters facing furthest out from the centre first
+	ClusterShape tmesh = measureCluster(pindices, ppositions, 0, ttricount);
+	Vector3f tmeshcentre = tmesh.area > 0.0f ? tmesh.centre * (1.0f / tmesh.area) : Vector3f(0, 0, 0);
+
+	size_t tclustercount = tclusters.size() - 1;
+	std::vector<float> tkeys(tclustercount, 0.0f);
+	for (size_t k = 0; k < tclustercount; k++)
+	{
+		ClusterShape tshape = measureCluster(pindices, ppositions, tclusters[k], tclusters[k + 1]);
+		float tlength = std::sqrt(tshape.normal.Dot(tshape.normal));
+		if (tshape.area > 0.0f && tlength > 0.0f)
+			tkeys[k] = (tshape.centre * (1.0f / tshape.area) - tmeshcentre).Dot(tshape.normal) / tlength;
+	}
+
+	std::vector<uint32_t> torder(tclustercount);
+	for (size_t k = 0; k < tclustercount; k++)
+		torder[k] = (uint32_t)k;
+	std::stable_sort(torder.begin(), torder.end(), [&](uint32_t pa, uint32_t pb) { return tkeys[pa] > tkeys[pb]; });
+
+	std::vector<uint32_t> tout;
+	tout.reserve(pindices.size());
+	for (uint32_t k : torder)
+		tout.insert(tout.end(), pindices.begin() + tclusters[k] * 3, pindices.begin() + tclusters[k + 1] * 3);
+
+	//Sorting loses the warm cache between clusters, so keep the Tipsify order if that costs too much
+	if (analyzeVertexCache(tout, ppositions.size(), pcachesize).acmr <= ttarget)
+		pindices.swap(tout);
+}
+
+///////////////////////////
+// Number the Vertices by First
+// Use
+///////////////////////////
+void LJMUMeshOptimizer::buildFetchRemap(const std::vector<uint32_t>& pindices, size_t pvertexcount,
+	std::vector<uint32_t>& premap)
+{
+	premap.assign(pvertexcount, UNMAPPED);
+
+	uint32_t tnext = 0;
+	for (uint32_t tindex : pindices)
+	{
+		if (premap[tindex] == UNMAPPED)
+			premap[tindex] = tnext++;
+	}
+
+	for (uint32_t& tslot : premap)
+	{
+		if (tslot == UNMAPPED)
+			tslot = tnext++;
+	}
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Vector3f.h"
+
+namespace LJMUDX
+{
+	/////////////////////////
+	// Vertex shader runs an index
+	// list costs, from a FIFO
+	// post-transform cache
+	/////////////////////////
+	struct LJMUVertexCacheStats
+	{
+		uint32_t	transforms;		//Cache misses, each one a vertex shader run
+		float		acmr;			//Transforms per triangle, 0.5 at best
+		float		atvr;			//Transforms per vertex used, 1 at best
+	};
+
+	/////////////////////////
+	// Cache use of an index list
+	// before and after optimising
+	/////////////////////////
+	struct LJMUMeshOptimizeReport
+	{
+		LJMUVertexCacheStats	before;
+		LJMUVertexCacheStats	after;
+	};
+
+	/////////////////////////
+	// Reorders indexed triangle
+	// lists for the GPU, keeping
+	// every triangle's winding.
+	//
+	// optimizeVertexCache is
+	// Tipsify: it fans round one
+	// vertex at a time, picking the
+	// next vertex to fan round
+	// from those just used that
+	// are still in the cache.
+	// Where it has to go back to a
+	// vertex that has left the
+	// cache it starts a new
+	// cluster.
+	//
+	// optimizeOverdraw cuts those
+	// clusters smaller, while the
+	// cache misses stay within a
+	// threshold of the Tipsify
+	// order, and draws first the
+	// clusters facing furthest
+	// out from the mesh's centre,
+	// which are the likeliest to
+	// hide the rest.
+	//
+	// optimizeVertexFetch moves
+	// the vertices into the order
+	// the indices first use them.
+	/////////////////////////
+	class LJMUMeshOptimizer
+	{
+	public:
+		//--------PUBLIC METHODS-------------------------------------------------------------
+		static const int	CACHE_SIZE = 16;
+
+		static LJMUVertexCacheStats	analyzeVertexCache(const std::vector<uint32_t>& pindices, size_t pvertexcount,
+										int pcachesize = CACHE_SIZE);
+
+		// pclusters, when given, receives the first triangle of each cluster
+		static void		optimizeVertexCache(std::vector<uint32_t>& pindices, size_t pvertexcount,
+							int pcachesize = CACHE_SIZE, std::vector<uint32_t>* pclusters = nullptr);
+
+		// Runs optimizeVertexCache first. pthreshold bounds the ACMR against the Tipsify
+		// order's, 1 keeps its clusters whole.
+		static void		optimizeOverdraw(std::vector<uint32_t>& pindices, const std::vector<Glyph3::Vector3f>& ppositions,
+							float pthreshold = 1.05f, int pcachesize = CACHE_SIZE);
+
+		// premap[old vertex] = new vertex, first use first, unused vertices at the end
+		static void		buildFetchRemap(const std::vector<uint32_t>& pindices, size_t pvertexcount,
+							std::vector<uint32_t>& premap);
+
+		template<class TVertex>
+		static void		optimizeVertexFetch(std::vector<TVertex>& pvertices, std::vector<uint32_t>& pindices);
+
+		// All three in turn, over vertices with a position member
+		template<class TVertex>
+		static LJMUMeshOptimizeReport	optimize(std::vector<TVertex>& pvertices, std::vector<uint32_t>& pindices,
+											float pthreshold = 1.05f);
+	};
+
+	///////////////////////////
+	// Reorder the Vertices and
+	// Renumber the Indices
+	///////////////////////////
+	template<class TVertex>
+	void LJMUMeshOptimizer::optimizeVertexFetch(std::vector<TVertex>& pvertices, std::vector<uint32_t>& pindices)
+	{
+		std::vector<uint32_t> tremap;
+		buildFetchRemap(pindices, pvertices.size(), tremap);
+
+		std::vector<TVertex> tordered(pvertices.size());
+		for (size_t v = 0; v < pvertices.size(); v++)
+			tordered[tremap[v]] = pvertices[v];
+		pvertices.swap(tordered);
+
+		for (uint32_t& tindex : pindices)
+			tindex = tremap[tindex];
+	}
+
+	///////////////////////////
+	// Cache, Overdraw then Fetch
+	// Order
+	///////////////////////////
+	template<class TVertex>
+	LJMUMeshOptimizeReport LJMUMeshOptimizer::optimize(std::vector<TVertex>& pvertices, std::vector<uint32_t>& pindices,
+		float pthreshold)
+	{
+		LJMUMeshOptimizeReport treport;
+		treport.before = analyzeVertexCache(pindices, pvertices.size());
+
+		std::vector<Glyph3::Vector3f> tpositions;
+		tpositions.reserve(pvertices.size());
+		for (const TVertex& tvertex : pvertices)
+			tpositions.push_back(tvertex.position);
+
+		optimizeOverdraw(pindices, tpositions, pthreshold);
+		optimizeVertexFetch(pvertices, pindices);
+
+		treport.after = analyzeVertexCache(pindices, pvertices.size());
+		return treport;
+	}
+}
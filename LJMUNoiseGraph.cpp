@@ -0,0 +1,852 @@
+#include "LJMUNoiseGraph.h"
+#include "LJMUNoiseKernel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+
+using namespace LJMUDX;
+
+namespace
+{
+	// Points per chunk in evaluateSet, 16KB of floats per node result
+	const int NOISEGRAPH_SET_CHUNK = 4096;
+
+	// Shift between the octaves of a fractal node
+	const FN_DECIMAL NOISEGRAPH_OCTAVE_OFFSET = FN_DECIMAL(131.71);
+
+	const int NOISEGRAPH_VERSION = 1;
+
+	const char* const NODE_NAMES[] = { "source", "warp", "fractal", "combine", "remap", "clamp" };
+	const char* const COMBINE_NAMES[] = { "add", "sub", "mul", "min", "max", "lerp" };
+	const char* const NOISE_NAMES[] = { "Value", "ValueFractal", "Perlin", "PerlinFractal", "Simplex", "SimplexFractal",
+		"Cellular", "WhiteNoise", "Cubic", "CubicFractal" };
+	const char* const INTERP_NAMES[] = { "Linear", "Hermite", "Quintic" };
+	const char* const FRACTAL_NAMES[] = { "FBM", "Billow", "RigidMulti" };
+	const char* const DISTANCE_NAMES[] = { "Euclidean", "Manhattan", "Natural" };
+	const char* const RETURN_NAMES[] = { "CellValue", "NoiseLookup", "Distance", "Distance2", "Distance2Add",
+		"Distance2Sub", "Distance2Mul", "Distance2Div" };
+
+	typedef std::map<std::string, std::string> LJMUKeyValues;
+
+	template <int N>
+	int findName(const char* const (&pnames)[N], const std::string& pname)
+	{
+		for (int i = 0; i < N; i++)
+		{
+			if (pname == pnames[i])
+				return i;
+		}
+		return -1;
+	}
+
+	template <int N>
+	bool readName(const LJMUKeyValues& pvalues, const char* pkey, const char* const (&pnames)[N], int& pout)
+	{
+		auto tit = pvalues.find(pkey);
+		if (tit == pvalues.end())
+			return true;
+
+		pout = findName(pnames, tit->second);
+		return pout >= 0;
+	}
+
+	template <class T>
+	bool readValue(const LJMUKeyValues& pvalues, const char* pkey, T& pout)
+	{
+		auto tit = pvalues.find(pkey);
+		if (tit == pvalues.end())
+			return true;
+
+		std::istringstream tstream(tit->second);
+		tstream >> pout;
+		return !tstream.fail();
+	}
+
+	void writeNoise(std::ostream& pstream, const FastNoise& pnoise)
+	{
+		int tindex0, tindex1;
+		pnoise.GetCellularDistance2Indices(tindex0, tindex1);
+
+		pstream << " seed=" << pnoise.GetSeed()
+			<< " frequency=" << pnoise.GetFrequency()
+			<< " noise=" << NOISE_NAMES[pnoise.GetNoiseType()]
+			<< " interp=" << INTERP_NAMES[pnoise.GetInterp()]
+			<< " octaves=" << pnoise.GetFractalOctaves()
+			<< " lacunarity=" << pnoise.GetFractalLacunarity()
+			<< " gain=" << pnoise.GetFractalGain()
+			<< " fractal=" << FRACTAL_NAMES[pnoise.GetFractalType()]
+			<< " cellular_distance=" << DISTANCE_NAMES[pnoise.GetCellularDistanceFunction()]
+			<< " cellular_return=" << RETURN_NAMES[pnoise.GetCellularReturnType()]
+			<< " cellular_index0=" << tindex0
+			<< " cellular_index1=" << tindex1
+			<< " cellular_jitter=" << pnoise.GetCellularJitter()
+			<< " perturb_amp=" << pnoise.GetGradientPerturbAmp();
+	}
+
+	bool readNoise(const LJMUKeyValues& pvalues, FastNoise& pnoise)
+	{
+		int tseed = pnoise.GetSeed();
+		FN_DECIMAL tfrequency = pnoise.GetFrequency();
+		int tnoise = pnoise.GetNoiseType();
+		int tinterp = pnoise.GetInterp();
+		int toctaves = pnoise.GetFractalOctaves();
+		FN_DECIMAL tlacunarity = pnoise.GetFractalLacunarity();
+		FN_DECIMAL tgain = pnoise.GetFractalGain();
+		int tfractal = pnoise.GetFractalType();
+		int tdistance = pnoise.GetCellularDistanceFunction();
+		int treturn = pnoise.GetCellularReturnType();
+		int tindex0, tindex1;
+		pnoise.GetCellularDistance2Indices(tindex0, tindex1);
+		FN_DECIMAL tjitter = pnoise.GetCellularJitter();
+		FN_DECIMAL tamp = pnoise.GetGradientPerturbAmp();
+
+		bool tok = readValue(pvalues, "seed", tseed)
+			&& readValue(pvalues, "frequency", tfrequency)
+			&& readName(pvalues, "noise", NOISE_NAMES, tnoise)
+			&& readName(pvalues, "interp", INTERP_NAMES, tinterp)
+			&& readValue(pvalues, "octaves", toctaves)
+			&& readValue(pvalues, "lacunarity", tlacunarity)
+			&& readValue(pvalues, "gain", tgain)
+			&& readName(pvalues, "fractal", FRACTAL_NAMES, tfractal)
+			&& readName(pvalues, "cellular_distance", DISTANCE_NAMES, tdistance)
+			&& readName(pvalues, "cellular_return", RETURN_NAMES, treturn)
+			&& readValue(pvalues, "cellular_index0", tindex0)
+			&& readValue(pvalues, "cellular_index1", tindex1)
+			&& readValue(pvalues, "cellular_jitter", tjitter)
+			&& readValue(pvalues, "perturb_amp", tamp);
+
+		if (!tok)
+			return false;
+
+		pnoise.SetSeed(tseed);
+		pnoise.SetFrequency(tfrequency);
+		pnoise.SetNoiseType((FastNoise::NoiseType)tnoise);
+		pnoise.SetInterp((FastNoise::Interp)tinterp);
+		pnoise.SetFractalOctaves(toctaves);
+		pnoise.SetFractalLacunarity(tlacunarity);
+		pnoise.SetFractalGain(tgain);
+		pnoise.SetFractalType((FastNoise::FractalType)tfractal);
+		pnoise.SetCellularDistanceFunction((FastNoise::CellularDistanceFunction)tdistance);
+		pnoise.SetCellularReturnType((FastNoise::CellularReturnType)treturn);
+		pnoise.SetCellularDistance2Indices(tindex0, tindex1);
+		pnoise.SetCellularJitter(tjitter);
+		pnoise.SetGradientPerturbAmp(tamp);
+		return true;
+	}
+}
+
+///////////////////////////
+// Empty Workspace
+///////////////////////////
+LJMUNoiseGraphWorkspace::LJMUNoiseGraphWorkspace() :
+	_domain_count(0),
+	_result_count(0),
+	_is_3d(false),
+	_count(0)
+{
+
+}
+
+///////////////////////////
+// Constructor
+///////////////////////////
+LJMUNoiseGraph::LJMUNoiseGraph()
+{
+
+}
+
+///////////////////////////
+// Destructor, defined here
+// where the evaluator is
+// a complete type
+///////////////////////////
+LJMUNoiseGraph::~LJMUNoiseGraph()
+{
+
+}
+
+LJMUNoiseGraph::LJMUNoiseGraph(LJMUNoiseGraph&&) = default;
+LJMUNoiseGraph& LJMUNoiseGraph::operator=(LJMUNoiseGraph&&) = default;
+
+///////////////////////////
+// Node Constructor
+///////////////////////////
+LJMUNoiseGraph::Node::Node() :
+	type(NODE_SOURCE),
+	warp_fractal(true),
+	octaves(1),
+	lacunarity(2),
+	gain(FN_DECIMAL(0.5)),
+	fractal_type(FastNoise::FBM),
+	op(COMBINE_ADD)
+{
+	inputs[0] = inputs[1] = inputs[2] = -1;
+	range[0] = range[1] = range[2] = range[3] = 0;
+}
+
+LJMUNoiseGraph::Node::~Node() = default;
+LJMUNoiseGraph::Node::Node(Node&&) = default;
+LJMUNoiseGraph::Node& LJMUNoiseGraph::Node::operator=(Node&&) = default;
+
+///////////////////////////
+// Add a FastNoise Source
+///////////////////////////
+int LJMUNoiseGraph::addSource(const FastNoise& pnoise)
+{
+	if (pnoise.GetCellularReturnType() == FastNoise::NoiseLookup && pnoise.GetNoiseType() == FastNoise::Cellular)
+		return -1;
+
+	Node tnode;
+	tnode.type = NODE_SOURCE;
+	tnode.noise = pnoise;
+	tnode.obj_eval = LJMUNoiseEvaluator::create(pnoise);
+	return this->addNode(tnode);
+}
+
+///////////////////////////
+// Add a Domain Warp
+///////////////////////////
+int LJMUNoiseGraph::addWarp(int pinput, const FastNoise& pwarp, bool pfractal)
+{
+	if (!this->isValidInput(pinput))
+		return -1;
+
+	Node tnode;
+	tnode.type = NODE_WARP;
+	tnode.inputs[0] = pinput;
+	tnode.noise = pwarp;
+	tnode.warp_fractal = pfractal;
+	return this->addNode(tnode);
+}
+
+///////////////////////////
+// Add a Fractal over a
+// Subgraph
+///////////////////////////
+int LJMUNoiseGraph::addFractal(int pinput, int poctaves, FN_DECIMAL placunarity, FN_DECIMAL pgain, FastNoise::FractalType ptype)
+{
+	if (!this->isValidInput(pinput) || poctaves < 1)
+		return -1;
+
+	Node tnode;
+	tnode.type = NODE_FRACTAL;
+	tnode.inputs[0] = pinput;
+	tnode.octaves = poctaves;
+	tnode.lacunarity = placunarity;
+	tnode.gain = pgain;
+	tnode.fractal_type = ptype;
+
+	//Same bounding as FastNoise::CalculateFractalBounding
+	FN_DECIMAL tamp = pgain;
+	FN_DECIMAL tampfractal = 1;
+	for (int i = 1; i < poctaves; i++)
+	{
+		tampfractal += tamp;
+		tamp *= pgain;
+	}
+	tnode.range[0] = 1 / tampfractal;
+
+	return this->addNode(tnode);
+}
+
+///////////////////////////
+// Add a Combination of
+// Two Nodes
+///////////////////////////
+int LJMUNoiseGraph::addCombine(CombineOp pop, int pa, int pb, int pt)
+{
+	if (!this->isValidInput(pa) || !this->isValidInput(pb) || (pop == COMBINE_LERP && !this->isValidInput(pt)))
+		return -1;
+
+	Node tnode;
+	tnode.type = NODE_COMBINE;
+	tnode.op = pop;
+	tnode.inputs[0] = pa;
+	tnode.inputs[1] = pb;
+	tnode.inputs[2] = pop == COMBINE_LERP ? pt : -1;
+	return this->addNode(tnode);
+}
+
+///////////////////////////
+// Add a Linear Remap
+///////////////////////////
+int LJMUNoiseGraph::addRemap(int pinput, FN_DECIMAL pinmin, FN_DECIMAL pinmax, FN_DECIMAL poutmin, FN_DECIMAL poutmax)
+{
+	if (!this->isValidInput(pinput) || pinmax == pinmin)
+		return -1;
+
+	Node tnode;
+	tnode.type = NODE_REMAP;
+	tnode.inputs[0] = pinput;
+	tnode.range[0] = pinmin;
+	tnode.range[1] = pinmax;
+	tnode.range[2] = poutmin;
+	tnode.range[3] = poutmax;
+	return this->addNode(tnode);
+}
+
+///////////////////////////
+// Add a Clamp
+///////////////////////////
+int LJMUNoiseGraph::addClamp(int pinput, FN_DECIMAL pmin, FN_DECIMAL pmax)
+{
+	if (!this->isValidInput(pinput))
+		return -1;
+
+	Node tnode;
+	tnode.type = NODE_CLAMP;
+	tnode.inputs[0] = pinput;
+	tnode.range[0] = pmin;
+	tnode.range[1] = pmax;
+	return this->addNode(tnode);
+}
+
+///////////////////////////
+// Name an Output Node
+///////////////////////////
+bool LJMUNoiseGraph::setOutput(const std::string& pname, int pnode)
+{
+	if (!this->isValidInput(pnode) || pname.empty() || pname.find_first_of(" \t\r\n") != std::string::npos)
+		return false;
+
+	for (auto& toutput : this->_list_outputs)
+	{
+		if (toutput.name == pname)
+		{
+			toutput.node = pnode;
+			return true;
+		}
+	}
+
+	Output toutput = { pname, pnode };
+	this->_list_outputs.push_back(toutput);
+	return true;
+}
+
+///////////////////////////
+// Find an Output Node
+///////////////////////////
+int LJMUNoiseGraph::getOutput(const std::string& pname) const
+{
+	for (const auto& toutput : this->_list_outputs)
+	{
+		if (toutput.name == pname)
+			return toutput.node;
+	}
+	return -1;
+}
+
+///////////////////////////
+// Remove all Nodes
+///////////////////////////
+void LJMUNoiseGraph::clear()
+{
+	this->_list_nodes.clear();
+	this->_list_outputs.clear();
+}
+
+///////////////////////////
+// Evaluate Nodes over a
+// Block of Points
+///////////////////////////
+void LJMUNoiseGraph::evaluate(LJMUNoiseGraphWorkspace& pwork, const LJMUNoiseBlock& pblock,
+	const int* pnodes, int pnodecount, FN_DECIMAL* const* pout) const
+{
+	if (pblock.count <= 0)
+		return;
+
+	pwork._count = pblock.count;
+	pwork._is_3d = pblock.z != nullptr;
+	pwork._result_count = 0;
+	pwork._domain_count = 1;
+
+	if (pwork._list_domains.empty())
+		pwork._list_domains.resize(1);
+
+	//Domain 0 holds the caller's points
+	LJMUNoiseGraphWorkspace::Domain& tbase = pwork._list_domains[0];
+	tbase.parent = -1;
+	tbase.node = -1;
+	tbase.octave = 0;
+	tbase.x.assign(pblock.x, pblock.x + pblock.count);
+	tbase.y.assign(pblock.y, pblock.y + pblock.count);
+	if (pwork._is_3d)
+		tbase.z.assign(pblock.z, pblock.z + pblock.count);
+
+	for (int i = 0; i < pnodecount; i++)
+	{
+		if (!this->isValidInput(pnodes[i]))
+		{
+			std::fill(pout[i], pout[i] + pblock.count, FN_DECIMAL(0));
+			continue;
+		}
+
+		int tresult = this->evaluateNode(pwork, pnodes[i], 0);
+		const std::vector<FN_DECIMAL>& tvalues = pwork._list_results[tresult].values;
+		std::copy(tvalues.begin(), tvalues.begin() + pblock.count, pout[i]);
+	}
+}
+
+///////////////////////////
+// Fill a 2D Lattice
+///////////////////////////
+void LJMUNoiseGraph::evaluateSet(int pnode, FN_DECIMAL* pset, FN_DECIMAL pxstart, FN_DECIMAL pystart,
+	int pxsize, int pysize, FN_DECIMAL pstep) const
+{
+	if (!pset || pxsize <= 0 || pysize <= 0)
+		return;
+
+	//Per-thread workspace and point buffers, reused across calls
+	thread_local LJMUNoiseGraphWorkspace twork;
+	thread_local std::vector<FN_DECIMAL> tx;
+	thread_local std::vector<FN_DECIMAL> ty;
+
+	size_t ttotal = (size_t)pxsize * pysize;
+	for (size_t tstart = 0; tstart < ttotal; tstart += NOISEGRAPH_SET_CHUNK)
+	{
+		int tcount = (int)std::min((size_t)NOISEGRAPH_SET_CHUNK, ttotal - tstart);
+		tx.resize(tcount);
+		ty.resize(tcount);
+
+		for (int i = 0; i < tcount; i++)
+		{
+			size_t tindex = tstart + i;
+			tx[i] = pxstart + (FN_DECIMAL)(tindex / pysize) * pstep;
+			ty[i] = pystart + (FN_DECIMAL)(tindex % pysize) * pstep;
+		}
+
+		LJMUNoiseBlock tblock = { tx.data(), ty.data(), nullptr, tcount };
+		FN_DECIMAL* tout = pset + tstart;
+		this->evaluate(twork, tblock, &pnode, 1, &tout);
+	}
+}
+
+///////////////////////////
+// Append a Node
+///////////////////////////
+int LJMUNoiseGraph::addNode(Node& pnode)
+{
+	this->_list_nodes.push_back(std::move(pnode));
+	return (int)this->_list_nodes.size() - 1;
+}
+
+///////////////////////////
+// Find or Build the Domain
+// pnode makes from pparent
+///////////////////////////
+int LJMUNoiseGraph::findDomain(LJMUNoiseGraphWorkspace& pwork, int pparent, int pnode, int poctave) const
+{
+	for (int i = 1; i < pwork._domain_count; i++)
+	{
+		const LJMUNoiseGraphWorkspace::Domain& tdomain = pwork._list_domains[i];
+		if (tdomain.parent == pparent && tdomain.node == pnode && tdomain.octave == poctave)
+			return i;
+	}
+
+	int tindex = pwork._domain_count++;
+	if ((int)pwork._list_domains.size() < pwork._domain_count)
+		pwork._list_domains.resize(pwork._domain_count);
+
+	const LJMUNoiseGraphWorkspace::Domain& tsrc = pwork._list_domains[pparent];
+	LJMUNoiseGraphWorkspace::Domain& tdst = pwork._list_domains[tindex];
+	const Node& tnode = this->_list_nodes[pnode];
+	int tcount = pwork._count;
+
+	tdst.parent = pparent;
+	tdst.node = pnode;
+	tdst.octave = poctave;
+	tdst.x.assign(tsrc.x.begin(), tsrc.x.begin() + tcount);
+	tdst.y.assign(tsrc.y.begin(), tsrc.y.begin() + tcount);
+	if (pwork._is_3d)
+		tdst.z.assign(tsrc.z.begin(), tsrc.z.begin() + tcount);
+
+	if (tnode.type == NODE_WARP)
+	{
+		if (pwork._is_3d)
+		{
+			for (int i = 0; i < tcount; i++)
+			{
+				if (tnode.warp_fractal)
+					tnode.noise.GradientPerturbFractal(tdst.x[i], tdst.y[i], tdst.z[i]);
+				else
+					tnode.noise.GradientPerturb(tdst.x[i], tdst.y[i], tdst.z[i]);
+			}
+		}
+		else
+		{
+			for (int i = 0; i < tcount; i++)
+			{
+				if (tnode.warp_fractal)
+					tnode.noise.GradientPerturbFractal(tdst.x[i], tdst.y[i]);
+				else
+					tnode.noise.GradientPerturb(tdst.x[i], tdst.y[i]);
+			}
+		}
+	}
+	else
+	{
+		//Fractal octave, scaled the same way FastNoise steps its octaves
+		FN_DECIMAL tscale = 1;
+		for (int i = 0; i < poctave; i++)
+			tscale *= tnode.lacunarity;
+		FN_DECIMAL toffset = NOISEGRAPH_OCTAVE_OFFSET * poctave;
+
+		for (int i = 0; i < tcount; i++)
+		{
+			tdst.x[i] = tdst.x[i] * tscale + toffset;
+			tdst.y[i] = tdst.y[i] * tscale + toffset;
+		}
+		if (pwork._is_3d)
+		{
+			for (int i = 0; i < tcount; i++)
+				tdst.z[i] = tdst.z[i] * tscale + toffset;
+		}
+	}
+
+	return tindex;
+}
+
+///////////////////////////
+// Evaluate one Node in one
+// Domain, returns the index
+// of its cached result
+///////////////////////////
+int LJMUNoiseGraph::evaluateNode(LJMUNoiseGraphWorkspace& pwork, int pnode, int pdomain) const
+{
+	for (int i = 0; i < pwork._result_count; i++)
+	{
+		const LJMUNoiseGraphWorkspace::Result& tresult = pwork._list_results[i];
+		if (tresult.node == pnode && tresult.domain == pdomain)
+			return i;
+	}
+
+	const Node& tnode = this->_list_nodes[pnode];
+	int tcount = pwork._count;
+
+	//A warp is its input evaluated in the warped domain, no result of its own
+	if (tnode.type == NODE_WARP)
+		return this->evaluateNode(pwork, tnode.inputs[0], this->findDomain(pwork, pdomain, pnode, 0));
+
+	//Inputs first, as they may grow the result list
+	int tinputs[3] = { -1, -1, -1 };
+	if (tnode.type != NODE_SOURCE && tnode.type != NODE_FRACTAL)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			if (tnode.inputs[i] >= 0)
+				tinputs[i] = this->evaluateNode(pwork, tnode.inputs[i], pdomain);
+		}
+	}
+
+	int tindex = pwork._result_count++;
+	if ((int)pwork._list_results.size() < pwork._result_count)
+		pwork._list_results.resize(pwork._result_count);
+
+	pwork._list_results[tindex].node = pnode;
+	pwork._list_results[tindex].domain = pdomain;
+	pwork._list_results[tindex].values.resize(tcount);
+
+	switch (tnode.type)
+	{
+	case NODE_SOURCE:
+	{
+		const LJMUNoiseGraphWorkspace::Domain& tdomain = pwork._list_domains[pdomain];
+		tnode.obj_eval->getNoiseBlock(tdomain.x.data(), tdomain.y.data(), pwork._is_3d ? tdomain.z.data() : nullptr,
+			tcount, pwork._list_results[tindex].values.data());
+		break;
+	}
+	case NODE_FRACTAL:
+	{
+		FN_DECIMAL tamp = 1;
+		for (int o = 0; o < tnode.octaves; o++)
+		{
+			int tdomain = o == 0 ? pdomain : this->findDomain(pwork, pdomain, pnode, o);
+			const FN_DECIMAL* tsrc = pwork._list_results[this->evaluateNode(pwork, tnode.inputs[0], tdomain)].values.data();
+			FN_DECIMAL* tdst = pwork._list_results[tindex].values.data();
+
+			switch (tnode.fractal_type)
+			{
+			case FastNoise::Billow:
+				for (int i = 0; i < tcount; i++)
+					tdst[i] = (o == 0 ? 0 : tdst[i]) + (std::fabs(tsrc[i]) * 2 - 1) * tamp;
+				break;
+			case FastNoise::RigidMulti:
+				for (int i = 0; i < tcount; i++)
+					tdst[i] = o == 0 ? 1 - std::fabs(tsrc[i]) : tdst[i] - (1 - std::fabs(tsrc[i])) * tamp;
+				break;
+			default:
+				for (int i = 0; i < tcount; i++)
+					tdst[i] = (o == 0 ? 0 : tdst[i]) + tsrc[i] * tamp;
+				break;
+			}
+			tamp *= tnode.gain;
+		}
+
+		//FastNoise leaves rigid multi unbounded
+		if (tnode.fractal_type != FastNoise::RigidMulti)
+		{
+			FN_DECIMAL* tdst = pwork._list_results[tindex].values.data();
+			for (int i = 0; i < tcount; i++)
+				tdst[i] *= tnode.range[0];
+		}
+		break;
+	}
+	case NODE_COMBINE:
+	{
+		const FN_DECIMAL* ta = pwork._list_results[tinputs[0]].values.data();
+		const FN_DECIMAL* tb = pwork._list_results[tinputs[1]].values.data();
+		FN_DECIMAL* tdst = pwork._list_results[tindex].values.data();
+
+		switch (tnode.op)
+		{
+		case COMBINE_ADD:
+			for (int i = 0; i < tcount; i++)
+				tdst[i] = ta[i] + tb[i];
+			break;
+		case COMBINE_SUB:
+			for (int i = 0; i < tcount; i++)
+				tdst[i] = ta[i] - tb[i];
+			break;
+		case COMBINE_MUL:
+			for (int i = 0; i < tcount; i++)
+				tdst[i] = ta[i] * tb[i];
+			break;
+		case COMBINE_MIN:
+			for (int i = 0; i < tcount; i++)
+				tdst[i] = std::min(ta[i], tb[i]);
+			break;
+		case COMBINE_MAX:
+			for (int i = 0; i < tcount; i++)
+				tdst[i] = std::max(ta[i], tb[i]);
+			break;
+		case COMBINE_LERP:
+		{
+			const FN_DECIMAL* tt = pwork._list_results[tinputs[2]].values.data();
+			for (int i = 0; i < tcount; i++)
+				tdst[i] = ta[i] + tt[i] * (tb[i] - ta[i]);
+			break;
+		}
+		}
+		break;
+	}
+	case NODE_REMAP:
+	{
+		const FN_DECIMAL* tsrc = pwork._list_results[tinputs[0]].values.data();
+		FN_DECIMAL* tdst = pwork._list_results[tindex].values.data();
+		FN_DECIMAL tscale = (tnode.range[3] - tnode.range[2]) / (tnode.range[1] - tnode.range[0]);
+		FN_DECIMAL toffset = tnode.range[2] - tnode.range[0] * tscale;
+
+		for (int i = 0; i < tcount; i++)
+			tdst[i] = tsrc[i] * tscale + toffset;
+		break;
+	}
+	case NODE_CLAMP:
+	{
+		const FN_DECIMAL* tsrc = pwork._list_results[tinputs[0]].values.data();
+		FN_DECIMAL* tdst = pwork._list_results[tindex].values.data();
+
+		for (int i = 0; i < tcount; i++)
+			tdst[i] = std::min(std::max(tsrc[i], tnode.range[0]), tnode.range[1]);
+		break;
+	}
+	default:
+		break;
+	}
+
+	return tindex;
+}
+
+///////////////////////////
+// Write the Graph as Text,
+// one node per line in
+// evaluation order
+///////////////////////////
+bool LJMUNoiseGraph::save(std::ostream& pstream) const
+{
+	std::streamsize tprecision = pstream.precision(std::numeric_limits<FN_DECIMAL>::max_digits10);
+
+	pstream << "noisegraph " << NOISEGRAPH_VERSION << "\n";
+
+	for (const auto& tnode : this->_list_nodes)
+	{
+		pstream << NODE_NAMES[tnode.type];
+
+		switch (tnode.type)
+		{
+		case NODE_SOURCE:
+			writeNoise(pstream, tnode.noise);
+			break;
+		case NODE_WARP:
+			pstream << " input=" << tnode.inputs[0] << " warp_fractal=" << (tnode.warp_fractal ? 1 : 0);
+			writeNoise(pstream, tnode.noise);
+			break;
+		case NODE_FRACTAL:
+			pstream << " input=" << tnode.inputs[0] << " octaves=" << tnode.octaves << " lacunarity=" << tnode.lacunarity
+				<< " gain=" << tnode.gain << " fractal=" << FRACTAL_NAMES[tnode.fractal_type];
+			break;
+		case NODE_COMBINE:
+			pstream << " op=" << COMBINE_NAMES[tnode.op] << " a=" << tnode.inputs[0] << " b=" << tnode.inputs[1];
+			if (tnode.op == COMBINE_LERP)
+				pstream << " t=" << tnode.inputs[2];
+			break;
+		case NODE_REMAP:
+			pstream << " input=" << tnode.inputs[0] << " in_min=" << tnode.range[0] << " in_max=" << tnode.range[1]
+				<< " out_min=" << tnode.range[2] << " out_max=" << tnode.range[3];
+			break;
+		case NODE_CLAMP:
+			pstream << " input=" << tnode.inputs[0] << " min=" << tnode.range[0] << " max=" << tnode.range[1];
+			break;
+		}
+		pstream << "\n";
+	}
+
+	for (const auto& toutput : this->_list_outputs)
+	{
+		pstream << "output " << toutput.name << " " << toutput.node << "\n";
+	}
+
+	pstream.precision(tprecision);
+	return !pstream.fail();
+}
+
+///////////////////////////
+// Read a Graph Written by
+// save, the graph is left
+// empty on failure
+///////////////////////////
+bool LJMUNoiseGraph::load(std::istream& pstream)
+{
+	this->clear();
+
+	std::string tline;
+	int tversion = 0;
+	if (!std::getline(pstream, tline) || std::sscanf(tline.c_str(), "noisegraph %d", &tversion) != 1 || tversion != NOISEGRAPH_VERSION)
+		return false;
+
+	while (std::getline(pstream, tline))
+	{
+		std::istringstream ss(tline);
+		std::string ttype;
+		if (!(ss >> ttype))
+			continue;
+
+		if (ttype == "output")
+		{
+			std::string tname;
+			int tnode = -1;
+			if (!(ss >> tname >> tnode) || !this->setOutput(tname, tnode))
+			{
+				this->clear();
+				return false;
+			}
+			continue;
+		}
+
+		LJMUKeyValues tvalues;
+		std::string ttoken;
+		while (ss >> ttoken)
+		{
+			size_t tsplit = ttoken.find('=');
+			if (tsplit != std::string::npos)
+				tvalues[ttoken.substr(0, tsplit)] = ttoken.substr(tsplit + 1);
+		}
+
+		int tresult = -1;
+		int tinput = -1;
+		readValue(tvalues, "input", tinput);
+
+		switch (findName(NODE_NAMES, ttype))
+		{
+		case NODE_SOURCE:
+		{
+			FastNoise tnoise;
+			if (readNoise(tvalues, tnoise))
+				tresult = this->addSource(tnoise);
+			break;
+		}
+		case NODE_WARP:
+		{
+			FastNoise tnoise;
+			int tfractal = 1;
+			if (readNoise(tvalues, tnoise) && readValue(tvalues, "warp_fractal", tfractal))
+				tresult = this->addWarp(tinput, tnoise, tfractal != 0);
+			break;
+		}
+		case NODE_FRACTAL:
+		{
+			int toctaves = 0;
+			FN_DECIMAL tlacunarity = 2;
+			FN_DECIMAL tgain = FN_DECIMAL(0.5);
+			int tfractal = FastNoise::FBM;
+			if (readValue(tvalues, "octaves", toctaves) && readValue(tvalues, "lacunarity", tlacunarity)
+				&& readValue(tvalues, "gain", tgain) && readName(tvalues, "fractal", FRACTAL_NAMES, tfractal))
+				tresult = this->addFractal(tinput, toctaves, tlacunarity, tgain, (FastNoise::FractalType)tfractal);
+			break;
+		}
+		case NODE_COMBINE:
+		{
+			int top = -1;
+			int ta = -1;
+			int tb = -1;
+			int tt = -1;
+			if (readName(tvalues, "op", COMBINE_NAMES, top) && readValue(tvalues, "a", ta)
+				&& readValue(tvalues, "b", tb) && readValue(tvalues, "t", tt) && top >= 0)
+				tresult = this->addCombine((CombineOp)top, ta, tb, tt);
+			break;
+		}
+		case NODE_REMAP:
+		{
+			FN_DECIMAL trange[4] = { -1, 1, 0, 1 };
+			if (readValue(tvalues, "in_min", trange[0]) && readValue(tvalues, "in_max", trange[1])
+				&& readValue(tvalues, "out_min", trange[2]) && readValue(tvalues, "out_max", trange[3]))
+				tresult = this->addRemap(tinput, trange[0], trange[1], trange[2], trange[3]);
+			break;
+		}
+		case NODE_CLAMP:
+		{
+			FN_DECIMAL tmin = 0;
+			FN_DECIMAL tmax = 1;
+			if (readValue(tvalues, "min", tmin) && readValue(tvalues, "max", tmax))
+				tresult = this->addClamp(tinput, tmin, tmax);
+			break;
+		}
+		default:
+			break;
+		}
+
+		if (tresult < 0)
+		{
+			this->clear();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+///////////////////////////
+// Save to a File
+///////////////////////////
+bool LJMUNoiseGraph::saveFile(const std::string& pfilename) const
+{
+	std::ofstream tfile(pfilename, std::ios::out | std::ios::trunc);
+	if (!tfile.is_open())
+		return false;
+	return this->save(tfile);
+}
+
+///////////////////////////
+// Load from a File
+///////////////////////////
+bool LJMUNoiseGraph::loadFile(const std::string& pfilename)
+{
+	std::ifstream tfile(pfilename, std::ios::in);
+	if (!tfile.is_open())
+		return false;
+	return this->load(tfile);
+}
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FastNoise.h"
+
+namespace LJMUDX
+{
+	class LJMUNoiseEvaluator;
+
+	/////////////////////////
+	// Block of sample points,
+	// stored as separate x, y and
+	// z arrays. z is null for a
+	// 2D block.
+	/////////////////////////
+	struct LJMUNoiseBlock
+	{
+		const FN_DECIMAL*	x;
+		const FN_DECIMAL*	y;
+		const FN_DECIMAL*	z;
+		int					count;
+	};
+
+	/////////////////////////
+	// Scratch buffers for one
+	// graph evaluation. Reusing a
+	// workspace between blocks
+	// avoids reallocating the node
+	// results, one per thread.
+	/////////////////////////
+	class LJMUNoiseGraphWorkspace
+	{
+	public:
+		//--------CONSTRUCTORS/DESTRUCTORS----------------------------------------------------
+		LJMUNoiseGraphWorkspace();
+
+	private:
+		friend class LJMUNoiseGraph;
+
+		// Sample coordinates after a chain of warps and octave scales
+		struct Domain
+		{
+			int						parent;
+			int						node;
+			int						octave;
+			std::vector<FN_DECIMAL>	x;
+			std::vector<FN_DECIMAL>	y;
+			std::vector<FN_DECIMAL>	z;
+		};
+
+		// Result of one node in one domain
+		struct Result
+		{
+			int						node;
+			int						domain;
+			std::vector<FN_DECIMAL>	values;
+		};
+
+		//--------CLASS MEMBERS--------------------------------------------------------------
+		std::vector<Domain>		_list_domains;
+		std::vector<Result>		_list_results;
+		int						_domain_count;
+		int						_result_count;
+		bool					_is_3d;
+		int						_count;
+	};
+
+	/////////////////////////
+	// Small DAG of noise nodes.
+	// FastNoise objects are the
+	// sources, and warp, fractal,
+	// combine, remap and clamp
+	// nodes build on them. Nodes
+	// may only use nodes added
+	// before them, so the node
+	// order is a valid evaluation
+	// order.
+	//
+	// Whole blocks of points are
+	// evaluated at once, and each
+	// node is evaluated once per
+	// coordinate domain however
+	// many nodes or outputs use it.
+	//
+	// The graph saves to a line
+	// based text format so a bake
+	// can be reproduced exactly.
+	/////////////////////////
+	class LJMUNoiseGraph
+	{
+	public:
+		enum NodeType { NODE_SOURCE, NODE_WARP, NODE_FRACTAL, NODE_COMBINE, NODE_REMAP, NODE_CLAMP };
+		enum CombineOp { COMBINE_ADD, COMBINE_SUB, COMBINE_MUL, COMBINE_MIN, COMBINE_MAX, COMBINE_LERP };
+
+		//--------CONSTRUCTORS/DESTRUCTORS----------------------------------------------------
+		LJMUNoiseGraph();
+		~LJMUNoiseGraph();
+
+		LJMUNoiseGraph(LJMUNoiseGraph&&);
+		LJMUNoiseGraph& operator=(LJMUNoiseGraph&&);
+
+		//--------PUBLIC METHODS-------------------------------------------------------------
+		// Every add method returns the new node's index, or -1 if an input index is invalid
+
+		// Noise from pnoise.GetNoise, cellular noise lookups are not supported
+		int				addSource(const FastNoise& pnoise);
+
+		// Evaluates pinput at points moved by pwarp.GradientPerturb{Fractal}, pwarp's
+		// frequency, fractal settings and gradient perturb amp control the warp
+		int				addWarp(int pinput, const FastNoise& pwarp, bool pfractal = true);
+
+		// Sums poctaves copies of pinput at increasing frequency. Each octave is shifted
+		// by a fixed offset so octaves of the same subgraph do not line up at the origin.
+		int				addFractal(int pinput, int poctaves, FN_DECIMAL placunarity = 2, FN_DECIMAL pgain = FN_DECIMAL(0.5),
+							FastNoise::FractalType ptype = FastNoise::FBM);
+
+		// pt is only used by COMBINE_LERP, which returns pa + pt * (pb - pa)
+		int				addCombine(CombineOp pop, int pa, int pb, int pt = -1);
+
+		int				addRemap(int pinput, FN_DECIMAL pinmin, FN_DECIMAL pinmax, FN_DECIMAL poutmin, FN_DECIMAL poutmax);
+		int				addClamp(int pinput, FN_DECIMAL pmin, FN_DECIMAL pmax);
+
+		// Names a node as a graph output, renaming replaces the old node
+		bool			setOutput(const std::string& pname, int pnode);
+		int				getOutput(const std::string& pname) const;
+
+		int				getNodeCount() const { return (int)this->_list_nodes.size(); }
+		NodeType		getNodeType(int pnode) const { return this->_list_nodes[pnode].type; }
+		void			clear();
+
+		// Evaluates pnodes[0] .. pnodes[pnodecount - 1] over pblock into pout[0] .. pout[pnodecount - 1],
+		// each pblock.count long. Nodes shared between them are evaluated once.
+		void			evaluate(LJMUNoiseGraphWorkspace& pwork, const LJMUNoiseBlock& pblock,
+							const int* pnodes, int pnodecount, FN_DECIMAL* const* pout) const;
+
+		// Fills a 2D lattice with node pnode, same layout as FastNoise::GetNoiseSet
+		void			evaluateSet(int pnode, FN_DECIMAL* pset, FN_DECIMAL pxstart, FN_DECIMAL pystart,
+							int pxsize, int pysize, FN_DECIMAL pstep = 1) const;
+
+		bool			save(std::ostream& pstream) const;
+		bool			load(std::istream& pstream);
+		bool			saveFile(const std::string& pfilename) const;
+		bool			loadFile(const std::string& pfilename);
+
+	private:
+		//-------------HELPER TYPES----------------------------------------------------
+		struct Node
+		{
+			//Defined with the graph's, where the evaluator is a complete type
+			Node();
+			~Node();
+			Node(Node&&);
+			Node& operator=(Node&&);
+
+			NodeType							type;
+			int									inputs[3];
+			FastNoise							noise;
+			std::unique_ptr<LJMUNoiseEvaluator>	obj_eval;
+			bool								warp_fractal;
+			int									octaves;
+			FN_DECIMAL							lacunarity;
+			FN_DECIMAL							gain;
+			FastNoise::FractalType				fractal_type;
+			CombineOp							op;
+			FN_DECIMAL							range[4];
+		};
+
+		struct Output
+		{
+			std::string		name;
+			int				node;
+		};
+
+		//-------------HELPER METHODS--------------------------------------------------
+		bool			isValidInput(int pnode) const { return pnode >= 0 && pnode < (int)this->_list_nodes.size(); }
+		int				addNode(Node& pnode);
+
+		int				findDomain(LJMUNoiseGraphWorkspace& pwork, int pparent, int pnode, int poctave) const;
+		int				evaluateNode(LJMUNoiseGraphWorkspace& pwork, int pnode, int pdomain) const;
+
+		//--------CLASS MEMBERS--------------------------------------------------------------
+		std::vector<Node>		_list_nodes;
+		std::vector<Output>		_list_outputs;
+	};
+}
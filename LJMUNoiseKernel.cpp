@@ -0,0 +1,135 @@
+#include "LJMUNoiseKernel.h"
+
+using namespace LJMUDX;
+
+namespace
+{
+	/////////////////////////
+	// Fallback for the noise
+	// types without a kernel,
+	// evaluates a copy of the
+	// FastNoise settings
+	/////////////////////////
+	class LJMUFastNoiseEvaluator : public LJMUNoiseEvaluator
+	{
+	public:
+		explicit LJMUFastNoiseEvaluator(const FastNoise& pnoise) :
+			_noise(pnoise)
+		{
+
+		}
+
+		FN_DECIMAL getNoise(FN_DECIMAL px, FN_DECIMAL py) const override
+		{
+			return this->_noise.GetNoise(px, py);
+		}
+
+		FN_DECIMAL getNoise(FN_DECIMAL px, FN_DECIMAL py, FN_DECIMAL pz) const override
+		{
+			return this->_noise.GetNoise(px, py, pz);
+		}
+
+		void getNoiseSet(FN_DECIMAL* pset, FN_DECIMAL pxstart, FN_DECIMAL pystart,
+			int pxsize, int pysize, FN_DECIMAL pstep) const override
+		{
+			this->_noise.GetNoiseSet(pset, pxstart, pystart, pxsize, pysize, pstep);
+		}
+
+		void getNoiseSet(FN_DECIMAL* pset, FN_DECIMAL pxstart, FN_DECIMAL pystart, FN_DECIMAL pzstart,
+			int pxsize, int pysize, int pzsize, FN_DECIMAL pstep) const override
+		{
+			this->_noise.GetNoiseSet(pset, pxstart, pystart, pzstart, pxsize, pysize, pzsize, pstep);
+		}
+
+		void getNoiseBlock(const FN_DECIMAL* px, const FN_DECIMAL* py, const FN_DECIMAL* pz,
+			int pcount, FN_DECIMAL* pout) const override
+		{
+			for (int i = 0; i < pcount; i++)
+				pout[i] = pz ? this->_noise.GetNoise(px[i], py[i], pz[i]) : this->_noise.GetNoise(px[i], py[i]);
+		}
+
+	private:
+		FastNoise		_noise;
+	};
+
+	typedef std::unique_ptr<LJMUNoiseEvaluator> LJMUNoiseEvaluatorPtr;
+
+	template <FastNoise::NoiseType TNoise, FastNoise::FractalType TFractal, FastNoise::Interp TInterp>
+	LJMUNoiseEvaluatorPtr makeKernel(const FastNoise& pnoise)
+	{
+		return LJMUNoiseEvaluatorPtr(new LJMUNoiseKernelEvaluator<LJMUNoiseKernel<TNoise, TFractal, TInterp>>(pnoise));
+	}
+
+	//Value and Perlin depend on the interpolation
+	template <FastNoise::NoiseType TNoise, FastNoise::FractalType TFractal>
+	LJMUNoiseEvaluatorPtr makeInterpKernel(const FastNoise& pnoise)
+	{
+		switch (pnoise.GetInterp())
+		{
+		case FastNoise::Linear:
+			return makeKernel<TNoise, TFractal, FastNoise::Linear>(pnoise);
+		case FastNoise::Hermite:
+			return makeKernel<TNoise, TFractal, FastNoise::Hermite>(pnoise);
+		default:
+			return makeKernel<TNoise, TFractal, FastNoise::Quintic>(pnoise);
+		}
+	}
+
+	template <FastNoise::NoiseType TNoise>
+	LJMUNoiseEvaluatorPtr makeInterpFractalKernel(const FastNoise& pnoise)
+	{
+		switch (pnoise.GetFractalType())
+		{
+		case FastNoise::Billow:
+			return makeInterpKernel<TNoise, FastNoise::Billow>(pnoise);
+		case FastNoise::RigidMulti:
+			return makeInterpKernel<TNoise, FastNoise::RigidMulti>(pnoise);
+		default:
+			return makeInterpKernel<TNoise, FastNoise::FBM>(pnoise);
+		}
+	}
+
+	//Simplex and Cubic ignore the interpolation, one instantiation per fractal type is enough
+	template <FastNoise::NoiseType TNoise>
+	LJMUNoiseEvaluatorPtr makeFractalKernel(const FastNoise& pnoise)
+	{
+		switch (pnoise.GetFractalType())
+		{
+		case FastNoise::Billow:
+			return makeKernel<TNoise, FastNoise::Billow, FastNoise::Quintic>(pnoise);
+		case FastNoise::RigidMulti:
+			return makeKernel<TNoise, FastNoise::RigidMulti, FastNoise::Quintic>(pnoise);
+		default:
+			return makeKernel<TNoise, FastNoise::FBM, FastNoise::Quintic>(pnoise);
+		}
+	}
+}
+
+///////////////////////////
+// Map the FastNoise Settings
+// onto a Kernel
+///////////////////////////
+std::unique_ptr<LJMUNoiseEvaluator> LJMUNoiseEvaluator::create(const FastNoise& pnoise)
+{
+	switch (pnoise.GetNoiseType())
+	{
+	case FastNoise::Value:
+		return makeInterpKernel<FastNoise::Value, FastNoise::FBM>(pnoise);
+	case FastNoise::ValueFractal:
+		return makeInterpFractalKernel<FastNoise::ValueFractal>(pnoise);
+	case FastNoise::Perlin:
+		return makeInterpKernel<FastNoise::Perlin, FastNoise::FBM>(pnoise);
+	case FastNoise::PerlinFractal:
+		return makeInterpFractalKernel<FastNoise::PerlinFractal>(pnoise);
+	case FastNoise::Simplex:
+		return makeKernel<FastNoise::Simplex, FastNoise::FBM, FastNoise::Quintic>(pnoise);
+	case FastNoise::SimplexFractal:
+		return makeFractalKernel<FastNoise::SimplexFractal>(pnoise);
+	case FastNoise::Cubic:
+		return makeKernel<FastNoise::Cubic, FastNoise::FBM, FastNoise::Quintic>(pnoise);
+	case FastNoise::CubicFractal:
+		return makeFractalKernel<FastNoise::CubicFractal>(pnoise);
+	default:
+		return LJMUNoiseEvaluatorPtr(new LJMUFastNoiseEvaluator(pnoise));
+	}
+}
@@ -0,0 +1,692 @@
+#pragma once
+
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+#include "FastNoise.h"
+
+namespace LJMUDX
+{
+	/////////////////////////
+	// Runtime view of a noise
+	// configuration. Built by
+	// create() from the settings
+	// of a FastNoise object, so
+	// the enum based setup keeps
+	// working while the set fills
+	// run without any dispatch.
+	/////////////////////////
+	class LJMUNoiseEvaluator
+	{
+	public:
+		//--------CONSTRUCTORS/DESTRUCTORS----------------------------------------------------
+		virtual ~LJMUNoiseEvaluator() {}
+
+		//--------PUBLIC METHODS-------------------------------------------------------------
+		// Picks the kernel matching the noise type, fractal type and interpolation of pnoise.
+		// Cellular and white noise have no kernel and fall back to pnoise itself.
+		static std::unique_ptr<LJMUNoiseEvaluator> create(const FastNoise& pnoise);
+
+		virtual FN_DECIMAL	getNoise(FN_DECIMAL px, FN_DECIMAL py) const = 0;
+		virtual FN_DECIMAL	getNoise(FN_DECIMAL px, FN_DECIMAL py, FN_DECIMAL pz) const = 0;
+
+		// Same layout as FastNoise::GetNoiseSet, pset[x * pysize + y] and pset[(x * pysize + y) * pzsize + z]
+		virtual void		getNoiseSet(FN_DECIMAL* pset, FN_DECIMAL pxstart, FN_DECIMAL pystart,
+								int pxsize, int pysize, FN_DECIMAL pstep = 1) const = 0;
+		virtual void		getNoiseSet(FN_DECIMAL* pset, FN_DECIMAL pxstart, FN_DECIMAL pystart, FN_DECIMAL pzstart,
+								int pxsize, int pysize, int pzsize, FN_DECIMAL pstep = 1) const = 0;
+
+		// Evaluates pcount arbitrary points, pz may be null for 2D noise
+		virtual void		getNoiseBlock(const FN_DECIMAL* px, const FN_DECIMAL* py, const FN_DECIMAL* pz,
+								int pcount, FN_DECIMAL* pout) const = 0;
+	};
+
+	/////////////////////////
+	// Scalar helpers shared by
+	// the kernels, identical to
+	// the ones inside FastNoise
+	/////////////////////////
+	namespace LJMUNoiseMath
+	{
+		inline int			fastFloor(FN_DECIMAL f) { return (f >= 0 ? (int)f : (int)f - 1); }
+		inline FN_DECIMAL	fastAbs(FN_DECIMAL f) { return std::fabs(f); }
+		inline FN_DECIMAL	lerp(FN_DECIMAL a, FN_DECIMAL b, FN_DECIMAL t) { return a + t * (b - a); }
+		inline FN_DECIMAL	cubicLerp(FN_DECIMAL a, FN_DECIMAL b, FN_DECIMAL c, FN_DECIMAL d, FN_DECIMAL t)
+		{
+			FN_DECIMAL p = (d - c) - (a - b);
+			return t * t * t * p + t * t * ((a - b) - p) + t * (c - a) + b;
+		}
+
+		template <FastNoise::Interp TInterp>
+		inline FN_DECIMAL	interp(FN_DECIMAL t)
+		{
+			switch (TInterp)
+			{
+			case FastNoise::Hermite:
+				return t * t * (3 - 2 * t);
+			case FastNoise::Quintic:
+				return t * t * t * (t * (t * 6 - 15) + 10);
+			default:
+				return t;
+			}
+		}
+	}
+
+	/////////////////////////
+	// Noise evaluator with the
+	// noise type, fractal type and
+	// interpolation fixed at
+	// compile time. Every switch
+	// FastNoise makes per sample
+	// folds away, so getNoise can
+	// be inlined straight into a
+	// generator loop. The output
+	// matches FastNoise::GetNoise
+	// for the same settings.
+	//
+	// The lookup tables are
+	// copied, so the kernel does
+	// not depend on the FastNoise
+	// object it was built from.
+	/////////////////////////
+	template <FastNoise::NoiseType TNoise, FastNoise::FractalType TFractal = FastNoise::FBM, FastNoise::Interp TInterp = FastNoise::Quintic>
+	class LJMUNoiseKernel
+	{
+		static_assert(TNoise != FastNoise::Cellular && TNoise != FastNoise::WhiteNoise,
+			"Cellular and white noise have no kernel, use LJMUNoiseEvaluator::create");
+
+	public:
+		static const bool IS_FRACTAL = TNoise == FastNoise::ValueFractal || TNoise == FastNoise::PerlinFractal ||
+			TNoise == FastNoise::SimplexFractal || TNoise == FastNoise::CubicFractal;
+
+		//--------CONSTRUCTORS/DESTRUCTORS----------------------------------------------------
+		explicit LJMUNoiseKernel(const FastNoise& pnoise) :
+			_frequency(pnoise.GetFrequency()),
+			_octaves(pnoise.GetFractalOctaves()),
+			_lacunarity(pnoise.GetFractalLacunarity()),
+			_gain(pnoise.GetFractalGain()),
+			_bounding(pnoise.GetFractalBounding())
+		{
+			std::memcpy(this->_perm, pnoise.GetPermutation(), sizeof(this->_perm));
+			std::memcpy(this->_perm12, pnoise.GetPermutation12(), sizeof(this->_perm12));
+			std::memcpy(this->_lut_val, FastNoise::GetValueLUT(), sizeof(this->_lut_val));
+			std::memcpy(this->_lut_grad_x, FastNoise::GetGradientLUT(0), sizeof(this->_lut_grad_x));
+			std::memcpy(this->_lut_grad_y, FastNoise::GetGradientLUT(1), sizeof(this->_lut_grad_y));
+			std::memcpy(this->_lut_grad_z, FastNoise::GetGradientLUT(2), sizeof(this->_lut_grad_z));
+		}
+
+		//--------PUBLIC METHODS-------------------------------------------------------------
+		FN_DECIMAL getNoise(FN_DECIMAL px, FN_DECIMAL py) const
+		{
+			px *= this->_frequency;
+			py *= this->_frequency;
+
+			if (!IS_FRACTAL)
+				return this->single(0, px, py);
+
+			FN_DECIMAL tsum = this->firstOctave(this->single(this->_perm[0], px, py));
+			FN_DECIMAL tamp = 1;
+
+			for (int i = 1; i < this->_octaves; i++)
+			{
+				px *= this->_lacunarity;
+				py *= this->_lacunarity;
+
+				tamp *= this->_gain;
+				tsum = this->addOctave(tsum, this->single(this->_perm[i], px, py), tamp);
+			}
+
+			return this->finish(tsum);
+		}
+
+		FN_DECIMAL getNoise(FN_DECIMAL px, FN_DECIMAL py, FN_DECIMAL pz) const
+		{
+			px *= this->_frequency;
+			py *= this->_frequency;
+			pz *= this->_frequency;
+
+			if (!IS_FRACTAL)
+				return this->single(0, px, py, pz);
+
+			FN_DECIMAL tsum = this->firstOctave(this->single(this->_perm[0], px, py, pz));
+			FN_DECIMAL tamp = 1;
+
+			for (int i = 1; i < this->_octaves; i++)
+			{
+				px *= this->_lacunarity;
+				py *= this->_lacunarity;
+				pz *= this->_lacunarity;
+
+				tamp *= this->_gain;
+				tsum = this->addOctave(tsum, this->single(this->_perm[i], px, py, pz), tamp);
+			}
+
+			return this->finish(tsum);
+		}
+
+		// Lattice fills go through the FastNoise SSE2 kernels where the noise type has one,
+		// the scalar loop below only runs without SSE2
+		void getNoiseSet(FN_DECIMAL* pset, FN_DECIMAL pxstart, FN_DECIMAL pystart, int pxsize, int pysize, FN_DECIMAL pstep = 1) const
+		{
+			if (FastNoise::GetNoiseSetSSE2(this->getSetParams(), pset, pxstart, pystart, pxsize, pysize, pstep))
+				return;
+
+			for (int x = 0; x < pxsize; x++)
+			{
+				FN_DECIMAL tx = pxstart + (FN_DECIMAL)x * pstep;
+				FN_DECIMAL* trow = pset + (size_t)x * pysize;
+
+				for (int y = 0; y < pysize; y++)
+					trow[y] = this->getNoise(tx, pystart + (FN_DECIMAL)y * pstep);
+			}
+		}
+
+		void getNoiseSet(FN_DECIMAL* pset, FN_DECIMAL pxstart, FN_DECIMAL pystart, FN_DECIMAL pzstart,
+			int pxsize, int pysize, int pzsize, FN_DECIMAL pstep = 1) const
+		{
+			if (FastNoise::GetNoiseSetSSE2(this->getSetParams(), pset, pxstart, pystart, pzstart, pxsize, pysize, pzsize, pstep))
+				return;
+
+			for (int x = 0; x < pxsize; x++)
+			{
+				FN_DECIMAL tx = pxstart + (FN_DECIMAL)x * pstep;
+
+				for (int y = 0; y < pysize; y++)
+				{
+					FN_DECIMAL ty = pystart + (FN_DECIMAL)y * pstep;
+					FN_DECIMAL* trow = pset + ((size_t)x * pysize + y) * pzsize;
+
+					for (int z = 0; z < pzsize; z++)
+						trow[z] = this->getNoise(tx, ty, pzstart + (FN_DECIMAL)z * pstep);
+				}
+			}
+		}
+
+		void getNoiseBlock(const FN_DECIMAL* px, const FN_DECIMAL* py, const FN_DECIMAL* pz, int pcount, FN_DECIMAL* pout) const
+		{
+			if (pz)
+			{
+				for (int i = 0; i < pcount; i++)
+					pout[i] = this->getNoise(px[i], py[i], pz[i]);
+			}
+			else
+			{
+				for (int i = 0; i < pcount; i++)
+					pout[i] = this->getNoise(px[i], py[i]);
+			}
+		}
+
+	private:
+		//-------------HELPER METHODS--------------------------------------------------
+		FastNoise::SetParams getSetParams() const
+		{
+			FastNoise::SetParams tparams = { this->_perm, this->_perm12, TNoise, TFractal, TInterp,
+				this->_frequency, this->_octaves, this->_lacunarity, this->_gain, this->_bounding };
+			return tparams;
+		}
+
+		//-------------FRACTAL HELPERS-------------------------------------------------
+		static FN_DECIMAL firstOctave(FN_DECIMAL pnoise)
+		{
+			switch (TFractal)
+			{
+			case FastNoise::Billow:
+				return LJMUNoiseMath::fastAbs(pnoise) * 2 - 1;
+			case FastNoise::RigidMulti:
+				return 1 - LJMUNoiseMath::fastAbs(pnoise);
+			default:
+				return pnoise;
+			}
+		}
+
+		static FN_DECIMAL addOctave(FN_DECIMAL psum, FN_DECIMAL pnoise, FN_DECIMAL pamp)
+		{
+			switch (TFractal)
+			{
+			case FastNoise::Billow:
+				return psum + (LJMUNoiseMath::fastAbs(pnoise) * 2 - 1) * pamp;
+			case FastNoise::RigidMulti:
+				return psum - (1 - LJMUNoiseMath::fastAbs(pnoise)) * pamp;
+			default:
+				return psum + pnoise * pamp;
+			}
+		}
+
+		FN_DECIMAL finish(FN_DECIMAL psum) const
+		{
+			//FastNoise leaves rigid multi unbounded
+			return TFractal == FastNoise::RigidMulti ? psum : psum * this->_bounding;
+		}
+
+		//-------------BASIS NOISE-----------------------------------------------------
+		FN_DECIMAL single(unsigned char poffset, FN_DECIMAL px, FN_DECIMAL py) const
+		{
+			switch (TNoise)
+			{
+			case FastNoise::Value:
+			case FastNoise::ValueFractal:
+				return this->singleValue(poffset, px, py);
+			case FastNoise::Perlin:
+			case FastNoise::PerlinFractal:
+				return this->singlePerlin(poffset, px, py);
+			case FastNoise::Simplex:
+			case FastNoise::SimplexFractal:
+				return this->singleSimplex(poffset, px, py);
+			default:
+				return this->singleCubic(poffset, px, py);
+			}
+		}
+
+		FN_DECIMAL single(unsigned char poffset, FN_DECIMAL px, FN_DECIMAL py, FN_DECIMAL pz) const
+		{
+			switch (TNoise)
+			{
+			case FastNoise::Value:
+			case FastNoise::ValueFractal:
+				return this->singleValue(poffset, px, py, pz);
+			case FastNoise::Perlin:
+			case FastNoise::PerlinFractal:
+				return this->singlePerlin(poffset, px, py, pz);
+			case FastNoise::Simplex:
+			case FastNoise::SimplexFractal:
+				return this->singleSimplex(poffset, px, py, pz);
+			default:
+				return this->singleCubic(poffset, px, py, pz);
+			}
+		}
+
+		//-------------LATTICE LOOKUPS-------------------------------------------------
+		FN_DECIMAL valCoord(unsigned char poffset, int px, int py) const
+		{
+			return this->_lut_val[this->_perm[(px & 0xff) + this->_perm[(py & 0xff) + poffset]]];
+		}
+
+		FN_DECIMAL valCoord(unsigned char poffset, int px, int py, int pz) const
+		{
+			return this->_lut_val[this->_perm[(px & 0xff) + this->_perm[(py & 0xff) + this->_perm[(pz & 0xff) + poffset]]]];
+		}
+
+		FN_DECIMAL gradCoord(unsigned char poffset, int px, int py, FN_DECIMAL pxd, FN_DECIMAL pyd) const
+		{
+			unsigned char tlut = this->_perm12[(px & 0xff) + this->_perm[(py & 0xff) + poffset]];
+			return pxd * this->_lut_grad_x[tlut] + pyd * this->_lut_grad_y[tlut];
+		}
+
+		FN_DECIMAL gradCoord(unsigned char poffset, int px, int py, int pz, FN_DECIMAL pxd, FN_DECIMAL pyd, FN_DECIMAL pzd) const
+		{
+			unsigned char tlut = this->_perm12[(px & 0xff) + this->_perm[(py & 0xff) + this->_perm[(pz & 0xff) + poffset]]];
+			return pxd * this->_lut_grad_x[tlut] + pyd * this->_lut_grad_y[tlut] + pzd * this->_lut_grad_z[tlut];
+		}
+
+		//-------------VALUE-----------------------------------------------------------
+		FN_DECIMAL singleValue(unsigned char poffset, FN_DECIMAL px, FN_DECIMAL py) const
+		{
+			int x0 = LJMUNoiseMath::fastFloor(px);
+			int y0 = LJMUNoiseMath::fastFloor(py);
+			int x1 = x0 + 1;
+			int y1 = y0 + 1;
+
+			FN_DECIMAL xs = LJMUNoiseMath::interp<TInterp>(px - (FN_DECIMAL)x0);
+			FN_DECIMAL ys = LJMUNoiseMath::interp<TInterp>(py - (FN_DECIMAL)y0);
+
+			FN_DECIMAL xf0 = LJMUNoiseMath::lerp(this->valCoord(poffset, x0, y0), this->valCoord(poffset, x1, y0), xs);
+			FN_DECIMAL xf1 = LJMUNoiseMath::lerp(this->valCoord(poffset, x0, y1), this->valCoord(poffset, x1, y1), xs);
+
+			return LJMUNoiseMath::lerp(xf0, xf1, ys);
+		}
+
+		FN_DECIMAL singleValue(unsigned char poffset, FN_DECIMAL px, FN_DECIMAL py, FN_DECIMAL pz) const
+		{
+			int x0 = LJMUNoiseMath::fastFloor(px);
+			int y0 = LJMUNoiseMath::fastFloor(py);
+			int z0 = LJMUNoiseMath::fastFloor(pz);
+			int x1 = x0 + 1;
+			int y1 = y0 + 1;
+			int z1 = z0 + 1;
+
+			FN_DECIMAL xs = LJMUNoiseMath::interp<TInterp>(px - (FN_DECIMAL)x0);
+			FN_DECIMAL ys = LJMUNoiseMath::interp<TInterp>(py - (FN_DECIMAL)y0);
+			FN_DECIMAL zs = LJMUNoiseMath::interp<TInterp>(pz - (FN_DECIMAL)z0);
+
+			FN_DECIMAL xf00 = LJMUNoiseMath::lerp(this->valCoord(poffset, x0, y0, z0), this->valCoord(poffset, x1, y0, z0), xs);
+			FN_DECIMAL xf10 = LJMUNoiseMath::lerp(this->valCoord(poffset, x0, y1, z0), this->valCoord(poffset, x1, y1, z0), xs);
+			FN_DECIMAL xf01 = LJMUNoiseMath::lerp(this->valCoord(poffset, x0, y0, z1), this->valCoord(poffset, x1, y0, z1), xs);
+			FN_DECIMAL xf11 = LJMUNoiseMath::lerp(this->valCoord(poffset, x0, y1, z1), this->valCoord(poffset, x1, y1, z1), xs);
+
+			FN_DECIMAL yf0 = LJMUNoiseMath::lerp(xf00, xf10, ys);
+			FN_DECIMAL yf1 = LJMUNoiseMath::lerp(xf01, xf11, ys);
+
+			return LJMUNoiseMath::lerp(yf0, yf1, zs);
+		}
+
+		//-------------PERLIN----------------------------------------------------------
+		FN_DECIMAL singlePerlin(unsigned char poffset, FN_DECIMAL px, FN_DECIMAL py) const
+		{
+			int x0 = LJMUNoiseMath::fastFloor(px);
+			int y0 = LJMUNoiseMath::fastFloor(py);
+			int x1 = x0 + 1;
+			int y1 = y0 + 1;
+
+			FN_DECIMAL xd0 = px - (FN_DECIMAL)x0;
+			FN_DECIMAL yd0 = py - (FN_DECIMAL)y0;
+			FN_DECIMAL xd1 = xd0 - 1;
+			FN_DECIMAL yd1 = yd0 - 1;
+
+			FN_DECIMAL xs = LJMUNoiseMath::interp<TInterp>(xd0);
+			FN_DECIMAL ys = LJMUNoiseMath::interp<TInterp>(yd0);
+
+			FN_DECIMAL xf0 = LJMUNoiseMath::lerp(this->gradCoord(poffset, x0, y0, xd0, yd0), this->gradCoord(poffset, x1, y0, xd1, yd0), xs);
+			FN_DECIMAL xf1 = LJMUNoiseMath::lerp(this->gradCoord(poffset, x0, y1, xd0, yd1), this->gradCoord(poffset, x1, y1, xd1, yd1), xs);
+
+			return LJMUNoiseMath::lerp(xf0, xf1, ys);
+		}
+
+		FN_DECIMAL singlePerlin(unsigned char poffset, FN_DECIMAL px, FN_DECIMAL py, FN_DECIMAL pz) const
+		{
+			int x0 = LJMUNoiseMath::fastFloor(px);
+			int y0 = LJMUNoiseMath::fastFloor(py);
+			int z0 = LJMUNoiseMath::fastFloor(pz);
+			int x1 = x0 + 1;
+			int y1 = y0 + 1;
+			int z1 = z0 + 1;
+
+			FN_DECIMAL xd0 = px - (FN_DECIMAL)x0;
+			FN_DECIMAL yd0 = py - (FN_DECIMAL)y0;
+			FN_DECIMAL zd0 = pz - (FN_DECIMAL)z0;
+			FN_DECIMAL xd1 = xd0 - 1;
+			FN_DECIMAL yd1 = yd0 - 1;
+			FN_DECIMAL zd1 = zd0 - 1;
+
+			FN_DECIMAL xs = LJMUNoiseMath::interp<TInterp>(xd0);
+			FN_DECIMAL ys = LJMUNoiseMath::interp<TInterp>(yd0);
+			FN_DECIMAL zs = LJMUNoiseMath::interp<TInterp>(zd0);
+
+			FN_DECIMAL xf00 = LJMUNoiseMath::lerp(this->gradCoord(poffset, x0, y0, z0, xd0, yd0, zd0), this->gradCoord(poffset, x1, y0, z0, xd1, yd0, zd0), xs);
+			FN_DECIMAL xf10 = LJMUNoiseMath::lerp(this->gradCoord(poffset, x0, y1, z0, xd0, yd1, zd0), this->gradCoord(poffset, x1, y1, z0, xd1, yd1, zd0), xs);
+			FN_DECIMAL xf01 = LJMUNoiseMath::lerp(this->gradCoord(poffset, x0, y0, z1, xd0, yd0, zd1), this->gradCoord(poffset, x1, y0, z1, xd1, yd0, zd1), xs);
+			FN_DECIMAL xf11 = LJMUNoiseMath::lerp(this->gradCoord(poffset, x0, y1, z1, xd0, yd1, zd1), this->gradCoord(poffset, x1, y1, z1, xd1, yd1, zd1), xs);
+
+			FN_DECIMAL yf0 = LJMUNoiseMath::lerp(xf00, xf10, ys);
+			FN_DECIMAL yf1 = LJMUNoiseMath::lerp(xf01, xf11, ys);
+
+			return LJMUNoiseMath::lerp(yf0, yf1, zs);
+		}
+
+		//-------------SIMPLEX---------------------------------------------------------
+		FN_DECIMAL singleSimplex(unsigned char poffset, FN_DECIMAL px, FN_DECIMAL py) const
+		{
+			const FN_DECIMAL tsqrt3 = FN_DECIMAL(1.7320508075688772935274463415059);
+			const FN_DECIMAL tf2 = FN_DECIMAL(0.5) * (tsqrt3 - FN_DECIMAL(1.0));
+			const FN_DECIMAL tg2 = (FN_DECIMAL(3.0) - tsqrt3) / FN_DECIMAL(6.0);
+
+			FN_DECIMAL t = (px + py) * tf2;
+			int i = LJMUNoiseMath::fastFloor(px + t);
+			int j = LJMUNoiseMath::fastFloor(py + t);
+
+			t = (i + j) * tg2;
+			FN_DECIMAL x0 = px - (i - t);
+			FN_DECIMAL y0 = py - (j - t);
+
+			int i1, j1;
+			if (x0 > y0)
+			{
+				i1 = 1; j1 = 0;
+			}
+			else
+			{
+				i1 = 0; j1 = 1;
+			}
+
+			FN_DECIMAL x1 = x0 - (FN_DECIMAL)i1 + tg2;
+			FN_DECIMAL y1 = y0 - (FN_DECIMAL)j1 + tg2;
+			FN_DECIMAL x2 = x0 - 1 + 2 * tg2;
+			FN_DECIMAL y2 = y0 - 1 + 2 * tg2;
+
+			FN_DECIMAL n0, n1, n2;
+
+			t = FN_DECIMAL(0.5) - x0 * x0 - y0 * y0;
+			if (t < 0) n0 = 0;
+			else
+			{
+				t *= t;
+				n0 = t * t * this->gradCoord(poffset, i, j, x0, y0);
+			}
+
+			t = FN_DECIMAL(0.5) - x1 * x1 - y1 * y1;
+			if (t < 0) n1 = 0;
+			else
+			{
+				t *= t;
+				n1 = t * t * this->gradCoord(poffset, i + i1, j + j1, x1, y1);
+			}
+
+			t = FN_DECIMAL(0.5) - x2 * x2 - y2 * y2;
+			if (t < 0) n2 = 0;
+			else
+			{
+				t *= t;
+				n2 = t * t * this->gradCoord(poffset, i + 1, j + 1, x2, y2);
+			}
+
+			return 70 * (n0 + n1 + n2);
+		}
+
+		FN_DECIMAL singleSimplex(unsigned char poffset, FN_DECIMAL px, FN_DECIMAL py, FN_DECIMAL pz) const
+		{
+			const FN_DECIMAL tf3 = 1 / FN_DECIMAL(3);
+			const FN_DECIMAL tg3 = 1 / FN_DECIMAL(6);
+
+			FN_DECIMAL t = (px + py + pz) * tf3;
+			int i = LJMUNoiseMath::fastFloor(px + t);
+			int j = LJMUNoiseMath::fastFloor(py + t);
+			int k = LJMUNoiseMath::fastFloor(pz + t);
+
+			t = (i + j + k) * tg3;
+			FN_DECIMAL x0 = px - (i - t);
+			FN_DECIMAL y0 = py - (j - t);
+			FN_DECIMAL z0 = pz - (k - t);
+
+			int i1, j1, k1;
+			int i2, j2, k2;
+
+			if (x0 >= y0)
+			{
+				if (y0 >= z0)
+				{
+					i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 1; k2 = 0;
+				}
+				else if (x0 >= z0)
+				{
+					i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 0; k2 = 1;
+				}
+				else
+				{
+					i1 = 0; j1 = 0; k1 = 1; i2 = 1; j2 = 0; k2 = 1;
+				}
+			}
+			else
+			{
+				if (y0 < z0)
+				{
+					i1 = 0; j1 = 0; k1 = 1; i2 = 0; j2 = 1; k2 = 1;
+				}
+				else if (x0 < z0)
+				{
+					i1 = 0; j1 = 1; k1 = 0; i2 = 0; j2 = 1; k2 = 1;
+				}
+				else
+				{
+					i1 = 0; j1 = 1; k1 = 0; i2 = 1; j2 = 1; k2 = 0;
+				}
+			}
+
+			FN_DECIMAL x1 = x0 - i1 + tg3;
+			FN_DECIMAL y1 = y0 - j1 + tg3;
+			FN_DECIMAL z1 = z0 - k1 + tg3;
+			FN_DECIMAL x2 = x0 - i2 + 2 * tg3;
+			FN_DECIMAL y2 = y0 - j2 + 2 * tg3;
+			FN_DECIMAL z2 = z0 - k2 + 2 * tg3;
+			FN_DECIMAL x3 = x0 - 1 + 3 * tg3;
+			FN_DECIMAL y3 = y0 - 1 + 3 * tg3;
+			FN_DECIMAL z3 = z0 - 1 + 3 * tg3;
+
+			FN_DECIMAL n0, n1, n2, n3;
+
+			t = FN_DECIMAL(0.6) - x0 * x0 - y0 * y0 - z0 * z0;
+			if (t < 0) n0 = 0;
+			else
+			{
+				t *= t;
+				n0 = t * t * this->gradCoord(poffset, i, j, k, x0, y0, z0);
+			}
+
+			t = FN_DECIMAL(0.6) - x1 * x1 - y1 * y1 - z1 * z1;
+			if (t < 0) n1 = 0;
+			else
+			{
+				t *= t;
+				n1 = t * t * this->gradCoord(poffset, i + i1, j + j1, k + k1, x1, y1, z1);
+			}
+
+			t = FN_DECIMAL(0.6) - x2 * x2 - y2 * y2 - z2 * z2;
+			if (t < 0) n2 = 0;
+			else
+			{
+				t *= t;
+				n2 = t * t * this->gradCoord(poffset, i + i2, j + j2, k + k2, x2, y2, z2);
+			}
+
+			t = FN_DECIMAL(0.6) - x3 * x3 - y3 * y3 - z3 * z3;
+			if (t < 0) n3 = 0;
+			else
+			{
+				t *= t;
+				n3 = t * t * this->gradCoord(poffset, i + 1, j + 1, k + 1, x3, y3, z3);
+			}
+
+			return 32 * (n0 + n1 + n2 + n3);
+		}
+
+		//-------------CUBIC-----------------------------------------------------------
+		FN_DECIMAL cubicRow(unsigned char poffset, int px, int py, FN_DECIMAL pxs) const
+		{
+			return LJMUNoiseMath::cubicLerp(this->valCoord(poffset, px - 1, py), this->valCoord(poffset, px, py),
+				this->valCoord(poffset, px + 1, py), this->valCoord(poffset, px + 2, py), pxs);
+		}
+
+		FN_DECIMAL cubicRow(unsigned char poffset, int px, int py, int pz, FN_DECIMAL pxs) const
+		{
+			return LJMUNoiseMath::cubicLerp(this->valCoord(poffset, px - 1, py, pz), this->valCoord(poffset, px, py, pz),
+				this->valCoord(poffset, px + 1, py, pz), this->valCoord(poffset, px + 2, py, pz), pxs);
+		}
+
+		FN_DECIMAL cubicPlane(unsigned char poffset, int px, int py, int pz, FN_DECIMAL pxs, FN_DECIMAL pys) const
+		{
+			return LJMUNoiseMath::cubicLerp(this->cubicRow(poffset, px, py - 1, pz, pxs), this->cubicRow(poffset, px, py, pz, pxs),
+				this->cubicRow(poffset, px, py + 1, pz, pxs), this->cubicRow(poffset, px, py + 2, pz, pxs), pys);
+		}
+
+		FN_DECIMAL singleCubic(unsigned char poffset, FN_DECIMAL px, FN_DECIMAL py) const
+		{
+			const FN_DECIMAL tbounding = 1 / (FN_DECIMAL(1.5) * FN_DECIMAL(1.5));
+
+			int x1 = LJMUNoiseMath::fastFloor(px);
+			int y1 = LJMUNoiseMath::fastFloor(py);
+
+			FN_DECIMAL xs = px - (FN_DECIMAL)x1;
+			FN_DECIMAL ys = py - (FN_DECIMAL)y1;
+
+			return LJMUNoiseMath::cubicLerp(this->cubicRow(poffset, x1, y1 - 1, xs), this->cubicRow(poffset, x1, y1, xs),
+				this->cubicRow(poffset, x1, y1 + 1, xs), this->cubicRow(poffset, x1, y1 + 2, xs), ys) * tbounding;
+		}
+
+		FN_DECIMAL singleCubic(unsigned char poffset, FN_DECIMAL px, FN_DECIMAL py, FN_DECIMAL pz) const
+		{
+			const FN_DECIMAL tbounding = 1 / (FN_DECIMAL(1.5) * FN_DECIMAL(1.5) * FN_DECIMAL(1.5));
+
+			int x1 = LJMUNoiseMath::fastFloor(px);
+			int y1 = LJMUNoiseMath::fastFloor(py);
+			int z1 = LJMUNoiseMath::fastFloor(pz);
+
+			FN_DECIMAL xs = px - (FN_DECIMAL)x1;
+			FN_DECIMAL ys = py - (FN_DECIMAL)y1;
+			FN_DECIMAL zs = pz - (FN_DECIMAL)z1;
+
+			return LJMUNoiseMath::cubicLerp(this->cubicPlane(poffset, x1, y1, z1 - 1, xs, ys), this->cubicPlane(poffset, x1, y1, z1, xs, ys),
+				this->cubicPlane(poffset, x1, y1, z1 + 1, xs, ys), this->cubicPlane(poffset, x1, y1, z1 + 2, xs, ys), zs) * tbounding;
+		}
+
+		//--------CLASS MEMBERS--------------------------------------------------------------
+		FN_DECIMAL			_frequency;
+		int					_octaves;
+		FN_DECIMAL			_lacunarity;
+		FN_DECIMAL			_gain;
+		FN_DECIMAL			_bounding;
+		FN_DECIMAL			_lut_val[256];
+		FN_DECIMAL			_lut_grad_x[12];
+		FN_DECIMAL			_lut_grad_y[12];
+		FN_DECIMAL			_lut_grad_z[12];
+		unsigned char		_perm[512];
+		unsigned char		_perm12[512];
+	};
+
+	template <FastNoise::NoiseType TNoise, FastNoise::FractalType TFractal, FastNoise::Interp TInterp>
+	const bool LJMUNoiseKernel<TNoise, TFractal, TInterp>::IS_FRACTAL;
+
+	/////////////////////////
+	// Runtime evaluator around
+	// a compile-time kernel. The
+	// set fills loop inside the
+	// kernel, so there is one
+	// virtual call per set.
+	/////////////////////////
+	template <class TKernel>
+	class LJMUNoiseKernelEvaluator : public LJMUNoiseEvaluator
+	{
+	public:
+		//--------CONSTRUCTORS/DESTRUCTORS----------------------------------------------------
+		explicit LJMUNoiseKernelEvaluator(const FastNoise& pnoise) :
+			_kernel(pnoise)
+		{
+
+		}
+
+		//--------PUBLIC METHODS-------------------------------------------------------------
+		const TKernel&	getKernel() const { return this->_kernel; }
+
+		FN_DECIMAL getNoise(FN_DECIMAL px, FN_DECIMAL py) const override
+		{
+			return this->_kernel.getNoise(px, py);
+		}
+
+		FN_DECIMAL getNoise(FN_DECIMAL px, FN_DECIMAL py, FN_DECIMAL pz) const override
+		{
+			return this->_kernel.getNoise(px, py, pz);
+		}
+
+		void getNoiseSet(FN_DECIMAL* pset, FN_DECIMAL pxstart, FN_DECIMAL pystart,
+			int pxsize, int pysize, FN_DECIMAL pstep) const override
+		{
+			if (pset && pxsize > 0 && pysize > 0)
+				this->_kernel.getNoiseSet(pset, pxstart, pystart, pxsize, pysize, pstep);
+		}
+
+		void getNoiseSet(FN_DECIMAL* pset, FN_DECIMAL pxstart, FN_DECIMAL pystart, FN_DECIMAL pzstart,
+			int pxsize, int pysize, int pzsize, FN_DECIMAL pstep) const override
+		{
+			if (pset && pxsize > 0 && pysize > 0 && pzsize > 0)
+				this->_kernel.getNoiseSet(pset, pxstart, pystart, pzstart, pxsize, pysize, pzsize, pstep);
+		}
+
+		void getNoiseBlock(const FN_DECIMAL* px, const FN_DECIMAL* py, const FN_DECIMAL* pz,
+			int pcount, FN_DECIMAL* pout) const override
+		{
+			this->_kernel.getNoiseBlock(px, py, pz, pcount, pout);
+		}
+
+	private:
+		//--------CLASS MEMBERS--------------------------------------------------------------
+		TKernel			_kernel;
+	};
+}
@@ -0,0 +1,515 @@
+#include "LJMUNoiseTileCache.h"
+#include "LJMUHeightTileFile.h"
+#include "LJMUNoiseGraph.h"
+#include "LJMUNoiseKernel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+
+using namespace LJMUDX;
+
+namespace
+{
+	/////////////////////////
+	// FNV-1a over raw bytes,
+	// stable between runs so keys
+	// can be logged and compared
+	/////////////////////////
+	struct LJMUHash64
+	{
+		uint64_t value = 14695981039346656037ULL;
+
+		void add(const void* pdata, size_t psize)
+		{
+			const unsigned char* tbytes = (const unsigned char*)pdata;
+			for (size_t i = 0; i < psize; i++)
+			{
+				this->value ^= tbytes[i];
+				this->value *= 1099511628211ULL;
+			}
+		}
+
+		template <class T>
+		void add(const T& pvalue) { this->add(&pvalue, sizeof(T)); }
+	};
+
+	///////////////////////////
+	// Divide Rounding Down, so
+	// Negative Samples Fall in
+	// the Tile Below
+	///////////////////////////
+	int floorDiv(int pvalue, int pdivisor)
+	{
+		int tquotient = pvalue / pdivisor;
+		return (pvalue % pdivisor != 0 && (pvalue < 0) != (pdivisor < 0)) ? tquotient - 1 : tquotient;
+	}
+}
+
+///////////////////////////
+// Source from a Fill Function
+///////////////////////////
+LJMUNoiseTileSource::LJMUNoiseTileSource(int pseed, FN_DECIMAL pfrequency, uint64_t pconfighash, const FillFunc& pfill) :
+	_seed(pseed),
+	_frequency(pfrequency),
+	_config_hash(pconfighash),
+	_fill(pfill)
+{
+
+}
+
+///////////////////////////
+// Source from FastNoise
+///////////////////////////
+LJMUNoiseTileSource LJMUNoiseTileSource::fromNoise(const FastNoise& pnoise)
+{
+	int tindex0, tindex1;
+	pnoise.GetCellularDistance2Indices(tindex0, tindex1);
+
+	LJMUHash64 thash;
+	thash.add((int)pnoise.GetNoiseType());
+	thash.add((int)pnoise.GetInterp());
+	thash.add(pnoise.GetFractalOctaves());
+	thash.add(pnoise.GetFractalLacunarity());
+	thash.add(pnoise.GetFractalGain());
+	thash.add((int)pnoise.GetFractalType());
+	thash.add((int)pnoise.GetCellularDistanceFunction());
+	thash.add((int)pnoise.GetCellularReturnType());
+	thash.add(tindex0);
+	thash.add(tindex1);
+	thash.add(pnoise.GetCellularJitter());
+
+	std::shared_ptr<LJMUNoiseEvaluator> teval(LJMUNoiseEvaluator::create(pnoise));
+	return LJMUNoiseTileSource(pnoise.GetSeed(), pnoise.GetFrequency(), thash.value,
+		[teval](float* pout, FN_DECIMAL pxstart, FN_DECIMAL pzstart, int pwidth, int plength, FN_DECIMAL pstep)
+	{
+		teval->getNoiseSet(pout, pxstart, pzstart, pwidth, plength, pstep);
+	});
+}
+
+///////////////////////////
+// Source from a Graph Node
+///////////////////////////
+LJMUNoiseTileSource LJMUNoiseTileSource::fromGraph(const LJMUNoiseGraph& pgraph, int pnode)
+{
+	std::ostringstream ttext;
+	pgraph.save(ttext);
+	std::string tstring = ttext.str();
+
+	LJMUHash64 thash;
+	thash.add(tstring.data(), tstring.size());
+	thash.add(pnode);
+
+	//Seeds and frequencies live in the graph text, so they are covered by the hash
+	const LJMUNoiseGraph* tgraph = &pgraph;
+	return LJMUNoiseTileSource(0, 1, thash.value,
+		[tgraph, pnode](float* pout, FN_DECIMAL pxstart, FN_DECIMAL pzstart, int pwidth, int plength, FN_DECIMAL pstep)
+	{
+		tgraph->evaluateSet(pnode, pout, pxstart, pzstart, pwidth, plength, pstep);
+	});
+}
+
+///////////////////////////
+// Source from a Tile File
+///////////////////////////
+LJMUNoiseTileSource LJMUNoiseTileSource::fromHeightTiles(const LJMUHeightTileFile& pfile)
+{
+	LJMUHash64 thash;
+	thash.add(pfile.getFileName().data(), pfile.getFileName().size());
+	thash.add(pfile.getWidth());
+	thash.add(pfile.getLength());
+
+	const LJMUHeightTileFile* tfile = &pfile;
+	return LJMUNoiseTileSource(0, 1, thash.value,
+		[tfile](float* pout, FN_DECIMAL pxstart, FN_DECIMAL pzstart, int pwidth, int plength, FN_DECIMAL pstep)
+	{
+		//The coarsest level whose samples are no further apart than the step
+		int tmip = 0;
+		while (tmip + 1 < tfile->getMipCount() && (FN_DECIMAL)(2 << tmip) <= pstep)
+			tmip++;
+
+		FN_DECIMAL tspacing = (FN_DECIMAL)(1 << tmip);
+		int ti0 = (int)std::floor(pxstart / tspacing + (FN_DECIMAL)0.5);
+		int tj0 = (int)std::floor(pzstart / tspacing + (FN_DECIMAL)0.5);
+
+		if (pstep == tspacing)
+		{
+			tfile->readRegion(tmip, ti0, tj0, pwidth, plength, pout);
+			return;
+		}
+
+		//Otherwise read the rows and columns spanned and pick the nearest sample to each point
+		int ti1 = (int)std::floor((pxstart + (pwidth - 1) * pstep) / tspacing + (FN_DECIMAL)0.5);
+		int tj1 = (int)std::floor((pzstart + (plength - 1) * pstep) / tspacing + (FN_DECIMAL)0.5);
+		int tspan = tj1 - tj0 + 1;
+
+		thread_local std::vector<float> tregion;
+		tregion.resize((size_t)(ti1 - ti0 + 1) * tspan);
+		tfile->readRegion(tmip, ti0, tj0, ti1 - ti0 + 1, tspan, tregion.data());
+
+		for (int x = 0; x < pwidth; x++)
+		{
+			int ti = (int)std::floor((pxstart + x * pstep) / tspacing + (FN_DECIMAL)0.5) - ti0;
+			for (int z = 0; z < plength; z++)
+			{
+				int tj = (int)std::floor((pzstart + z * pstep) / tspacing + (FN_DECIMAL)0.5) - tj0;
+				pout[(size_t)x * plength + z] = tregion[(size_t)ti * tspan + tj];
+			}
+		}
+	});
+}
+
+///////////////////////////
+// Sample a Rectangle
+///////////////////////////
+void LJMUNoiseTileSource::fill(float* pout, FN_DECIMAL pxstart, FN_DECIMAL pzstart,
+	int pwidth, int plength, FN_DECIMAL pstep) const
+{
+	if (pout && pwidth > 0 && plength > 0)
+		this->_fill(pout, pxstart, pzstart, pwidth, plength, pstep);
+}
+
+///////////////////////////
+// Hash a Tile Key
+///////////////////////////
+size_t LJMUNoiseTileCache::KeyHasher::operator()(const LJMUNoiseTileKey& pkey) const
+{
+	LJMUHash64 thash;
+	thash.add(pkey.seed);
+	thash.add(pkey.frequency);
+	thash.add(pkey.config_hash);
+	thash.add(pkey.tile_x);
+	thash.add(pkey.tile_z);
+	thash.add(pkey.lod);
+	return (size_t)thash.value;
+}
+
+///////////////////////////
+// Constructor
+///////////////////////////
+LJMUNoiseTileCache::LJMUNoiseTileCache(int ptilesize, size_t pbudgetbytes) :
+	_tile_size(std::max(ptilesize, 1)),
+	_budget(pbudgetbytes),
+	_bytes_used(0),
+	_tick(0),
+	_hits(0),
+	_misses(0),
+	_evictions(0),
+	_shared_edges(0)
+{
+
+}
+
+///////////////////////////
+// Change the Memory Budget
+///////////////////////////
+void LJMUNoiseTileCache::setBudget(size_t pbudgetbytes)
+{
+	std::unique_lock<std::shared_timed_mutex> tlock(this->_mutex);
+	this->_budget = pbudgetbytes;
+	if (this->_bytes_used > this->_budget)
+		this->evictLocked(this->_budget);
+}
+
+///////////////////////////
+// Get a Tile, Sampling it
+// on a Miss
+///////////////////////////
+LJMUNoiseTilePtr LJMUNoiseTileCache::getTile(const LJMUNoiseTileSource& psource, int ptilex, int ptilez, int plod)
+{
+	LJMUNoiseTileKey tkey = this->makeKey(psource, ptilex, ptilez, plod);
+
+	LJMUNoiseTilePtr ttile = this->lookup(tkey);
+	if (ttile)
+	{
+		this->_hits++;
+		return ttile;
+	}
+	this->_misses++;
+
+	//Sample without holding the lock, two threads missing the same tile both sample it
+	//and the second insert finds the first
+	LJMUNoiseTilePtr tnew = this->sampleTile(psource, tkey);
+
+	std::unique_lock<std::shared_timed_mutex> tlock(this->_mutex);
+
+	auto tit = this->_map_tiles.find(tkey);
+	if (tit != this->_map_tiles.end())
+	{
+		tit->second.last_used->store(++this->_tick, std::memory_order_relaxed);
+		return tit->second.tile;
+	}
+
+	Entry tentry;
+	tentry.tile = tnew;
+	tentry.last_used.reset(new std::atomic<uint64_t>(++this->_tick));
+	this->_map_tiles.emplace(tkey, std::move(tentry));
+	this->_bytes_used += this->getTileBytes();
+
+	//Evict down to 7/8 of the budget so a full cache does not evict on every miss
+	if (this->_bytes_used > this->_budget)
+		this->evictLocked(this->_budget - this->_budget / 8);
+
+	return tnew;
+}
+
+///////////////////////////
+// Get a Tile only if it is
+// Cached
+///////////////////////////
+LJMUNoiseTilePtr LJMUNoiseTileCache::findTile(const LJMUNoiseTileSource& psource, int ptilex, int ptilez, int plod)
+{
+	LJMUNoiseTilePtr ttile = this->lookup(this->makeKey(psource, ptilex, ptilez, plod));
+	if (ttile)
+		this->_hits++;
+	else
+		this->_misses++;
+	return ttile;
+}
+
+///////////////////////////
+// Copy a Region out of the
+// Tiles Covering it
+///////////////////////////
+void LJMUNoiseTileCache::fillRegion(const LJMUNoiseTileSource& psource, float* pout, int pi0, int pj0,
+	int pwidth, int plength, int plod)
+{
+	if (!pout || pwidth <= 0 || plength <= 0)
+		return;
+
+	int tsize = this->_tile_size;
+	int ttx0 = floorDiv(pi0, tsize);
+	int ttx1 = floorDiv(pi0 + pwidth - 1, tsize);
+	int ttz0 = floorDiv(pj0, tsize);
+	int ttz1 = floorDiv(pj0 + plength - 1, tsize);
+
+	for (int ttx = ttx0; ttx <= ttx1; ttx++)
+	{
+		for (int ttz = ttz0; ttz <= ttz1; ttz++)
+		{
+			LJMUNoiseTilePtr ttile = this->getTile(psource, ttx, ttz, plod);
+
+			//Overlap of the tile's first size samples with the region, in sample indices
+			int ti0 = std::max(pi0, ttx * tsize);
+			int ti1 = std::min(pi0 + pwidth, (ttx + 1) * tsize);
+			int tj0 = std::max(pj0, ttz * tsize);
+			int tj1 = std::min(pj0 + plength, (ttz + 1) * tsize);
+
+			for (int i = ti0; i < ti1; i++)
+			{
+				std::memcpy(&pout[(size_t)(i - pi0) * plength + (tj0 - pj0)],
+					&ttile->samples[(size_t)(i - ttx * tsize) * ttile->getStride() + (tj0 - ttz * tsize)],
+					(size_t)(tj1 - tj0) * sizeof(float));
+			}
+		}
+	}
+}
+
+///////////////////////////
+// Read the Counters
+///////////////////////////
+LJMUNoiseTileCacheStats LJMUNoiseTileCache::getStats() const
+{
+	LJMUNoiseTileCacheStats tstats;
+	tstats.hits = this->_hits.load();
+	tstats.misses = this->_misses.load();
+	tstats.evictions = this->_evictions.load();
+	tstats.shared_edges = this->_shared_edges.load();
+
+	std::shared_lock<std::shared_timed_mutex> tlock(this->_mutex);
+	tstats.tile_count = this->_map_tiles.size();
+	tstats.bytes_used = this->_bytes_used;
+	tstats.bytes_budget = this->_budget;
+	return tstats;
+}
+
+///////////////////////////
+// Zero the Counters
+///////////////////////////
+void LJMUNoiseTileCache::resetStats()
+{
+	this->_hits = 0;
+	this->_misses = 0;
+	this->_evictions = 0;
+	this->_shared_edges = 0;
+}
+
+///////////////////////////
+// Drop every Tile, tiles
+// still held by callers
+// stay valid
+///////////////////////////
+void LJMUNoiseTileCache::clear()
+{
+	std::unique_lock<std::shared_timed_mutex> tlock(this->_mutex);
+	this->_map_tiles.clear();
+	this->_bytes_used = 0;
+}
+
+///////////////////////////
+// Build the Key of a Tile
+///////////////////////////
+LJMUNoiseTileKey LJMUNoiseTileCache::makeKey(const LJMUNoiseTileSource& psource, int ptilex, int ptilez, int plod) const
+{
+	LJMUNoiseTileKey tkey;
+	tkey.seed = psource.getSeed();
+	tkey.frequency = psource.getFrequency();
+	tkey.config_hash = psource.getConfigHash();
+	tkey.tile_x = ptilex;
+	tkey.tile_z = ptilez;
+	tkey.lod = std::max(plod, 0);
+	return tkey;
+}
+
+///////////////////////////
+// Find a Tile under the
+// Shared Lock and Stamp it
+///////////////////////////
+LJMUNoiseTilePtr LJMUNoiseTileCache::lookup(const LJMUNoiseTileKey& pkey)
+{
+	std::shared_lock<std::shared_timed_mutex> tlock(this->_mutex);
+
+	auto tit = this->_map_tiles.find(pkey);
+	if (tit == this->_map_tiles.end())
+		return nullptr;
+
+	tit->second.last_used->store(++this->_tick, std::memory_order_relaxed);
+	return tit->second.tile;
+}
+
+///////////////////////////
+// Sample a Tile, copying the
+// edges shared with cached
+// neighbours
+///////////////////////////
+LJMUNoiseTilePtr LJMUNoiseTileCache::sampleTile(const LJMUNoiseTileSource& psource, const LJMUNoiseTileKey& pkey)
+{
+	int tsize = this->_tile_size;
+	int tstride = tsize + 1;
+
+	std::shared_ptr<LJMUNoiseTile> ttile = std::make_shared<LJMUNoiseTile>();
+	ttile->key = pkey;
+	ttile->size = tsize;
+	ttile->samples.resize((size_t)tstride * tstride);
+
+	//Neighbours are looked up without touching their stamps or the counters
+	LJMUNoiseTilePtr tneighbours[4];
+	{
+		std::shared_lock<std::shared_timed_mutex> tlock(this->_mutex);
+		const int toffsets[4][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+
+		for (int i = 0; i < 4; i++)
+		{
+			LJMUNoiseTileKey tnkey = pkey;
+			tnkey.tile_x += toffsets[i][0];
+			tnkey.tile_z += toffsets[i][1];
+
+			auto tit = this->_map_tiles.find(tnkey);
+			if (tit != this->_map_tiles.end())
+				tneighbours[i] = tit->second.tile;
+		}
+	}
+
+	const LJMUNoiseTile* tleft = tneighbours[0].get();
+	const LJMUNoiseTile* tright = tneighbours[1].get();
+	const LJMUNoiseTile* tdown = tneighbours[2].get();
+	const LJMUNoiseTile* tup = tneighbours[3].get();
+
+	//Sample the rectangle no neighbour covers
+	int tx0 = tleft ? 1 : 0;
+	int tx1 = tright ? tsize - 1 : tsize;
+	int tz0 = tdown ? 1 : 0;
+	int tz1 = tup ? tsize - 1 : tsize;
+
+	if (tx1 >= tx0 && tz1 >= tz0)
+	{
+		int twidth = tx1 - tx0 + 1;
+		int tlength = tz1 - tz0 + 1;
+		int tstep = 1 << pkey.lod;
+
+		thread_local std::vector<float> tscratch;
+		tscratch.resize((size_t)twidth * tlength);
+
+		psource.fill(tscratch.data(),
+			(FN_DECIMAL)(((long long)pkey.tile_x * tsize + tx0) * tstep),
+			(FN_DECIMAL)(((long long)pkey.tile_z * tsize + tz0) * tstep),
+			twidth, tlength, (FN_DECIMAL)tstep);
+
+		for (int x = 0; x < twidth; x++)
+		{
+			std::memcpy(&ttile->samples[(size_t)(tx0 + x) * tstride + tz0],
+				&tscratch[(size_t)x * tlength], tlength * sizeof(float));
+		}
+	}
+
+	//Shared rows along x are contiguous, shared columns along z are strided
+	if (tleft)
+		std::memcpy(&ttile->samples[0], &tleft->samples[(size_t)tsize * tstride], tstride * sizeof(float));
+	if (tright)
+		std::memcpy(&ttile->samples[(size_t)tsize * tstride], &tright->samples[0], tstride * sizeof(float));
+	if (tdown)
+	{
+		for (int x = 0; x < tstride; x++)
+			ttile->samples[(size_t)x * tstride] = tdown->samples[(size_t)x * tstride + tsize];
+	}
+	if (tup)
+	{
+		for (int x = 0; x < tstride; x++)
+			ttile->samples[(size_t)x * tstride + tsize] = tup->samples[(size_t)x * tstride];
+	}
+
+	this->_shared_edges += (tleft ? 1 : 0) + (tright ? 1 : 0) + (tdown ? 1 : 0) + (tup ? 1 : 0);
+	return ttile;
+}
+
+///////////////////////////
+// Approximate Memory of one
+// Cached Tile
+///////////////////////////
+size_t LJMUNoiseTileCache::getTileBytes() const
+{
+	size_t tsamples = (size_t)(this->_tile_size + 1) * (this->_tile_size + 1);
+	return tsamples * sizeof(float) + sizeof(LJMUNoiseTile) + sizeof(Entry) + sizeof(LJMUNoiseTileKey) +
+		sizeof(std::atomic<uint64_t>) + 4 * sizeof(void*);
+}
+
+///////////////////////////
+// Evict the Least Recently
+// Used Tiles until at most
+// ptarget Bytes are Used
+///////////////////////////
+void LJMUNoiseTileCache::evictLocked(size_t ptarget)
+{
+	size_t ttilebytes = this->getTileBytes();
+	if (this->_bytes_used <= ptarget)
+		return;
+
+	size_t tevict = (this->_bytes_used - ptarget + ttilebytes - 1) / ttilebytes;
+	tevict = std::min(tevict, this->_map_tiles.size());
+
+	//One pass to find the oldest stamps rather than keeping an ordered list,
+	//so readers never need the exclusive lock to mark a tile as used
+	std::vector<std::pair<uint64_t, LJMUNoiseTileKey>> tages;
+	tages.reserve(this->_map_tiles.size());
+	for (const auto& tentry : this->_map_tiles)
+	{
+		tages.emplace_back(tentry.second.last_used->load(std::memory_order_relaxed), tentry.first);
+	}
+
+	auto tolder = [](const std::pair<uint64_t, LJMUNoiseTileKey>& pa, const std::pair<uint64_t, LJMUNoiseTileKey>& pb)
+	{
+		return pa.first < pb.first;
+	};
+	if (tevict < tages.size())
+		std::nth_element(tages.begin(), tages.begin() + tevict, tages.end(), tolder);
+
+	for (size_t i = 0; i < tevict; i++)
+	{
+		this->_map_tiles.erase(tages[i].second);
+	}
+
+	this->_bytes_used -= tevict * ttilebytes;
+	this->_evictions += tevict;
+}
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "FastNoise.h"
+
+namespace LJMUDX
+{
+	class LJMUHeightTileFile;
+	class LJMUNoiseEvaluator;
+	class LJMUNoiseGraph;
+
+	/////////////////////////
+	// Something the cache can
+	// sample tiles from. The seed,
+	// frequency and config hash
+	// identify the source in the
+	// tile keys, so two sources
+	// with equal settings share
+	// their tiles.
+	/////////////////////////
+	class LJMUNoiseTileSource
+	{
+	public:
+		// Fills pout[x * plength + z] with the source at (pxstart + x * pstep, pzstart + z * pstep)
+		typedef std::function<void(float* pout, FN_DECIMAL pxstart, FN_DECIMAL pzstart,
+			int pwidth, int plength, FN_DECIMAL pstep)> FillFunc;
+
+		//--------CONSTRUCTORS/DESTRUCTORS----------------------------------------------------
+		LJMUNoiseTileSource(int pseed, FN_DECIMAL pfrequency, uint64_t pconfighash, const FillFunc& pfill);
+
+		// Samples pnoise through a noise kernel, the hash covers every FastNoise setting
+		static LJMUNoiseTileSource fromNoise(const FastNoise& pnoise);
+
+		// Samples node pnode of pgraph, the hash covers the saved graph text.
+		// pgraph must outlive the source and any cache misses made with it.
+		static LJMUNoiseTileSource fromGraph(const LJMUNoiseGraph& pgraph, int pnode);
+
+		// Reads an open tile file, x and z being its sample indices. Steps of 2, 4 .. read its
+		// mip levels, and positions off the map take the nearest edge. The hash covers the
+		// file name and size. pfile must outlive the source and any cache misses made with it.
+		static LJMUNoiseTileSource fromHeightTiles(const LJMUHeightTileFile& pfile);
+
+		//--------PUBLIC METHODS-------------------------------------------------------------
+		int				getSeed() const { return this->_seed; }
+		FN_DECIMAL		getFrequency() const { return this->_frequency; }
+		uint64_t		getConfigHash() const { return this->_config_hash; }
+
+		void			fill(float* pout, FN_DECIMAL pxstart, FN_DECIMAL pzstart,
+							int pwidth, int plength, FN_DECIMAL pstep) const;
+
+	private:
+		//--------CLASS MEMBERS--------------------------------------------------------------
+		int				_seed;
+		FN_DECIMAL		_frequency;
+		uint64_t		_config_hash;
+		FillFunc		_fill;
+	};
+
+	/////////////////////////
+	// Identifies one cached tile
+	/////////////////////////
+	struct LJMUNoiseTileKey
+	{
+		int			seed;
+		FN_DECIMAL	frequency;
+		uint64_t	config_hash;
+		int			tile_x;
+		int			tile_z;
+		int			lod;
+
+		bool operator==(const LJMUNoiseTileKey& pother) const
+		{
+			return this->seed == pother.seed && this->frequency == pother.frequency &&
+				this->config_hash == pother.config_hash && this->tile_x == pother.tile_x &&
+				this->tile_z == pother.tile_z && this->lod == pother.lod;
+		}
+	};
+
+	/////////////////////////
+	// Sampled tile, immutable
+	// once it is in the cache.
+	// Holds (size + 1)^2 samples
+	// laid out [x * (size + 1) + z],
+	// so the last row and column
+	// are the first of the next
+	// tile. Sample (x, z) is at
+	// ((tile_x * size + x) << lod,
+	// (tile_z * size + z) << lod).
+	/////////////////////////
+	struct LJMUNoiseTile
+	{
+		LJMUNoiseTileKey	key;
+		int					size;
+		std::vector<float>	samples;
+
+		int				getStride() const { return this->size + 1; }
+		float			getSample(int px, int pz) const { return this->samples[(size_t)px * (this->size + 1) + pz]; }
+	};
+
+	typedef std::shared_ptr<const LJMUNoiseTile> LJMUNoiseTilePtr;
+
+	/////////////////////////
+	// Cache counters, read
+	// without locking so they
+	// are only approximately in
+	// step with each other
+	/////////////////////////
+	struct LJMUNoiseTileCacheStats
+	{
+		uint64_t	hits;
+		uint64_t	misses;
+		uint64_t	evictions;
+		uint64_t	shared_edges;		//Tile edges copied from a cached neighbour instead of sampled
+		size_t		tile_count;
+		size_t		bytes_used;
+		size_t		bytes_budget;
+	};
+
+	/////////////////////////
+	// Cache of sampled noise
+	// tiles for unbounded terrain.
+	// Lookups take a shared lock
+	// and only stamp the tile with
+	// an atomic tick, so any number
+	// of threads can read at once.
+	// Misses sample outside the
+	// lock, then insert and evict
+	// the least recently used
+	// tiles under an exclusive one.
+	/////////////////////////
+	class LJMUNoiseTileCache
+	{
+	public:
+		//--------CONSTRUCTORS/DESTRUCTORS----------------------------------------------------
+		LJMUNoiseTileCache(int ptilesize = 64, size_t pbudgetbytes = 64 * 1024 * 1024);
+
+		//--------PUBLIC METHODS-------------------------------------------------------------
+		int				getTileSize() const { return this->_tile_size; }
+
+		// Shrinking the budget evicts straight away
+		void			setBudget(size_t pbudgetbytes);
+		size_t			getBudget() const { return this->_budget; }
+
+		// Returns the tile, sampling it on a miss. Never returns null.
+		LJMUNoiseTilePtr	getTile(const LJMUNoiseTileSource& psource, int ptilex, int ptilez, int plod = 0);
+
+		// Returns the tile if it is cached, null otherwise. Counts as a hit or a miss.
+		LJMUNoiseTilePtr	findTile(const LJMUNoiseTileSource& psource, int ptilex, int ptilez, int plod = 0);
+
+		// Fills pout[x * plength + z] with sample (pi0 + x, pj0 + z) of level plod, as
+		// LJMUNoiseTileSource::fill with a step of 1 << plod would, copying from the tiles
+		// that cover the region and sampling only the ones missing
+		void			fillRegion(const LJMUNoiseTileSource& psource, float* pout, int pi0, int pj0,
+							int pwidth, int plength, int plod = 0);
+
+		LJMUNoiseTileCacheStats	getStats() const;
+		void			resetStats();
+		void			clear();
+
+	protected:
+		//-------------HELPER TYPES----------------------------------------------------
+		struct KeyHasher
+		{
+			size_t operator()(const LJMUNoiseTileKey& pkey) const;
+		};
+
+		struct Entry
+		{
+			LJMUNoiseTilePtr					tile;
+			std::unique_ptr<std::atomic<uint64_t>>	last_used;
+		};
+
+		//-------------HELPER METHODS--------------------------------------------------
+		LJMUNoiseTileKey	makeKey(const LJMUNoiseTileSource& psource, int ptilex, int ptilez, int plod) const;
+		LJMUNoiseTilePtr	lookup(const LJMUNoiseTileKey& pkey);
+		LJMUNoiseTilePtr	sampleTile(const LJMUNoiseTileSource& psource, const LJMUNoiseTileKey& pkey);
+		size_t			getTileBytes() const;
+		void			evictLocked(size_t ptarget);
+
+		//--------CLASS MEMBERS--------------------------------------------------------------
+		int									_tile_size;
+		size_t								_budget;
+		size_t								_bytes_used;
+		std::unordered_map<LJMUNoiseTileKey, Entry, KeyHasher>	_map_tiles;
+		mutable std::shared_timed_mutex		_mutex;
+		std::atomic<uint64_t>				_tick;
+		std::atomic<uint64_t>				_hits;
+		std::atomic<uint64_t>				_misses;
+		std::atomic<uint64_t>				_evictions;
+		std::atomic<uint64_t>				_shared_edges;
+	};
+}
@@ -0,0 +1,221 @@
+#include "LJMUParametricSurface.h"
+
+#include <cmath>
+#include <utility>
+
+#include "LJMUHeightmap.h"
+
+using namespace LJMUDX;
+using namespace Glyph3;
+
+namespace
+{
+	const double SURFACE_PI = 3.14159265358979323846;
+
+	//Waves of the plane, frequencies in half turns per vertex
+	const double MAJOR_FREQUENCY = 0.02;
+	const float MAJOR_HEIGHT = 1.0f;
+	const double MINOR_FREQUENCY = 0.2;
+	const float MINOR_HEIGHT = 0.25f;
+
+	///////////////////////////
+	// Parameter of Line k of
+	// pcount, 0 to 1
+	///////////////////////////
+	float getParameter(int pk, int pcount)
+	{
+		return pcount > 1 ? (float)pk / (float)(pcount - 1) : 0.0f;
+	}
+}
+
+const float LJMUWavePlaneSurface::HEIGHT_SCALE = 10.0f;
+
+///////////////////////////
+// Step sin and cos Round by a
+// Fixed Rotation
+///////////////////////////
+void LJMUParametricSurface::sweepSinCos(double pstart, double pstep, int pcount, float* psin, float* pcos)
+{
+	double ts = std::sin(pstart);
+	double tc = std::cos(pstart);
+	double tsstep = std::sin(pstep);
+	double tcstep = std::cos(pstep);
+
+	for (int k = 0; k < pcount; k++)
+	{
+		psin[k] = (float)ts;
+		pcos[k] = (float)tc;
+
+		double tnext = tc * tcstep - ts * tsstep;
+		ts = ts * tcstep + tc * tsstep;
+		tc = tnext;
+	}
+}
+
+///////////////////////////
+// Two Triangles per Quad, a
+// Row of Quads per Task
+///////////////////////////
+void LJMUParametricSurface::buildGridIndices(int pcolumns, int prows, bool pwinding, std::vector<uint32_t>& pindices)
+{
+	pindices.clear();
+	if (pcolumns < 2 || prows < 2)
+		return;
+
+	size_t trowindices = (size_t)(pcolumns - 1) * 6;
+	pindices.resize(trowindices * (size_t)(prows - 1));
+	uint32_t* tout = pindices.data();
+
+	LJMUThreadPool::getShared().parallelFor(prows - 1, [&](int r)
+	{
+		uint32_t* tquad = tout + (size_t)r * trowindices;
+		for (int c = 0; c < pcolumns - 1; c++, tquad += 6)
+		{
+			uint32_t t0 = (uint32_t)r * (uint32_t)pcolumns + (uint32_t)c;
+			uint32_t t1 = t0 + (uint32_t)pcolumns;
+			uint32_t t2 = t1 + 1;
+			uint32_t t3 = t0 + 1;
+
+			if (!pwinding)
+				std::swap(t1, t3);
+
+			tquad[0] = t3;
+			tquad[1] = t1;
+			tquad[2] = t0;
+			tquad[3] = t3;
+			tquad[4] = t2;
+			tquad[5] = t1;
+		}
+	});
+}
+
+///////////////////////////
+// Azimuth Table, Once Round
+///////////////////////////
+void LJMUSphereSurface::columns(int pcount, std::vector<Column>& pcolumns) const
+{
+	std::vector<float> tsin(pcount), tcos(pcount);
+	LJMUParametricSurface::sweepSinCos(0.0, 2.0 * SURFACE_PI / (double)(pcount - 1), pcount, tsin.data(), tcos.data());
+
+	pcolumns.resize(pcount);
+	for (int c = 0; c < pcount; c++)
+		pcolumns[c] = { getParameter(c, pcount), tsin[c], tcos[c] };
+}
+
+///////////////////////////
+// Elevation Table, Pole to
+// Pole
+///////////////////////////
+void LJMUSphereSurface::rows(int pcount, std::vector<Row>& prows) const
+{
+	std::vector<float> tsin(pcount), tcos(pcount);
+	LJMUParametricSurface::sweepSinCos(0.0, SURFACE_PI / (double)(pcount - 1), pcount, tsin.data(), tcos.data());
+
+	prows.resize(pcount);
+	for (int r = 0; r < pcount; r++)
+		prows[r] = { getParameter(r, pcount), tsin[r], tcos[r] };
+}
+
+///////////////////////////
+// Azimuth Table, Once Round
+///////////////////////////
+void LJMUCylinderSurface::columns(int pcount, std::vector<Column>& pcolumns) const
+{
+	std::vector<float> tsin(pcount), tcos(pcount);
+	LJMUParametricSurface::sweepSinCos(0.0, 2.0 * SURFACE_PI / (double)(pcount - 1), pcount, tsin.data(), tcos.data());
+
+	pcolumns.resize(pcount);
+	for (int c = 0; c < pcount; c++)
+		pcolumns[c] = { getParameter(c, pcount), tsin[c], tcos[c] };
+}
+
+///////////////////////////
+// Height Table, Bottom to Top
+///////////////////////////
+void LJMUCylinderSurface::rows(int pcount, std::vector<Row>& prows) const
+{
+	prows.resize(pcount);
+	for (int r = 0; r < pcount; r++)
+	{
+		float tv = getParameter(r, pcount);
+		prows[r] = { tv, tv - 0.5f };
+	}
+}
+
+///////////////////////////
+// Corner, Axes and Steps of
+// the Grid
+///////////////////////////
+LJMUWavePlaneSurface::LJMUWavePlaneSurface(const Vector3f& pcentre, const Vector3f& pxdir, const Vector3f& pzdir,
+	int pxvertices, int pzvertices, const Vector2f& pspacing, const Vector2f& pgridpos, const Vector2f& ptexscale) :
+	_heights(nullptr)
+{
+	Vector3f txunit = pxdir;
+	Vector3f tzunit = pzdir;
+	txunit.Normalize();
+	tzunit.Normalize();
+
+	this->_xstep = txunit * pspacing.x;
+	this->_zstep = tzunit * pspacing.y;
+	this->_start = pcentre - this->_xstep * ((float)(pxvertices - 1) * 0.5f) - this->_zstep * ((float)(pzvertices - 1) * 0.5f);
+
+	//Direct3D is left handed, so z cross x is up
+	this->_up = tzunit.Cross(txunit);
+	this->_up.Normalize();
+
+	this->_gridshift = Vector2f(pgridpos.x * (float)(pxvertices - 1), pgridpos.y * (float)(pzvertices - 1));
+	this->_texstep = Vector2f(ptexscale.x / (float)pxvertices, ptexscale.y / (float)pzvertices);
+}
+
+///////////////////////////
+// Offsets and Cosine Waves
+// along z
+///////////////////////////
+void LJMUWavePlaneSurface::columns(int pcount, std::vector<Column>& pcolumns) const
+{
+	std::vector<float> tsin(pcount), tmajor(pcount), tminor(pcount);
+	double tshift = (double)this->_gridshift.y;
+	LJMUParametricSurface::sweepSinCos(tshift * MAJOR_FREQUENCY * SURFACE_PI, MAJOR_FREQUENCY * SURFACE_PI, pcount,
+		tsin.data(), tmajor.data());
+	LJMUParametricSurface::sweepSinCos(tshift * MINOR_FREQUENCY * SURFACE_PI, MINOR_FREQUENCY * SURFACE_PI, pcount,
+		tsin.data(), tminor.data());
+
+	pcolumns.resize(pcount);
+	for (int j = 0; j < pcount; j++)
+	{
+		float tshifted = (float)j + this->_gridshift.y;
+		pcolumns[j] = { j, this->_zstep * tshifted, tshifted * this->_texstep.y,
+			tmajor[j] * MAJOR_HEIGHT, tminor[j] * MINOR_HEIGHT };
+	}
+}
+
+///////////////////////////
+// Offsets and Sine Waves
+// along x
+///////////////////////////
+void LJMUWavePlaneSurface::rows(int pcount, std::vector<Row>& prows) const
+{
+	std::vector<float> tcos(pcount), tmajor(pcount), tminor(pcount);
+	double tshift = (double)this->_gridshift.x;
+	LJMUParametricSurface::sweepSinCos(tshift * MAJOR_FREQUENCY * SURFACE_PI, MAJOR_FREQUENCY * SURFACE_PI, pcount,
+		tmajor.data(), tcos.data());
+	LJMUParametricSurface::sweepSinCos(tshift * MINOR_FREQUENCY * SURFACE_PI, MINOR_FREQUENCY * SURFACE_PI, pcount,
+		tminor.data(), tcos.data());
+
+	prows.resize(pcount);
+	for (int i = 0; i < pcount; i++)
+	{
+		float tshifted = (float)i + this->_gridshift.x;
+		prows[i] = { i, this->_start + this->_xstep * tshifted, tshifted * this->_texstep.x,
+			tmajor[i] * MAJOR_HEIGHT, tminor[i] * MINOR_HEIGHT };
+	}
+}
+
+///////////////////////////
+// Keep the Height if Asked
+///////////////////////////
+void LJMUWavePlaneSurface::recordHeight(int pi, int pj, float pheight) const
+{
+	if (this->_heights)
+		this->_heights->setHeight(pi, pj, pheight);
+}
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Vector2f.h"
+#include "Vector3f.h"
+#include "Vector4f.h"
+#include "LJMUThreadPool.h"
+
+namespace LJMUDX
+{
+	class LJMUHeightmap;
+
+	/////////////////////////
+	// Builds indexed grids over
+	// surfaces that separate into
+	// a table per column and a
+	// table per row, so angles,
+	// height terms and offsets are
+	// worked out once per line of
+	// the grid, not per vertex.
+	//
+	// A surface is a functor with
+	// Column and Row types and
+	//   void columns(int, std::vector<Column>&) const;
+	//   void rows(int, std::vector<Row>&) const;
+	//   template<class TVertex>
+	//   void vertex(const Column&, const Row&, TVertex&) const;
+	// vertex writes what the
+	// surface defines over a copy
+	// of a prototype vertex, which
+	// holds everything else.
+	//
+	// Rows fill in parallel,
+	// straight into the vertex
+	// array, and sin/cos tables
+	// come from a rotation
+	// recurrence, not a trig call
+	// per entry.
+	/////////////////////////
+	class LJMUParametricSurface
+	{
+	public:
+		//--------PUBLIC METHODS-------------------------------------------------------------
+		// psin[k] and pcos[k] of pstart + k * pstep, rotated on in double precision
+		static void		sweepSinCos(double pstart, double pstep, int pcount, float* psin, float* pcos);
+
+		// Vertex (c, r) at r * pcolumns + c, each quad wound as LJMULevelDemo's planes were
+		static void		buildGridIndices(int pcolumns, int prows, bool pwinding, std::vector<uint32_t>& pindices);
+
+		template<class TVertex, class TSurface>
+		static void		generate(const TSurface& psurface, int pcolumns, int prows, const TVertex& pprototype,
+							std::vector<TVertex>& pvertices, std::vector<uint32_t>& pindices, bool pwinding = true);
+	};
+
+	/////////////////////////
+	// Unit latitude and longitude
+	// sphere, columns round from
+	// +x towards +z and rows down
+	// from the north pole
+	/////////////////////////
+	class LJMUSphereSurface
+	{
+	public:
+		//--------HELPER TYPES---------------------------------------------------------------
+		struct Column	{ float u, sa, ca; };
+		struct Row		{ float v, sp, cp; };
+
+		//--------PUBLIC METHODS-------------------------------------------------------------
+		void			columns(int pcount, std::vector<Column>& pcolumns) const;
+		void			rows(int pcount, std::vector<Row>& prows) const;
+
+		template<class TVertex>
+		void			vertex(const Column& pcolumn, const Row& prow, TVertex& pvertex) const
+		{
+			pvertex.position = Glyph3::Vector3f(prow.sp * pcolumn.ca, prow.cp, prow.sp * pcolumn.sa);
+			pvertex.normal = pvertex.position;
+			pvertex.texcoords = Glyph3::Vector2f(pcolumn.u, prow.v);
+		}
+	};
+
+	/////////////////////////
+	// Open unit cylinder round the
+	// y axis, from -0.5 to 0.5
+	/////////////////////////
+	class LJMUCylinderSurface
+	{
+	public:
+		//--------HELPER TYPES---------------------------------------------------------------
+		struct Column	{ float u, sa, ca; };
+		struct Row		{ float v, height; };
+
+		//--------PUBLIC METHODS-------------------------------------------------------------
+		void			columns(int pcount, std::vector<Column>& pcolumns) const;
+		void			rows(int pcount, std::vector<Row>& prows) const;
+
+		template<class TVertex>
+		void			vertex(const Column& pcolumn, const Row& prow, TVertex& pvertex) const
+		{
+			pvertex.position = Glyph3::Vector3f(pcolumn.ca, prow.height, pcolumn.sa);
+			pvertex.normal = Glyph3::Vector3f(pcolumn.ca, 0.0f, pcolumn.sa);
+			pvertex.texcoords = Glyph3::Vector2f(pcolumn.u, prow.v);
+		}
+	};
+
+	/////////////////////////
+	// Plane rippled by a large and
+	// a small wave, the product of
+	// a sine along x and a cosine
+	// along z, shaded by height.
+	// Rows run along x and columns
+	// along z. gridpos offsets the
+	// grid by whole planes so
+	// neighbouring ones join up.
+	/////////////////////////
+	class LJMUWavePlaneSurface
+	{
+	public:
+		//--------HELPER TYPES---------------------------------------------------------------
+		struct Column	{ int j; Glyph3::Vector3f offset; float v, major, minor; };
+		struct Row		{ int i; Glyph3::Vector3f offset; float u, major, minor; };
+
+		//--------CONSTRUCTORS/DESTRUCTORS----------------------------------------------------
+		LJMUWavePlaneSurface(const Glyph3::Vector3f& pcentre, const Glyph3::Vector3f& pxdir, const Glyph3::Vector3f& pzdir,
+			int pxvertices, int pzvertices, const Glyph3::Vector2f& pspacing, const Glyph3::Vector2f& pgridpos,
+			const Glyph3::Vector2f& ptexscale);
+
+		//--------PUBLIC METHODS-------------------------------------------------------------
+		static const float	HEIGHT_SCALE;
+
+		const Glyph3::Vector3f&	getUp() const { return this->_up; }
+
+		// Receives each vertex's height before HEIGHT_SCALE, at (row, column)
+		void			setHeights(LJMUHeightmap* pheights) { this->_heights = pheights; }
+
+		void			columns(int pcount, std::vector<Column>& pcolumns) const;
+		void			rows(int pcount, std::vector<Row>& prows) const;
+
+		template<class TVertex>
+		void			vertex(const Column& pcolumn, const Row& prow, TVertex& pvertex) const
+		{
+			float theight = prow.major * pcolumn.major + prow.minor * pcolumn.minor;
+			float tshade = (theight + 1.0f) * 0.5f;
+			tshade = tshade < 0.0f ? 0.0f : (tshade > 1.0f ? 1.0f : tshade);
+
+			//The height is scaled twice, as the original terrain was
+			pvertex.position = prow.offset + pcolumn.offset + this->_up * (theight * HEIGHT_SCALE * HEIGHT_SCALE);
+			pvertex.color = Glyph3::Vector4f(tshade, 1.0f - tshade, tshade * 0.5f, 1.0f);
+			pvertex.texcoords = Glyph3::Vector2f(prow.u, pcolumn.v);
+			recordHeight(prow.i, pcolumn.j, theight);
+		}
+
+	protected:
+		//-------------HELPER METHODS--------------------------------------------------
+		void			recordHeight(int pi, int pj, float pheight) const;
+
+		//--------CLASS MEMBERS--------------------------------------------------------------
+		Glyph3::Vector3f	_start;
+		Glyph3::Vector3f	_xstep;
+		Glyph3::Vector3f	_zstep;
+		Glyph3::Vector3f	_up;
+		Glyph3::Vector2f	_gridshift;		//Whole grids of offset, in vertices
+		Glyph3::Vector2f	_texstep;
+		LJMUHeightmap*		_heights;
+	};
+
+	///////////////////////////
+	// Fill the Rows in Parallel
+	// and Index the Grid
+	///////////////////////////
+	template<class TVertex, class TSurface>
+	void LJMUParametricSurface::generate(const TSurface& psurface, int pcolumns, int prows, const TVertex& pprototype,
+		std::vector<TVertex>& pvertices, std::vector<uint32_t>& pindices, bool pwinding)
+	{
+		pvertices.clear();
+		pindices.clear();
+		if (pcolumns < 2 || prows < 2)
+			return;
+
+		std::vector<typename TSurface::Column> tcolumns;
+		std::vector<typename TSurface::Row> trows;
+		psurface.columns(pcolumns, tcolumns);
+		psurface.rows(prows, trows);
+
+		//Each vertex is written once, by the row that owns it
+		pvertices.resize((size_t)pcolumns * (size_t)prows);
+		TVertex* tout = pvertices.data();
+		LJMUThreadPool::getShared().parallelFor(prows, [&](int r)
+		{
+			TVertex* trow = tout + (size_t)r * (size_t)pcolumns;
+			const typename TSurface::Row& tr = trows[r];
+			for (int c = 0; c < pcolumns; c++)
+			{
+				trow[c] = pprototype;
+				psurface.vertex(tcolumns[c], tr, trow[c]);
+			}
+		});
+
+		buildGridIndices(pcolumns, prows, pwinding, pindices);
+	}
+}
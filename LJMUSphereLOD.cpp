@@ -0,0 +1,241 @@
+#include "LJMUSphereLOD.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace LJMUDX;
+using namespace Glyph3;
+
+namespace
+{
+	const float SPHERE_PI = 3.14159265f;
+
+	/////////////////////////
+	// Cube face, its grid runs
+	// along u then v, with u x v
+	// the outward normal
+	/////////////////////////
+	struct CubeFace
+	{
+		Vector3f	normal;
+		Vector3f	u;
+		Vector3f	v;
+	};
+
+	const CubeFace CUBE_FACES[6] = {
+		{ Vector3f(1, 0, 0), Vector3f(0, 1, 0), Vector3f(0, 0, 1) },
+		{ Vector3f(-1, 0, 0), Vector3f(0, 0, 1), Vector3f(0, 1, 0) },
+		{ Vector3f(0, 1, 0), Vector3f(0, 0, 1), Vector3f(1, 0, 0) },
+		{ Vector3f(0, -1, 0), Vector3f(1, 0, 0), Vector3f(0, 0, 1) },
+		{ Vector3f(0, 0, 1), Vector3f(1, 0, 0), Vector3f(0, 1, 0) },
+		{ Vector3f(0, 0, -1), Vector3f(0, 1, 0), Vector3f(1, 0, 0) }
+	};
+
+	///////////////////////////
+	// Face Coordinate of Grid
+	// Line k, Exact at the Edges so
+	// Neighbouring Faces Meet
+	///////////////////////////
+	float getFaceCoord(int pk, int pcells)
+	{
+		if (pk == 0)
+			return -1.0f;
+		if (pk == pcells)
+			return 1.0f;
+		return std::tan(((float)pk * 2.0f / (float)pcells - 1.0f) * SPHERE_PI * 0.25f);
+	}
+
+	///////////////////////////
+	// Equirectangular u, 0 at +x
+	// Turning towards +z
+	///////////////////////////
+	float getAzimuthU(const Vector3f& pposition)
+	{
+		float tu = std::atan2(pposition.z, pposition.x) / (2.0f * SPHERE_PI);
+		return tu < 0.0f ? tu + 1.0f : tu;
+	}
+}
+
+///////////////////////////
+// Constructor
+///////////////////////////
+LJMUSphereLOD::LJMUSphereLOD() :
+	_pixels_per_edge(8.0f),
+	_hysteresis(0.2f)
+{
+	this->setLevels(128, 6);
+}
+
+///////////////////////////
+// Build the Cube-Sphere
+///////////////////////////
+void LJMUSphereLOD::build(int pcells, std::vector<LJMUSphereVertex>& pvertices, std::vector<uint32_t>& pindices)
+{
+	pvertices.clear();
+	pindices.clear();
+	if (pcells < 1)
+		return;
+
+	int tside = pcells + 1;
+	std::vector<float> tcoords(tside);
+	for (int k = 0; k < tside; k++)
+		tcoords[k] = getFaceCoord(k, pcells);
+
+	//Face grids, the vertices along shared edges come out identical on both faces
+	LJMUSphereVertex tvertex;
+	for (const CubeFace& tface : CUBE_FACES)
+	{
+		for (int a = 0; a < tside; a++)
+		{
+			for (int b = 0; b < tside; b++)
+			{
+				Vector3f tpos = tface.normal + tface.u * tcoords[a] + tface.v * tcoords[b];
+				tpos.Normalize();
+				tvertex.position = tpos;
+				tvertex.normal = tpos;
+				tvertex.texcoords = Vector2f(getAzimuthU(tpos), std::acos(std::min(std::max(tpos.y, -1.0f), 1.0f)) / SPHERE_PI);
+				pvertices.push_back(tvertex);
+			}
+		}
+	}
+
+	//Two triangles a quad, anticlockwise seen from outside like the UV spheres
+	pindices.reserve((size_t)getTriangleCount(pcells) * 3);
+	for (int f = 0; f < 6; f++)
+	{
+		uint32_t tbase = (uint32_t)(f * tside * tside);
+		for (int a = 0; a < pcells; a++)
+		{
+			for (int b = 0; b < pcells; b++)
+			{
+				uint32_t t00 = tbase + (uint32_t)(a * tside + b);
+				uint32_t t10 = t00 + (uint32_t)tside;
+				uint32_t t01 = t00 + 1;
+				uint32_t t11 = t10 + 1;
+
+				uint32_t tquad[6] = { t00, t10, t11, t00, t11, t01 };
+				pindices.insert(pindices.end(), tquad, tquad + 6);
+			}
+		}
+	}
+
+	//Triangles across the seam take copies of their low u vertices at u + 1, and triangles
+	//at a pole a pole vertex of their own, at the middle of their other two u
+	std::vector<int> tseamcopies(pvertices.size(), -1);
+	for (size_t t = 0; t < pindices.size(); t += 3)
+	{
+		uint32_t* ttri = &pindices[t];
+		int tpole = -1;
+		float tmaxu = 0.0f;
+		for (int c = 0; c < 3; c++)
+		{
+			const Vector3f& tpos = pvertices[ttri[c]].position;
+			if (tpos.x * tpos.x + tpos.z * tpos.z < 1e-12f)
+				tpole = c;
+			else
+				tmaxu = std::max(tmaxu, pvertices[ttri[c]].texcoords.x);
+		}
+
+		float tsumu = 0.0f;
+		for (int c = 0; c < 3; c++)
+		{
+			if (c == tpole)
+				continue;
+
+			uint32_t tindex = ttri[c];
+			if (tmaxu - pvertices[tindex].texcoords.x > 0.5f)
+			{
+				if (tseamcopies[tindex] < 0)
+				{
+					tvertex = pvertices[tindex];
+					tvertex.texcoords.x += 1.0f;
+					tseamcopies[tindex] = (int)pvertices.size();
+					pvertices.push_back(tvertex);
+				}
+				ttri[c] = (uint32_t)tseamcopies[tindex];
+			}
+			tsumu += pvertices[ttri[c]].texcoords.x;
+		}
+
+		if (tpole >= 0)
+		{
+			tvertex = pvertices[ttri[tpole]];
+			tvertex.texcoords.x = tsumu * 0.5f;
+			ttri[tpole] = (uint32_t)pvertices.size();
+			pvertices.push_back(tvertex);
+		}
+	}
+
+	//Tangents follow the texture, so the pole copies turn with their u
+	for (LJMUSphereVertex& tv : pvertices)
+	{
+		float tazimuth = tv.texcoords.x * 2.0f * SPHERE_PI;
+		float televation = tv.texcoords.y * SPHERE_PI;
+		float tca = std::cos(tazimuth), tsa = std::sin(tazimuth);
+		float tce = std::cos(televation), tse = std::sin(televation);
+		tv.tangent = Vector3f(-tsa, 0.0f, tca);
+		tv.binormal = Vector3f(tce * tca, -tse, tce * tsa);
+	}
+}
+
+///////////////////////////
+// Projected Radius of a Sphere
+///////////////////////////
+float LJMUSphereLOD::getScreenRadius(const Vector3f& pcenter, float pradius, const Vector3f& pcamerapos,
+	float pscreenheight, float pfovy)
+{
+	Vector3f tdelta = pcenter - pcamerapos;
+	float tdistsq = tdelta.x * tdelta.x + tdelta.y * tdelta.y + tdelta.z * tdelta.z;
+	float tradsq = pradius * pradius;
+	if (tdistsq <= tradsq)
+		return FLT_MAX;
+
+	//The silhouette cone's half angle has tan r / sqrt(d^2 - r^2)
+	return pradius / std::sqrt(tdistsq - tradsq) * pscreenheight * 0.5f / std::tan(pfovy * 0.5f);
+}
+
+///////////////////////////
+// Halve the Cells down the
+// Chain
+///////////////////////////
+void LJMUSphereLOD::setLevels(int pfinestcells, int plevelcount)
+{
+	this->_list_cells.clear();
+	int tcells = pfinestcells;
+	for (int l = 0; l < plevelcount && tcells >= 1; l++, tcells /= 2)
+		this->_list_cells.push_back(tcells);
+}
+
+///////////////////////////
+// Pick a Level, Holding the
+// Current one Inside the Band
+///////////////////////////
+int LJMUSphereLOD::selectLevel(int pcurrent, float pscreenradius) const
+{
+	if (this->_list_cells.empty())
+		return -1;
+
+	int tfine = this->getIdealLevel(pscreenradius);
+	int tcoarse = this->getIdealLevel(pscreenradius * (1.0f + this->_hysteresis));
+	if (pcurrent < 0 || pcurrent >= this->getLevelCount() || pcurrent > tfine)
+		return tfine;
+	if (pcurrent < tcoarse)
+		return tcoarse;
+	return pcurrent;
+}
+
+///////////////////////////
+// Coarsest Level whose Edges
+// Stay Within the Pixel Length
+///////////////////////////
+int LJMUSphereLOD::getIdealLevel(float pscreenradius) const
+{
+	//Around the equator lie four faces of cells, each edge about pi / 2 / cells of the radius
+	float tneeded = SPHERE_PI * 0.5f * pscreenradius / std::max(this->_pixels_per_edge, 1e-3f);
+
+	int tlevel = 0;
+	while (tlevel + 1 < this->getLevelCount() && (float)this->_list_cells[tlevel + 1] >= tneeded)
+		tlevel++;
+	return tlevel;
+}
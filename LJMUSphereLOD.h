@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Vector2f.h"
+#include "Vector3f.h"
+
+namespace LJMUDX
+{
+	/////////////////////////
+	// Vertex of a unit sphere, for
+	// copying into whichever vertex
+	// format draws it
+	/////////////////////////
+	struct LJMUSphereVertex
+	{
+		Glyph3::Vector3f	position;
+		Glyph3::Vector3f	normal;
+		Glyph3::Vector3f	tangent;	//Along +u, east
+		Glyph3::Vector3f	binormal;	//Along +v, south
+		Glyph3::Vector2f	texcoords;
+	};
+
+	/////////////////////////
+	// Chain of cube-sphere levels
+	// of detail, and the choice of
+	// level for a sphere on screen.
+	//
+	// Each face of a cube is cut
+	// into cells x cells quads and
+	// pushed out onto the unit
+	// sphere. The face grid is
+	// spaced by tan, so the quads
+	// stay close to square and the
+	// same size everywhere, with no
+	// crowding at the poles like a
+	// latitude and longitude grid.
+	// Texture coordinates are the
+	// same equirectangular mapping
+	// as the demo's UV spheres.
+	// Vertices are doubled along
+	// the u = 0 seam, and each
+	// triangle at a pole gets its
+	// own pole vertex at its mid u.
+	//
+	// Level 0 is the finest, each
+	// level after has half the
+	// cells a side, a quarter of
+	// the triangles.
+	/////////////////////////
+	class LJMUSphereLOD
+	{
+	public:
+		//--------CONSTRUCTORS/DESTRUCTORS----------------------------------------------------
+		LJMUSphereLOD();
+
+		//--------PUBLIC METHODS-------------------------------------------------------------
+		// Unit sphere with pcells x pcells quads on each cube face, wound like
+		// LJMULevelDemo::CreateStandardSphere
+		static void		build(int pcells, std::vector<LJMUSphereVertex>& pvertices, std::vector<uint32_t>& pindices);
+		static int		getTriangleCount(int pcells) { return pcells * pcells * 12; }
+
+		// Radius in pixels of a sphere seen from pcamerapos, FLT_MAX from inside it
+		static float	getScreenRadius(const Glyph3::Vector3f& pcenter, float pradius, const Glyph3::Vector3f& pcamerapos,
+							float pscreenheight, float pfovy);
+
+		// Level 0 has pfinestcells a side, each of the plevelcount levels half the one before
+		void			setLevels(int pfinestcells, int plevelcount);
+		void			setPixelsPerEdge(float ppixels) { this->_pixels_per_edge = ppixels; }
+
+		// A finer level is taken as soon as it is needed, a coarser one only once it would
+		// still do with the sphere pfraction larger on screen
+		void			setHysteresis(float pfraction) { this->_hysteresis = pfraction; }
+
+		int				getLevelCount() const { return (int)this->_list_cells.size(); }
+		int				getCells(int plevel) const { return this->_list_cells[plevel]; }
+
+		// Level for a sphere of pscreenradius pixels now drawn at pcurrent, -1 for none
+		int				selectLevel(int pcurrent, float pscreenradius) const;
+
+	private:
+		//-------------HELPER METHODS--------------------------------------------------
+		int				getIdealLevel(float pscreenradius) const;
+
+		//--------CLASS MEMBERS--------------------------------------------------------------
+		std::vector<int>	_list_cells;
+		float				_pixels_per_edge;
+		float				_hysteresis;
+	};
+}
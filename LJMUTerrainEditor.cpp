@@ -0,0 +1,281 @@
+#include "LJMUTerrainEditor.h"
+#include "LJMUHeightmap.h"
+#include "LJMUTerrainExecutor.h"
+#include "LJMUTerrainHorizon.h"
+#include "LJMUTerrainQuadtree.h"
+#include "LJMUTerrainQuery.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+
+using namespace LJMUDX;
+using namespace Glyph3;
+
+///////////////////////////
+// Constructor
+///////////////////////////
+LJMUTerrainEditor::LJMUTerrainEditor() :
+	_obj_map(nullptr),
+	_obj_tree(nullptr),
+	_obj_executor(nullptr),
+	_obj_query(nullptr),
+	_obj_horizon(nullptr),
+	_origin(0.0f, 0.0f, 0.0f),
+	_spacing(1.0f, 1.0f),
+	_height_scale(1.0f),
+	_stats()
+{
+
+}
+
+///////////////////////////
+// Bind the Map to Edit
+///////////////////////////
+bool LJMUTerrainEditor::bind(LJMUHeightmap& pmap, const Vector3f& porigin, const Vector2f& pspacing, float pheightscale)
+{
+	this->clear();
+	if (pmap.isEmpty() || pspacing.x == 0.0f || pspacing.y == 0.0f || pheightscale == 0.0f)
+		return false;
+
+	this->_obj_map = &pmap;
+	this->_origin = porigin;
+	this->_spacing = pspacing;
+	this->_height_scale = pheightscale;
+	return true;
+}
+
+///////////////////////////
+// Unbind and Drop the Queue
+///////////////////////////
+void LJMUTerrainEditor::clear()
+{
+	this->_obj_map = nullptr;
+	this->_list_strokes.clear();
+	this->_list_rects.clear();
+	this->_list_nodes.clear();
+}
+
+///////////////////////////
+// Queue a Stroke
+///////////////////////////
+void LJMUTerrainEditor::stroke(const LJMUTerrainBrush& pbrush, float px, float pz)
+{
+	if (!this->_obj_map)
+		return;
+
+	Stroke tstroke = { pbrush, px, pz };
+	this->_list_strokes.push_back(tstroke);
+}
+
+///////////////////////////
+// Apply the Frame's Strokes
+///////////////////////////
+void LJMUTerrainEditor::update()
+{
+	if (!this->_obj_map)
+		return;
+
+	//The horizons keep their own copy of the heights, so they never hold up the next batch
+	if (this->_obj_horizon)
+		this->_obj_horizon->commitUpdates();
+
+	if (this->_obj_executor)
+	{
+		this->_obj_executor->commitRebuilt();
+		if (this->_obj_executor->isRebuilding())
+			return;
+	}
+
+	if (this->_list_strokes.empty())
+		return;
+
+	auto tstart = std::chrono::steady_clock::now();
+
+	//Strokes dragged across a frame mostly overlap, so their rectangles are merged first
+	this->_list_rects.clear();
+	for (const Stroke& tstroke : this->_list_strokes)
+	{
+		Rect trect;
+		if (this->applyStroke(tstroke, trect))
+			addRect(this->_list_rects, trect);
+	}
+
+	this->_stats.strokes += this->_list_strokes.size();
+	this->_list_strokes.clear();
+
+	this->_list_nodes.clear();
+	for (const Rect& trect : this->_list_rects)
+	{
+		int twidth = trect.i1 - trect.i0 + 1;
+		int tlength = trect.j1 - trect.j0 + 1;
+
+		if (this->_obj_query)
+			this->_obj_query->update(trect.i0, trect.j0, twidth, tlength);
+		if (this->_obj_tree)
+			this->_obj_tree->update(*this->_obj_map, trect.i0, trect.j0, twidth, tlength, this->_list_nodes);
+		if (this->_obj_horizon)
+			this->_obj_horizon->update(trect.i0, trect.j0, twidth, tlength);
+	}
+
+	std::sort(this->_list_nodes.begin(), this->_list_nodes.end());
+	this->_list_nodes.erase(std::unique(this->_list_nodes.begin(), this->_list_nodes.end()), this->_list_nodes.end());
+
+	if (this->_obj_executor)
+		this->_obj_executor->rebuild(this->_list_nodes);
+
+	double tms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tstart).count();
+	this->_stats.batches++;
+	this->_stats.last_nodes = (int)this->_list_nodes.size();
+	this->_stats.last_ms = tms;
+	this->_stats.max_ms = std::max(this->_stats.max_ms, tms);
+}
+
+///////////////////////////
+// Change the Samples under
+// one Brush. Smoothing reads
+// the heights from before the
+// stroke, one sample past its
+// edge.
+///////////////////////////
+bool LJMUTerrainEditor::applyStroke(const Stroke& pstroke, Rect& prect)
+{
+	LJMUHeightmap& tmap = *this->_obj_map;
+	const LJMUTerrainBrush& tbrush = pstroke.brush;
+
+	float tci = (pstroke.x - this->_origin.x) / this->_spacing.x;
+	float tcj = (pstroke.z - this->_origin.z) / this->_spacing.y;
+	float tri = std::fabs(tbrush.radius / this->_spacing.x);
+	float trj = std::fabs(tbrush.radius / this->_spacing.y);
+	if (!(tri > 0.0f && trj > 0.0f))
+		return false;
+
+	int ti0 = std::max((int)std::ceil(tci - tri), 0);
+	int tj0 = std::max((int)std::ceil(tcj - trj), 0);
+	int ti1 = std::min((int)std::floor(tci + tri), tmap.getWidth() - 1);
+	int tj1 = std::min((int)std::floor(tcj + trj), tmap.getLength() - 1);
+	if (ti0 > ti1 || tj0 > tj1)
+		return false;
+
+	int tai0 = std::max(ti0 - 1, 0);
+	int taj0 = std::max(tj0 - 1, 0);
+	int tai1 = std::min(ti1 + 1, tmap.getWidth() - 1);
+	int taj1 = std::min(tj1 + 1, tmap.getLength() - 1);
+	int tspan = taj1 - taj0 + 1;
+	size_t tcount = (size_t)(tai1 - tai0 + 1) * tspan;
+
+	this->_list_heights.resize(tcount * 2);
+	float* tsrc = this->_list_heights.data();
+	float* tdst = tsrc + tcount;
+	for (int i = tai0; i <= tai1; i++)
+		tmap.readRow(i, taj0, tspan, tsrc + (size_t)(i - tai0) * tspan);
+	std::copy(tsrc, tsrc + tcount, tdst);
+
+	float tinvscale = 1.0f / this->_height_scale;
+	float tdelta = tbrush.strength * tinvscale;
+	float ttarget = (tbrush.height - this->_origin.y) * tinvscale;
+
+	//Re-encoding a unorm map over a wider range would touch every sample, so strokes stop at its ends
+	float tlo = -FLT_MAX;
+	float thi = FLT_MAX;
+	if (tmap.getFormat() != LJMUHeightmap::FORMAT_FLOAT32)
+	{
+		tlo = std::min(tmap.getOffset(), tmap.getOffset() + tmap.getScale());
+		thi = std::max(tmap.getOffset(), tmap.getOffset() + tmap.getScale());
+	}
+
+	for (int i = ti0; i <= ti1; i++)
+	{
+		float tdi = ((float)i - tci) / tri;
+		const float* trowsrc = tsrc + (size_t)(i - tai0) * tspan;
+		float* trowdst = tdst + (size_t)(i - tai0) * tspan;
+
+		for (int j = tj0; j <= tj1; j++)
+		{
+			float tdj = ((float)j - tcj) / trj;
+			float td2 = tdi * tdi + tdj * tdj;
+			if (td2 >= 1.0f)
+				continue;
+
+			float tweight = (1.0f - td2) * (1.0f - td2);
+			int tj = j - taj0;
+			float th = trowsrc[tj];
+
+			switch (tbrush.mode)
+			{
+			case LJMUTerrainBrush::BRUSH_RAISE:
+				th += tdelta * tweight;
+				break;
+			case LJMUTerrainBrush::BRUSH_LOWER:
+				th -= tdelta * tweight;
+				break;
+			case LJMUTerrainBrush::BRUSH_SMOOTH:
+			{
+				//Mean of the 3 x 3 block, clamped at the map's edges
+				float tsum = 0.0f;
+				int tn = 0;
+				for (int di = std::max(i - 1, tai0) - tai0; di <= std::min(i + 1, tai1) - tai0; di++)
+				{
+					for (int dj = std::max(tj - 1, 0); dj <= std::min(tj + 1, tspan - 1); dj++)
+					{
+						tsum += tsrc[(size_t)di * tspan + dj];
+						tn++;
+					}
+				}
+				th += (tsum / (float)tn - th) * std::min(tbrush.strength * tweight, 1.0f);
+				break;
+			}
+			case LJMUTerrainBrush::BRUSH_FLATTEN:
+				th += (ttarget - th) * std::min(tbrush.strength * tweight, 1.0f);
+				break;
+			}
+
+			if (th < tlo || th > thi)
+			{
+				th = std::min(std::max(th, tlo), thi);
+				this->_stats.clamped++;
+			}
+			trowdst[tj] = th;
+		}
+	}
+
+	int twidth = tj1 - tj0 + 1;
+	for (int i = ti0; i <= ti1; i++)
+		tmap.writeRow(i, tj0, twidth, tdst + (size_t)(i - tai0) * tspan + (tj0 - taj0));
+
+	prect.i0 = ti0;
+	prect.j0 = tj0;
+	prect.i1 = ti1;
+	prect.j1 = tj1;
+	return true;
+}
+
+///////////////////////////
+// Merge a Rectangle with any
+// it Overlaps or Touches
+///////////////////////////
+void LJMUTerrainEditor::addRect(std::vector<Rect>& prects, const Rect& prect)
+{
+	Rect tmerged = prect;
+
+	//A grown rectangle can reach ones it missed before, so look again after every merge
+	for (size_t k = 0; k < prects.size();)
+	{
+		const Rect& tother = prects[k];
+		if (tother.i0 > tmerged.i1 + 1 || tother.i1 + 1 < tmerged.i0 || tother.j0 > tmerged.j1 + 1 || tother.j1 + 1 < tmerged.j0)
+		{
+			k++;
+			continue;
+		}
+
+		tmerged.i0 = std::min(tmerged.i0, tother.i0);
+		tmerged.j0 = std::min(tmerged.j0, tother.j0);
+		tmerged.i1 = std::max(tmerged.i1, tother.i1);
+		tmerged.j1 = std::max(tmerged.j1, tother.j1);
+		prects.erase(prects.begin() + k);
+		k = 0;
+	}
+
+	prects.push_back(tmerged);
+}
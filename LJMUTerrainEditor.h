@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Vector2f.h"
+#include "Vector3f.h"
+
+namespace LJMUDX
+{
+	class LJMUHeightmap;
+	class LJMUTerrainExecutor;
+	class LJMUTerrainHorizon;
+	class LJMUTerrainQuadtree;
+	class LJMUTerrainQuery;
+
+	/////////////////////////
+	// Shape of an edit. Every
+	// brush fades out smoothly
+	// from its centre to its
+	// radius.
+	/////////////////////////
+	struct LJMUTerrainBrush
+	{
+		enum Mode { BRUSH_RAISE, BRUSH_LOWER, BRUSH_SMOOTH, BRUSH_FLATTEN };
+
+		Mode	mode;
+		float	radius;			//World units
+		float	strength;		//Raise and lower: world units at the centre. Smooth and flatten: 0 to 1
+		float	height;			//World height flatten pulls towards
+	};
+
+	/////////////////////////
+	// Main thread cost of the
+	// edits, in milliseconds
+	/////////////////////////
+	struct LJMUTerrainEditStats
+	{
+		uint64_t	strokes;
+		uint64_t	batches;		//Frames that applied strokes
+		int			last_nodes;		//Chunks rebuilt by the last batch
+		uint64_t	clamped;		//Samples a stroke pushed past a unorm map's range
+		double		last_ms;
+		double		max_ms;
+	};
+
+	/////////////////////////
+	// Brush edits to a bound
+	// heightmap while the terrain
+	// is drawn.
+	//
+	// Strokes are queued and
+	// applied together once a
+	// frame. Each batch changes
+	// the samples under the
+	// brushes, grows the bounds of
+	// the quadtree nodes over them
+	// and hands those nodes' chunks
+	// to the executor to remesh on
+	// the thread pool. The workers
+	// read the map, so the next
+	// batch waits until they are
+	// done, usually a frame later.
+	//
+	// Bind a float map to edit
+	// freely. A unorm map only
+	// holds heights between its
+	// offset and offset + scale,
+	// so a stroke past that range
+	// is clamped to it and the
+	// clamped samples counted.
+	/////////////////////////
+	class LJMUTerrainEditor
+	{
+	public:
+		//--------CONSTRUCTORS/DESTRUCTORS----------------------------------------------------
+		LJMUTerrainEditor();
+
+		//--------PUBLIC METHODS-------------------------------------------------------------
+		// pmap must outlive the editor, placed as for the tree and its meshes
+		bool			bind(LJMUHeightmap& pmap, const Glyph3::Vector3f& porigin,
+							const Glyph3::Vector2f& pspacing, float pheightscale);
+		void			clear();
+
+		// Kept in step with the map, any of them may be null
+		void			setTerrain(LJMUTerrainQuadtree* ptree, LJMUTerrainExecutor* pexecutor) { this->_obj_tree = ptree; this->_obj_executor = pexecutor; }
+		void			setQuery(LJMUTerrainQuery* pquery) { this->_obj_query = pquery; }
+		void			setHorizon(LJMUTerrainHorizon* phorizon) { this->_obj_horizon = phorizon; }
+
+		bool			isBound() const { return this->_obj_map != nullptr; }
+
+		// Queues a stroke centred on world (px, pz) for the next update
+		void			stroke(const LJMUTerrainBrush& pbrush, float px, float pz);
+		int				getQueuedCount() const { return (int)this->_list_strokes.size(); }
+
+		// Call once a frame from the render thread. Swaps in the remeshed chunks and horizons,
+		// then applies the queued strokes unless the last remesh is still running.
+		void			update();
+
+		const LJMUTerrainEditStats&	getStats() const { return this->_stats; }
+
+	private:
+		//-------------HELPER TYPES----------------------------------------------------
+		struct Stroke
+		{
+			LJMUTerrainBrush	brush;
+			float				x;
+			float				z;
+		};
+
+		struct Rect
+		{
+			int		i0;
+			int		j0;
+			int		i1;				//Last sample, inclusive
+			int		j1;
+		};
+
+		//-------------HELPER METHODS--------------------------------------------------
+		bool			applyStroke(const Stroke& pstroke, Rect& prect);
+		static void		addRect(std::vector<Rect>& prects, const Rect& prect);
+
+		//--------CLASS MEMBERS--------------------------------------------------------------
+		LJMUHeightmap*			_obj_map;
+		LJMUTerrainQuadtree*	_obj_tree;
+		LJMUTerrainExecutor*	_obj_executor;
+		LJMUTerrainQuery*		_obj_query;
+		LJMUTerrainHorizon*		_obj_horizon;
+		Glyph3::Vector3f		_origin;
+		Glyph3::Vector2f		_spacing;
+		float					_height_scale;
+		std::vector<Stroke>		_list_strokes;
+		std::vector<Rect>		_list_rects;
+		std::vector<int>		_list_nodes;
+		std::vector<float>		_list_heights;
+		LJMUTerrainEditStats	_stats;
+	};
+}
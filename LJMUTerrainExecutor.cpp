@@ -0,0 +1,193 @@
+#include "LJMUTerrainExecutor.h"
+#include "LJMUHeightmap.h"
+#include "LJMUTerrainQuadtree.h"
+#include "LJMUThreadPool.h"
+
+#include <algorithm>
+
+using namespace LJMUDX;
+using namespace Glyph3;
+
+///////////////////////////
+// Constructor, the layout
+// matches the chunk meshes
+///////////////////////////
+LJMUTerrainExecutor::LJMUTerrainExecutor() :
+	_obj_tree(nullptr),
+	_obj_map(nullptr),
+	_obj_pool(nullptr),
+	_version(0),
+	_running(0)
+{
+	this->SetLayoutElements(BasicVertexDX11::GetElementCount(), BasicVertexDX11::Elements);
+}
+
+LJMUTerrainExecutor::~LJMUTerrainExecutor()
+{
+	this->clear();
+}
+
+///////////////////////////
+// Build every Chunk Mesh
+///////////////////////////
+bool LJMUTerrainExecutor::build(const LJMUTerrainQuadtree& ptree, const LJMUHeightmap& pmap, const LJMUTerrainMeshBuilder& pbuilder)
+{
+	this->clear();
+	if (ptree.getNodeCount() == 0 || pmap.isEmpty())
+		return false;
+
+	LJMUTerrainMeshBuilder tbuilder = pbuilder;
+	//Simplified chunks can sit a further max error away from their neighbours along a shared edge
+	tbuilder.setSkirtDepth(std::max(pbuilder.getSkirtDepth(), ptree.getMaxError() + pbuilder.getMaxError()));
+
+	this->_list_chunks.resize(ptree.getNodeCount());
+	for (int n = 0; n < ptree.getNodeCount(); n++)
+	{
+		this->_list_chunks[n] = tbuilder.build(pmap, ptree.getRegion(n));
+		if (!this->_list_chunks[n])
+		{
+			this->clear();
+			return false;
+		}
+	}
+
+	this->_obj_tree = &ptree;
+	this->_obj_map = &pmap;
+	this->_builder = pbuilder;
+	this->_list_versions.assign(ptree.getNodeCount(), 0);
+	return true;
+}
+
+///////////////////////////
+// Drop the Chunks
+///////////////////////////
+void LJMUTerrainExecutor::clear()
+{
+	std::unique_lock<std::mutex> tlock(this->_mutex);
+	this->_cv_idle.wait(tlock, [this]() { return this->_running == 0; });
+	this->_list_staged.clear();
+	tlock.unlock();
+
+	this->_list_chunks.clear();
+	this->_list_selected.clear();
+	this->_list_versions.clear();
+	this->_obj_tree = nullptr;
+	this->_obj_map = nullptr;
+}
+
+///////////////////////////
+// Start Rebuilding Chunks
+///////////////////////////
+void LJMUTerrainExecutor::rebuild(const std::vector<int>& pnodes)
+{
+	if (!this->_obj_tree || pnodes.empty())
+		return;
+
+	RebuildPtr trebuild = std::make_shared<Rebuild>();
+	trebuild->version = ++this->_version;
+
+	//Edits can deepen the tree's error past what the first skirts allowed for
+	trebuild->builder = this->_builder;
+	trebuild->builder.setSkirtDepth(std::max(this->_builder.getSkirtDepth(),
+		this->_obj_tree->getMaxError() + this->_builder.getMaxError()));
+
+	for (int tnode : pnodes)
+	{
+		if (tnode < 0 || tnode >= (int)this->_list_chunks.size() || this->_list_versions[tnode] == trebuild->version)
+			continue;
+
+		this->_list_versions[tnode] = trebuild->version;
+		trebuild->nodes.push_back(tnode);
+		trebuild->regions.push_back(this->_obj_tree->getRegion(tnode));
+	}
+
+	if (trebuild->nodes.empty())
+		return;
+
+	{
+		std::lock_guard<std::mutex> tlock(this->_mutex);
+		this->_running++;
+	}
+
+	LJMUThreadPool& tpool = this->_obj_pool ? *this->_obj_pool : LJMUThreadPool::getShared();
+	tpool.submit([this, trebuild]() { this->runRebuild(trebuild); });
+}
+
+///////////////////////////
+// Are Workers still Reading
+// the Map
+///////////////////////////
+bool LJMUTerrainExecutor::isRebuilding() const
+{
+	std::lock_guard<std::mutex> tlock(this->_mutex);
+	return this->_running > 0;
+}
+
+///////////////////////////
+// Swap in Finished Chunks
+///////////////////////////
+int LJMUTerrainExecutor::commitRebuilt()
+{
+	std::vector<RebuildPtr> tstaged;
+	{
+		std::lock_guard<std::mutex> tlock(this->_mutex);
+		tstaged.swap(this->_list_staged);
+	}
+
+	int tcommitted = 0;
+	for (const RebuildPtr& trebuild : tstaged)
+	{
+		for (size_t k = 0; k < trebuild->nodes.size(); k++)
+		{
+			int tnode = trebuild->nodes[k];
+			if (trebuild->meshes[k] && this->_list_versions[tnode] == trebuild->version)
+			{
+				this->_list_chunks[tnode] = trebuild->meshes[k];
+				tcommitted++;
+			}
+		}
+	}
+
+	return tcommitted;
+}
+
+///////////////////////////
+// Worker Side of a Rebuild
+///////////////////////////
+void LJMUTerrainExecutor::runRebuild(const RebuildPtr& prebuild)
+{
+	LJMUThreadPool& tpool = this->_obj_pool ? *this->_obj_pool : LJMUThreadPool::getShared();
+
+	prebuild->meshes.resize(prebuild->nodes.size());
+	tpool.parallelFor((int)prebuild->nodes.size(), [&](int k)
+	{
+		prebuild->meshes[k] = prebuild->builder.build(*this->_obj_map, prebuild->regions[k]);
+	});
+
+	std::lock_guard<std::mutex> tlock(this->_mutex);
+	this->_list_staged.push_back(prebuild);
+	this->_running--;
+	this->_cv_idle.notify_all();
+}
+
+///////////////////////////
+// Set the Chunks to Draw
+///////////////////////////
+void LJMUTerrainExecutor::setSelection(const std::vector<int>& pnodes)
+{
+	this->_list_selected.clear();
+	for (int tnode : pnodes)
+	{
+		if (tnode >= 0 && tnode < (int)this->_list_chunks.size())
+			this->_list_selected.push_back(tnode);
+	}
+}
+
+///////////////////////////
+// Draw the Selected Chunks
+///////////////////////////
+void LJMUTerrainExecutor::Execute(PipelineManagerDX11* pPipeline, IParameterManager* pParamManager)
+{
+	for (int tnode : this->_list_selected)
+		this->_list_chunks[tnode]->Execute(pPipeline, pParamManager);
+}
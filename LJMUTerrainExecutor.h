@@ -0,0 +1,102 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "PipelineExecutorDX11.h"
+
+#include "LJMUTerrainMeshBuilder.h"
+
+namespace LJMUDX
+{
+	class LJMUHeightmap;
+	class LJMUTerrainQuadtree;
+	class LJMUThreadPool;
+
+	/////////////////////////
+	// Draws the chunks of a
+	// terrain quadtree that were
+	// selected for this frame.
+	// Every node's mesh is built
+	// once up front, so changing
+	// the selection only changes
+	// which buffers are drawn.
+	//
+	// After the heights change,
+	// the meshes of the nodes over
+	// them are rebuilt on the
+	// thread pool while the old
+	// ones are still drawn.
+	/////////////////////////
+	class LJMUTerrainExecutor : public Glyph3::PipelineExecutorDX11
+	{
+	public:
+		//--------CONSTRUCTORS/DESTRUCTORS----------------------------------------------------
+		LJMUTerrainExecutor();
+		virtual ~LJMUTerrainExecutor();
+
+		//--------PUBLIC METHODS-------------------------------------------------------------
+		void			setThreadPool(LJMUThreadPool* ppool) { this->_obj_pool = ppool; }
+
+		// Builds one mesh per node with pbuilder's placement. The skirts are made at least as
+		// deep as the tree's largest height error so no seam can open between levels.
+		// ptree and pmap must outlive the executor for rebuild.
+		bool			build(const LJMUTerrainQuadtree& ptree, const LJMUHeightmap& pmap, const LJMUTerrainMeshBuilder& pbuilder);
+		void			clear();
+
+		// Starts rebuilding the meshes of pnodes from the map given to build, as listed by
+		// LJMUTerrainQuadtree::update. The workers read the map, so leave it alone until
+		// isRebuilding is false.
+		void			rebuild(const std::vector<int>& pnodes);
+		bool			isRebuilding() const;
+
+		// Swaps the finished meshes in, returning how many. Call from the render thread.
+		int				commitRebuilt();
+
+		// Node indices from LJMUTerrainQuadtree::select
+		void			setSelection(const std::vector<int>& pnodes);
+		int				getSelectedCount() const { return (int)this->_list_selected.size(); }
+		int				getChunkCount() const { return (int)this->_list_chunks.size(); }
+
+		virtual void	Execute(Glyph3::PipelineManagerDX11* pPipeline, Glyph3::IParameterManager* pParamManager);
+
+	private:
+		//-------------HELPER TYPES----------------------------------------------------
+		struct Rebuild
+		{
+			uint32_t							version;
+			LJMUTerrainMeshBuilder				builder;
+			std::vector<int>					nodes;
+			std::vector<LJMUTerrainRegion>		regions;
+			std::vector<LJMUTerrainMeshPtr>		meshes;
+		};
+
+		typedef std::shared_ptr<Rebuild> RebuildPtr;
+
+		//-------------HELPER METHODS--------------------------------------------------
+		void			runRebuild(const RebuildPtr& prebuild);
+
+		//--------CLASS MEMBERS--------------------------------------------------------------
+		std::vector<LJMUTerrainMeshPtr>	_list_chunks;		//One per quadtree node
+		std::vector<int>				_list_selected;
+		const LJMUTerrainQuadtree*		_obj_tree;
+		const LJMUHeightmap*			_obj_map;
+		LJMUTerrainMeshBuilder			_builder;
+		LJMUThreadPool*					_obj_pool;
+
+		//Render thread only
+		uint32_t						_version;
+		std::vector<uint32_t>			_list_versions;		//Latest rebuild of each node, older ones are dropped
+
+		//Shared with the workers
+		std::vector<RebuildPtr>			_list_staged;
+		int								_running;
+		mutable std::mutex				_mutex;
+		std::condition_variable			_cv_idle;
+	};
+
+	typedef std::shared_ptr<LJMUTerrainExecutor> LJMUTerrainExecutorPtr;
+}
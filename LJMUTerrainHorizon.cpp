@@ -0,0 +1,436 @@
+#include "LJMUTerrainHorizon.h"
+#include "LJMUHeightmap.h"
+#include "LJMUThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace LJMUDX;
+using namespace Glyph3;
+
+namespace
+{
+	const float HORIZON_PI = 3.14159265f;
+	const float HORIZON_CODES = 255.0f / (HORIZON_PI * 0.5f);		//Codes per radian of elevation
+	const float HORIZON_GROWTH = 0.125f;							//Steps lengthen by this share of the distance walked
+
+	inline float saturate(float pvalue)
+	{
+		return std::min(std::max(pvalue, 0.0f), 1.0f);
+	}
+}
+
+///////////////////////////
+// Constructor
+///////////////////////////
+LJMUTerrainHorizon::LJMUTerrainHorizon() :
+	_obj_map(nullptr),
+	_obj_pool(nullptr),
+	_direction_count(16),
+	_max_distance(2000.0f),
+	_penumbra(0.05f),
+	_origin(0.0f, 0.0f, 0.0f),
+	_spacing(1.0f, 1.0f),
+	_height_scale(1.0f),
+	_width(0),
+	_length(0),
+	_max_height(0.0f),
+	_pending(false),
+	_running(0)
+{
+	this->_pending_region = { 0, 0, -1, -1 };
+}
+
+LJMUTerrainHorizon::~LJMUTerrainHorizon()
+{
+	this->clear();
+}
+
+///////////////////////////
+// Bake every Sample
+///////////////////////////
+bool LJMUTerrainHorizon::build(const LJMUHeightmap& pmap, const Vector3f& porigin, const Vector2f& pspacing, float pheightscale)
+{
+	this->clear();
+	if (pmap.getWidth() < 2 || pmap.getLength() < 2 || pspacing.x <= 0.0f || pspacing.y <= 0.0f ||
+		this->_direction_count < 1 || this->_max_distance <= 0.0f)
+		return false;
+
+	this->_origin = porigin;
+	this->_spacing = pspacing;
+	this->_height_scale = pheightscale;
+	this->_width = pmap.getWidth();
+	this->_length = pmap.getLength();
+
+	LJMUThreadPool& tpool = this->_obj_pool ? *this->_obj_pool : LJMUThreadPool::getShared();
+
+	this->_list_heights.resize((size_t)this->_width * this->_length);
+	tpool.parallelFor(this->_width, [&](int i)
+	{
+		float* trow = this->_list_heights.data() + (size_t)i * this->_length;
+		pmap.readRow(i, 0, this->_length, trow);
+		for (int j = 0; j < this->_length; j++)
+			trow[j] *= pheightscale;
+	});
+	this->_max_height = *std::max_element(this->_list_heights.begin(), this->_list_heights.end());
+
+	this->_list_steps.resize(this->_direction_count);
+	for (int k = 0; k < this->_direction_count; k++)
+	{
+		float tazimuth = 2.0f * HORIZON_PI * (float)k / (float)this->_direction_count;
+		this->_list_steps[k] = Vector2f(std::cos(tazimuth) / pspacing.x, std::sin(tazimuth) / pspacing.y);
+	}
+
+	//One sample apart close in, where the nearest hills matter most, then further apart
+	float tmin = std::min(pspacing.x, pspacing.y);
+	this->_list_distances.clear();
+	for (float d = tmin; d <= this->_max_distance; d += std::max(tmin, d * HORIZON_GROWTH))
+		this->_list_distances.push_back(d);
+
+	this->_list_horizons.resize((size_t)this->_width * this->_length * this->_direction_count);
+	this->_list_occlusion.resize((size_t)this->_width * this->_length);
+	tpool.parallelFor(this->_width, [&](int i)
+	{
+		for (int j = 0; j < this->_length; j++)
+		{
+			size_t tindex = (size_t)i * this->_length + j;
+			this->bakeSample(i, j, &this->_list_horizons[tindex * this->_direction_count], this->_list_occlusion[tindex]);
+		}
+	});
+
+	this->_obj_map = &pmap;
+	return true;
+}
+
+///////////////////////////
+// Wait for the Workers and
+// Drop Everything
+///////////////////////////
+void LJMUTerrainHorizon::clear()
+{
+	std::unique_lock<std::mutex> tlock(this->_mutex);
+	this->_cv_idle.wait(tlock, [this]() { return this->_running == 0; });
+	this->_list_staged.clear();
+	tlock.unlock();
+
+	this->_obj_map = nullptr;
+	this->_pending = false;
+	this->_width = 0;
+	this->_length = 0;
+	this->_list_heights.clear();
+	this->_list_horizons.clear();
+	this->_list_occlusion.clear();
+}
+
+///////////////////////////
+// Queue a Changed Region
+///////////////////////////
+void LJMUTerrainHorizon::update(int pi0, int pj0, int pwidth, int plength)
+{
+	if (!this->_obj_map)
+		return;
+
+	Region tregion = { std::max(pi0, 0), std::max(pj0, 0),
+		std::min(pi0 + pwidth, this->_width) - 1, std::min(pj0 + plength, this->_length) - 1 };
+	if (tregion.i0 > tregion.i1 || tregion.j0 > tregion.j1)
+		return;
+
+	//Everything changed while an update runs goes into the next one
+	if (this->_pending)
+	{
+		tregion.i0 = std::min(tregion.i0, this->_pending_region.i0);
+		tregion.j0 = std::min(tregion.j0, this->_pending_region.j0);
+		tregion.i1 = std::max(tregion.i1, this->_pending_region.i1);
+		tregion.j1 = std::max(tregion.j1, this->_pending_region.j1);
+	}
+
+	this->_pending = true;
+	this->_pending_region = tregion;
+	this->startPending();
+}
+
+///////////////////////////
+// Work Running or Waiting
+///////////////////////////
+bool LJMUTerrainHorizon::isUpdating() const
+{
+	std::lock_guard<std::mutex> tlock(this->_mutex);
+	return this->_running > 0 || this->_pending;
+}
+
+///////////////////////////
+// Swap in Finished Updates
+///////////////////////////
+int LJMUTerrainHorizon::commitUpdates()
+{
+	std::vector<UpdatePtr> tstaged;
+	{
+		std::lock_guard<std::mutex> tlock(this->_mutex);
+		tstaged.swap(this->_list_staged);
+	}
+
+	int tcommitted = 0;
+	int tdirections = this->_direction_count;
+	for (const UpdatePtr& tupdate : tstaged)
+	{
+		const Region& tregion = tupdate->region;
+		int tspan = tregion.j1 - tregion.j0 + 1;
+
+		for (int i = tregion.i0; i <= tregion.i1; i++)
+		{
+			size_t tfrom = (size_t)(i - tregion.i0) * tspan;
+			size_t tto = (size_t)i * this->_length + tregion.j0;
+			std::copy(tupdate->horizons.begin() + tfrom * tdirections, tupdate->horizons.begin() + (tfrom + tspan) * tdirections,
+				this->_list_horizons.begin() + tto * tdirections);
+			std::copy(tupdate->occlusion.begin() + tfrom, tupdate->occlusion.begin() + tfrom + tspan,
+				this->_list_occlusion.begin() + tto);
+		}
+
+		tcommitted += (tregion.i1 - tregion.i0 + 1) * tspan;
+	}
+
+	this->startPending();
+	return tcommitted;
+}
+
+///////////////////////////
+// Horizon toward an Azimuth,
+// between the two Nearest
+// Directions
+///////////////////////////
+float LJMUTerrainHorizon::getHorizon(int pi, int pj, float pazimuth) const
+{
+	if (!this->_obj_map)
+		return 0.0f;
+
+	pi = std::min(std::max(pi, 0), this->_width - 1);
+	pj = std::min(std::max(pj, 0), this->_length - 1);
+
+	float tturn = pazimuth / (2.0f * HORIZON_PI);
+	float tk = (tturn - std::floor(tturn)) * (float)this->_direction_count;
+	int tk0 = std::min((int)tk, this->_direction_count - 1);
+	int tk1 = (tk0 + 1) % this->_direction_count;
+	float tf = tk - (float)tk0;
+
+	const uint8_t* thorizons = &this->_list_horizons[((size_t)pi * this->_length + pj) * this->_direction_count];
+	return ((float)thorizons[tk0] + ((float)thorizons[tk1] - (float)thorizons[tk0]) * tf) / HORIZON_CODES;
+}
+
+///////////////////////////
+// Sunlight at a World Point
+///////////////////////////
+float LJMUTerrainHorizon::getSunlight(float px, float pz, const Vector3f& pdirection) const
+{
+	float tlength = std::sqrt(pdirection.x * pdirection.x + pdirection.y * pdirection.y + pdirection.z * pdirection.z);
+	if (!this->_obj_map || tlength <= 0.0f)
+		return 1.0f;
+
+	//The sun lies back along the direction the light travels
+	float televation = std::asin(std::max(-1.0f, std::min(1.0f, -pdirection.y / tlength)));
+	float tazimuth = std::atan2(-pdirection.z, -pdirection.x);
+
+	float tfi = std::min(std::max((px - this->_origin.x) / this->_spacing.x, 0.0f), (float)(this->_width - 1));
+	float tfj = std::min(std::max((pz - this->_origin.z) / this->_spacing.y, 0.0f), (float)(this->_length - 1));
+	int ti = std::min((int)tfi, this->_width - 2);
+	int tj = std::min((int)tfj, this->_length - 2);
+	float tu = tfi - (float)ti;
+	float tv = tfj - (float)tj;
+
+	float ttop = this->getSunlight(ti, tj, tazimuth, televation) * (1.0f - tv) + this->getSunlight(ti, tj + 1, tazimuth, televation) * tv;
+	float tbottom = this->getSunlight(ti + 1, tj, tazimuth, televation) * (1.0f - tv) + this->getSunlight(ti + 1, tj + 1, tazimuth, televation) * tv;
+	return ttop + (tbottom - ttop) * tu;
+}
+
+///////////////////////////
+// Open Sky at a World Point
+///////////////////////////
+float LJMUTerrainHorizon::getOcclusion(float px, float pz) const
+{
+	if (!this->_obj_map)
+		return 1.0f;
+
+	float tfi = std::min(std::max((px - this->_origin.x) / this->_spacing.x, 0.0f), (float)(this->_width - 1));
+	float tfj = std::min(std::max((pz - this->_origin.z) / this->_spacing.y, 0.0f), (float)(this->_length - 1));
+	int ti = std::min((int)tfi, this->_width - 2);
+	int tj = std::min((int)tfj, this->_length - 2);
+	float tu = tfi - (float)ti;
+	float tv = tfj - (float)tj;
+
+	const uint8_t* trow = &this->_list_occlusion[(size_t)ti * this->_length + tj];
+	const uint8_t* tnext = trow + this->_length;
+	float ttop = (float)trow[0] + ((float)trow[1] - (float)trow[0]) * tv;
+	float tbottom = (float)tnext[0] + ((float)tnext[1] - (float)tnext[0]) * tv;
+	return (ttop + (tbottom - ttop) * tu) / 255.0f;
+}
+
+///////////////////////////
+// Sunlight of every Sample
+///////////////////////////
+bool LJMUTerrainHorizon::bakeSunlight(const Vector3f& pdirection, std::vector<uint8_t>& psunlight) const
+{
+	float tlength = std::sqrt(pdirection.x * pdirection.x + pdirection.y * pdirection.y + pdirection.z * pdirection.z);
+	if (!this->_obj_map || tlength <= 0.0f)
+		return false;
+
+	float televation = std::asin(std::max(-1.0f, std::min(1.0f, -pdirection.y / tlength)));
+	float tazimuth = std::atan2(-pdirection.z, -pdirection.x);
+
+	psunlight.resize((size_t)this->_width * this->_length);
+
+	LJMUThreadPool& tpool = this->_obj_pool ? *this->_obj_pool : LJMUThreadPool::getShared();
+	tpool.parallelFor(this->_width, [&](int i)
+	{
+		uint8_t* trow = psunlight.data() + (size_t)i * this->_length;
+		for (int j = 0; j < this->_length; j++)
+			trow[j] = (uint8_t)(this->getSunlight(i, j, tazimuth, televation) * 255.0f + 0.5f);
+	});
+
+	return true;
+}
+
+///////////////////////////
+// Walk out from one Sample in
+// every Direction. A walk
+// stops once even the highest
+// ground in the map could not
+// rise above the horizon found
+// so far.
+///////////////////////////
+void LJMUTerrainHorizon::bakeSample(int pi, int pj, uint8_t* phorizons, uint8_t& pocclusion) const
+{
+	const float* theights = this->_list_heights.data();
+	float th0 = theights[(size_t)pi * this->_length + pj];
+	float tclimb = this->_max_height - th0;
+	float tlasti = (float)(this->_width - 1);
+	float tlastj = (float)(this->_length - 1);
+	float tsky = 0.0f;
+
+	for (int k = 0; k < this->_direction_count; k++)
+	{
+		const Vector2f& tstep = this->_list_steps[k];
+		float tbest = 0.0f;			//Tangent of the horizon, flat ground at worst
+
+		for (float d : this->_list_distances)
+		{
+			if (tclimb <= tbest * d)
+				break;
+
+			float tfi = (float)pi + tstep.x * d;
+			float tfj = (float)pj + tstep.y * d;
+			if (tfi < 0.0f || tfj < 0.0f || tfi > tlasti || tfj > tlastj)
+				break;
+
+			int ti = std::min((int)tfi, this->_width - 2);
+			int tj = std::min((int)tfj, this->_length - 2);
+			float tu = tfi - (float)ti;
+			float tv = tfj - (float)tj;
+
+			const float* trow = theights + (size_t)ti * this->_length + tj;
+			const float* tnext = trow + this->_length;
+			float ttop = trow[0] + (trow[1] - trow[0]) * tv;
+			float tbottom = tnext[0] + (tnext[1] - tnext[0]) * tv;
+			float th = ttop + (tbottom - ttop) * tu;
+
+			tbest = std::max(tbest, (th - th0) / d);
+		}
+
+		phorizons[k] = (uint8_t)(std::atan(tbest) * HORIZON_CODES + 0.5f);
+
+		//Cosine weighted sky above the horizon, cos^2 of its elevation
+		tsky += 1.0f / (1.0f + tbest * tbest);
+	}
+
+	pocclusion = (uint8_t)(tsky / (float)this->_direction_count * 255.0f + 0.5f);
+}
+
+///////////////////////////
+// Sunlight at a Sample, soft
+// across the penumbra
+///////////////////////////
+float LJMUTerrainHorizon::getSunlight(int pi, int pj, float pazimuth, float pelevation) const
+{
+	float thorizon = this->getHorizon(pi, pj, pazimuth);
+	if (this->_penumbra <= 0.0f)
+		return pelevation >= thorizon ? 1.0f : 0.0f;
+
+	return saturate((pelevation - thorizon) / this->_penumbra + 0.5f);
+}
+
+///////////////////////////
+// Start the Waiting Update.
+// Its heights are copied in
+// here, on the render thread,
+// while no worker reads them.
+///////////////////////////
+void LJMUTerrainHorizon::startPending()
+{
+	if (!this->_pending || !this->_obj_map)
+		return;
+
+	{
+		std::lock_guard<std::mutex> tlock(this->_mutex);
+		if (this->_running > 0)
+			return;
+	}
+
+	const Region& tchanged = this->_pending_region;
+	int tspan = tchanged.j1 - tchanged.j0 + 1;
+	for (int i = tchanged.i0; i <= tchanged.i1; i++)
+	{
+		float* trow = this->_list_heights.data() + (size_t)i * this->_length + tchanged.j0;
+		this->_obj_map->readRow(i, tchanged.j0, tspan, trow);
+		for (int j = 0; j < tspan; j++)
+		{
+			trow[j] *= this->_height_scale;
+			this->_max_height = std::max(this->_max_height, trow[j]);
+		}
+	}
+
+	//Any sample close enough to see the changed ones can have a new horizon
+	int treachi = (int)std::ceil(this->_max_distance / this->_spacing.x);
+	int treachj = (int)std::ceil(this->_max_distance / this->_spacing.y);
+
+	UpdatePtr tupdate = std::make_shared<Update>();
+	tupdate->region.i0 = std::max(tchanged.i0 - treachi, 0);
+	tupdate->region.j0 = std::max(tchanged.j0 - treachj, 0);
+	tupdate->region.i1 = std::min(tchanged.i1 + treachi, this->_width - 1);
+	tupdate->region.j1 = std::min(tchanged.j1 + treachj, this->_length - 1);
+	this->_pending = false;
+
+	{
+		std::lock_guard<std::mutex> tlock(this->_mutex);
+		this->_running++;
+	}
+
+	LJMUThreadPool& tpool = this->_obj_pool ? *this->_obj_pool : LJMUThreadPool::getShared();
+	tpool.submit([this, tupdate]() { this->runUpdate(tupdate); });
+}
+
+///////////////////////////
+// Worker Side of an Update
+///////////////////////////
+void LJMUTerrainHorizon::runUpdate(const UpdatePtr& pupdate)
+{
+	const Region& tregion = pupdate->region;
+	int tspan = tregion.j1 - tregion.j0 + 1;
+	int trows = tregion.i1 - tregion.i0 + 1;
+
+	pupdate->horizons.resize((size_t)trows * tspan * this->_direction_count);
+	pupdate->occlusion.resize((size_t)trows * tspan);
+
+	LJMUThreadPool& tpool = this->_obj_pool ? *this->_obj_pool : LJMUThreadPool::getShared();
+	tpool.parallelFor(trows, [&](int r)
+	{
+		for (int j = 0; j < tspan; j++)
+		{
+			size_t tindex = (size_t)r * tspan + j;
+			this->bakeSample(tregion.i0 + r, tregion.j0 + j, &pupdate->horizons[tindex * this->_direction_count],
+				pupdate->occlusion[tindex]);
+		}
+	});
+
+	std::lock_guard<std::mutex> tlock(this->_mutex);
+	this->_list_staged.push_back(pupdate);
+	this->_running--;
+	this->_cv_idle.notify_all();
+}
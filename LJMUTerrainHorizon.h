@@ -0,0 +1,149 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Vector2f.h"
+#include "Vector3f.h"
+
+namespace LJMUDX
+{
+	class LJMUHeightmap;
+	class LJMUThreadPool;
+
+	/////////////////////////
+	// Horizon angles over a
+	// heightmap, for terrain
+	// shadows from any sun
+	// direction and an ambient
+	// occlusion term.
+	//
+	// Each sample stores how far
+	// above flat the ground rises
+	// in a number of directions
+	// around it, found by walking
+	// out with steps that grow
+	// with distance. The sun
+	// reaches a sample when it is
+	// above the horizon in its
+	// direction, and the open sky
+	// left above all the horizons
+	// gives the occlusion.
+	//
+	// The heights are copied in,
+	// so updates after an edit
+	// run on the thread pool
+	// without touching the map
+	// while the old angles are
+	// still looked up.
+	/////////////////////////
+	class LJMUTerrainHorizon
+	{
+	public:
+		//--------CONSTRUCTORS/DESTRUCTORS----------------------------------------------------
+		LJMUTerrainHorizon();
+		~LJMUTerrainHorizon();
+
+		LJMUTerrainHorizon(const LJMUTerrainHorizon&) = delete;
+		LJMUTerrainHorizon& operator=(const LJMUTerrainHorizon&) = delete;
+
+		//--------PUBLIC METHODS-------------------------------------------------------------
+		void			setThreadPool(LJMUThreadPool* ppool) { this->_obj_pool = ppool; }
+
+		// Set before build. Hills further than pdistance world units away cast no shadow.
+		void			setDirectionCount(int pcount) { this->_direction_count = pcount; }
+		void			setMaxDistance(float pdistance) { this->_max_distance = pdistance; }
+
+		// Width in radians of the soft edge between sun and shadow
+		void			setPenumbra(float pangle) { this->_penumbra = pangle; }
+
+		// Bakes every sample of pmap, placed as for the mesh builder. pmap must outlive the
+		// horizons for update.
+		bool			build(const LJMUHeightmap& pmap, const Glyph3::Vector3f& porigin,
+							const Glyph3::Vector2f& pspacing, float pheightscale);
+		void			clear();
+
+		bool			isBuilt() const { return this->_obj_map != nullptr; }
+		int				getDirectionCount() const { return this->_direction_count; }
+
+		// Call after changing samples [pi0, pi0 + pwidth) x [pj0, pj0 + plength) of the map.
+		// Rebakes every sample within the max distance of them on the pool, later changes
+		// waiting for the one running.
+		void			update(int pi0, int pj0, int pwidth, int plength);
+		bool			isUpdating() const;
+
+		// Swaps in finished updates and starts waiting ones, returning the samples swapped.
+		// Call from the render thread.
+		int				commitUpdates();
+
+		// Horizon elevation in radians at a sample, towards world azimuth pazimuth
+		// measured from +x to +z
+		float			getHorizon(int pi, int pj, float pazimuth) const;
+
+		// 0 in shadow to 1 in full sun at world (px, pz), for light travelling along pdirection
+		float			getSunlight(float px, float pz, const Glyph3::Vector3f& pdirection) const;
+
+		// Cosine weighted open sky at world (px, pz), 1 on a peak and falling in hollows
+		float			getOcclusion(float px, float pz) const;
+
+		// Sunlight of every sample for one light direction, 255 in full sun, laid out
+		// [i * length + j]. A lookup per sample, cheap enough to redo as the sun moves.
+		bool			bakeSunlight(const Glyph3::Vector3f& pdirection, std::vector<uint8_t>& psunlight) const;
+
+	private:
+		//-------------HELPER TYPES----------------------------------------------------
+		struct Region
+		{
+			int		i0;
+			int		j0;
+			int		i1;				//Last sample, inclusive
+			int		j1;
+		};
+
+		struct Update
+		{
+			Region					region;
+			std::vector<uint8_t>	horizons;
+			std::vector<uint8_t>	occlusion;
+		};
+
+		typedef std::shared_ptr<Update> UpdatePtr;
+
+		//-------------HELPER METHODS--------------------------------------------------
+		void			bakeSample(int pi, int pj, uint8_t* phorizons, uint8_t& pocclusion) const;
+		float			getSunlight(int pi, int pj, float pazimuth, float pelevation) const;
+		void			startPending();
+		void			runUpdate(const UpdatePtr& pupdate);
+
+		//--------CLASS MEMBERS--------------------------------------------------------------
+		const LJMUHeightmap*		_obj_map;
+		LJMUThreadPool*				_obj_pool;
+		int							_direction_count;
+		float						_max_distance;
+		float						_penumbra;
+		Glyph3::Vector3f			_origin;
+		Glyph3::Vector2f			_spacing;
+		float						_height_scale;
+		int							_width;
+		int							_length;
+		float						_max_height;
+		std::vector<float>			_list_heights;		//World heights, read by the workers
+		std::vector<float>			_list_distances;	//Steps of the walk, world units
+		std::vector<Glyph3::Vector2f>	_list_steps;		//Samples per world unit along each direction
+
+		//Render thread only
+		std::vector<uint8_t>		_list_horizons;		//[(i * length + j) * directions + k], 0 to 90 degrees
+		std::vector<uint8_t>		_list_occlusion;
+		bool						_pending;
+		Region						_pending_region;
+
+		//Shared with the workers
+		std::vector<UpdatePtr>		_list_staged;
+		int							_running;
+		mutable std::mutex			_mutex;
+		std::condition_variable		_cv_idle;
+	};
+}
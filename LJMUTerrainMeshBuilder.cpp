@@ -0,0 +1,325 @@
+#include "LJMUTerrainMeshBuilder.h"
+#include "LJMUHeightmap.h"
+#include "LJMUMeshOptimizer.h"
+#include "LJMUTerrainRTIN.h"
+#include "LJMUThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace LJMUDX;
+using namespace Glyph3;
+
+///////////////////////////
+// Constructor
+///////////////////////////
+LJMUTerrainMeshBuilder::LJMUTerrainMeshBuilder() :
+	_origin(0.0f, 0.0f, 0.0f),
+	_spacing(1.0f, 1.0f),
+	_height_scale(1.0f),
+	_skirt_depth(0.0f),
+	_max_error(0.0f),
+	_tex_scale(1.0f, 1.0f),
+	_colour(1.0f, 1.0f, 1.0f, 1.0f),
+	_obj_pool(nullptr)
+{
+
+}
+
+///////////////////////////
+// Region Covering a Map
+///////////////////////////
+LJMUTerrainRegion LJMUTerrainMeshBuilder::getWholeMap(const LJMUHeightmap& pmap)
+{
+	LJMUTerrainRegion tregion = { 0, 0, pmap.getWidth(), pmap.getLength(), 1 };
+	return tregion;
+}
+
+///////////////////////////
+// Build the Mesh for a Map
+///////////////////////////
+LJMUTerrainMeshPtr LJMUTerrainMeshBuilder::build(const LJMUHeightmap& pmap) const
+{
+	return this->build(pmap, getWholeMap(pmap));
+}
+
+LJMUTerrainMeshPtr LJMUTerrainMeshBuilder::build(const LJMUHeightmap& pmap, const LJMUTerrainRegion& pregion) const
+{
+	if (pmap.isEmpty() || pregion.width < 2 || pregion.length < 2)
+		return nullptr;
+
+	std::vector<BasicVertexDX11::Vertex> tvertices;
+	std::vector<uint32_t> tindices;
+	this->buildVertices(pmap, pregion, tvertices);
+	if (this->isAdaptive(pregion))
+		this->simplify(pregion, tvertices, tindices);
+	else
+		buildIndices(pregion.width, pregion.length, tindices, this->_skirt_depth > 0.0f);
+
+	//Rows of cells reuse little of the vertex cache. A height field seen from above has
+	//little overdraw to sort out, so only the cache and fetch order are worth the time.
+	LJMUMeshOptimizer::optimizeVertexCache(tindices, tvertices.size());
+	LJMUMeshOptimizer::optimizeVertexFetch(tvertices, tindices);
+
+	auto tmesh = std::make_shared<DrawIndexedExecutorDX11<BasicVertexDX11::Vertex>>();
+	tmesh->SetLayoutElements(BasicVertexDX11::GetElementCount(), BasicVertexDX11::Elements);
+	tmesh->SetPrimitiveType(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+	//Size the buffers once instead of letting them grow
+	tmesh->SetMaxVertexCount((unsigned int)tvertices.size());
+	tmesh->SetMaxIndexCount((unsigned int)tindices.size());
+
+	for (const auto& tvertex : tvertices)
+		tmesh->AddVertex(tvertex);
+
+	for (size_t i = 0; i < tindices.size(); i += 3)
+		tmesh->AddIndices(tindices[i], tindices[i + 1], tindices[i + 2]);
+
+	return tmesh;
+}
+
+///////////////////////////
+// Whether build Simplifies
+// the Region
+///////////////////////////
+bool LJMUTerrainMeshBuilder::isAdaptive(const LJMUTerrainRegion& pregion) const
+{
+	return this->_max_error > 0.0f && pregion.width == pregion.length && LJMUTerrainRTIN::isGridSize(pregion.width);
+}
+
+///////////////////////////
+// Positions and Normals,
+// one Row of Vertices per Task
+///////////////////////////
+void LJMUTerrainMeshBuilder::buildVertices(const LJMUHeightmap& pmap, const LJMUTerrainRegion& pregion,
+	std::vector<BasicVertexDX11::Vertex>& pvertices) const
+{
+	pvertices.clear();
+	if (pregion.width <= 0 || pregion.length <= 0 || pmap.isEmpty())
+		return;
+
+	size_t tgridcount = (size_t)pregion.width * pregion.length;
+	pvertices.resize(tgridcount);
+
+	LJMUThreadPool& tpool = this->_obj_pool ? *this->_obj_pool : LJMUThreadPool::getShared();
+
+	int tmapwidth = pmap.getWidth();
+	int tmaplength = pmap.getLength();
+	int tstep = std::max(pregion.step, 1);
+
+	//Columns touched by the region, including the neighbours used by the normals
+	int tjlo = std::max(pregion.j0 - tstep, 0);
+	int tjhi = std::min(pregion.j0 + (pregion.length - 1) * tstep + tstep, tmaplength - 1);
+	int tspan = tjhi - tjlo + 1;
+
+	float tu = this->_tex_scale.x / (float)tmapwidth;
+	float tv = this->_tex_scale.y / (float)tmaplength;
+
+	tpool.parallelFor(pregion.width, [&](int pvi)
+	{
+		int ti = std::min(pregion.i0 + pvi * tstep, tmapwidth - 1);
+		int tiprev = std::max(ti - tstep, 0);
+		int tinext = std::min(ti + tstep, tmapwidth - 1);
+
+		thread_local std::vector<float> trows;
+		trows.resize((size_t)tspan * 3);
+
+		float* tprev = trows.data();
+		float* tcur = tprev + tspan;
+		float* tnext = tcur + tspan;
+		pmap.readRow(tiprev, tjlo, tspan, tprev);
+		pmap.readRow(ti, tjlo, tspan, tcur);
+		pmap.readRow(tinext, tjlo, tspan, tnext);
+
+		//Central differences, one sided at the map edges
+		float tdi = (float)(tinext - tiprev) * this->_spacing.x;
+		BasicVertexDX11::Vertex* tout = pvertices.data() + (size_t)pvi * pregion.length;
+
+		for (int vj = 0; vj < pregion.length; vj++)
+		{
+			int tj = std::min(pregion.j0 + vj * tstep, tmaplength - 1);
+			int tjprev = std::max(tj - tstep, 0);
+			int tjnext = std::min(tj + tstep, tmaplength - 1);
+			float tdj = (float)(tjnext - tjprev) * this->_spacing.y;
+
+			float th = tcur[tj - tjlo];
+			float tdhdi = tdi > 0.0f ? (tnext[tj - tjlo] - tprev[tj - tjlo]) * this->_height_scale / tdi : 0.0f;
+			float tdhdj = tdj > 0.0f ? (tcur[tjnext - tjlo] - tcur[tjprev - tjlo]) * this->_height_scale / tdj : 0.0f;
+
+			BasicVertexDX11::Vertex& tvertex = tout[vj];
+			tvertex.position = Vector3f(this->_origin.x + ti * this->_spacing.x,
+				this->_origin.y + th * this->_height_scale,
+				this->_origin.z + tj * this->_spacing.y);
+
+			Vector3f tnormal(-tdhdi, 1.0f, -tdhdj);
+			tnormal.Normalize();
+			tvertex.normal = tnormal;
+
+			tvertex.color = this->_colour;
+			tvertex.texcoords = Vector2f(ti * tu, tj * tv);
+		}
+	});
+
+	if (this->_skirt_depth <= 0.0f || pregion.width < 2 || pregion.length < 2)
+		return;
+
+	//Skirt vertices copy the border, keeping its normal so the lighting does not step
+	std::vector<uint32_t> tborder;
+	getBorder(pregion.width, pregion.length, tborder);
+	pvertices.resize(tgridcount + tborder.size());
+
+	for (size_t k = 0; k < tborder.size(); k++)
+	{
+		BasicVertexDX11::Vertex& tskirt = pvertices[tgridcount + k];
+		tskirt = pvertices[tborder[k]];
+		tskirt.position.y -= this->_skirt_depth;
+	}
+}
+
+///////////////////////////
+// Triangle List Indices
+///////////////////////////
+void LJMUTerrainMeshBuilder::buildIndices(int pwidth, int plength, std::vector<uint32_t>& pindices, bool pskirt)
+{
+	pindices.clear();
+	if (pwidth < 2 || plength < 2)
+		return;
+
+	size_t tborderlength = (size_t)(pwidth - 1) * 2 + (size_t)(plength - 1) * 2;
+	pindices.reserve((size_t)(pwidth - 1) * (plength - 1) * 6 + (pskirt ? tborderlength * 6 : 0));
+
+	for (int i = 0; i < pwidth - 1; i++)
+	{
+		for (int j = 0; j < plength - 1; j++)
+		{
+			uint32_t ti0 = (uint32_t)(i * plength + j);
+			uint32_t ti1 = ti0 + plength;
+			uint32_t ti2 = ti1 + 1;
+			uint32_t ti3 = ti0 + 1;
+
+			pindices.push_back(ti3);
+			pindices.push_back(ti1);
+			pindices.push_back(ti0);
+
+			pindices.push_back(ti3);
+			pindices.push_back(ti2);
+			pindices.push_back(ti1);
+		}
+	}
+
+	if (!pskirt)
+		return;
+
+	//One quad between each border edge and the skirt vertices below it, facing outwards
+	std::vector<uint32_t> tborder;
+	getBorder(pwidth, plength, tborder);
+
+	uint32_t tfirstskirt = (uint32_t)pwidth * plength;
+	uint32_t tcount = (uint32_t)tborder.size();
+
+	for (uint32_t k = 0; k < tcount; k++)
+	{
+		uint32_t tnext = (k + 1) % tcount;
+		uint32_t te0 = tborder[k];
+		uint32_t te1 = tborder[tnext];
+		uint32_t ts0 = tfirstskirt + k;
+		uint32_t ts1 = tfirstskirt + tnext;
+
+		pindices.push_back(te0);
+		pindices.push_back(ts0);
+		pindices.push_back(te1);
+
+		pindices.push_back(te1);
+		pindices.push_back(ts0);
+		pindices.push_back(ts1);
+	}
+}
+
+///////////////////////////
+// Border Vertices in Order
+// along i = 0, j = length - 1,
+// i = width - 1, then j = 0
+///////////////////////////
+void LJMUTerrainMeshBuilder::getBorder(int pwidth, int plength, std::vector<uint32_t>& pborder)
+{
+	pborder.clear();
+
+	for (int j = 0; j < plength - 1; j++)
+		pborder.push_back((uint32_t)j);
+	for (int i = 0; i < pwidth - 1; i++)
+		pborder.push_back((uint32_t)(i * plength + plength - 1));
+	for (int j = plength - 1; j > 0; j--)
+		pborder.push_back((uint32_t)((pwidth - 1) * plength + j));
+	for (int i = pwidth - 1; i > 0; i--)
+		pborder.push_back((uint32_t)(i * plength));
+}
+
+///////////////////////////
+// Keep the Vertices the RTIN
+// Needs, in the Order the
+// Triangles first Use them
+///////////////////////////
+void LJMUTerrainMeshBuilder::simplify(const LJMUTerrainRegion& pregion, std::vector<BasicVertexDX11::Vertex>& pvertices,
+	std::vector<uint32_t>& pindices) const
+{
+	int tsize = pregion.width;
+	size_t tgridcount = (size_t)tsize * tsize;
+
+	//The errors are measured on the world heights, so the limit is in world units
+	std::vector<float> theights(tgridcount);
+	for (size_t v = 0; v < tgridcount; v++)
+		theights[v] = pvertices[v].position.y;
+
+	std::vector<float> terrors;
+	LJMUTerrainRTIN::computeErrors(theights.data(), tsize, terrors);
+	LJMUTerrainRTIN::buildIndices(terrors, tsize, this->_max_error, pindices);
+
+	//Skirt quads hang from each pair of kept border vertices, which are the mesh's border edges
+	if (this->_skirt_depth > 0.0f && pvertices.size() > tgridcount)
+	{
+		std::vector<uint32_t> tborder;
+		getBorder(tsize, tsize, tborder);
+
+		std::vector<uint32_t> tkept;
+		std::vector<char> tused(tgridcount, 0);
+		for (uint32_t tindex : pindices)
+			tused[tindex] = 1;
+		for (uint32_t k = 0; k < (uint32_t)tborder.size(); k++)
+		{
+			if (tused[tborder[k]])
+				tkept.push_back(k);
+		}
+
+		for (size_t k = 0; k < tkept.size(); k++)
+		{
+			uint32_t tfirst = tkept[k];
+			uint32_t tsecond = tkept[(k + 1) % tkept.size()];
+			uint32_t te0 = tborder[tfirst];
+			uint32_t te1 = tborder[tsecond];
+			uint32_t ts0 = (uint32_t)tgridcount + tfirst;
+			uint32_t ts1 = (uint32_t)tgridcount + tsecond;
+
+			pindices.push_back(te0);
+			pindices.push_back(ts0);
+			pindices.push_back(te1);
+
+			pindices.push_back(te1);
+			pindices.push_back(ts0);
+			pindices.push_back(ts1);
+		}
+	}
+
+	std::vector<uint32_t> tremap(pvertices.size(), UINT32_MAX);
+	std::vector<BasicVertexDX11::Vertex> tkeptvertices;
+	tkeptvertices.reserve(pindices.size() / 2);
+	for (uint32_t& tindex : pindices)
+	{
+		if (tremap[tindex] == UINT32_MAX)
+		{
+			tremap[tindex] = (uint32_t)tkeptvertices.size();
+			tkeptvertices.push_back(pvertices[tindex]);
+		}
+		tindex = tremap[tindex];
+	}
+	pvertices.swap(tkeptvertices);
+}
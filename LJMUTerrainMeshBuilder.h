@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "BasicVertexDX11.h"
+#include "DrawIndexedExecutorDX11.h"
+#include "Vector2f.h"
+#include "Vector3f.h"
+#include "Vector4f.h"
+
+namespace LJMUDX
+{
+	class LJMUHeightmap;
+	class LJMUThreadPool;
+
+	typedef std::shared_ptr<Glyph3::DrawIndexedExecutorDX11<Glyph3::BasicVertexDX11::Vertex>> LJMUTerrainMeshPtr;
+
+	/////////////////////////
+	// Grid of heightmap samples
+	// to build a mesh over. Vertex
+	// (vi, vj) takes sample
+	// (i0 + vi * step, j0 + vj * step),
+	// clamped to the map.
+	/////////////////////////
+	struct LJMUTerrainRegion
+	{
+		int i0;
+		int j0;
+		int width;		//Vertices along i
+		int length;		//Vertices along j
+		int step;
+	};
+
+	/////////////////////////
+	// Turns a heightmap into an
+	// indexed triangle list. Each
+	// sample becomes one shared
+	// vertex, and its normal is
+	// found from the neighbouring
+	// rows while they are decoded
+	// for the positions. Sample
+	// (i, j) is placed at
+	// origin + (i * spacing.x,
+	// height * scale, j * spacing.y).
+	/////////////////////////
+	class LJMUTerrainMeshBuilder
+	{
+	public:
+		//--------CONSTRUCTORS/DESTRUCTORS----------------------------------------------------
+		LJMUTerrainMeshBuilder();
+
+		//--------PUBLIC METHODS-------------------------------------------------------------
+		void			setThreadPool(LJMUThreadPool* ppool) { this->_obj_pool = ppool; }
+		void			setOrigin(const Glyph3::Vector3f& porigin) { this->_origin = porigin; }
+		void			setSpacing(const Glyph3::Vector2f& pspacing) { this->_spacing = pspacing; }
+		void			setHeightScale(float pscale) { this->_height_scale = pscale; }
+		void			setColour(const Glyph3::Vector4f& pcolour) { this->_colour = pcolour; }
+
+		// Number of times the texture repeats across the whole map
+		void			setTexScale(const Glyph3::Vector2f& ptexscale) { this->_tex_scale = ptexscale; }
+
+		// Hangs a wall of pdepth world units below the mesh's border, 0 for none. Skirts
+		// deeper than the height error between neighbouring chunks hide the seam cracks.
+		void			setSkirtDepth(float pdepth) { this->_skirt_depth = pdepth; }
+		float			getSkirtDepth() const { return this->_skirt_depth; }
+
+		// Drops vertices wherever the mesh stays within perror world units of every sample,
+		// 0 keeps them all. Only square regions of 2^k + 1 vertices a side are simplified,
+		// other regions keep the full grid. Neighbouring meshes can drop different vertices
+		// along a shared edge, so give them a skirt at least perror deep.
+		void			setMaxError(float perror) { this->_max_error = perror; }
+		float			getMaxError() const { return this->_max_error; }
+		bool			isAdaptive(const LJMUTerrainRegion& pregion) const;
+
+		static LJMUTerrainRegion	getWholeMap(const LJMUHeightmap& pmap);
+
+		// Builds and returns the mesh, null if the region has fewer than 2 x 2 vertices. Its
+		// triangles and vertices are reordered for the vertex cache.
+		LJMUTerrainMeshPtr	build(const LJMUHeightmap& pmap) const;
+		LJMUTerrainMeshPtr	build(const LJMUHeightmap& pmap, const LJMUTerrainRegion& pregion) const;
+
+		// CPU side of build, pregion.width * pregion.length vertices laid out [vi * length + vj],
+		// followed by one skirt vertex per border vertex when there is a skirt
+		void			buildVertices(const LJMUHeightmap& pmap, const LJMUTerrainRegion& pregion,
+							std::vector<Glyph3::BasicVertexDX11::Vertex>& pvertices) const;
+
+		// Two triangles per grid cell, wound like LJMUParametricSurface::buildGridIndices,
+		// then the skirt triangles when pskirt is set
+		static void		buildIndices(int pwidth, int plength, std::vector<uint32_t>& pindices, bool pskirt = false);
+
+	private:
+		//-------------HELPER METHODS--------------------------------------------------
+		// Grid vertices around the border, in order, each corner once
+		static void		getBorder(int pwidth, int plength, std::vector<uint32_t>& pborder);
+
+		// Replaces the grid built by buildVertices with an RTIN mesh over the vertices it keeps
+		void			simplify(const LJMUTerrainRegion& pregion, std::vector<Glyph3::BasicVertexDX11::Vertex>& pvertices,
+							std::vector<uint32_t>& pindices) const;
+
+		//--------CLASS MEMBERS--------------------------------------------------------------
+		Glyph3::Vector3f	_origin;
+		Glyph3::Vector2f	_spacing;
+		float				_height_scale;
+		float				_skirt_depth;
+		float				_max_error;
+		Glyph3::Vector2f	_tex_scale;
+		Glyph3::Vector4f	_colour;
+		LJMUThreadPool*		_obj_pool;
+	};
+}
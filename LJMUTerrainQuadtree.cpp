@@ -0,0 +1,425 @@
+#include "LJMUTerrainQuadtree.h"
+#include "LJMUHeightmap.h"
+#include "LJMUTerrainQuery.h"
+#include "LJMUThreadPool.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace LJMUDX;
+using namespace Glyph3;
+
+///////////////////////////
+// Constructor
+///////////////////////////
+LJMUTerrainQuadtree::LJMUTerrainQuadtree() :
+	_chunk_cells(0),
+	_level_count(0),
+	_map_width(0),
+	_map_length(0),
+	_origin(0.0f, 0.0f, 0.0f),
+	_spacing(1.0f, 1.0f),
+	_height_scale(1.0f),
+	_obj_pool(nullptr)
+{
+
+}
+
+///////////////////////////
+// Build the Tree
+///////////////////////////
+bool LJMUTerrainQuadtree::build(const LJMUHeightmap& pmap, int pchunkcells, const Vector3f& porigin,
+	const Vector2f& pspacing, float pheightscale)
+{
+	this->clear();
+	if (pmap.getWidth() < 2 || pmap.getLength() < 2 || pchunkcells < 1)
+		return false;
+
+	this->_chunk_cells = pchunkcells;
+	this->_map_width = pmap.getWidth();
+	this->_map_length = pmap.getLength();
+	this->_origin = porigin;
+	this->_spacing = pspacing;
+	this->_height_scale = pheightscale;
+
+	//Enough levels for the root chunk to cover the map
+	int tcells = std::max(this->_map_width, this->_map_length) - 1;
+	this->_level_count = 1;
+	while (((int64_t)pchunkcells << (this->_level_count - 1)) < tcells && this->_level_count < 31)
+		this->_level_count++;
+
+	this->addNode(0, 0, this->_level_count - 1);
+
+	LJMUThreadPool& tpool = this->_obj_pool ? *this->_obj_pool : LJMUThreadPool::getShared();
+	tpool.parallelFor((int)this->_list_nodes.size(), [&](int pnode)
+	{
+		this->computeBounds(pmap, this->_list_nodes[pnode]);
+	});
+
+	//Children come after their parents, so a reverse sweep carries the errors upwards.
+	//A parent's error must cover its children's or selection could refine past a coarse node.
+	for (int n = (int)this->_list_nodes.size() - 1; n >= 0; n--)
+	{
+		LJMUTerrainNode& tnode = this->_list_nodes[n];
+		for (int c = 0; c < 4; c++)
+		{
+			if (tnode.children[c] >= 0)
+				tnode.error = std::max(tnode.error, this->_list_nodes[tnode.children[c]].error);
+		}
+	}
+
+	return true;
+}
+
+///////////////////////////
+// Grow the Nodes over
+// Changed Samples.
+// Only the changed part of a
+// node is measured, so a small
+// edit costs about the same at
+// every level.
+///////////////////////////
+void LJMUTerrainQuadtree::update(const LJMUHeightmap& pmap, int pi0, int pj0, int pwidth, int plength,
+	std::vector<int>& pnodes)
+{
+	int ti1 = std::min(pi0 + pwidth, this->_map_width) - 1;
+	int tj1 = std::min(pj0 + plength, this->_map_length) - 1;
+	pi0 = std::max(pi0, 0);
+	pj0 = std::max(pj0, 0);
+	if (this->_list_nodes.empty() || pi0 > ti1 || pj0 > tj1)
+		return;
+
+	float tscale = std::fabs(this->_height_scale);
+	size_t tfirst = pnodes.size();
+
+	int tstack[4 * 32];
+	int tsize = 0;
+	tstack[tsize++] = 0;
+
+	while (tsize > 0)
+	{
+		int tindex = tstack[--tsize];
+		LJMUTerrainNode& tnode = this->_list_nodes[tindex];
+		int tstep = 1 << tnode.level;
+		int tilast = std::min(tnode.i0 + (this->_chunk_cells << tnode.level), this->_map_width - 1);
+		int tjlast = std::min(tnode.j0 + (this->_chunk_cells << tnode.level), this->_map_length - 1);
+
+		//Normals read a step past the node's vertices, so its mesh changes a step further out
+		if (ti1 < tnode.i0 - tstep || pi0 > tilast + tstep || tj1 < tnode.j0 - tstep || pj0 > tjlast + tstep)
+			continue;
+
+		pnodes.push_back(tindex);
+
+		//Widen the changed samples to whole cells of the node's grid
+		int tia = std::max(pi0, tnode.i0);
+		int tja = std::max(pj0, tnode.j0);
+		int tib = std::min(ti1, tilast);
+		int tjb = std::min(tj1, tjlast);
+		if (tia <= tib && tja <= tjb)
+		{
+			tia = tnode.i0 + ((std::min(tia, tilast - 1) - tnode.i0) / tstep) * tstep;
+			tja = tnode.j0 + ((std::min(tja, tjlast - 1) - tnode.j0) / tstep) * tstep;
+			tib = std::min(tnode.i0 + ((tib - tnode.i0 + tstep - 1) / tstep) * tstep, tilast);
+			tjb = std::min(tnode.j0 + ((tjb - tnode.j0 + tstep - 1) / tstep) * tstep, tjlast);
+			tib = std::max(tib, std::min(tia + tstep, tilast));
+			tjb = std::max(tjb, std::min(tja + tstep, tjlast));
+
+			float tmin, tmax, terror;
+			this->measure(pmap, tnode, tia, tja, tib, tjb, tmin, tmax, terror);
+
+			float tylo = this->_origin.y + tmin * this->_height_scale;
+			float tyhi = this->_origin.y + tmax * this->_height_scale;
+			tnode.min_y = std::min(tnode.min_y, std::min(tylo, tyhi));
+			tnode.max_y = std::max(tnode.max_y, std::max(tylo, tyhi));
+			tnode.error = std::max(tnode.error, terror * tscale);
+		}
+
+		for (int c = 3; c >= 0; c--)
+		{
+			if (tnode.children[c] >= 0)
+				tstack[tsize++] = tnode.children[c];
+		}
+	}
+
+	//Every node visited here had its parent visited first, so a reverse sweep over them
+	//carries the errors upwards as in build
+	for (size_t n = pnodes.size(); n-- > tfirst;)
+	{
+		LJMUTerrainNode& tnode = this->_list_nodes[pnodes[n]];
+		for (int c = 0; c < 4; c++)
+		{
+			if (tnode.children[c] >= 0)
+				tnode.error = std::max(tnode.error, this->_list_nodes[tnode.children[c]].error);
+		}
+	}
+}
+
+///////////////////////////
+// Remove every Node
+///////////////////////////
+void LJMUTerrainQuadtree::clear()
+{
+	this->_list_nodes.clear();
+	this->_chunk_cells = 0;
+	this->_level_count = 0;
+	this->_map_width = 0;
+	this->_map_length = 0;
+}
+
+///////////////////////////
+// Mesh Region of a Node
+///////////////////////////
+LJMUTerrainRegion LJMUTerrainQuadtree::getRegion(int pnode) const
+{
+	const LJMUTerrainNode& tnode = this->_list_nodes[pnode];
+	int tstep = 1 << tnode.level;
+
+	//Vertices past the map edge would only repeat the last sample
+	int tcellsi = std::min(this->_chunk_cells, (this->_map_width - 1 - tnode.i0 + tstep - 1) / tstep);
+	int tcellsj = std::min(this->_chunk_cells, (this->_map_length - 1 - tnode.j0 + tstep - 1) / tstep);
+
+	LJMUTerrainRegion tregion = { tnode.i0, tnode.j0, tcellsi + 1, tcellsj + 1, tstep };
+	return tregion;
+}
+
+///////////////////////////
+// Pick the Nodes to Draw
+///////////////////////////
+void LJMUTerrainQuadtree::select(const Vector3f& pcamera, float pmaxpixelerror, float pviewheight, float pfovy,
+	std::vector<int>& pselected) const
+{
+	LJMUTerrainCulling tculling = { nullptr, 0, nullptr };
+	this->select(pcamera, pmaxpixelerror, pviewheight, pfovy, tculling, pselected);
+}
+
+void LJMUTerrainQuadtree::select(const Vector3f& pcamera, float pmaxpixelerror, float pviewheight, float pfovy,
+	const LJMUTerrainCulling& pculling, std::vector<int>& pselected) const
+{
+	pselected.clear();
+	if (this->_list_nodes.empty())
+		return;
+
+	//Pixels per world unit at distance 1, the error test is error * k / distance <= max error
+	float tk = pviewheight / (2.0f * std::tan(pfovy * 0.5f));
+	float tlimit = pmaxpixelerror / tk;
+
+	//Depth first, at most 3 siblings wait per level
+	int tstack[4 * 32];
+	int tsize = 0;
+	tstack[tsize++] = 0;
+
+	while (tsize > 0)
+	{
+		const LJMUTerrainNode& tnode = this->_list_nodes[tstack[--tsize]];
+		if (this->isCulled(tnode, pcamera, pculling))
+			continue;
+
+		//Distance to the nearest point of the node's bounds
+		float tdx = std::max(std::max(tnode.min_x - pcamera.x, pcamera.x - tnode.max_x), 0.0f);
+		float tdy = std::max(std::max(tnode.min_y - pcamera.y, pcamera.y - tnode.max_y), 0.0f);
+		float tdz = std::max(std::max(tnode.min_z - pcamera.z, pcamera.z - tnode.max_z), 0.0f);
+		float tdistance = std::sqrt(tdx * tdx + tdy * tdy + tdz * tdz);
+
+		if (tnode.isLeaf() || tnode.error <= tlimit * tdistance)
+		{
+			pselected.push_back((int)(&tnode - this->_list_nodes.data()));
+			continue;
+		}
+
+		for (int c = 3; c >= 0; c--)
+		{
+			if (tnode.children[c] >= 0)
+				tstack[tsize++] = tnode.children[c];
+		}
+	}
+}
+
+///////////////////////////
+// Is a Node outside the
+// Planes or behind the Ground
+///////////////////////////
+bool LJMUTerrainQuadtree::isCulled(const LJMUTerrainNode& pnode, const Vector3f& pcamera,
+	const LJMUTerrainCulling& pculling) const
+{
+	//Outside a plane if the box corner furthest along its normal is
+	for (int p = 0; p < pculling.plane_count; p++)
+	{
+		const Vector4f& tplane = pculling.planes[p];
+		float tx = tplane.x >= 0.0f ? pnode.max_x : pnode.min_x;
+		float ty = tplane.y >= 0.0f ? pnode.max_y : pnode.min_y;
+		float tz = tplane.z >= 0.0f ? pnode.max_z : pnode.min_z;
+		if (tplane.x * tx + tplane.y * ty + tplane.z * tz + tplane.w < 0.0f)
+			return true;
+	}
+
+	if (!pculling.occluder)
+		return false;
+
+	//Nothing can stand between the camera and the ground under it
+	if (pcamera.x >= pnode.min_x && pcamera.x <= pnode.max_x && pcamera.z >= pnode.min_z && pcamera.z <= pnode.max_z)
+		return false;
+
+	//Lines to points above the top only count as blocked before they reach the node's
+	//footprint. A point lower down shares the same path across the ground, so it is
+	//blocked by the same hill, while the node's own slopes never hide it.
+	float ttop = pnode.max_y + 0.01f;
+	Vector3f tpoints[5] = {
+		Vector3f(0.5f * (pnode.min_x + pnode.max_x), ttop, 0.5f * (pnode.min_z + pnode.max_z)),
+		Vector3f(pnode.min_x, ttop, pnode.min_z),
+		Vector3f(pnode.max_x, ttop, pnode.min_z),
+		Vector3f(pnode.min_x, ttop, pnode.max_z),
+		Vector3f(pnode.max_x, ttop, pnode.max_z)
+	};
+
+	for (int k = 0; k < 5; k++)
+	{
+		float tdx = tpoints[k].x - pcamera.x;
+		float tdz = tpoints[k].z - pcamera.z;
+
+		float tenter = 0.0f;
+		if (tdx != 0.0f)
+			tenter = std::max(tenter, std::min((pnode.min_x - pcamera.x) / tdx, (pnode.max_x - pcamera.x) / tdx));
+		if (tdz != 0.0f)
+			tenter = std::max(tenter, std::min((pnode.min_z - pcamera.z) / tdz, (pnode.max_z - pcamera.z) / tdz));
+		tenter = std::min(tenter, 1.0f) * 0.999f;
+
+		Vector3f tedge(pcamera.x + tdx * tenter, pcamera.y + (ttop - pcamera.y) * tenter, pcamera.z + tdz * tenter);
+		if (!pculling.occluder->isOccluded(pcamera, tedge))
+			return false;
+	}
+
+	return true;
+}
+
+///////////////////////////
+// Add a Node and the
+// Children Inside the Map
+///////////////////////////
+int LJMUTerrainQuadtree::addNode(int pi0, int pj0, int plevel)
+{
+	int tindex = (int)this->_list_nodes.size();
+
+	LJMUTerrainNode tnode;
+	tnode.i0 = pi0;
+	tnode.j0 = pj0;
+	tnode.level = plevel;
+	tnode.children[0] = tnode.children[1] = tnode.children[2] = tnode.children[3] = -1;
+	tnode.min_x = tnode.min_y = tnode.min_z = 0.0f;
+	tnode.max_x = tnode.max_y = tnode.max_z = 0.0f;
+	tnode.error = 0.0f;
+	this->_list_nodes.push_back(tnode);
+
+	if (plevel == 0)
+		return tindex;
+
+	int thalf = this->_chunk_cells << (plevel - 1);
+	for (int c = 0; c < 4; c++)
+	{
+		int ti0 = pi0 + (c & 1) * thalf;
+		int tj0 = pj0 + (c >> 1) * thalf;
+
+		//A child needs at least one cell inside the map
+		if (ti0 < this->_map_width - 1 && tj0 < this->_map_length - 1)
+		{
+			int tchild = this->addNode(ti0, tj0, plevel - 1);
+			this->_list_nodes[tindex].children[c] = tchild;
+		}
+	}
+
+	return tindex;
+}
+
+///////////////////////////
+// Bounds and Height Error
+// of a Node
+///////////////////////////
+void LJMUTerrainQuadtree::computeBounds(const LJMUHeightmap& pmap, LJMUTerrainNode& pnode) const
+{
+	int tilast = std::min(pnode.i0 + (this->_chunk_cells << pnode.level), this->_map_width - 1);
+	int tjlast = std::min(pnode.j0 + (this->_chunk_cells << pnode.level), this->_map_length - 1);
+
+	float tmin, tmax, terror;
+	this->measure(pmap, pnode, pnode.i0, pnode.j0, tilast, tjlast, tmin, tmax, terror);
+
+	float tylo = this->_origin.y + tmin * this->_height_scale;
+	float tyhi = this->_origin.y + tmax * this->_height_scale;
+
+	pnode.min_x = this->_origin.x + pnode.i0 * this->_spacing.x;
+	pnode.max_x = this->_origin.x + tilast * this->_spacing.x;
+	pnode.min_y = std::min(tylo, tyhi);
+	pnode.max_y = std::max(tylo, tyhi);
+	pnode.min_z = this->_origin.z + pnode.j0 * this->_spacing.y;
+	pnode.max_z = this->_origin.z + tjlast * this->_spacing.y;
+	pnode.error = terror * std::fabs(this->_height_scale);
+}
+
+///////////////////////////
+// Range and Height Error of
+// Part of a Node. The error is
+// the largest gap between a
+// sample and the bilinear
+// surface through the node's
+// own vertices, found a row at
+// a time so only three rows of
+// samples are held at once.
+///////////////////////////
+void LJMUTerrainQuadtree::measure(const LJMUHeightmap& pmap, const LJMUTerrainNode& pnode, int pia, int pja,
+	int pib, int pjb, float& pmin, float& pmax, float& perror) const
+{
+	int tstep = 1 << pnode.level;
+	int tspan = pjb - pja + 1;
+
+	thread_local std::vector<float> trows;
+	trows.resize((size_t)tspan * 3);
+	float* ttop = trows.data();
+	float* tbottom = ttop + tspan;
+	float* trow = tbottom + tspan;
+
+	float tmin = FLT_MAX;
+	float tmax = -FLT_MAX;
+	float terror = 0.0f;
+
+	pmap.readRow(pia, pja, tspan, ttop);
+
+	for (int ia = pia; ia < pib; ia += tstep)
+	{
+		int ib = std::min(ia + tstep, pib);
+		pmap.readRow(ib, pja, tspan, tbottom);
+
+		for (int i = ia; i <= ib; i++)
+		{
+			const float* tsamples = trow;
+			if (i == ia)
+				tsamples = ttop;
+			else if (i == ib)
+				tsamples = tbottom;
+			else
+				pmap.readRow(i, pja, tspan, trow);
+
+			float tfi = (float)(i - ia) / (float)(ib - ia);
+
+			for (int j = 0; j < tspan; j++)
+			{
+				int ja = (j / tstep) * tstep;
+				int jb = std::min(ja + tstep, tspan - 1);
+				float tfj = jb > ja ? (float)(j - ja) / (float)(jb - ja) : 0.0f;
+
+				float tlodtop = ttop[ja] + (ttop[jb] - ttop[ja]) * tfj;
+				float tlodbottom = tbottom[ja] + (tbottom[jb] - tbottom[ja]) * tfj;
+				float tlod = tlodtop + (tlodbottom - tlodtop) * tfi;
+
+				float th = tsamples[j];
+				tmin = std::min(tmin, th);
+				tmax = std::max(tmax, th);
+				terror = std::max(terror, std::fabs(th - tlod));
+			}
+		}
+
+		std::swap(ttop, tbottom);
+	}
+
+	pmin = tmin;
+	pmax = tmax;
+	perror = terror;
+}
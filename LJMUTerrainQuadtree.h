@@ -0,0 +1,144 @@
+#pragma once
+
+#include <vector>
+
+#include "Vector2f.h"
+#include "Vector3f.h"
+#include "Vector4f.h"
+
+#include "LJMUTerrainMeshBuilder.h"
+
+namespace LJMUDX
+{
+	class LJMUHeightmap;
+	class LJMUTerrainQuery;
+	class LJMUThreadPool;
+
+	/////////////////////////
+	// One quadtree node. Every
+	// node is drawn as a chunk of
+	// the same number of cells,
+	// so a node at level L samples
+	// every (1 << L)th height and
+	// covers 2^L leaf chunks.
+	/////////////////////////
+	struct LJMUTerrainNode
+	{
+		int		i0;				//First heightmap sample
+		int		j0;
+		int		level;
+		int		children[4];	//-1 where the child would lie outside the map
+		float	min_x;			//World space bounds
+		float	min_y;
+		float	min_z;
+		float	max_x;
+		float	max_y;
+		float	max_z;
+		float	error;			//Largest world space height error from drawing at this level
+
+		bool	isLeaf() const { return this->level == 0; }
+	};
+
+	/////////////////////////
+	// What select may leave out
+	// besides refining. Planes
+	// are (normal, d) with the
+	// inside where
+	// dot(normal, p) + d >= 0.
+	// A node is hidden behind the
+	// occluder's ground when the
+	// lines to the corners and
+	// centre of its top are all
+	// blocked, so a peak thinner
+	// than the node between them
+	// can still be missed.
+	/////////////////////////
+	struct LJMUTerrainCulling
+	{
+		const Glyph3::Vector4f*		planes;
+		int							plane_count;
+		const LJMUTerrainQuery*		occluder;		//May be null
+	};
+
+	/////////////////////////
+	// Chunked terrain LOD over a
+	// heightmap. Chunks are
+	// addressed like the gridPos
+	// of CreatePlaneMesh, in units
+	// of chunk cells, with the
+	// sample step doubling per
+	// level.
+	//
+	// Selection walks down from
+	// the root and stops at the
+	// first node whose height
+	// error projects to no more
+	// than the allowed number of
+	// pixels. Chunks of different
+	// levels are joined by the
+	// mesh builder's skirts, at
+	// least getMaxError() deep.
+	/////////////////////////
+	class LJMUTerrainQuadtree
+	{
+	public:
+		//--------CONSTRUCTORS/DESTRUCTORS----------------------------------------------------
+		LJMUTerrainQuadtree();
+
+		//--------PUBLIC METHODS-------------------------------------------------------------
+		void			setThreadPool(LJMUThreadPool* ppool) { this->_obj_pool = ppool; }
+
+		// Builds the nodes and their bounds, pchunkcells cells along each side of a chunk.
+		// The placement matches an LJMUTerrainMeshBuilder with the same settings.
+		bool			build(const LJMUHeightmap& pmap, int pchunkcells, const Glyph3::Vector3f& porigin,
+							const Glyph3::Vector2f& pspacing, float pheightscale);
+		void			clear();
+
+		// Call after changing samples [pi0, pi0 + pwidth) x [pj0, pj0 + plength) of the map.
+		// Grows the bounds and errors of the nodes over them and adds to pnodes every node
+		// whose mesh uses them, normals included. Nothing shrinks, build again to tighten.
+		void			update(const LJMUHeightmap& pmap, int pi0, int pj0, int pwidth, int plength,
+							std::vector<int>& pnodes);
+
+		int				getNodeCount() const { return (int)this->_list_nodes.size(); }
+		const LJMUTerrainNode&	getNode(int pnode) const { return this->_list_nodes[pnode]; }
+		int				getChunkCells() const { return this->_chunk_cells; }
+		int				getLevelCount() const { return this->_level_count; }
+		float			getMaxError() const { return this->_list_nodes.empty() ? 0.0f : this->_list_nodes[0].error; }
+
+		// Mesh region for a node, clipped to the map
+		LJMUTerrainRegion	getRegion(int pnode) const;
+
+		// Fills pselected with the nodes to draw from pcamera. pviewheight is the viewport
+		// height in pixels and pfovy the vertical field of view in radians.
+		void			select(const Glyph3::Vector3f& pcamera, float pmaxpixelerror, float pviewheight, float pfovy,
+							std::vector<int>& pselected) const;
+
+		// As above, skipping nodes outside the planes or behind the occluder's hills.
+		// A culled node's children are never visited.
+		void			select(const Glyph3::Vector3f& pcamera, float pmaxpixelerror, float pviewheight, float pfovy,
+							const LJMUTerrainCulling& pculling, std::vector<int>& pselected) const;
+
+	private:
+		//-------------HELPER METHODS--------------------------------------------------
+		int				addNode(int pi0, int pj0, int plevel);
+		bool			isCulled(const LJMUTerrainNode& pnode, const Glyph3::Vector3f& pcamera,
+							const LJMUTerrainCulling& pculling) const;
+		void			computeBounds(const LJMUHeightmap& pmap, LJMUTerrainNode& pnode) const;
+
+		// Samples [pia, pib] x [pja, pjb] of a node, the first row and column on its grid
+		void			measure(const LJMUHeightmap& pmap, const LJMUTerrainNode& pnode, int pia, int pja,
+							int pib, int pjb, float& pmin, float& pmax, float& perror) const;
+
+		//--------CLASS MEMBERS--------------------------------------------------------------
+		std::vector<LJMUTerrainNode>	_list_nodes;		//Root first, parents before children
+		int								_chunk_cells;
+		int								_level_count;
+		int								_map_width;
+		int								_map_length;
+		Glyph3::Vector3f				_origin;
+		Glyph3::Vector2f				_spacing;
+		float							_height_scale;
+		LJMUThreadPool*					_obj_pool;
+	};
+}
@@ -0,0 +1,418 @@
+#include "LJMUTerrainQuery.h"
+#include "LJMUHeightmap.h"
+#include "LJMUThreadPool.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace LJMUDX;
+using namespace Glyph3;
+
+namespace
+{
+	/////////////////////////
+	// Pyramid cell waiting to be
+	// visited, with the part of
+	// the segment inside it
+	/////////////////////////
+	struct LJMUSegmentCell
+	{
+		int		level;
+		int		ci;
+		int		cj;
+		float	tmin;
+		float	tmax;
+	};
+
+	const int	LJMU_QUERY_BLOCK = 1024;		//Points per task in getHeights
+}
+
+///////////////////////////
+// Constructor
+///////////////////////////
+LJMUTerrainQuery::LJMUTerrainQuery() :
+	_obj_map(nullptr),
+	_obj_pool(nullptr),
+	_origin(0.0f, 0.0f, 0.0f),
+	_spacing(1.0f, 1.0f),
+	_height_scale(1.0f)
+{
+
+}
+
+///////////////////////////
+// Pool for Batches and the
+// Pyramid Build
+///////////////////////////
+void LJMUTerrainQuery::setThreadPool(LJMUThreadPool* ppool)
+{
+	this->_obj_pool = ppool;
+	this->_pyramid.setThreadPool(ppool);
+}
+
+///////////////////////////
+// Attach to a Heightmap
+///////////////////////////
+bool LJMUTerrainQuery::bind(const LJMUHeightmap& pmap, const Vector3f& porigin, const Vector2f& pspacing, float pheightscale)
+{
+	this->clear();
+	if (pspacing.x <= 0.0f || pspacing.y <= 0.0f || !this->_pyramid.build(pmap))
+		return false;
+
+	this->_obj_map = &pmap;
+	this->_origin = porigin;
+	this->_spacing = pspacing;
+	this->_height_scale = pheightscale;
+	return true;
+}
+
+///////////////////////////
+// Detach from the Heightmap
+///////////////////////////
+void LJMUTerrainQuery::clear()
+{
+	this->_obj_map = nullptr;
+	this->_pyramid.clear();
+}
+
+///////////////////////////
+// Refresh a Changed Region
+///////////////////////////
+void LJMUTerrainQuery::update(int pi0, int pj0, int pwidth, int plength)
+{
+	if (this->_obj_map)
+		this->_pyramid.update(*this->_obj_map, pi0, pj0, pwidth, plength);
+}
+
+///////////////////////////
+// Is a Point over the Map
+///////////////////////////
+bool LJMUTerrainQuery::isInside(float px, float pz) const
+{
+	if (!this->_obj_map)
+		return false;
+
+	float tu = (px - this->_origin.x) / this->_spacing.x;
+	float tv = (pz - this->_origin.z) / this->_spacing.y;
+	return tu >= 0.0f && tv >= 0.0f &&
+		tu <= (float)(this->_obj_map->getWidth() - 1) && tv <= (float)(this->_obj_map->getLength() - 1);
+}
+
+///////////////////////////
+// Height at a Point
+///////////////////////////
+float LJMUTerrainQuery::getHeight(float px, float pz) const
+{
+	if (!this->_obj_map)
+		return 0.0f;
+
+	return this->sampleCell((px - this->_origin.x) / this->_spacing.x, (pz - this->_origin.z) / this->_spacing.y, nullptr);
+}
+
+float LJMUTerrainQuery::getHeight(float px, float pz, Vector3f& pnormal) const
+{
+	pnormal = Vector3f(0.0f, 1.0f, 0.0f);
+	if (!this->_obj_map)
+		return 0.0f;
+
+	return this->sampleCell((px - this->_origin.x) / this->_spacing.x, (pz - this->_origin.z) / this->_spacing.y, &pnormal);
+}
+
+///////////////////////////
+// Heights for a Batch of
+// Points, a Block per Task
+///////////////////////////
+void LJMUTerrainQuery::getHeights(const Vector2f* ppoints, int pcount, float* pheights, Vector3f* pnormals) const
+{
+	if (pcount <= 0)
+		return;
+
+	if (!this->_obj_map)
+	{
+		std::fill(pheights, pheights + pcount, 0.0f);
+		if (pnormals)
+			std::fill(pnormals, pnormals + pcount, Vector3f(0.0f, 1.0f, 0.0f));
+		return;
+	}
+
+	float tinvx = 1.0f / this->_spacing.x;
+	float tinvz = 1.0f / this->_spacing.y;
+	int tblocks = (pcount + LJMU_QUERY_BLOCK - 1) / LJMU_QUERY_BLOCK;
+
+	LJMUThreadPool& tpool = this->_obj_pool ? *this->_obj_pool : LJMUThreadPool::getShared();
+	tpool.parallelFor(tblocks, [&](int pblock)
+	{
+		int tfirst = pblock * LJMU_QUERY_BLOCK;
+		int tlast = std::min(tfirst + LJMU_QUERY_BLOCK, pcount);
+
+		for (int k = tfirst; k < tlast; k++)
+		{
+			float tu = (ppoints[k].x - this->_origin.x) * tinvx;
+			float tv = (ppoints[k].y - this->_origin.z) * tinvz;
+			pheights[k] = this->sampleCell(tu, tv, pnormals ? pnormals + k : nullptr);
+		}
+	});
+}
+
+///////////////////////////
+// First Ground Hit along a
+// Segment or Ray
+///////////////////////////
+bool LJMUTerrainQuery::intersectSegment(const Vector3f& pstart, const Vector3f& pend, float& pt) const
+{
+	return this->findHit(pstart, pend, false, pt);
+}
+
+bool LJMUTerrainQuery::intersectRay(const Vector3f& porigin, const Vector3f& pdirection, float pmaxdistance, float& pdistance) const
+{
+	Vector3f tend(porigin.x + pdirection.x * pmaxdistance,
+		porigin.y + pdirection.y * pmaxdistance,
+		porigin.z + pdirection.z * pmaxdistance);
+
+	float tt;
+	if (!this->findHit(porigin, tend, false, tt))
+		return false;
+
+	pdistance = tt * pmaxdistance;
+	return true;
+}
+
+///////////////////////////
+// Is the Line of Sight
+// Blocked by the Ground
+///////////////////////////
+bool LJMUTerrainQuery::isOccluded(const Vector3f& pfrom, const Vector3f& pto) const
+{
+	float tt;
+	return this->findHit(pfrom, pto, true, tt);
+}
+
+///////////////////////////
+// Walk the Pyramid along a
+// Segment, depth first and
+// nearest child first, so the
+// first cell that is hit holds
+// the nearest hit. Each step
+// down halves the cells, so a
+// segment across the map takes
+// a logarithmic number of steps
+// to reach the cells it crosses.
+// An occlusion test stops as
+// soon as the segment passes
+// under a cell's lowest point.
+///////////////////////////
+bool LJMUTerrainQuery::findHit(const Vector3f& pstart, const Vector3f& pend, bool pocclusion, float& pt) const
+{
+	if (!this->_obj_map)
+		return false;
+
+	//Across the ground in samples, heights stay in world units. Both are linear so t carries over.
+	float tstart[3] = { (pstart.x - this->_origin.x) / this->_spacing.x, pstart.y, (pstart.z - this->_origin.z) / this->_spacing.y };
+	float tdelta[3] = { (pend.x - pstart.x) / this->_spacing.x, pend.y - pstart.y, (pend.z - pstart.z) / this->_spacing.y };
+
+	//At most 3 siblings wait per level
+	LJMUSegmentCell tstack[4 * 32];
+	int tsize = 0;
+	float tground;
+
+	LJMUSegmentCell troot = { this->_pyramid.getTopLevel(), 0, 0, 0.0f, 1.0f };
+	if (!this->clipToCell(troot.level, 0, 0, tstart, tdelta, troot.tmin, troot.tmax, tground))
+		return false;
+	tstack[tsize++] = troot;
+
+	while (tsize > 0)
+	{
+		LJMUSegmentCell tcell = tstack[--tsize];
+
+		if (tcell.level == 0)
+		{
+			if (this->intersectCell(tcell.ci, tcell.cj, tstart, tdelta, tcell.tmin, tcell.tmax, pt))
+				return true;
+			continue;
+		}
+
+		int tlevel = tcell.level - 1;
+		LJMUSegmentCell tchildren[4];
+		int tcount = 0;
+
+		for (int c = 0; c < 4; c++)
+		{
+			LJMUSegmentCell tchild = { tlevel, tcell.ci * 2 + (c & 1), tcell.cj * 2 + (c >> 1), tcell.tmin, tcell.tmax };
+			if (tchild.ci >= this->_pyramid.getCellsI(tlevel) || tchild.cj >= this->_pyramid.getCellsJ(tlevel))
+				continue;
+
+			if (!this->clipToCell(tlevel, tchild.ci, tchild.cj, tstart, tdelta, tchild.tmin, tchild.tmax, tground))
+				continue;
+
+			if (pocclusion && std::max(tstart[1] + tdelta[1] * tchild.tmin, tstart[1] + tdelta[1] * tchild.tmax) < tground)
+			{
+				pt = tchild.tmin;
+				return true;
+			}
+
+			tchildren[tcount++] = tchild;
+		}
+
+		//Furthest pushed first so the nearest is visited next
+		std::sort(tchildren, tchildren + tcount,
+			[](const LJMUSegmentCell& pa, const LJMUSegmentCell& pb) { return pa.tmin > pb.tmin; });
+
+		for (int c = 0; c < tcount; c++)
+			tstack[tsize++] = tchildren[c];
+	}
+
+	return false;
+}
+
+///////////////////////////
+// Bilinear Height and Normal
+// at Sample Coordinates
+///////////////////////////
+float LJMUTerrainQuery::sampleCell(float pu, float pv, Vector3f* pnormal) const
+{
+	int tlasti = this->_obj_map->getWidth() - 1;
+	int tlastj = this->_obj_map->getLength() - 1;
+
+	pu = std::min(std::max(pu, 0.0f), (float)tlasti);
+	pv = std::min(std::max(pv, 0.0f), (float)tlastj);
+	int ti = std::min((int)pu, tlasti - 1);
+	int tj = std::min((int)pv, tlastj - 1);
+	float tfu = pu - (float)ti;
+	float tfv = pv - (float)tj;
+
+	float th00 = this->_obj_map->getHeight(ti, tj);
+	float th10 = this->_obj_map->getHeight(ti + 1, tj);
+	float th01 = this->_obj_map->getHeight(ti, tj + 1);
+	float th11 = this->_obj_map->getHeight(ti + 1, tj + 1);
+
+	float th0 = th00 + (th10 - th00) * tfu;
+	float th1 = th01 + (th11 - th01) * tfu;
+
+	if (pnormal)
+	{
+		//Slopes of the bilinear patch, the same normal form as the mesh builder
+		float tdhdx = ((th10 - th00) * (1.0f - tfv) + (th11 - th01) * tfv) * this->_height_scale / this->_spacing.x;
+		float tdhdz = (th1 - th0) * this->_height_scale / this->_spacing.y;
+
+		Vector3f tnormal(-tdhdx, 1.0f, -tdhdz);
+		tnormal.Normalize();
+		*pnormal = tnormal;
+	}
+
+	return this->_origin.y + (th0 + (th1 - th0) * tfv) * this->_height_scale;
+}
+
+///////////////////////////
+// Clip the Segment to a
+// Pyramid Cell's Box
+///////////////////////////
+bool LJMUTerrainQuery::clipToCell(int plevel, int pci, int pcj, const float* pstart, const float* pdelta,
+	float& ptmin, float& ptmax, float& pground) const
+{
+	LJMUHeightBounds tbounds = this->_pyramid.getCellBounds(*this->_obj_map, plevel, pci, pcj);
+	float tylo = this->_origin.y + tbounds.min * this->_height_scale;
+	float tyhi = this->_origin.y + tbounds.max * this->_height_scale;
+	pground = std::min(tylo, tyhi);
+
+	//Everything under the surface is solid ground, so the box has no floor
+	float tlo[3] = { (float)(pci << plevel), -FLT_MAX, (float)(pcj << plevel) };
+	float thi[3] = { (float)std::min((pci + 1) << plevel, this->_obj_map->getWidth() - 1),
+		std::max(tylo, tyhi),
+		(float)std::min((pcj + 1) << plevel, this->_obj_map->getLength() - 1) };
+
+	for (int a = 0; a < 3; a++)
+	{
+		if (pdelta[a] == 0.0f)
+		{
+			if (pstart[a] < tlo[a] || pstart[a] > thi[a])
+				return false;
+			continue;
+		}
+
+		float tinv = 1.0f / pdelta[a];
+		float t0 = (tlo[a] - pstart[a]) * tinv;
+		float t1 = (thi[a] - pstart[a]) * tinv;
+		if (t0 > t1)
+			std::swap(t0, t1);
+
+		ptmin = std::max(ptmin, t0);
+		ptmax = std::min(ptmax, t1);
+		if (ptmin > ptmax)
+			return false;
+	}
+
+	return true;
+}
+
+///////////////////////////
+// Exact Hit inside a Grid
+// Cell. Along the segment the
+// bilinear surface is a
+// quadratic in t, so the gap
+// above it is one too.
+///////////////////////////
+bool LJMUTerrainQuery::intersectCell(int pci, int pcj, const float* pstart, const float* pdelta,
+	float ptmin, float ptmax, float& pt) const
+{
+	double th00 = this->_origin.y + this->_obj_map->getHeight(pci, pcj) * this->_height_scale;
+	double th10 = this->_origin.y + this->_obj_map->getHeight(pci + 1, pcj) * this->_height_scale;
+	double th01 = this->_origin.y + this->_obj_map->getHeight(pci, pcj + 1) * this->_height_scale;
+	double th11 = this->_origin.y + this->_obj_map->getHeight(pci + 1, pcj + 1) * this->_height_scale;
+
+	//h(s, r) = a + b s + c r + e s r over the cell
+	double ta = th00;
+	double tb = th10 - th00;
+	double tc = th01 - th00;
+	double te = th00 - th10 - th01 + th11;
+
+	double ts0 = pstart[0] - pci;
+	double tr0 = pstart[2] - pcj;
+	double tds = pdelta[0];
+	double tdr = pdelta[2];
+
+	//Gap above the ground, f(t) = qa t^2 + qb t + qc
+	double tqa = -te * tds * tdr;
+	double tqb = pdelta[1] - (tb * tds + tc * tdr + te * (ts0 * tdr + tr0 * tds));
+	double tqc = pstart[1] - (ta + tb * ts0 + tc * tr0 + te * ts0 * tr0);
+
+	if (tqc + (tqb + tqa * ptmin) * ptmin <= 0.0)
+	{
+		pt = ptmin;
+		return true;
+	}
+
+	double troots[2];
+	int tcount = 0;
+
+	if (tqa == 0.0)
+	{
+		if (tqb != 0.0)
+			troots[tcount++] = -tqc / tqb;
+	}
+	else
+	{
+		double tdisc = tqb * tqb - 4.0 * tqa * tqc;
+		if (tdisc >= 0.0)
+		{
+			//Avoids cancelling the larger terms against each other
+			double tq = -0.5 * (tqb + (tqb < 0.0 ? -std::sqrt(tdisc) : std::sqrt(tdisc)));
+			troots[tcount++] = tq / tqa;
+			if (tq != 0.0)
+				troots[tcount++] = tqc / tq;
+		}
+	}
+
+	double tbest = 2.0;
+	for (int k = 0; k < tcount; k++)
+	{
+		if (troots[k] >= ptmin && troots[k] <= ptmax)
+			tbest = std::min(tbest, troots[k]);
+	}
+
+	if (tbest > ptmax)
+		return false;
+
+	pt = (float)tbest;
+	return true;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Vector2f.h"
+#include "Vector3f.h"
+
+#include "LJMUHeightPyramid.h"
+
+namespace LJMUDX
+{
+	class LJMUHeightmap;
+	class LJMUThreadPool;
+
+	/////////////////////////
+	// Answers height questions
+	// about a terrain in world
+	// space, placed the same way
+	// as LJMUTerrainMeshBuilder:
+	// sample (i, j) sits at
+	// origin + (i * spacing.x,
+	// height * scale, j * spacing.y).
+	//
+	// Heights are bilinear across
+	// each grid cell and cost four
+	// sample reads. Points off the
+	// map take the height at the
+	// nearest edge. Segments are
+	// tested against the min/max
+	// pyramid first, so only the
+	// cells the segment might
+	// touch are solved exactly.
+	/////////////////////////
+	class LJMUTerrainQuery
+	{
+	public:
+		//--------CONSTRUCTORS/DESTRUCTORS----------------------------------------------------
+		LJMUTerrainQuery();
+
+		//--------PUBLIC METHODS-------------------------------------------------------------
+		void			setThreadPool(LJMUThreadPool* ppool);
+
+		// pmap must outlive the query
+		bool			bind(const LJMUHeightmap& pmap, const Glyph3::Vector3f& porigin,
+							const Glyph3::Vector2f& pspacing, float pheightscale);
+		void			clear();
+
+		// Call after changing samples [pi0, pi0 + pwidth) x [pj0, pj0 + plength) of the bound map
+		void			update(int pi0, int pj0, int pwidth, int plength);
+
+		bool			isBound() const { return this->_obj_map != nullptr; }
+		bool			isInside(float px, float pz) const;
+
+		float			getHeight(float px, float pz) const;
+		float			getHeight(float px, float pz, Glyph3::Vector3f& pnormal) const;
+
+		// Heights for pcount points, ppoints holding (x, z). pnormals may be null.
+		void			getHeights(const Glyph3::Vector2f* ppoints, int pcount, float* pheights,
+							Glyph3::Vector3f* pnormals = nullptr) const;
+
+		// Finds where the segment first meets the ground, as pt from 0 at pstart to 1 at pend.
+		// A segment starting below the ground hits at 0. False if it stays above the map.
+		bool			intersectSegment(const Glyph3::Vector3f& pstart, const Glyph3::Vector3f& pend, float& pt) const;
+
+		// Picking along a normalised direction, pdistance is how far along it the ground is hit
+		bool			intersectRay(const Glyph3::Vector3f& porigin, const Glyph3::Vector3f& pdirection, float pmaxdistance,
+							float& pdistance) const;
+
+		// True if the ground blocks the line from pfrom to pto. Cheaper than finding the hit,
+		// the walk stops at the first cell the line passes wholly beneath.
+		bool			isOccluded(const Glyph3::Vector3f& pfrom, const Glyph3::Vector3f& pto) const;
+
+		const LJMUHeightPyramid&	getPyramid() const { return this->_pyramid; }
+
+	private:
+		//-------------HELPER METHODS--------------------------------------------------
+		bool			findHit(const Glyph3::Vector3f& pstart, const Glyph3::Vector3f& pend, bool pocclusion, float& pt) const;
+		float			sampleCell(float pu, float pv, Glyph3::Vector3f* pnormal) const;
+		bool			clipToCell(int plevel, int pci, int pcj, const float* pstart, const float* pdelta,
+							float& ptmin, float& ptmax, float& pground) const;
+		bool			intersectCell(int pci, int pcj, const float* pstart, const float* pdelta,
+							float ptmin, float ptmax, float& pt) const;
+
+		//--------CLASS MEMBERS--------------------------------------------------------------
+		const LJMUHeightmap*	_obj_map;
+		LJMUHeightPyramid		_pyramid;
+		LJMUThreadPool*			_obj_pool;
+		Glyph3::Vector3f		_origin;
+		Glyph3::Vector2f		_spacing;
+		float					_height_scale;
+	};
+}
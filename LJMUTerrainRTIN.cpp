@@ -0,0 +1,137 @@
+#include "LJMUTerrainRTIN.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+using namespace LJMUDX;
+
+///////////////////////////
+// Sizes the Triangles can
+// Split down to Cells on
+///////////////////////////
+bool LJMUTerrainRTIN::isGridSize(int psize)
+{
+	int tcells = psize - 1;
+	return tcells >= 1 && (tcells & (tcells - 1)) == 0;
+}
+
+///////////////////////////
+// Vertex Errors, Smallest
+// Triangles First.
+// Triangle id 2 and 3 are the
+// two halves of the grid, and
+// id * 2 and id * 2 + 1 are the
+// halves of id, so walking the
+// ids down finishes every level
+// before the one above it.
+///////////////////////////
+void LJMUTerrainRTIN::computeErrors(const float* pheights, int psize, std::vector<float>& perrors)
+{
+	perrors.assign((size_t)psize * psize, 0.0f);
+	if (!isGridSize(psize))
+		return;
+
+	int tcells = psize - 1;
+	int ttriangles = tcells * tcells * 2 - 2;
+	int tparents = ttriangles - tcells * tcells;
+
+	for (int t = ttriangles - 1; t >= 0; t--)
+	{
+		//Follow the id's bits down from the grid halves to find the long edge a - b and corner c
+		int tid = t + 2;
+		int tai = 0, taj = 0, tbi = 0, tbj = 0, tci = 0, tcj = 0;
+		if (tid & 1)
+		{
+			tbi = tbj = tci = tcells;
+		}
+		else
+		{
+			tai = taj = tcj = tcells;
+		}
+
+		while ((tid >>= 1) > 1)
+		{
+			int tmi = (tai + tbi) >> 1;
+			int tmj = (taj + tbj) >> 1;
+			if (tid & 1)
+			{
+				tbi = tai; tbj = taj;
+				tai = tci; taj = tcj;
+			}
+			else
+			{
+				tai = tbi; taj = tbj;
+				tbi = tci; tbj = tcj;
+			}
+			tci = tmi;
+			tcj = tmj;
+		}
+
+		int tmi = (tai + tbi) >> 1;
+		int tmj = (taj + tbj) >> 1;
+		float tlinear = (pheights[tai * psize + taj] + pheights[tbi * psize + tbj]) * 0.5f;
+		float tdeviation = std::fabs(tlinear - pheights[tmi * psize + tmj]);
+
+		//The halves' planes leave this one's by at most the midpoint's deviation, so adding the
+		//worse half's error bounds every sample under the triangle, not only its midpoint
+		if (t < tparents)
+		{
+			int tcorneri = tmi + tmj - taj;
+			int tcornerj = tmj + tai - tmi;
+			tdeviation += std::max(perrors[((tai + tcorneri) >> 1) * psize + ((taj + tcornerj) >> 1)],
+				perrors[((tbi + tcorneri) >> 1) * psize + ((tbj + tcornerj) >> 1)]);
+		}
+
+		float& terror = perrors[tmi * psize + tmj];
+		terror = std::max(terror, tdeviation);
+	}
+}
+
+///////////////////////////
+// Split from the two Grid
+// Halves Down
+///////////////////////////
+void LJMUTerrainRTIN::buildIndices(const std::vector<float>& perrors, int psize, float pmaxerror,
+	std::vector<uint32_t>& pindices)
+{
+	pindices.clear();
+	if (!isGridSize(psize) || perrors.size() != (size_t)psize * psize)
+		return;
+
+	int tcells = psize - 1;
+	addTriangle(perrors, psize, pmaxerror, 0, 0, tcells, tcells, tcells, 0, pindices);
+	addTriangle(perrors, psize, pmaxerror, tcells, tcells, 0, 0, 0, tcells, pindices);
+}
+
+///////////////////////////
+// Split a Triangle at its Long
+// Edge or Emit it
+///////////////////////////
+void LJMUTerrainRTIN::addTriangle(const std::vector<float>& perrors, int psize, float pmaxerror,
+	int pai, int paj, int pbi, int pbj, int pci, int pcj, std::vector<uint32_t>& pindices)
+{
+	int tmi = (pai + pbi) >> 1;
+	int tmj = (paj + pbj) >> 1;
+
+	if (std::abs(pai - pci) + std::abs(paj - pcj) > 1 && perrors[tmi * psize + tmj] > pmaxerror)
+	{
+		addTriangle(perrors, psize, pmaxerror, pci, pcj, pai, paj, tmi, tmj, pindices);
+		addTriangle(perrors, psize, pmaxerror, pbi, pbj, pci, pcj, tmi, tmj, pindices);
+		return;
+	}
+
+	//The halves alternate in winding, so turn each one round to match the full grid's
+	int tcross = (pbi - pai) * (pcj - paj) - (pbj - paj) * (pci - pai);
+	pindices.push_back((uint32_t)(pai * psize + paj));
+	if (tcross < 0)
+	{
+		pindices.push_back((uint32_t)(pbi * psize + pbj));
+		pindices.push_back((uint32_t)(pci * psize + pcj));
+	}
+	else
+	{
+		pindices.push_back((uint32_t)(pci * psize + pcj));
+		pindices.push_back((uint32_t)(pbi * psize + pbj));
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace LJMUDX
+{
+	/////////////////////////
+	// Right-triangulated irregular
+	// network over a square grid of
+	// 2^k + 1 samples a side.
+	//
+	// The grid is split into two
+	// right triangles, and each
+	// triangle into two more at the
+	// midpoint of its long edge,
+	// down to single cells. Every
+	// vertex stores the largest
+	// height error of leaving it
+	// out, taken over the whole
+	// subtree below it and over
+	// both triangles sharing its
+	// edge. Splitting wherever that
+	// error is above the limit then
+	// gives a mesh with no cracks
+	// that stays within the limit
+	// of every sample.
+	/////////////////////////
+	class LJMUTerrainRTIN
+	{
+	public:
+		//--------PUBLIC METHODS-------------------------------------------------------------
+		static bool		isGridSize(int psize);
+
+		// pheights holds psize * psize heights laid out [i * psize + j]. perrors receives the
+		// error of each vertex in the same layout.
+		static void		computeErrors(const float* pheights, int psize, std::vector<float>& perrors);
+
+		// Triangle list over the grid vertices that keeps every vertex whose error is above
+		// pmaxerror, wound like LJMUTerrainMeshBuilder::buildIndices
+		static void		buildIndices(const std::vector<float>& perrors, int psize, float pmaxerror,
+							std::vector<uint32_t>& pindices);
+
+	private:
+		//-------------HELPER METHODS--------------------------------------------------
+		static void		addTriangle(const std::vector<float>& perrors, int psize, float pmaxerror,
+							int pai, int paj, int pbi, int pbj, int pci, int pcj, std::vector<uint32_t>& pindices);
+	};
+}
@@ -0,0 +1,402 @@
+#include "LJMUTerrainSplat.h"
+#include "LJMUHeightmap.h"
+#include "LJMUThreadPool.h"
+#include "FastNoise.h"
+
+#include <algorithm>
+#include <cmath>
+
+//SSE2 is always there on x64, and on x86 when the compiler has been told it can use it
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LJMU_SPLAT_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace LJMUDX;
+using namespace Glyph3;
+
+namespace
+{
+	//Rate of a ramp with no fade, steep enough to step between neighbouring floats
+	const float SPLAT_STEP_RATE = 1e30f;
+	const float SPLAT_MAX_SLOPE = 89.9f;
+	const float SPLAT_DEGREES = 3.14159265f / 180.0f;
+	const int SPLAT_BLOCK_ROWS = 32;
+
+	inline float ramp(float px, float pedge, float prate)
+	{
+		return std::min(std::max((px - pedge) * prate + 1.0f, 0.0f), 1.0f);
+	}
+
+#ifdef LJMU_SPLAT_SSE2
+	inline __m128 rampSSE2(__m128 px, __m128 pedge, __m128 prate)
+	{
+		__m128 tw = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(px, pedge), prate), _mm_set1_ps(1.0f));
+		return _mm_min_ps(_mm_max_ps(tw, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+	}
+
+	inline __m128 rampDownSSE2(__m128 px, __m128 pedge, __m128 prate)
+	{
+		__m128 tw = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(pedge, px), prate), _mm_set1_ps(1.0f));
+		return _mm_min_ps(_mm_max_ps(tw, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+	}
+#endif
+}
+
+///////////////////////////
+// Constructor
+///////////////////////////
+LJMUTerrainSplat::LJMUTerrainSplat() :
+	_spacing(1.0f, 1.0f),
+	_height_scale(1.0f),
+	_obj_noise(nullptr),
+	_noise_amount(0.0f),
+	_obj_pool(nullptr)
+{
+
+}
+
+///////////////////////////
+// Add a Texture Layer
+///////////////////////////
+int LJMUTerrainSplat::addLayer(const LJMUSplatLayer& player)
+{
+	Layer tlayer;
+	tlayer.height = makeRamp(player.height.lo, player.height.hi, player.height.fade);
+	tlayer.slope = makeSlopeRamp(player.slope);
+	tlayer.curvature = makeRamp(player.curvature.lo, player.curvature.hi, player.curvature.fade);
+	tlayer.strength = player.strength;
+
+	this->_list_layers.push_back(tlayer);
+	return (int)this->_list_layers.size() - 1;
+}
+
+///////////////////////////
+// Weights of every Layer
+///////////////////////////
+bool LJMUTerrainSplat::generateWeights(const LJMUHeightmap& pmap, std::vector<float>& pweights) const
+{
+	int tlayers = (int)this->_list_layers.size();
+	if (tlayers == 0 || pmap.getWidth() < 2 || pmap.getLength() < 2)
+		return false;
+
+	int tlength = pmap.getLength();
+	pweights.resize((size_t)pmap.getWidth() * tlength * tlayers);
+
+	this->weighRows(pmap, tlayers, [&](int i, const float* trow)
+	{
+		float* tout = pweights.data() + (size_t)i * tlength * tlayers;
+		for (int j = 0; j < tlength; j++)
+		{
+			for (int k = 0; k < tlayers; k++)
+				tout[j * tlayers + k] = trow[(size_t)k * tlength + j];
+		}
+	});
+
+	return true;
+}
+
+///////////////////////////
+// Packed Control Texture
+///////////////////////////
+bool LJMUTerrainSplat::generateControl(const LJMUHeightmap& pmap, std::vector<uint32_t>& ptexels) const
+{
+	int tlayers = std::min((int)this->_list_layers.size(), 4);
+	if (tlayers == 0 || pmap.getWidth() < 2 || pmap.getLength() < 2)
+		return false;
+
+	int tlength = pmap.getLength();
+	ptexels.resize((size_t)pmap.getWidth() * tlength);
+
+	this->weighRows(pmap, tlayers, [&](int i, const float* trow)
+	{
+		//Missing layers read as zero weight
+		thread_local std::vector<float> tzero;
+		tzero.assign(tlength, 0.0f);
+
+		const float* tr = trow;
+		const float* tg = tlayers > 1 ? tr + tlength : tzero.data();
+		const float* tb = tlayers > 2 ? tg + tlength : tzero.data();
+		const float* ta = tlayers > 3 ? tb + tlength : tzero.data();
+		uint32_t* tout = ptexels.data() + (size_t)i * tlength;
+		int j = 0;
+
+#ifdef LJMU_SPLAT_SSE2
+		__m128 v255 = _mm_set1_ps(255.0f);
+		for (; j + 4 <= tlength; j += 4)
+		{
+			//Rounds to nearest, and weights in 0 to 1 never carry into the next byte
+			__m128i tred = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(tr + j), v255));
+			__m128i tgreen = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(tg + j), v255));
+			__m128i tblue = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(tb + j), v255));
+			__m128i talpha = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(ta + j), v255));
+
+			__m128i tpacked = _mm_or_si128(_mm_or_si128(tred, _mm_slli_epi32(tgreen, 8)),
+				_mm_or_si128(_mm_slli_epi32(tblue, 16), _mm_slli_epi32(talpha, 24)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(tout + j), tpacked);
+		}
+#endif
+
+		for (; j < tlength; j++)
+		{
+			uint32_t tred = (uint32_t)(tr[j] * 255.0f + 0.5f);
+			uint32_t tgreen = (uint32_t)(tg[j] * 255.0f + 0.5f);
+			uint32_t tblue = (uint32_t)(tb[j] * 255.0f + 0.5f);
+			uint32_t talpha = (uint32_t)(ta[j] * 255.0f + 0.5f);
+			tout[j] = tred | (tgreen << 8) | (tblue << 16) | (talpha << 24);
+		}
+	});
+
+	return true;
+}
+
+///////////////////////////
+// Range as Two Ramps
+///////////////////////////
+LJMUTerrainSplat::Ramp LJMUTerrainSplat::makeRamp(float plo, float phi, float pfade)
+{
+	//An open end never fades, so its ramp stays at 1 whatever the value
+	Ramp tramp;
+	tramp.rise = plo > -FLT_MAX ? plo : 0.0f;
+	tramp.rise_rate = plo > -FLT_MAX ? (pfade > 0.0f ? 1.0f / pfade : SPLAT_STEP_RATE) : 0.0f;
+	tramp.fall = phi < FLT_MAX ? phi : 0.0f;
+	tramp.fall_rate = phi < FLT_MAX ? (pfade > 0.0f ? 1.0f / pfade : SPLAT_STEP_RATE) : 0.0f;
+	return tramp;
+}
+
+///////////////////////////
+// Slope Range as Ramps over
+// the Gradient. The ramps are
+// straight in the gradient, so
+// no sample needs an arctangent.
+///////////////////////////
+LJMUTerrainSplat::Ramp LJMUTerrainSplat::makeSlopeRamp(const LJMUSplatRange& prange)
+{
+	Ramp tramp = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+	if (prange.lo > 0.0f)
+	{
+		float tlo = std::min(prange.lo, SPLAT_MAX_SLOPE);
+		float tfoot = std::max(tlo - prange.fade, 0.0f);
+		tramp.rise = std::tan(tlo * SPLAT_DEGREES);
+		float twidth = tramp.rise - std::tan(tfoot * SPLAT_DEGREES);
+		tramp.rise_rate = twidth > 0.0f ? 1.0f / twidth : SPLAT_STEP_RATE;
+	}
+
+	if (prange.hi < 90.0f)
+	{
+		float thi = std::max(prange.hi, 0.0f);
+		float tfoot = std::min(thi + prange.fade, SPLAT_MAX_SLOPE);
+		tramp.fall = std::tan(thi * SPLAT_DEGREES);
+		float twidth = std::tan(tfoot * SPLAT_DEGREES) - tramp.fall;
+		tramp.fall_rate = twidth > 0.0f ? 1.0f / twidth : SPLAT_STEP_RATE;
+	}
+
+	return tramp;
+}
+
+///////////////////////////
+// Weigh every Row on the
+// Pool. Each task slides down
+// a block of rows, so every
+// row is decoded once per
+// block rather than three
+// times.
+///////////////////////////
+void LJMUTerrainSplat::weighRows(const LJMUHeightmap& pmap, int playercount,
+	const std::function<void(int, const float*)>& pstore) const
+{
+	int twidth = pmap.getWidth();
+	int tlength = pmap.getLength();
+	int tblocks = (twidth + SPLAT_BLOCK_ROWS - 1) / SPLAT_BLOCK_ROWS;
+
+	LJMUThreadPool& tpool = this->_obj_pool ? *this->_obj_pool : LJMUThreadPool::getShared();
+	tpool.parallelFor(tblocks, [&](int pblock)
+	{
+		int ti0 = pblock * SPLAT_BLOCK_ROWS;
+		int ti1 = std::min(ti0 + SPLAT_BLOCK_ROWS, twidth);
+
+		thread_local std::vector<float> trows;
+		thread_local std::vector<float> tweights;
+		trows.resize((size_t)tlength * 3);
+		tweights.resize((size_t)tlength * playercount);
+		float* tprev = trows.data();
+		float* tcur = tprev + tlength;
+		float* tnext = tcur + tlength;
+
+		pmap.readRow(std::max(ti0 - 1, 0), 0, tlength, tprev);
+		pmap.readRow(ti0, 0, tlength, tcur);
+
+		for (int i = ti0; i < ti1; i++)
+		{
+			int tinext = std::min(i + 1, twidth - 1);
+			pmap.readRow(tinext, 0, tlength, tnext);
+
+			//Rows past the edges repeat it, so the difference spans one row there
+			float tdistance = (float)(tinext - std::max(i - 1, 0));
+			this->weighRow(tprev, tcur, tnext, tdistance, i, tlength, playercount, tweights.data());
+			pstore(i, tweights.data());
+
+			float* tfree = tprev;
+			tprev = tcur;
+			tcur = tnext;
+			tnext = tfree;
+		}
+	});
+}
+
+///////////////////////////
+// Weights along one Row.
+// The height, gradient and
+// curvature of the row go into
+// their own arrays first, then
+// each layer is weighed over
+// them, four samples at a time.
+///////////////////////////
+void LJMUTerrainSplat::weighRow(const float* pprev, const float* pcur, const float* pnext, float pdistance,
+	int pi, int plength, int playercount, float* pweights) const
+{
+	thread_local std::vector<float> tbuffer;
+	thread_local std::vector<FN_DECIMAL> tnoise;
+	tbuffer.resize((size_t)plength * 3);
+	float* theight = tbuffer.data();
+	float* tgradient = theight + plength;
+	float* tcurvature = tgradient + plength;
+
+	//Central differences in world units, one sided along the map's edges
+	float tscale = this->_height_scale;
+	float tdi = tscale / (pdistance * this->_spacing.x);
+	float tdj = tscale / (2.0f * this->_spacing.y);
+	float tdjedge = tscale / this->_spacing.y;
+	float tcurvi = tscale / (this->_spacing.x * this->_spacing.x);
+	float tcurvj = tscale / (this->_spacing.y * this->_spacing.y);
+
+	auto tfeature = [&](int j)
+	{
+		int tjprev = std::max(j - 1, 0);
+		int tjnext = std::min(j + 1, plength - 1);
+		float tgi = (pnext[j] - pprev[j]) * tdi;
+		float tgj = (pcur[tjnext] - pcur[tjprev]) * (tjnext - tjprev == 2 ? tdj : tdjedge);
+		theight[j] = pcur[j] * tscale;
+		tgradient[j] = std::sqrt(tgi * tgi + tgj * tgj);
+		tcurvature[j] = (pprev[j] + pnext[j] - 2.0f * pcur[j]) * tcurvi + (pcur[tjprev] + pcur[tjnext] - 2.0f * pcur[j]) * tcurvj;
+	};
+
+	tfeature(0);
+	int j = 1;
+
+#ifdef LJMU_SPLAT_SSE2
+	__m128 vdi = _mm_set1_ps(tdi);
+	__m128 vdj = _mm_set1_ps(tdj);
+	__m128 vcurvi = _mm_set1_ps(tcurvi);
+	__m128 vcurvj = _mm_set1_ps(tcurvj);
+	__m128 vscale = _mm_set1_ps(tscale);
+	__m128 vtwo = _mm_set1_ps(2.0f);
+	for (; j + 4 <= plength - 1; j += 4)
+	{
+		__m128 tp = _mm_loadu_ps(pprev + j);
+		__m128 tn = _mm_loadu_ps(pnext + j);
+		__m128 tc = _mm_loadu_ps(pcur + j);
+		__m128 tl = _mm_loadu_ps(pcur + j - 1);
+		__m128 tr = _mm_loadu_ps(pcur + j + 1);
+
+		__m128 tgi = _mm_mul_ps(_mm_sub_ps(tn, tp), vdi);
+		__m128 tgj = _mm_mul_ps(_mm_sub_ps(tr, tl), vdj);
+		__m128 tc2 = _mm_mul_ps(tc, vtwo);
+
+		_mm_storeu_ps(theight + j, _mm_mul_ps(tc, vscale));
+		_mm_storeu_ps(tgradient + j, _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(tgi, tgi), _mm_mul_ps(tgj, tgj))));
+		_mm_storeu_ps(tcurvature + j, _mm_add_ps(_mm_mul_ps(_mm_sub_ps(_mm_add_ps(tp, tn), tc2), vcurvi),
+			_mm_mul_ps(_mm_sub_ps(_mm_add_ps(tl, tr), tc2), vcurvj)));
+	}
+#endif
+
+	for (; j < plength; j++)
+		tfeature(j);
+
+	if (this->_obj_noise && this->_noise_amount != 0.0f)
+	{
+		tnoise.resize(plength);
+		this->_obj_noise->GetNoiseSet(tnoise.data(), (FN_DECIMAL)pi, (FN_DECIMAL)0, 1, plength);
+		for (int k = 0; k < plength; k++)
+			theight[k] += (float)tnoise[k] * this->_noise_amount;
+	}
+
+	//Each layer's raw weight, then the sums across them
+	for (int l = 0; l < playercount; l++)
+	{
+		const Layer& tlayer = this->_list_layers[l];
+		float* tw = pweights + (size_t)l * plength;
+		j = 0;
+
+#ifdef LJMU_SPLAT_SSE2
+		__m128 vstrength = _mm_set1_ps(tlayer.strength);
+		__m128 vhrise = _mm_set1_ps(tlayer.height.rise), vhriserate = _mm_set1_ps(tlayer.height.rise_rate);
+		__m128 vhfall = _mm_set1_ps(tlayer.height.fall), vhfallrate = _mm_set1_ps(tlayer.height.fall_rate);
+		__m128 vsrise = _mm_set1_ps(tlayer.slope.rise), vsriserate = _mm_set1_ps(tlayer.slope.rise_rate);
+		__m128 vsfall = _mm_set1_ps(tlayer.slope.fall), vsfallrate = _mm_set1_ps(tlayer.slope.fall_rate);
+		__m128 vcrise = _mm_set1_ps(tlayer.curvature.rise), vcriserate = _mm_set1_ps(tlayer.curvature.rise_rate);
+		__m128 vcfall = _mm_set1_ps(tlayer.curvature.fall), vcfallrate = _mm_set1_ps(tlayer.curvature.fall_rate);
+		for (; j + 4 <= plength; j += 4)
+		{
+			__m128 th = _mm_loadu_ps(theight + j);
+			__m128 tg = _mm_loadu_ps(tgradient + j);
+			__m128 tc = _mm_loadu_ps(tcurvature + j);
+
+			__m128 tweight = _mm_mul_ps(vstrength, _mm_mul_ps(rampSSE2(th, vhrise, vhriserate), rampDownSSE2(th, vhfall, vhfallrate)));
+			tweight = _mm_mul_ps(tweight, _mm_mul_ps(rampSSE2(tg, vsrise, vsriserate), rampDownSSE2(tg, vsfall, vsfallrate)));
+			tweight = _mm_mul_ps(tweight, _mm_mul_ps(rampSSE2(tc, vcrise, vcriserate), rampDownSSE2(tc, vcfall, vcfallrate)));
+			_mm_storeu_ps(tw + j, tweight);
+		}
+#endif
+
+		for (; j < plength; j++)
+		{
+			float tweight = tlayer.strength;
+			tweight *= ramp(theight[j], tlayer.height.rise, tlayer.height.rise_rate) * ramp(-theight[j], -tlayer.height.fall, tlayer.height.fall_rate);
+			tweight *= ramp(tgradient[j], tlayer.slope.rise, tlayer.slope.rise_rate) * ramp(-tgradient[j], -tlayer.slope.fall, tlayer.slope.fall_rate);
+			tweight *= ramp(tcurvature[j], tlayer.curvature.rise, tlayer.curvature.rise_rate) * ramp(-tcurvature[j], -tlayer.curvature.fall, tlayer.curvature.fall_rate);
+			tw[j] = tweight;
+		}
+	}
+
+	//Normalise, a sample nothing covers falling back to the first layer
+	j = 0;
+
+#ifdef LJMU_SPLAT_SSE2
+	__m128 vone = _mm_set1_ps(1.0f);
+	for (; j + 4 <= plength; j += 4)
+	{
+		__m128 tsum = _mm_setzero_ps();
+		for (int l = 0; l < playercount; l++)
+			tsum = _mm_add_ps(tsum, _mm_loadu_ps(pweights + (size_t)l * plength + j));
+
+		__m128 tcovered = _mm_cmpgt_ps(tsum, _mm_setzero_ps());
+		__m128 tinv = _mm_and_ps(tcovered, _mm_div_ps(vone, _mm_max_ps(tsum, _mm_set1_ps(FLT_MIN))));
+		for (int l = 0; l < playercount; l++)
+		{
+			float* tw = pweights + (size_t)l * plength + j;
+			_mm_storeu_ps(tw, _mm_mul_ps(_mm_loadu_ps(tw), tinv));
+		}
+		_mm_storeu_ps(pweights + j, _mm_add_ps(_mm_loadu_ps(pweights + j), _mm_andnot_ps(tcovered, vone)));
+	}
+#endif
+
+	for (; j < plength; j++)
+	{
+		float tsum = 0.0f;
+		for (int l = 0; l < playercount; l++)
+			tsum += pweights[(size_t)l * plength + j];
+
+		if (tsum > 0.0f)
+		{
+			float tinv = 1.0f / tsum;
+			for (int l = 0; l < playercount; l++)
+				pweights[(size_t)l * plength + j] *= tinv;
+		}
+		else
+		{
+			pweights[j] = 1.0f;
+		}
+	}
+}
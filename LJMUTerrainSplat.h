@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cfloat>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "Vector2f.h"
+
+class FastNoise;
+
+namespace LJMUDX
+{
+	class LJMUHeightmap;
+	class LJMUThreadPool;
+
+	/////////////////////////
+	// Values a layer covers in
+	// full, fading to nothing over
+	// fade either side. Open ended
+	// until set.
+	/////////////////////////
+	struct LJMUSplatRange
+	{
+		float	lo = -FLT_MAX;
+		float	hi = FLT_MAX;
+		float	fade = 0.0f;
+	};
+
+	/////////////////////////
+	// Where a texture layer is
+	// painted. A sample's weight
+	// is the product of its three
+	// ranges times the strength.
+	/////////////////////////
+	struct LJMUSplatLayer
+	{
+		LJMUSplatRange	height;			//World units above the origin
+		LJMUSplatRange	slope;			//Degrees from flat
+		LJMUSplatRange	curvature;		//World units per world unit squared, above 0 in hollows and below on ridges
+		float			strength = 1.0f;
+	};
+
+	/////////////////////////
+	// Texture blend weights for
+	// every sample of a heightmap,
+	// from its height, slope and
+	// curvature. Noise can jitter
+	// the heights the layers see,
+	// so the bands between them
+	// do not follow the contours.
+	//
+	// The map is worked through a
+	// row at a time on the thread
+	// pool, with the slope and
+	// curvature found from the
+	// neighbouring rows and four
+	// samples evaluated at once
+	// where SSE2 is available.
+	// Each sample's weights are
+	// normalised to sum to 1, a
+	// sample no layer covers goes
+	// wholly to the first.
+	/////////////////////////
+	class LJMUTerrainSplat
+	{
+	public:
+		//--------CONSTRUCTORS/DESTRUCTORS----------------------------------------------------
+		LJMUTerrainSplat();
+
+		//--------PUBLIC METHODS-------------------------------------------------------------
+		void			setThreadPool(LJMUThreadPool* ppool) { this->_obj_pool = ppool; }
+
+		// Placement of the samples, as given to the mesh builder
+		void			setSpacing(const Glyph3::Vector2f& pspacing) { this->_spacing = pspacing; }
+		void			setHeightScale(float pscale) { this->_height_scale = pscale; }
+
+		// pnoise is sampled at each sample's (i, j) and must outlive the splat, null for none.
+		// pamount is the most world units it moves a height by.
+		void			setNoise(const FastNoise* pnoise, float pamount) { this->_obj_noise = pnoise; this->_noise_amount = pamount; }
+
+		int				addLayer(const LJMUSplatLayer& player);
+		void			clearLayers() { this->_list_layers.clear(); }
+		int				getLayerCount() const { return (int)this->_list_layers.size(); }
+
+		// Every layer's weight per sample, laid out [(i * length + j) * layers + layer]
+		bool			generateWeights(const LJMUHeightmap& pmap, std::vector<float>& pweights) const;
+
+		// RGBA8 control texture of the first four layers, red in the low byte. The four should
+		// cover every sample between them, as further layers are left out before normalising.
+		bool			generateControl(const LJMUHeightmap& pmap, std::vector<uint32_t>& ptexels) const;
+
+	private:
+		//-------------HELPER TYPES----------------------------------------------------
+		// A range as two ramps, weight = sat((x - rise) * rise_rate + 1) * sat((fall - x) * fall_rate + 1)
+		struct Ramp
+		{
+			float	rise;
+			float	rise_rate;
+			float	fall;
+			float	fall_rate;
+		};
+
+		struct Layer
+		{
+			Ramp	height;
+			Ramp	slope;			//Over the gradient, the tangent of the slope
+			Ramp	curvature;
+			float	strength;
+		};
+
+		//-------------HELPER METHODS--------------------------------------------------
+		static Ramp		makeRamp(float plo, float phi, float pfade);
+		static Ramp		makeSlopeRamp(const LJMUSplatRange& prange);
+
+		// Hands pstore the weights of each row in turn, from the pool's threads
+		void			weighRows(const LJMUHeightmap& pmap, int playercount,
+							const std::function<void(int, const float*)>& pstore) const;
+
+		// Normalised weights of the first playercount layers along row pi, laid out
+		// [layer * length + j]. pdistance is the rows between pprev and pnext.
+		void			weighRow(const float* pprev, const float* pcur, const float* pnext, float pdistance,
+							int pi, int plength, int playercount, float* pweights) const;
+
+		//--------CLASS MEMBERS--------------------------------------------------------------
+		Glyph3::Vector2f		_spacing;
+		float					_height_scale;
+		const FastNoise*		_obj_noise;
+		float					_noise_amount;
+		std::vector<Layer>		_list_layers;
+		LJMUThreadPool*			_obj_pool;
+	};
+}
@@ -0,0 +1,388 @@
+#include "LJMUTerrainStreamer.h"
+#include "LJMUHeightmap.h"
+#include "LJMUThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace LJMUDX;
+using namespace Glyph3;
+
+///////////////////////////
+// Constructor, the layout
+// matches the chunk meshes
+///////////////////////////
+LJMUTerrainStreamer::LJMUTerrainStreamer(const LJMUNoiseTileSource& psource) :
+	_source(psource),
+	_obj_tile_cache(std::make_shared<LJMUNoiseTileCache>()),
+	_obj_pool(nullptr),
+	_chunk_cells(32),
+	_origin(0.0f, 0.0f, 0.0f),
+	_spacing(1.0f, 1.0f),
+	_height_scale(1.0f),
+	_tex_repeats(1.0f),
+	_max_error(0.0f),
+	_colour(1.0f, 1.0f, 1.0f, 1.0f),
+	_view_distance(1000.0f),
+	_max_staged(8),
+	_uploads_per_frame(2),
+	_running(0),
+	_stats()
+{
+	this->SetLayoutElements(BasicVertexDX11::GetElementCount(), BasicVertexDX11::Elements);
+}
+
+///////////////////////////
+// Destructor, the workers
+// hold on to this streamer
+// until they finish
+///////////////////////////
+LJMUTerrainStreamer::~LJMUTerrainStreamer()
+{
+	this->clear();
+}
+
+///////////////////////////
+// Stream Chunks around the
+// Camera for one Frame
+///////////////////////////
+void LJMUTerrainStreamer::update(const Vector3f& pcamera, const Vector3f& pdirection)
+{
+	float tchunkx = this->_chunk_cells * this->_spacing.x;
+	float tchunkz = this->_chunk_cells * this->_spacing.y;
+	float tkeep = this->_view_distance + std::max(tchunkx, tchunkz);
+	uint64_t tevicted = 0;
+	uint64_t tcancelled = 0;
+	uint64_t trequested = 0;
+
+	//Chunks are dropped a chunk further out than they are requested so they do not flicker
+	for (auto it = this->_map_resident.begin(); it != this->_map_resident.end();)
+	{
+		int tcx = (int)(it->first >> 32);
+		int tcz = (int)(int32_t)(uint32_t)it->first;
+		if (this->getChunkDistance(tcx, tcz, pcamera) > tkeep)
+		{
+			it = this->_map_resident.erase(it);
+			tevicted++;
+		}
+		else
+		{
+			++it;
+		}
+	}
+
+	for (auto it = this->_map_requests.begin(); it != this->_map_requests.end();)
+	{
+		if (this->getChunkDistance(it->second.cx, it->second.cz, pcamera) > tkeep)
+		{
+			it = this->_map_requests.erase(it);
+			tcancelled++;
+		}
+		else
+		{
+			++it;
+		}
+	}
+
+	//Running jobs check the flag between stages, one that comes back into range carries on
+	for (auto& tjob : this->_map_jobs)
+	{
+		const Request& trequest = tjob.second->request;
+		tjob.second->cancelled = this->getChunkDistance(trequest.cx, trequest.cz, pcamera) > tkeep;
+	}
+
+	//Request every chunk in range that is not already resident or on its way
+	int tcxlo = (int)std::floor((pcamera.x - this->_origin.x - this->_view_distance) / tchunkx);
+	int tcxhi = (int)std::floor((pcamera.x - this->_origin.x + this->_view_distance) / tchunkx);
+	int tczlo = (int)std::floor((pcamera.z - this->_origin.z - this->_view_distance) / tchunkz);
+	int tczhi = (int)std::floor((pcamera.z - this->_origin.z + this->_view_distance) / tchunkz);
+	Clock::time_point tnow = Clock::now();
+
+	for (int cx = tcxlo; cx <= tcxhi; cx++)
+	{
+		for (int cz = tczlo; cz <= tczhi; cz++)
+		{
+			if (this->getChunkDistance(cx, cz, pcamera) > this->_view_distance)
+				continue;
+
+			int64_t tkey = makeKey(cx, cz);
+			if (this->_map_resident.count(tkey) || this->_map_requests.count(tkey) || this->_map_jobs.count(tkey))
+				continue;
+
+			Request trequest = { cx, cz, tnow, 0.0f };
+			this->_map_requests.emplace(tkey, trequest);
+			trequested++;
+		}
+	}
+
+	for (auto& trequest : this->_map_requests)
+		trequest.second.priority = this->getPriority(trequest.second.cx, trequest.second.cz, pcamera, pdirection);
+
+	{
+		std::lock_guard<std::mutex> tlock(this->_mutex);
+		this->_stats.requested += trequested;
+		this->_stats.cancelled += tcancelled;
+		this->_stats.evicted += tevicted;
+	}
+
+	this->commitStaged(pcamera, pdirection);
+	this->startRequests();
+
+	std::lock_guard<std::mutex> tlock(this->_mutex);
+	this->_stats.pending = (int)this->_map_requests.size();
+	this->_stats.in_flight = (int)this->_map_jobs.size();
+	this->_stats.resident = (int)this->_map_resident.size();
+}
+
+///////////////////////////
+// Cancel and Drop Everything
+///////////////////////////
+void LJMUTerrainStreamer::clear()
+{
+	for (auto& tjob : this->_map_jobs)
+		tjob.second->cancelled = true;
+
+	std::unique_lock<std::mutex> tlock(this->_mutex);
+	this->_cv_idle.wait(tlock, [this]() { return this->_running == 0; });
+
+	this->_list_staged.clear();
+	this->_map_jobs.clear();
+	this->_map_requests.clear();
+	this->_map_resident.clear();
+	this->_stats.pending = 0;
+	this->_stats.in_flight = 0;
+	this->_stats.resident = 0;
+}
+
+///////////////////////////
+// Get the Counters
+///////////////////////////
+LJMUTerrainStreamStats LJMUTerrainStreamer::getStats() const
+{
+	std::lock_guard<std::mutex> tlock(this->_mutex);
+	return this->_stats;
+}
+
+///////////////////////////
+// Zero the Counters, the
+// chunk counts are kept
+///////////////////////////
+void LJMUTerrainStreamer::resetStats()
+{
+	std::lock_guard<std::mutex> tlock(this->_mutex);
+	LJMUTerrainStreamStats tstats = {};
+	tstats.pending = this->_stats.pending;
+	tstats.in_flight = this->_stats.in_flight;
+	tstats.resident = this->_stats.resident;
+	this->_stats = tstats;
+}
+
+///////////////////////////
+// Draw the Resident Chunks
+///////////////////////////
+void LJMUTerrainStreamer::Execute(PipelineManagerDX11* pPipeline, IParameterManager* pParamManager)
+{
+	for (auto& tchunk : this->_map_resident)
+		tchunk.second->Execute(pPipeline, pParamManager);
+}
+
+///////////////////////////
+// Distance across the Ground
+// to a Chunk's Centre
+///////////////////////////
+float LJMUTerrainStreamer::getChunkDistance(int pcx, int pcz, const Vector3f& pcamera) const
+{
+	float tx = this->_origin.x + (pcx + 0.5f) * this->_chunk_cells * this->_spacing.x - pcamera.x;
+	float tz = this->_origin.z + (pcz + 0.5f) * this->_chunk_cells * this->_spacing.y - pcamera.z;
+	return std::sqrt(tx * tx + tz * tz);
+}
+
+///////////////////////////
+// Start Order of a Chunk,
+// chunks straight ahead count
+// as half their distance and
+// those behind as one and a half
+///////////////////////////
+float LJMUTerrainStreamer::getPriority(int pcx, int pcz, const Vector3f& pcamera, const Vector3f& pdirection) const
+{
+	float tx = this->_origin.x + (pcx + 0.5f) * this->_chunk_cells * this->_spacing.x - pcamera.x;
+	float tz = this->_origin.z + (pcz + 0.5f) * this->_chunk_cells * this->_spacing.y - pcamera.z;
+	float tdistance = std::sqrt(tx * tx + tz * tz);
+	float tforward = std::sqrt(pdirection.x * pdirection.x + pdirection.z * pdirection.z);
+
+	//Looking straight down, or standing on the chunk, gives no preferred direction
+	float tfacing = 0.0f;
+	if (tdistance > 0.0f && tforward > 0.0f)
+		tfacing = (tx * pdirection.x + tz * pdirection.z) / (tdistance * tforward);
+
+	return tdistance * (1.0f - 0.5f * tfacing);
+}
+
+///////////////////////////
+// Commit the most Urgent
+// Finished Chunks
+///////////////////////////
+void LJMUTerrainStreamer::commitStaged(const Vector3f& pcamera, const Vector3f& pdirection)
+{
+	std::vector<JobPtr> tready;
+	{
+		std::lock_guard<std::mutex> tlock(this->_mutex);
+		tready.swap(this->_list_staged);
+	}
+
+	if (tready.empty())
+		return;
+
+	float tkeep = this->_view_distance + this->_chunk_cells * std::max(this->_spacing.x, this->_spacing.y);
+	Clock::time_point tnow = Clock::now();
+	std::vector<std::pair<float, JobPtr>> tcommit;
+	uint64_t tcancelled = 0;
+
+	//Results the camera has left behind are thrown away before they cost an upload
+	for (auto& tjob : tready)
+	{
+		const Request& trequest = tjob->request;
+		if (!tjob->mesh || this->getChunkDistance(trequest.cx, trequest.cz, pcamera) > tkeep)
+		{
+			this->_map_jobs.erase(makeKey(trequest.cx, trequest.cz));
+			tcancelled++;
+		}
+		else
+		{
+			tcommit.emplace_back(this->getPriority(trequest.cx, trequest.cz, pcamera, pdirection), tjob);
+		}
+	}
+
+	std::sort(tcommit.begin(), tcommit.end(),
+		[](const std::pair<float, JobPtr>& pa, const std::pair<float, JobPtr>& pb) { return pa.first < pb.first; });
+
+	size_t tcount = std::min(tcommit.size(), (size_t)std::max(this->_uploads_per_frame, 0));
+
+	std::lock_guard<std::mutex> tlock(this->_mutex);
+	for (size_t i = 0; i < tcommit.size(); i++)
+	{
+		const JobPtr& tjob = tcommit[i].second;
+		if (i >= tcount)
+		{
+			this->_list_staged.push_back(tjob);
+			continue;
+		}
+
+		int64_t tkey = makeKey(tjob->request.cx, tjob->request.cz);
+		this->_map_resident[tkey] = tjob->mesh;
+		this->_map_jobs.erase(tkey);
+
+		addLatency(this->_stats.staged, tjob->built, tnow);
+		addLatency(this->_stats.total, tjob->request.requested, tnow);
+		this->_stats.committed++;
+	}
+	this->_stats.cancelled += tcancelled;
+}
+
+///////////////////////////
+// Hand the most Urgent
+// Requests to the Workers
+///////////////////////////
+void LJMUTerrainStreamer::startRequests()
+{
+	int tfree = this->_max_staged - (int)this->_map_jobs.size();
+	if (tfree <= 0 || this->_map_requests.empty())
+		return;
+
+	std::vector<Request> torder;
+	torder.reserve(this->_map_requests.size());
+	for (auto& trequest : this->_map_requests)
+		torder.push_back(trequest.second);
+
+	tfree = std::min(tfree, (int)torder.size());
+	std::partial_sort(torder.begin(), torder.begin() + tfree, torder.end(),
+		[](const Request& pa, const Request& pb) { return pa.priority < pb.priority; });
+
+	LJMUThreadPool& tpool = this->_obj_pool ? *this->_obj_pool : LJMUThreadPool::getShared();
+
+	for (int i = 0; i < tfree; i++)
+	{
+		int64_t tkey = makeKey(torder[i].cx, torder[i].cz);
+
+		JobPtr tjob = std::make_shared<Job>();
+		tjob->request = torder[i];
+		tjob->cancelled = false;
+
+		this->_map_requests.erase(tkey);
+		this->_map_jobs.emplace(tkey, tjob);
+
+		{
+			std::lock_guard<std::mutex> tlock(this->_mutex);
+			this->_running++;
+		}
+		tpool.submit([this, tjob]() { this->runJob(tjob); });
+	}
+}
+
+///////////////////////////
+// Worker Side of a Chunk.
+// The heights carry a one
+// sample apron so the normals
+// along the edges match the
+// neighbouring chunks.
+///////////////////////////
+void LJMUTerrainStreamer::runJob(const JobPtr& pjob)
+{
+	pjob->started = Clock::now();
+
+	if (!pjob->cancelled)
+	{
+		int tcells = this->_chunk_cells;
+		int tsize = tcells + 3;
+		int ti0 = pjob->request.cx * tcells - 1;
+		int tj0 = pjob->request.cz * tcells - 1;
+
+		//Revisited chunks and the aprons shared with neighbours come out of the cache
+		LJMUHeightmap tmap(tsize, tsize);
+		this->_obj_tile_cache->fillRegion(this->_source, static_cast<float*>(tmap.getData()), ti0, tj0, tsize, tsize);
+		pjob->heights_done = Clock::now();
+
+		if (!pjob->cancelled)
+		{
+			//The builder spreads the texture over the whole map, apron included
+			float trepeats = this->_tex_repeats * (float)tsize / (float)tcells;
+
+			LJMUTerrainMeshBuilder tbuilder;
+			tbuilder.setThreadPool(this->_obj_pool);
+			tbuilder.setOrigin(Vector3f(this->_origin.x + ti0 * this->_spacing.x, this->_origin.y, this->_origin.z + tj0 * this->_spacing.y));
+			tbuilder.setSpacing(this->_spacing);
+			tbuilder.setHeightScale(this->_height_scale);
+			tbuilder.setColour(this->_colour);
+			tbuilder.setTexScale(Vector2f(trepeats, trepeats));
+			tbuilder.setMaxError(this->_max_error);
+			tbuilder.setSkirtDepth(this->_max_error);
+
+			LJMUTerrainRegion tregion = { 1, 1, tcells + 1, tcells + 1, 1 };
+			pjob->mesh = tbuilder.build(tmap, tregion);
+			pjob->built = Clock::now();
+		}
+	}
+
+	std::lock_guard<std::mutex> tlock(this->_mutex);
+	addLatency(this->_stats.queued, pjob->request.requested, pjob->started);
+	if (pjob->mesh)
+	{
+		addLatency(this->_stats.heights, pjob->started, pjob->heights_done);
+		addLatency(this->_stats.mesh, pjob->heights_done, pjob->built);
+	}
+
+	this->_list_staged.push_back(pjob);
+	this->_running--;
+	this->_cv_idle.notify_all();
+}
+
+///////////////////////////
+// Add a Sample to a Stage
+///////////////////////////
+void LJMUTerrainStreamer::addLatency(LJMUStreamLatency& platency, Clock::time_point pfrom, Clock::time_point pto)
+{
+	double tms = std::chrono::duration<double, std::milli>(pto - pfrom).count();
+	platency.count++;
+	platency.total_ms += tms;
+	platency.max_ms = std::max(platency.max_ms, tms);
+}
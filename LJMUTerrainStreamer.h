@@ -0,0 +1,203 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "PipelineExecutorDX11.h"
+
+#include "LJMUNoiseTileCache.h"
+#include "LJMUTerrainMeshBuilder.h"
+
+namespace LJMUDX
+{
+	/////////////////////////
+	// Time spent in one stage
+	// of the streaming pipeline,
+	// in milliseconds
+	/////////////////////////
+	struct LJMUStreamLatency
+	{
+		uint64_t	count;
+		double		total_ms;
+		double		max_ms;
+
+		double		getMean() const { return this->count > 0 ? this->total_ms / (double)this->count : 0.0; }
+	};
+
+	/////////////////////////
+	// Streaming counters. The
+	// stages are queued (requested
+	// until a worker starts it),
+	// heights, mesh, staged (built
+	// until committed) and total
+	// (requested until committed).
+	/////////////////////////
+	struct LJMUTerrainStreamStats
+	{
+		uint64_t			requested;
+		uint64_t			committed;
+		uint64_t			cancelled;		//Dropped at any stage because the camera moved away
+		uint64_t			evicted;
+		int					pending;		//Waiting for a worker slot
+		int					in_flight;		//On a worker or staged
+		int					resident;
+		LJMUStreamLatency	queued;
+		LJMUStreamLatency	heights;
+		LJMUStreamLatency	mesh;
+		LJMUStreamLatency	staged;
+		LJMUStreamLatency	total;
+	};
+
+	/////////////////////////
+	// Streams noise terrain
+	// chunks in and out around
+	// the camera. update() runs
+	// on the render thread: it
+	// requests the chunks in view
+	// range, cancels the ones the
+	// camera has left, starts the
+	// nearest requests on the
+	// thread pool, and commits at
+	// most a few finished chunks
+	// so no frame pays for more
+	// than that many uploads.
+	//
+	// Workers read the heights
+	// through a noise tile cache
+	// and build the mesh, then
+	// wait in a staging list.
+	// Chunks are only started while
+	// fewer than the staging limit
+	// are in flight, so the list
+	// can never grow past it.
+	//
+	// Chunk (cx, cz) covers height
+	// samples cx * cells to
+	// (cx + 1) * cells along x,
+	// sample (x, z) placed at
+	// origin + (x * spacing.x,
+	// height * scale, z * spacing.y).
+	// Neighbours sample their
+	// shared edge identically so
+	// no seams open.
+	/////////////////////////
+	class LJMUTerrainStreamer : public Glyph3::PipelineExecutorDX11
+	{
+	public:
+		//--------CONSTRUCTORS/DESTRUCTORS----------------------------------------------------
+		LJMUTerrainStreamer(const LJMUNoiseTileSource& psource);
+		virtual ~LJMUTerrainStreamer();
+
+		//--------PUBLIC METHODS-------------------------------------------------------------
+		// Placement settings are read by the workers, so set them before the first update
+		// or after a clear.
+		void			setThreadPool(LJMUThreadPool* ppool) { this->_obj_pool = ppool; }
+		void			setChunkCells(int pcells) { this->_chunk_cells = pcells; }
+		void			setOrigin(const Glyph3::Vector3f& porigin) { this->_origin = porigin; }
+		void			setSpacing(const Glyph3::Vector2f& pspacing) { this->_spacing = pspacing; }
+		void			setHeightScale(float pscale) { this->_height_scale = pscale; }
+		void			setColour(const Glyph3::Vector4f& pcolour) { this->_colour = pcolour; }
+
+		// Chunk heights are read through this cache, so a chunk streamed back in and the
+		// apron samples shared with its neighbours come from cached tiles. Tiles the size
+		// of a chunk line up with the chunk edges. The streamer makes its own if none is set.
+		void			setTileCache(const std::shared_ptr<LJMUNoiseTileCache>& pcache) { this->_obj_tile_cache = pcache; }
+		const std::shared_ptr<LJMUNoiseTileCache>&	getTileCache() const { return this->_obj_tile_cache; }
+
+		// Texture repeats across each chunk, whole numbers keep the chunks seamless
+		void			setTexRepeats(float prepeats) { this->_tex_repeats = prepeats; }
+
+		// Simplifies each chunk to within perror world units, 0 for the full grid. Needs a
+		// power of two chunk cells, and hangs a skirt that deep to cover the seams.
+		void			setMaxError(float perror) { this->_max_error = perror; }
+
+		// Chunks whose centre is within pdistance world units of the camera are streamed in,
+		// and dropped again once they are a chunk further than that
+		void			setViewDistance(float pdistance) { this->_view_distance = pdistance; }
+		void			setMaxStaged(int pcount) { this->_max_staged = pcount; }
+		void			setUploadsPerFrame(int pcount) { this->_uploads_per_frame = pcount; }
+
+		int				getChunkCells() const { return this->_chunk_cells; }
+		float			getViewDistance() const { return this->_view_distance; }
+
+		// Render thread only. pdirection is the camera's forward vector, chunks ahead of
+		// the camera are started before those behind it at the same distance.
+		void			update(const Glyph3::Vector3f& pcamera, const Glyph3::Vector3f& pdirection);
+
+		// Cancels everything, waits for the workers and drops the resident chunks
+		void			clear();
+
+		LJMUTerrainStreamStats	getStats() const;
+		void			resetStats();
+
+		virtual void	Execute(Glyph3::PipelineManagerDX11* pPipeline, Glyph3::IParameterManager* pParamManager);
+
+	private:
+		typedef std::chrono::steady_clock Clock;
+
+		//-------------HELPER TYPES----------------------------------------------------
+		struct Request
+		{
+			int					cx;
+			int					cz;
+			Clock::time_point	requested;
+			float				priority;		//Lower starts sooner
+		};
+
+		struct Job
+		{
+			Request				request;
+			std::atomic<bool>	cancelled;
+			Clock::time_point	started;
+			Clock::time_point	heights_done;
+			Clock::time_point	built;
+			LJMUTerrainMeshPtr	mesh;			//Null if cancelled before it was built
+		};
+
+		typedef std::shared_ptr<Job> JobPtr;
+
+		//-------------HELPER METHODS--------------------------------------------------
+		static int64_t	makeKey(int pcx, int pcz) { return ((int64_t)pcx << 32) | (uint32_t)pcz; }
+		float			getChunkDistance(int pcx, int pcz, const Glyph3::Vector3f& pcamera) const;
+		float			getPriority(int pcx, int pcz, const Glyph3::Vector3f& pcamera, const Glyph3::Vector3f& pdirection) const;
+		void			commitStaged(const Glyph3::Vector3f& pcamera, const Glyph3::Vector3f& pdirection);
+		void			startRequests();
+		void			runJob(const JobPtr& pjob);
+		static void		addLatency(LJMUStreamLatency& platency, Clock::time_point pfrom, Clock::time_point pto);
+
+		//--------CLASS MEMBERS--------------------------------------------------------------
+		LJMUNoiseTileSource		_source;
+		std::shared_ptr<LJMUNoiseTileCache>	_obj_tile_cache;
+		LJMUThreadPool*			_obj_pool;
+		int						_chunk_cells;
+		Glyph3::Vector3f		_origin;
+		Glyph3::Vector2f		_spacing;
+		float					_height_scale;
+		float					_tex_repeats;
+		float					_max_error;
+		Glyph3::Vector4f		_colour;
+		float					_view_distance;
+		int						_max_staged;
+		int						_uploads_per_frame;
+
+		//Render thread only
+		std::unordered_map<int64_t, LJMUTerrainMeshPtr>	_map_resident;
+		std::unordered_map<int64_t, Request>			_map_requests;
+		std::unordered_map<int64_t, JobPtr>				_map_jobs;		//Running or staged
+
+		//Shared with the workers
+		std::vector<JobPtr>		_list_staged;
+		int						_running;
+		LJMUTerrainStreamStats	_stats;
+		mutable std::mutex		_mutex;
+		std::condition_variable	_cv_idle;
+	};
+
+	typedef std::shared_ptr<LJMUTerrainStreamer> LJMUTerrainStreamerPtr;
+}
@@ -0,0 +1,198 @@
+#include "LJMUThreadPool.h"
+
+#include <algorithm>
+
+using namespace LJMUDX;
+
+namespace
+{
+	/////////////////////////
+	// Block of parallelFor items
+	// owned by one participant.
+	// The owner takes from the
+	// front, thieves from the back.
+	/////////////////////////
+	struct LJMUWorkRange
+	{
+		std::mutex	mutex;
+		int			begin = 0;
+		int			end = 0;
+
+		bool popFront(int& pitem)
+		{
+			std::lock_guard<std::mutex> tlock(this->mutex);
+			if (this->begin >= this->end)
+				return false;
+			pitem = this->begin++;
+			return true;
+		}
+
+		bool popBack(int& pitem)
+		{
+			std::lock_guard<std::mutex> tlock(this->mutex);
+			if (this->begin >= this->end)
+				return false;
+			pitem = --this->end;
+			return true;
+		}
+	};
+
+	/////////////////////////
+	// Shared state of one
+	// parallelFor call
+	/////////////////////////
+	struct LJMUParallelJob
+	{
+		std::function<void(int)>			body;
+		std::unique_ptr<LJMUWorkRange[]>	ranges;
+		int									slots = 0;
+		int									count = 0;
+		std::atomic<int>					next_slot{ 0 };
+		std::atomic<int>					completed{ 0 };
+		std::mutex							done_mutex;
+		std::condition_variable				done_cv;
+
+		void run(int pslot)
+		{
+			int titem;
+			int tdone = 0;
+
+			//Drain our own block first, then steal from the others in turn
+			for (int i = 0; i < this->slots; i++)
+			{
+				LJMUWorkRange& trange = this->ranges[(pslot + i) % this->slots];
+				while (i == 0 ? trange.popFront(titem) : trange.popBack(titem))
+				{
+					this->body(titem);
+					tdone++;
+				}
+			}
+
+			if (tdone > 0 && this->completed.fetch_add(tdone) + tdone == this->count)
+			{
+				std::lock_guard<std::mutex> tlock(this->done_mutex);
+				this->done_cv.notify_all();
+			}
+		}
+	};
+}
+
+///////////////////////////
+// Start the worker threads
+///////////////////////////
+LJMUThreadPool::LJMUThreadPool(unsigned int pworkercount) :
+	_stop(false)
+{
+	if (pworkercount == 0)
+	{
+		unsigned int thardware = std::thread::hardware_concurrency();
+		pworkercount = thardware > 1 ? thardware - 1 : 1;
+	}
+
+	for (unsigned int i = 0; i < pworkercount; i++)
+	{
+		this->_list_workers.emplace_back(&LJMUThreadPool::workerLoop, this);
+	}
+}
+
+///////////////////////////
+// Finish queued tasks and
+// join the workers
+///////////////////////////
+LJMUThreadPool::~LJMUThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> tlock(this->_mutex);
+		this->_stop = true;
+	}
+	this->_cv_work.notify_all();
+
+	for (auto& tworker : this->_list_workers)
+	{
+		tworker.join();
+	}
+}
+
+///////////////////////////
+// Get the Application-wide Pool
+///////////////////////////
+LJMUThreadPool& LJMUThreadPool::getShared()
+{
+	static LJMUThreadPool tpool;
+	return tpool;
+}
+
+///////////////////////////
+// Queue a Task for a Worker
+///////////////////////////
+void LJMUThreadPool::submit(std::function<void()> ptask)
+{
+	{
+		std::lock_guard<std::mutex> tlock(this->_mutex);
+		this->_queue_tasks.push_back(std::move(ptask));
+	}
+	this->_cv_work.notify_one();
+}
+
+///////////////////////////
+// Run a Range of Items in
+// Parallel and Wait for Them
+///////////////////////////
+void LJMUThreadPool::parallelFor(int pcount, const std::function<void(int)>& pbody)
+{
+	if (pcount <= 0)
+		return;
+
+	int tslots = std::min(pcount, (int)this->getWorkerCount() + 1);
+	if (tslots == 1)
+	{
+		for (int i = 0; i < pcount; i++)
+			pbody(i);
+		return;
+	}
+
+	auto tjob = std::make_shared<LJMUParallelJob>();
+	tjob->body = pbody;
+	tjob->count = pcount;
+	tjob->slots = tslots;
+	tjob->ranges.reset(new LJMUWorkRange[tslots]);
+
+	for (int i = 0; i < tslots; i++)
+	{
+		tjob->ranges[i].begin = (int)((long long)pcount * i / tslots);
+		tjob->ranges[i].end = (int)((long long)pcount * (i + 1) / tslots);
+	}
+
+	//Helpers that start after the work is gone find empty ranges and return at once
+	for (int i = 1; i < tslots; i++)
+	{
+		this->submit([tjob]() { tjob->run(tjob->next_slot.fetch_add(1) + 1); });
+	}
+
+	tjob->run(0);
+
+	std::unique_lock<std::mutex> tlock(tjob->done_mutex);
+	tjob->done_cv.wait(tlock, [&tjob]() { return tjob->completed.load() == tjob->count; });
+}
+
+///////////////////////////
+// Worker Thread Body
+///////////////////////////
+void LJMUThreadPool::workerLoop()
+{
+	for (;;)
+	{
+		std::function<void()> ttask;
+		{
+			std::unique_lock<std::mutex> tlock(this->_mutex);
+			this->_cv_work.wait(tlock, [this]() { return this->_stop || !this->_queue_tasks.empty(); });
+
+			if (this->_stop && this->_queue_tasks.empty())
+				return;
+
+			ttask = std::move(this->_queue_tasks.front());
+			this->_queue_tasks.pop_front();
+		}
+		ttask();
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace LJMUDX
+{
+	/////////////////////////
+	// Fixed size pool of worker
+	// threads. Tasks can be queued
+	// to run asynchronously, or a
+	// range of work items can be
+	// run in parallel with
+	// parallelFor.
+	/////////////////////////
+	class LJMUThreadPool
+	{
+	public:
+		//--------CONSTRUCTORS/DESTRUCTORS----------------------------------------------------
+		LJMUThreadPool(unsigned int pworkercount = 0);	//0 uses one worker per hardware thread, less the caller
+		~LJMUThreadPool();
+
+		//--------PUBLIC METHODS-------------------------------------------------------------
+		static LJMUThreadPool& getShared();				//Pool shared by the application's background work
+
+		unsigned int	getWorkerCount() const { return (unsigned int)this->_list_workers.size(); }
+
+		void			submit(std::function<void()> ptask);
+
+		// Runs pbody(0) .. pbody(pcount - 1) and returns once every item has completed.
+		// Each participating thread owns a contiguous block of items and steals from
+		// the back of other blocks once its own is empty. The calling thread takes part,
+		// so parallelFor may be called from inside a pool task.
+		void			parallelFor(int pcount, const std::function<void(int)>& pbody);
+
+	protected:
+		//-------------HELPER METHODS--------------------------------------------------
+		void			workerLoop();
+
+		//--------CLASS MEMBERS--------------------------------------------------------------
+		std::vector<std::thread>			_list_workers;
+		std::deque<std::function<void()>>	_queue_tasks;
+		std::mutex							_mutex;
+		std::condition_variable				_cv_work;
+		bool								_stop;
+	};
+}
@@ -0,0 +1,212 @@
+//------------Command line converter for tiled heightmap files---------------
+//
+// HeightTileTool pack <in.r16> <width> <length> <out.lht> [tilesize] [mips]
+// HeightTileTool unpack <in.lht> <out.r16> [mip]
+// HeightTileTool noise <out.lht> <width> <length> <seed> <frequency> [tilesize] [mips]
+// HeightTileTool info <in.lht>
+//
+// A mips of 0 adds levels until one tile holds a whole level.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "FastNoise.h"
+#include "LJMUHeightmap.h"
+#include "LJMUHeightMapGenerator.h"
+#include "LJMUHeightTileFile.h"
+#include "LJMUMappedHeightmap.h"
+
+using namespace LJMUDX;
+
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+
+	double getMilliseconds(Clock::time_point pfrom)
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - pfrom).count();
+	}
+
+	int printUsage()
+	{
+		std::printf("HeightTileTool pack <in.r16> <width> <length> <out.lht> [tilesize] [mips]\n");
+		std::printf("HeightTileTool unpack <in.lht> <out.r16> [mip]\n");
+		std::printf("HeightTileTool noise <out.lht> <width> <length> <seed> <frequency> [tilesize] [mips]\n");
+		std::printf("HeightTileTool info <in.lht>\n");
+		return 1;
+	}
+
+	///////////////////////////
+	// Write a Map and Report
+	// the Sizes
+	///////////////////////////
+	int writeTiles(const std::string& pfilename, const LJMUHeightmap& pmap, int ptilesize, int pmips)
+	{
+		Clock::time_point tstart = Clock::now();
+		if (!LJMUHeightTileFile::write(pfilename, pmap, ptilesize, pmips))
+		{
+			std::printf("Could not write %s\n", pfilename.c_str());
+			return 1;
+		}
+
+		std::ifstream tfile(pfilename, std::ios::binary | std::ios::ate);
+		long long tbytes = (long long)tfile.tellg();
+		std::printf("Wrote %s in %.1f ms, %lld bytes against %lld raw\n", pfilename.c_str(), getMilliseconds(tstart),
+			tbytes, (long long)(pmap.getSampleCount() * sizeof(uint16_t)));
+		return 0;
+	}
+
+	///////////////////////////
+	// .r16 to Tiles
+	///////////////////////////
+	int pack(int pargc, char** pargv)
+	{
+		if (pargc < 6)
+			return printUsage();
+
+		int twidth = std::atoi(pargv[3]);
+		int tlength = std::atoi(pargv[4]);
+		int ttilesize = pargc > 6 ? std::atoi(pargv[6]) : 64;
+		int tmips = pargc > 7 ? std::atoi(pargv[7]) : 0;
+
+		//The raw codes are kept as they are, with a scale of 1 and offset of 0
+		LJMUMappedHeightmap tsource;
+		LJMUHeightmap tmap;
+		if (!tsource.open(pargv[2], twidth, tlength) ||
+			!tmap.create(twidth, tlength, LJMUHeightmap::FORMAT_UNORM16) ||
+			!tsource.readRows(0, twidth, static_cast<uint16_t*>(tmap.getData())))
+		{
+			std::printf("Could not read %d x %d samples from %s\n", twidth, tlength, pargv[2]);
+			return 1;
+		}
+
+		return writeTiles(pargv[5], tmap, ttilesize, tmips);
+	}
+
+	///////////////////////////
+	// Tiles to .r16
+	///////////////////////////
+	int unpack(int pargc, char** pargv)
+	{
+		if (pargc < 4)
+			return printUsage();
+
+		int tmip = pargc > 4 ? std::atoi(pargv[4]) : 0;
+
+		LJMUHeightTileFile tfile;
+		LJMUHeightmap tmap;
+		Clock::time_point tstart = Clock::now();
+		if (!tfile.open(pargv[2]) || !tfile.readLevel(tmip, tmap))
+		{
+			std::printf("Could not read level %d of %s\n", tmip, pargv[2]);
+			return 1;
+		}
+		double tms = getMilliseconds(tstart);
+
+		std::ofstream tout(pargv[3], std::ios::binary | std::ios::trunc);
+		tout.write(static_cast<const char*>(tmap.getData()), tmap.getBytes());
+		if (!tout)
+		{
+			std::printf("Could not write %s\n", pargv[3]);
+			return 1;
+		}
+
+		std::printf("Wrote %s, %d x %d samples decoded in %.1f ms\n", pargv[3], tmap.getWidth(), tmap.getLength(), tms);
+		return 0;
+	}
+
+	///////////////////////////
+	// FastNoise to Tiles, the
+	// same Perlin noise the demo
+	// generates its map from
+	///////////////////////////
+	int noise(int pargc, char** pargv)
+	{
+		if (pargc < 7)
+			return printUsage();
+
+		int twidth = std::atoi(pargv[3]);
+		int tlength = std::atoi(pargv[4]);
+		int ttilesize = pargc > 7 ? std::atoi(pargv[7]) : 64;
+		int tmips = pargc > 8 ? std::atoi(pargv[8]) : 0;
+
+		FastNoise tnoise;
+		tnoise.SetNoiseType(FastNoise::Perlin);
+		tnoise.SetSeed(std::atoi(pargv[5]));
+		tnoise.SetFrequency((FN_DECIMAL)std::atof(pargv[6]));
+
+		LJMUHeightmap tmap;
+		if (!tmap.create(twidth, tlength, LJMUHeightmap::FORMAT_UNORM16))
+		{
+			std::printf("Could not create a %d x %d map\n", twidth, tlength);
+			return 1;
+		}
+
+		LJMUHeightMapGenerator tgenerator;
+		tgenerator.generateNoise(tmap, tnoise);
+		return writeTiles(pargv[2], tmap, ttilesize, tmips);
+	}
+
+	///////////////////////////
+	// Levels and how well each
+	// Compressed
+	///////////////////////////
+	int info(int pargc, char** pargv)
+	{
+		if (pargc < 3)
+			return printUsage();
+
+		LJMUHeightTileFile tfile;
+		if (!tfile.open(pargv[2]))
+		{
+			std::printf("Could not open %s\n", pargv[2]);
+			return 1;
+		}
+
+		std::printf("%s: %d x %d, tiles of %d, scale %g, offset %g\n", pargv[2], tfile.getWidth(), tfile.getLength(),
+			tfile.getTileSize(), tfile.getScale(), tfile.getOffset());
+
+		std::vector<uint16_t> ttile((size_t)tfile.getTileSize() * tfile.getTileSize());
+		for (int m = 0; m < tfile.getMipCount(); m++)
+		{
+			long long tbytes = 0;
+			Clock::time_point tstart = Clock::now();
+			for (int ti = 0; ti < tfile.getTilesI(m); ti++)
+			{
+				for (int tj = 0; tj < tfile.getTilesJ(m); tj++)
+				{
+					tbytes += tfile.getTileBytes(m, ti, tj);
+					tfile.readTile(m, ti, tj, ttile.data());
+				}
+			}
+
+			int ttiles = tfile.getTilesI(m) * tfile.getTilesJ(m);
+			long long traw = (long long)tfile.getWidth(m) * tfile.getLength(m) * (long long)sizeof(uint16_t);
+			std::printf("  mip %d: %d x %d, %d tiles, %lld bytes (%.2fx), %.1f us per tile\n", m, tfile.getWidth(m),
+				tfile.getLength(m), ttiles, tbytes, (double)traw / (double)tbytes, getMilliseconds(tstart) * 1000.0 / ttiles);
+		}
+		return 0;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+		return printUsage();
+
+	std::string tcommand = argv[1];
+	if (tcommand == "pack")
+		return pack(argc, argv);
+	if (tcommand == "unpack")
+		return unpack(argc, argv);
+	if (tcommand == "noise")
+		return noise(argc, argv);
+	if (tcommand == "info")
+		return info(argc, argv);
+
+	return printUsage();
+}
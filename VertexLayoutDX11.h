@@ -0,0 +1,242 @@
+#pragma once
+#include "PCH.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+//--------------------------------------------------------------------------------
+using namespace Glyph3;
+
+//--------------------------------------------------------------------------------
+// One member of a vertex struct and the format the input assembler reads it as.
+// Declare them with VERTEX_ATTRIBUTE_DX11 so the offset and size come from the
+// struct itself.
+//--------------------------------------------------------------------------------
+struct VertexAttributeDX11
+{
+	const char*		semantic;
+	unsigned int	semanticIndex;
+	DXGI_FORMAT		format;
+	unsigned int	memberOffset;	// Into the vertex struct
+	unsigned int	memberSize;
+	unsigned int	stream;			// Input slot, 0 unless the layout is split
+};
+
+#define VERTEX_ATTRIBUTE_DX11(vertex, member, semantic, index, format) \
+	VertexAttributeDX11{ semantic, index, format, (unsigned int)offsetof(vertex, member), \
+		(unsigned int)sizeof(((vertex*)nullptr)->member), 0 }
+
+//--------------------------------------------------------------------------------
+// Bytes of one element of a format, 0 for formats not listed here yet
+//--------------------------------------------------------------------------------
+constexpr unsigned int GetFormatSizeDX11(DXGI_FORMAT format)
+{
+	switch (format)
+	{
+	case DXGI_FORMAT_R32G32B32A32_FLOAT:
+		return 16;
+	case DXGI_FORMAT_R32G32B32_FLOAT:
+		return 12;
+	case DXGI_FORMAT_R32G32_FLOAT:
+	case DXGI_FORMAT_R16G16B16A16_FLOAT:
+	case DXGI_FORMAT_R16G16B16A16_UNORM:
+	case DXGI_FORMAT_R16G16B16A16_SNORM:
+		return 8;
+	case DXGI_FORMAT_R32_FLOAT:
+	case DXGI_FORMAT_R32_UINT:
+	case DXGI_FORMAT_R16G16_FLOAT:
+	case DXGI_FORMAT_R16G16_UNORM:
+	case DXGI_FORMAT_R16G16_SNORM:
+	case DXGI_FORMAT_R8G8B8A8_UNORM:
+	case DXGI_FORMAT_R8G8B8A8_SNORM:
+		return 4;
+	default:
+		return 0;
+	}
+}
+
+//--------------------------------------------------------------------------------
+constexpr bool IsSameSemanticDX11(const char* a, const char* b)
+{
+	while (*a && *a == *b)
+	{
+		++a;
+		++b;
+	}
+	return *a == *b;
+}
+
+//--------------------------------------------------------------------------------
+template<size_t TCount>
+struct VertexElementsDX11
+{
+	D3D11_INPUT_ELEMENT_DESC items[TCount];
+};
+
+//--------------------------------------------------------------------------------
+// Input layout of a vertex struct, built once from its attributes at compile
+// time. The element array, strides and offsets all come from here, and
+// IsComplete and FormatsMatch can be static_asserted, so the layout can't drift
+// from the struct.
+//
+// A layout can be split over several streams. Each stream packs its own
+// attributes in order, and SplitVertices fills one buffer for each. A pass that
+// only needs positions binds the stream holding them and fetches nothing else.
+//--------------------------------------------------------------------------------
+template<class TVertex, size_t TCount>
+struct VertexLayoutDX11
+{
+	typedef TVertex Vertex;
+
+	VertexAttributeDX11 attributes[TCount];
+
+	constexpr unsigned int GetAttributeCount() const { return (unsigned int)TCount; }
+
+	constexpr unsigned int GetStreamCount() const
+	{
+		unsigned int count = 0;
+		for (size_t i = 0; i < TCount; i++)
+			count = attributes[i].stream + 1 > count ? attributes[i].stream + 1 : count;
+		return count;
+	}
+
+	// Bytes between vertices in a stream
+	constexpr unsigned int GetStride(unsigned int stream = 0) const
+	{
+		unsigned int stride = 0;
+		for (size_t i = 0; i < TCount; i++)
+			stride += attributes[i].stream == stream ? attributes[i].memberSize : 0;
+		return stride;
+	}
+
+	// Offset of an attribute within its stream
+	constexpr unsigned int GetOffset(size_t attribute) const
+	{
+		unsigned int offset = 0;
+		for (size_t i = 0; i < attribute; i++)
+			offset += attributes[i].stream == attributes[attribute].stream ? attributes[i].memberSize : 0;
+		return offset;
+	}
+
+	// Every byte of the vertex belongs to exactly one attribute
+	constexpr bool IsComplete() const
+	{
+		unsigned int covered = 0;
+		for (size_t i = 0; i < TCount; i++)
+		{
+			for (size_t j = 0; j < TCount; j++)
+			{
+				bool overlap = i != j &&
+					attributes[i].memberOffset < attributes[j].memberOffset + attributes[j].memberSize &&
+					attributes[j].memberOffset < attributes[i].memberOffset + attributes[i].memberSize;
+				if (overlap)
+					return false;
+			}
+			covered += attributes[i].memberSize;
+		}
+		return covered == sizeof(TVertex);
+	}
+
+	// Every member is the size its format reads
+	constexpr bool FormatsMatch() const
+	{
+		for (size_t i = 0; i < TCount; i++)
+		{
+			if (GetFormatSizeDX11(attributes[i].format) != attributes[i].memberSize)
+				return false;
+		}
+		return true;
+	}
+
+	// Every attribute is read from where it sits in the struct, so a buffer of
+	// TVertex can be bound as it is. Only a single-stream layout can pass, a split
+	// one is repacked by SplitVertices.
+	constexpr bool OffsetsMatch() const
+	{
+		for (size_t i = 0; i < TCount; i++)
+		{
+			if (attributes[i].stream != 0 || GetOffset(i) != attributes[i].memberOffset)
+				return false;
+		}
+		return true;
+	}
+
+	// Moves the attributes with this semantic to a stream
+	constexpr VertexLayoutDX11 SetStream(const char* semantic, unsigned int stream) const
+	{
+		VertexLayoutDX11 layout = *this;
+		for (size_t i = 0; i < TCount; i++)
+		{
+			if (IsSameSemanticDX11(layout.attributes[i].semantic, semantic))
+				layout.attributes[i].stream = stream;
+		}
+		return layout;
+	}
+
+	// The attributes with this semantic alone in stream 0, the rest in stream 1
+	constexpr VertexLayoutDX11 Isolate(const char* semantic) const
+	{
+		VertexLayoutDX11 layout = *this;
+		for (size_t i = 0; i < TCount; i++)
+			layout.attributes[i].stream = IsSameSemanticDX11(layout.attributes[i].semantic, semantic) ? 0 : 1;
+		return layout;
+	}
+
+	constexpr D3D11_INPUT_ELEMENT_DESC GetElement(size_t attribute) const
+	{
+		return D3D11_INPUT_ELEMENT_DESC{ attributes[attribute].semantic,
+			attributes[attribute].semanticIndex,
+			attributes[attribute].format,
+			attributes[attribute].stream,
+			GetOffset(attribute),
+			D3D11_INPUT_PER_VERTEX_DATA,
+			0 };
+	}
+
+	constexpr VertexElementsDX11<TCount> GetElements() const
+	{
+		VertexElementsDX11<TCount> elements{};
+		for (size_t i = 0; i < TCount; i++)
+			elements.items[i] = GetElement(i);
+		return elements;
+	}
+
+	// The elements of one stream, reading from input slot 0, for passes that bind only it
+	void GetStreamElements(unsigned int stream, std::vector<D3D11_INPUT_ELEMENT_DESC>& elements) const
+	{
+		elements.clear();
+		for (size_t i = 0; i < TCount; i++)
+		{
+			if (attributes[i].stream != stream)
+				continue;
+			D3D11_INPUT_ELEMENT_DESC element = GetElement(i);
+			element.InputSlot = 0;
+			elements.push_back(element);
+		}
+	}
+
+	// One buffer per stream, each GetStride(stream) bytes a vertex
+	void SplitVertices(const std::vector<TVertex>& vertices, std::vector<std::vector<uint8_t>>& streams) const
+	{
+		streams.resize(GetStreamCount());
+		for (unsigned int s = 0; s < streams.size(); s++)
+			streams[s].resize(vertices.size() * GetStride(s));
+
+		for (size_t i = 0; i < TCount; i++)
+		{
+			const VertexAttributeDX11& attribute = attributes[i];
+			unsigned int stride = GetStride(attribute.stream);
+			uint8_t* out = streams[attribute.stream].data() + GetOffset(i);
+			for (size_t v = 0; v < vertices.size(); v++, out += stride)
+				std::memcpy(out, reinterpret_cast<const uint8_t*>(&vertices[v]) + attribute.memberOffset, attribute.memberSize);
+		}
+	}
+};
+
+//--------------------------------------------------------------------------------
+template<class TVertex, class... TAttributes>
+constexpr VertexLayoutDX11<TVertex, sizeof...(TAttributes)> MakeVertexLayoutDX11(TAttributes... attributes)
+{
+	return VertexLayoutDX11<TVertex, sizeof...(TAttributes)>{ { attributes... } };
+}
+//--------------------------------------------------------------------------------